@@ -0,0 +1,145 @@
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "aircraft/aircraft_loader.hpp"
+#include "simulation/aero_identification.hpp"
+
+// Aerodynamic coefficient identification from a flight log
+// Usage: AeroFit <log.csv> --aircraft <config.json> [--out <fitted.json>] [--mode table|polar]
+//                [--segment <s>] [--max-step <s>] [--integrator rk4|euler] [--max-iterations <n>] [--threads <n>]
+
+static void printUsage()
+{
+    std::cout << "Usage: AeroFit <log.csv> --aircraft <config.json> [--out <fitted.json>] [--mode table|polar]\n"
+              << "               [--segment <s>] [--max-step <s>] [--integrator rk4|euler] [--max-iterations <n>]\n"
+              << "               [--threads <n>]\n"
+              << "  Fits the aircraft's aero table (default) or its legacy polar (CL_alpha, CD0, k) so the\n"
+              << "  simulator reproduces the log (columns t, altitude, vx, vz, pitch_deg, throttle, optional x;\n"
+              << "  the simulator's trajectory CSVs qualify). Mass, wing area and thrust come from the aircraft.\n"
+              << "  Writes the fitted config (default: fitted_aircraft.json) and, in table mode, its\n"
+              << "  aero table next to it.\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::string logPath, aircraftPath, outPath = "fitted_aircraft.json";
+    AeroFitOptions options;
+    size_t threads = 0;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--aircraft" && i + 1 < argc)
+            {
+                aircraftPath = argv[++i];
+            }
+            else if (arg == "--out" && i + 1 < argc)
+            {
+                outPath = argv[++i];
+            }
+            else if (arg == "--mode" && i + 1 < argc)
+            {
+                std::string name = argv[++i];
+                if (name == "table")
+                    options.mode = AeroFitMode::Table;
+                else if (name == "polar")
+                    options.mode = AeroFitMode::Polar;
+                else
+                    throw std::runtime_error("Unknown mode: " + name);
+            }
+            else if (arg == "--segment" && i + 1 < argc)
+            {
+                options.segment_duration = std::stod(argv[++i]);
+            }
+            else if (arg == "--max-step" && i + 1 < argc)
+            {
+                options.max_step = std::stod(argv[++i]);
+            }
+            else if (arg == "--integrator" && i + 1 < argc)
+            {
+                std::string name = argv[++i];
+                if (name == "rk4")
+                    options.integrator = IntegratorType::RK4;
+                else if (name == "euler")
+                    options.integrator = IntegratorType::SemiImplicitEuler;
+                else
+                    throw std::runtime_error("Unknown integrator: " + name);
+            }
+            else if (arg == "--max-iterations" && i + 1 < argc)
+            {
+                options.max_iterations = std::stoi(argv[++i]);
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                threads = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage();
+                return 0;
+            }
+            else if (logPath.empty() && arg.rfind("--", 0) != 0)
+            {
+                logPath = arg;
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                printUsage();
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (logPath.empty() || aircraftPath.empty())
+    {
+        printUsage();
+        return 1;
+    }
+    if (!(options.segment_duration > 0.0) || !(options.max_step > 0.0))
+    {
+        std::cerr << "Error: --segment and --max-step must be positive\n";
+        return 1;
+    }
+
+    try
+    {
+        FlightLog log = FlightLog::loadFromCSV(logPath);
+        Aircraft aircraft = AircraftLoader::loadFromJSON(aircraftPath);
+        ThreadPool pool(threads);
+
+        std::cout << "Fitting " << (options.mode == AeroFitMode::Table ? "aero table" : "polar") << " to "
+                  << log.rows.size() << " log rows on " << pool.size() << " threads\n";
+        AeroFitResult result = fitAeroCoefficients(log, aircraft, options, pool);
+
+        std::cout << result.segments << " segments, " << result.residuals << " residuals, "
+                  << result.iterations << " iterations" << (result.converged ? "" : " (not converged)") << "\n"
+                  << "Residual RMS " << std::setprecision(4) << result.initial_rms << " -> " << result.final_rms
+                  << " (1 = " << options.position_scale << " m / " << options.velocity_scale << " m/s)\n";
+        for (size_t i = 0; i < result.parameters.size(); i++)
+        {
+            std::cout << "  " << std::left << std::setw(14) << result.parameter_names[i] << std::right
+                      << std::setprecision(6) << result.parameters[i] << "\n";
+        }
+
+        std::filesystem::path table = writeFittedAircraft(result, outPath);
+        std::cout << "Wrote " << outPath;
+        if (!table.empty())
+            std::cout << " and " << table.string();
+        std::cout << "\n";
+        return result.converged ? 0 : 2;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -4,13 +4,13 @@
 // Linear lift coefficient (legacy)
 double calcCL(double alpha, double CL_alpha)
 {
-    return CL_alpha * alpha; // alpha in radians
+    return calcCL<double>(alpha, CL_alpha);
 }
 
 // Drag coefficient (parabolic drag polar - legacy)
 double calcCD(double CL, double CD0, double k)
 {
-    return CD0 + k * CL * CL;
+    return calcCD<double>(CL, CD0, k);
 }
 
 // Lift coefficient from table data
@@ -36,23 +36,23 @@ double calcCD(double alpha, double CD0, const AeroDataTable *table)
 // Lift force [N]
 double calcLift(double rho, double V, double S, double CL)
 {
-    return 0.5 * rho * V * V * S * CL;
+    return calcLift<double>(rho, V, S, CL);
 }
 
 // Drag force [N]
 double calcDrag(double rho, double V, double S, double CD)
 {
-    return 0.5 * rho * V * V * S * CD;
+    return calcDrag<double>(rho, V, S, CD);
 }
 
 // Weight [N]
 double calcWeight(double mass, double g)
 {
-    return mass * g;
+    return calcWeight<double>(mass, g);
 }
 
 // Thrust [N] (simplified linear with throttle)
 double calcThrust(double throttle, double maxThrust)
 {
-    return throttle * maxThrust;
+    return calcThrust<double>(throttle, maxThrust);
 }
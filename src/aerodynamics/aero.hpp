@@ -31,4 +31,43 @@ double calcWeight(double mass, double g);
 // Thrust force
 double calcThrust(double throttle, double maxThrust);
 
+// Generic forms of the legacy coefficients and the forces for other scalar
+// types (dual numbers in sensitivity runs); the double functions above are
+// these templates instantiated for double
+template <typename T>
+inline T calcCL(const T &alpha, const T &CL_alpha)
+{
+    return CL_alpha * alpha; // alpha in radians
+}
+
+template <typename T>
+inline T calcCD(const T &CL, const T &CD0, const T &k)
+{
+    return CD0 + k * CL * CL;
+}
+
+template <typename T>
+inline T calcLift(const T &rho, const T &V, const T &S, const T &CL)
+{
+    return 0.5 * rho * V * V * S * CL;
+}
+
+template <typename T>
+inline T calcDrag(const T &rho, const T &V, const T &S, const T &CD)
+{
+    return 0.5 * rho * V * V * S * CD;
+}
+
+template <typename T>
+inline T calcWeight(const T &mass, const T &g)
+{
+    return mass * g;
+}
+
+template <typename T>
+inline T calcThrust(const T &throttle, const T &maxThrust)
+{
+    return throttle * maxThrust;
+}
+
 #endif
@@ -89,24 +89,62 @@ public:
         return table;
     }
 
+    // Build from points (alpha in radians); sorted here
+    static AeroDataTable fromPoints(std::vector<DataPoint> points)
+    {
+        AeroDataTable table;
+        table.data = std::move(points);
+        std::sort(table.data.begin(), table.data.end(),
+                  [](const DataPoint &a, const DataPoint &b)
+                  { return a.alpha < b.alpha; });
+        return table;
+    }
+
+    // Write in the format loadFromCSV reads (alpha in degrees, with header)
+    void saveToCSV(const std::string &filepath) const
+    {
+        std::ofstream file(filepath);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Failed to write aero data file: " + filepath);
+        }
+
+        file << "alpha,CL,CD\n";
+        file.precision(12);
+        for (const DataPoint &p : data)
+        {
+            file << p.alpha * 180.0 / M_PI << "," << p.CL << "," << p.CD << "\n";
+        }
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write aero data file: " + filepath);
+        }
+    }
+
+    const std::vector<DataPoint> &points() const { return data; }
+
     // Interpolate CL at given alpha (in radians)
-    double getCL(double alpha) const
+    // Alpha may also be a dual number (sensitivity runs): the segment is
+    // chosen by its value and the derivative is that segment's slope.
+    template <typename T>
+    T getCL(const T &alpha) const
     {
-        double CL = interpolate(alpha, [](const DataPoint &p)
+        T CL = interpolate(alpha, [](const DataPoint &p)
                                 { return p.CL; });
 
         // Clamp CL to minimum of 0 only when extrapolating beyond known data
         if (!data.empty() && (alpha < data.front().alpha || alpha > data.back().alpha))
         {
-            return std::max(0.0, CL);
+            return std::max(T(0.0), CL);
         }
         return CL;
     }
 
     // Interpolate CD at given alpha (in radians)
-    double getCD(double alpha) const
+    template <typename T>
+    T getCD(const T &alpha) const
     {
-        double CD = interpolate(alpha, [](const DataPoint &p)
+        T CD = interpolate(alpha, [](const DataPoint &p)
                                 { return p.CD; });
 
         // When extrapolating, clamp CD to the last known value to prevent unrealistic behavior
@@ -134,8 +172,8 @@ private:
     std::vector<DataPoint> data;
 
     // Linear interpolation helper with extrapolation
-    template <typename Func>
-    double interpolate(double alpha, Func getValue) const
+    template <typename T, typename Func>
+    T interpolate(const T &alpha, Func getValue) const
     {
         if (data.empty())
             return 0.0;
@@ -147,7 +185,7 @@ private:
         if (alpha < data.front().alpha)
         {
             double slope = (getValue(data[1]) - getValue(data[0])) / (data[1].alpha - data[0].alpha);
-            double delta_alpha = alpha - data.front().alpha;
+            T delta_alpha = alpha - data.front().alpha;
             return getValue(data.front()) + slope * delta_alpha;
         }
 
@@ -156,7 +194,7 @@ private:
         {
             size_t n = data.size();
             double slope = (getValue(data[n - 1]) - getValue(data[n - 2])) / (data[n - 1].alpha - data[n - 2].alpha);
-            double delta_alpha = alpha - data.back().alpha;
+            T delta_alpha = alpha - data.back().alpha;
             return getValue(data.back()) + slope * delta_alpha;
         }
 
@@ -166,7 +204,7 @@ private:
             if (alpha >= data[i].alpha && alpha <= data[i + 1].alpha)
             {
                 // Linear interpolation
-                double t = (alpha - data[i].alpha) / (data[i + 1].alpha - data[i].alpha);
+                T t = (alpha - data[i].alpha) / (data[i + 1].alpha - data[i].alpha);
                 return getValue(data[i]) + t * (getValue(data[i + 1]) - getValue(data[i]));
             }
         }
@@ -3,8 +3,9 @@
 #include <string>
 #include <memory>
 
-// Forward declaration
+// Forward declarations
 class AeroDataTable;
+class GainSchedule;
 
 // Aircraft class representing a fixed-wing aircraft with its physical and aerodynamic properties
 class Aircraft
@@ -23,23 +24,31 @@ public:
     double maxThrust; // Maximum thrust in N
 
     // Aerodynamic table data (optional, overrides legacy params if present)
-    std::shared_ptr<AeroDataTable> aeroTable;
+    // Immutable once loaded, so aircraft built from the same CSV share one instance
+    std::shared_ptr<const AeroDataTable> aeroTable;
     std::string aeroDataFile; // Path to CSV file
 
+    // Autopilot gains over dynamic pressure and altitude (optional, immutable and shared like the aero table)
+    std::shared_ptr<const GainSchedule> gainSchedule;
+    std::string gainScheduleFile; // Path to CSV file
+
     // Default constructor with typical ultralight aircraft values
     Aircraft()
         : mass(120.0), S(1.60), CL_alpha(5.7), CD0(0.025), k(0.04), maxThrust(500.0),
-          aeroTable(nullptr), aeroDataFile("")
+          aeroTable(nullptr), aeroDataFile(""), gainSchedule(nullptr), gainScheduleFile("")
     {
     }
 
     // Constructor with custom values
     Aircraft(double mass_, double S_, double CL_alpha_, double CD0_, double k_, double maxThrust_)
         : mass(mass_), S(S_), CL_alpha(CL_alpha_), CD0(CD0_), k(k_), maxThrust(maxThrust_),
-          aeroTable(nullptr), aeroDataFile("")
+          aeroTable(nullptr), aeroDataFile(""), gainSchedule(nullptr), gainScheduleFile("")
     {
     }
 
     // Check if using table data
     bool hasAeroTable() const { return aeroTable != nullptr; }
+
+    // Check if the autopilot gains are scheduled
+    bool hasGainSchedule() const { return gainSchedule != nullptr; }
 };
@@ -2,12 +2,16 @@
 
 #include "aircraft.hpp"
 #include "../aerodynamics/aero_data.hpp"
+#include "../control/gain_schedule.hpp"
+#include "../utils/json_value.hpp"
 #include <string>
 #include <fstream>
 #include <stdexcept>
 #include <sstream>
 #include <filesystem>
 #include <memory>
+#include <map>
+#include <mutex>
 
 // Simple JSON parser for aircraft configuration
 // Expects format: { "key": value, ... }
@@ -62,7 +66,7 @@ public:
 
             try
             {
-                ac.aeroTable = std::make_shared<AeroDataTable>(AeroDataTable::loadFromCSV(aeroPath.string()));
+                ac.aeroTable = loadSharedAeroTable(aeroPath);
             }
             catch (const std::exception &e)
             {
@@ -72,10 +76,87 @@ public:
             }
         }
 
+        // Check for optional gainScheduleFile field
+        std::string gainFile = parseString(content, "gainScheduleFile");
+        if (!gainFile.empty())
+        {
+            ac.gainScheduleFile = gainFile;
+            std::filesystem::path gainPath = std::filesystem::path(filepath).parent_path() / gainFile;
+
+            try
+            {
+                ac.gainSchedule = loadSharedTable<GainSchedule>(gainPath);
+            }
+            catch (const std::exception &e)
+            {
+                // Fall back to the fixed gains
+                ac.gainSchedule = nullptr;
+            }
+        }
+
         return ac;
     }
 
+    // Write an aircraft in the format loadFromJSON reads
+    // The aero table and gain schedule are referenced by their file names,
+    // relative to the JSON file, and are not written here.
+    static void saveToJSON(const Aircraft &ac, const std::string &filepath)
+    {
+        std::ofstream file(filepath);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Failed to write aircraft config file: " + filepath);
+        }
+
+        file.precision(12);
+        file << "{\n"
+             << "    \"mass\": " << ac.mass << ",\n"
+             << "    \"S\": " << ac.S << ",\n"
+             << "    \"CL_alpha\": " << ac.CL_alpha << ",\n"
+             << "    \"CD0\": " << ac.CD0 << ",\n"
+             << "    \"k\": " << ac.k << ",\n"
+             << "    \"maxThrust\": " << ac.maxThrust;
+        if (!ac.aeroDataFile.empty())
+            file << ",\n    \"aeroDataFile\": \"" << jsonEscape(ac.aeroDataFile) << "\"";
+        if (!ac.gainScheduleFile.empty())
+            file << ",\n    \"gainScheduleFile\": \"" << jsonEscape(ac.gainScheduleFile) << "\"";
+        file << "\n}\n";
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write aircraft config file: " + filepath);
+        }
+    }
+
+    // Load an aero table, reusing the instance already held by another aircraft
+    // Tables are keyed by canonical path and kept alive only by the aircraft using them.
+    static std::shared_ptr<const AeroDataTable> loadSharedAeroTable(const std::filesystem::path &path)
+    {
+        return loadSharedTable<AeroDataTable>(path);
+    }
+
 private:
+    // Shared immutable table of type T (anything with a static loadFromCSV)
+    template <typename T>
+    static std::shared_ptr<const T> loadSharedTable(const std::filesystem::path &path)
+    {
+        static std::mutex cacheMutex;
+        static std::map<std::string, std::weak_ptr<const T>> cache;
+
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+        std::string key = ec ? path.string() : canonical.string();
+
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (auto table = cache[key].lock())
+        {
+            return table;
+        }
+
+        auto table = std::make_shared<const T>(T::loadFromCSV(path.string()));
+        cache[key] = table;
+        return table;
+    }
+
     static double parseDouble(const std::string &json, const std::string &key)
     {
         // Find the key in the JSON string
@@ -154,11 +235,11 @@ private:
             return "";
         }
 
-        // Find closing quote
+        // Find the closing quote, skipping escaped characters, and unescape
         size_t valueEnd = valueStart + 1;
         while (valueEnd < json.length() && json[valueEnd] != '"')
         {
-            valueEnd++;
+            valueEnd += json[valueEnd] == '\\' ? 2 : 1;
         }
 
         if (valueEnd >= json.length())
@@ -166,6 +247,6 @@ private:
             return "";
         }
 
-        return json.substr(valueStart + 1, valueEnd - valueStart - 1);
+        return JsonValue::parse(json.substr(valueStart, valueEnd - valueStart + 1)).asString();
     }
 };
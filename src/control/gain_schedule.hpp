@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Autopilot gains for one flight condition
+struct ScheduledGains
+{
+    std::array<double, 3> speed;    // kp, ki, kd of the speed (throttle) loop
+    std::array<double, 3> altitude; // kp, ki, kd of the altitude (elevator) loop
+};
+
+// Autopilot gains tabulated over dynamic pressure and altitude
+// Format: q (Pa), altitude (m), speed_kp, speed_ki, speed_kd, alt_kp, alt_ki, alt_kd
+// (with optional header row). The rows must cover every (q, altitude)
+// combination of the breakpoints that appear, in any order. Lookups
+// interpolate bilinearly and hold the edge values outside the table.
+class GainSchedule
+{
+public:
+    static constexpr size_t GainCount = 6;
+
+    static GainSchedule loadFromCSV(const std::string &filepath)
+    {
+        std::ifstream file(filepath);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Failed to open gain schedule file: " + filepath);
+        }
+
+        struct Row
+        {
+            double q, altitude;
+            std::array<double, GainCount> gains;
+        };
+        std::vector<Row> rows;
+
+        std::string line;
+        bool firstLine = true;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line.find_first_not_of(" \t\r\n") == std::string::npos)
+                continue;
+
+            // Skip header if it contains non-numeric data
+            if (firstLine)
+            {
+                firstLine = false;
+                if (std::isalpha(static_cast<unsigned char>(line[0])))
+                    continue;
+            }
+
+            std::stringstream ss(line);
+            std::string token;
+            std::array<double, GainCount + 2> values;
+            size_t count = 0;
+            while (count < values.size() && std::getline(ss, token, ','))
+                values[count++] = std::stod(token);
+            if (count != values.size())
+                throw std::runtime_error("Gain schedule row needs 8 values: " + line);
+
+            Row row{values[0], values[1], {}};
+            std::copy(values.begin() + 2, values.end(), row.gains.begin());
+            rows.push_back(row);
+        }
+
+        if (rows.empty())
+        {
+            throw std::runtime_error("No valid data found in: " + filepath);
+        }
+
+        GainSchedule schedule;
+        for (const Row &row : rows)
+        {
+            schedule.qBreaks.push_back(row.q);
+            schedule.altitudeBreaks.push_back(row.altitude);
+        }
+        uniqueSorted(schedule.qBreaks);
+        uniqueSorted(schedule.altitudeBreaks);
+
+        size_t nodeCount = schedule.qBreaks.size() * schedule.altitudeBreaks.size();
+        if (rows.size() != nodeCount)
+            throw std::runtime_error("Gain schedule must be a full q x altitude grid: " + filepath);
+
+        schedule.nodes.resize(nodeCount);
+        std::vector<bool> seen(nodeCount, false);
+        for (const Row &row : rows)
+        {
+            size_t i = std::lower_bound(schedule.qBreaks.begin(), schedule.qBreaks.end(), row.q) - schedule.qBreaks.begin();
+            size_t j = std::lower_bound(schedule.altitudeBreaks.begin(), schedule.altitudeBreaks.end(), row.altitude) - schedule.altitudeBreaks.begin();
+            size_t index = i * schedule.altitudeBreaks.size() + j;
+            if (seen[index])
+                throw std::runtime_error("Duplicate gain schedule point in: " + filepath);
+            seen[index] = true;
+            schedule.nodes[index] = row.gains;
+        }
+        return schedule;
+    }
+
+    // Gains at dynamic pressure q and altitude
+    ScheduledGains lookup(double q, double altitude) const
+    {
+        double tq, th;
+        size_t i = segment(qBreaks, q, tq);
+        size_t j = segment(altitudeBreaks, altitude, th);
+
+        size_t stride = altitudeBreaks.size();
+        size_t i1 = std::min(i + 1, qBreaks.size() - 1);
+        size_t j1 = std::min(j + 1, stride - 1);
+        const std::array<double, GainCount> &g00 = nodes[i * stride + j];
+        const std::array<double, GainCount> &g01 = nodes[i * stride + j1];
+        const std::array<double, GainCount> &g10 = nodes[i1 * stride + j];
+        const std::array<double, GainCount> &g11 = nodes[i1 * stride + j1];
+
+        std::array<double, GainCount> g;
+        for (size_t k = 0; k < GainCount; k++)
+        {
+            double low = g00[k] + th * (g01[k] - g00[k]);
+            double high = g10[k] + th * (g11[k] - g10[k]);
+            g[k] = low + tq * (high - low);
+        }
+        return ScheduledGains{{g[0], g[1], g[2]}, {g[3], g[4], g[5]}};
+    }
+
+    const std::vector<double> &dynamicPressures() const { return qBreaks; }
+    const std::vector<double> &altitudes() const { return altitudeBreaks; }
+
+private:
+    std::vector<double> qBreaks;        // Sorted, unique
+    std::vector<double> altitudeBreaks; // Sorted, unique
+    std::vector<std::array<double, GainCount>> nodes; // [q index][altitude index]
+
+    static void uniqueSorted(std::vector<double> &values)
+    {
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+    }
+
+    // Interval containing x and the fraction along it (clamped to the table)
+    static size_t segment(const std::vector<double> &breaks, double x, double &t)
+    {
+        t = 0.0;
+        if (breaks.size() == 1 || x <= breaks.front())
+            return 0;
+        if (x >= breaks.back())
+            return breaks.size() - 1;
+
+        // Tables are small: a linear scan beats a binary search
+        size_t i = 0;
+        while (x > breaks[i + 1])
+            i++;
+        t = (x - breaks[i]) / (breaks[i + 1] - breaks[i]);
+        return i;
+    }
+};
@@ -32,9 +32,18 @@
  * INTEGRAL WINDUP PROTECTION:
  * The integral term can accumulate unbounded error when the system is
  * saturated (e.g., throttle at 100%). We clamp the integral to prevent this.
+ *
+ * SCALAR TYPE:
+ * T is the type of the gains, signals and controller state. The simulator
+ * uses PIDController (double, compiled once in pid.cpp); sensitivity runs
+ * instantiate it with dual numbers to differentiate through the gains.
+ * Output limits and the timestep are always plain doubles.
  */
 
-class PIDController {
+#include <algorithm>  // for std::clamp
+
+template <typename T>
+class PIDControllerT {
 public:
     /**
      * Constructor: Initialize PID gains
@@ -44,8 +53,8 @@ public:
      * @param output_min Minimum output value (e.g., 0.0 for throttle)
      * @param output_max Maximum output value (e.g., 1.0 for throttle)
      */
-    PIDController(double Kp, double Ki, double Kd, 
-                  double output_min = -1.0, double output_max = 1.0);
+    PIDControllerT(T Kp, T Ki, T Kd,
+                   double output_min = -1.0, double output_max = 1.0);
 
     /**
      * Update the PID controller with new measurement
@@ -63,7 +72,7 @@ public:
      * @param dt Time step (seconds)
      * @return Control output (clamped to limits)
      */
-    double update(double setpoint, double measurement, double dt);
+    T update(T setpoint, T measurement, double dt);
 
     /**
      * Reset the controller state
@@ -72,6 +81,19 @@ public:
      */
     void reset();
 
+    /**
+     * Change the gains without resetting the controller state
+     *
+     * Used for gain scheduling and live tuning. The accumulated integral is
+     * rescaled so the integral term Ki*integral is unchanged at the switch
+     * (bumpless transfer); the previous error is kept so the derivative
+     * stays continuous as well.
+     * @param Kp Proportional gain
+     * @param Ki Integral gain
+     * @param Kd Derivative gain
+     */
+    void setGains(T Kp, T Ki, T Kd);
+
     /**
      * Set new output limits (useful for different control surfaces)
      * @param min Minimum output value
@@ -82,29 +104,177 @@ public:
     /**
      * Get individual term contributions (for tuning/debugging)
      */
-    double getProportionalTerm() const { return p_term; }
-    double getIntegralTerm() const { return i_term; }
-    double getDerivativeTerm() const { return d_term; }
+    T getProportionalTerm() const { return p_term; }
+    T getIntegralTerm() const { return i_term; }
+    T getDerivativeTerm() const { return d_term; }
+
+    /**
+     * Current gains
+     */
+    T getKp() const { return Kp; }
+    T getKi() const { return Ki; }
+    T getKd() const { return Kd; }
+
+    /**
+     * Everything update() depends on, field by field (checkpoints save it
+     * in a portable form and restore it to continue exactly)
+     */
+    struct Snapshot
+    {
+        T Kp, Ki, Kd;
+        double output_min, output_max;
+        T integral, previous_error;
+        bool first_update;
+        T p_term, i_term, d_term;
+    };
+
+    Snapshot snapshot() const
+    {
+        return {Kp, Ki, Kd, output_min, output_max, integral, previous_error, first_update, p_term, i_term, d_term};
+    }
+
+    void restore(const Snapshot &s)
+    {
+        Kp = s.Kp;
+        Ki = s.Ki;
+        Kd = s.Kd;
+        output_min = s.output_min;
+        output_max = s.output_max;
+        integral = s.integral;
+        previous_error = s.previous_error;
+        first_update = s.first_update;
+        p_term = s.p_term;
+        i_term = s.i_term;
+        d_term = s.d_term;
+    }
 
 private:
     // PID gains
-    double Kp;  // Proportional gain
-    double Ki;  // Integral gain
-    double Kd;  // Derivative gain
+    T Kp;  // Proportional gain
+    T Ki;  // Integral gain
+    T Kd;  // Derivative gain
 
     // Output limits
     double output_min;
     double output_max;
 
     // State variables
-    double integral;        // Accumulated error over time
-    double previous_error;  // Error from last update (for derivative)
-    bool first_update;      // Track if this is the first update
+    T integral;        // Accumulated error over time
+    T previous_error;  // Error from last update (for derivative)
+    bool first_update; // Track if this is the first update
 
     // Individual term values (for debugging)
-    double p_term;
-    double i_term;
-    double d_term;
+    T p_term;
+    T i_term;
+    T d_term;
 };
 
+/**
+ * PROGRAMMING IMPLEMENTATION EXPLANATION:
+ * 
+ * The PID controller maintains internal state between updates:
+ * - integral: sum of all past errors * dt
+ * - previous_error: error from last timestep (for derivative calculation)
+ * 
+ * This makes it suitable for real-time control loops where update()
+ * is called repeatedly at regular intervals.
+ */
+
+template <typename T>
+PIDControllerT<T>::PIDControllerT(T Kp, T Ki, T Kd,
+                                  double output_min, double output_max)
+    : Kp(Kp), Ki(Ki), Kd(Kd),
+      output_min(output_min), output_max(output_max),
+      integral(0.0), previous_error(0.0), first_update(true),
+      p_term(0.0), i_term(0.0), d_term(0.0)
+{
+}
+
+template <typename T>
+T PIDControllerT<T>::update(T setpoint, T measurement, double dt)
+{
+    // STEP 1: Calculate current error
+    // Positive error means we're below setpoint (need to increase output)
+    T error = setpoint - measurement;
+
+    // STEP 2: Update integral term (accumulated error)
+    // This is the area under the error curve over time
+    integral += error * dt;
+    
+    // STEP 3: Anti-windup - Clamp integral to reasonable bounds
+    // Prevent integral from growing unbounded when output is saturated
+    // Simple approach: limit integral based on output range
+    T max_integral = (output_max - output_min) / (Ki + 1e-10);  // Avoid division by zero
+    integral = std::clamp(integral, -max_integral, max_integral);
+
+    // STEP 4: Calculate derivative term (rate of change of error)
+    // Derivative predicts future error trend
+    // Negative derivative means error is decreasing (good!)
+    // On first update, derivative is 0 (no previous error to compare)
+    T derivative = 0.0;
+    if (!first_update && dt > 1e-10) {  // Skip derivative on first update
+        derivative = (error - previous_error) / dt;
+    }
+    first_update = false;  // Mark that we've had at least one update
+
+    // STEP 5: Calculate individual PID terms
+    p_term = Kp * error;
+    i_term = Ki * integral;
+    d_term = Kd * derivative;
+
+    // STEP 6: Sum all terms to get control output
+    T output = p_term + i_term + d_term;
+
+    // STEP 7: Clamp output to physical limits
+    // (e.g., throttle can't be negative or > 100%)
+    output = std::clamp<T>(output, output_min, output_max);
+
+    // STEP 8: Store error for next derivative calculation
+    previous_error = error;
+
+    return output;
+}
+
+template <typename T>
+void PIDControllerT<T>::reset()
+{
+    // Clear accumulated state
+    // Use this when:
+    // - Starting a new control task
+    // - Setpoint changes dramatically
+    // - Switching control modes
+    integral = 0.0;
+    previous_error = 0.0;
+    first_update = true;
+    p_term = 0.0;
+    i_term = 0.0;
+    d_term = 0.0;
+}
+
+template <typename T>
+void PIDControllerT<T>::setGains(T Kp, T Ki, T Kd)
+{
+    // Keep the integral contribution continuous across the change
+    // (with Ki = 0 before or after, the integral has no contribution to preserve)
+    if (this->Ki > 0.0 && Ki > 0.0)
+    {
+        integral *= this->Ki / Ki;
+    }
+
+    this->Kp = Kp;
+    this->Ki = Ki;
+    this->Kd = Kd;
+}
+
+template <typename T>
+void PIDControllerT<T>::setOutputLimits(double min, double max)
+{
+    output_min = min;
+    output_max = max;
+}
+
+// The simulator's controller; its code is compiled once, in pid.cpp
+using PIDController = PIDControllerT<double>;
+extern template class PIDControllerT<double>;
+
 #endif
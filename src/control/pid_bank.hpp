@@ -0,0 +1,91 @@
+#ifndef PID_BANK_HPP
+#define PID_BANK_HPP
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Bank of independent PID controllers stepped in lockstep
+ *
+ * Same control law, anti-windup and output clamping as PIDController, but
+ * stored structure-of-arrays (one contiguous array per gain, limit and state
+ * variable) so that update() processes every controller in one loop the
+ * compiler can vectorize. Differences from calling PIDController::update()
+ * once per controller:
+ * - The anti-windup bound (output_max - output_min) / Ki is computed when the
+ *   gains or limits change instead of on every update
+ * - "First update" is a per-lane 0/1 factor on the derivative instead of a
+ *   branch
+ * The arithmetic per lane is otherwise identical, so each lane produces the
+ * same outputs as a PIDController with the same gains and inputs (up to
+ * rounding where the compiler fuses multiply-adds differently).
+ */
+class PIDBank
+{
+public:
+    PIDBank() = default;
+
+    /**
+     * Create count controllers sharing the same gains and limits
+     */
+    PIDBank(size_t count, double Kp, double Ki, double Kd,
+            double output_min = -1.0, double output_max = 1.0);
+
+    /**
+     * Append a controller
+     * @return Its index (lane) in the bank
+     */
+    size_t add(double Kp, double Ki, double Kd,
+               double output_min = -1.0, double output_max = 1.0);
+
+    size_t size() const { return kp.size(); }
+
+    /**
+     * Update every controller
+     *
+     * @param setpoints Desired target value per controller (size() entries)
+     * @param measurements Current actual value per controller
+     * @param dt Time step shared by the whole bank (seconds)
+     * @param outputs Control output per controller (clamped to its limits)
+     */
+    void update(const double *setpoints, const double *measurements, double dt, double *outputs);
+
+    /**
+     * Change one controller's gains without resetting its state
+     * (bumpless, like PIDController::setGains)
+     */
+    void setGains(size_t i, double Kp, double Ki, double Kd);
+
+    void setOutputLimits(size_t i, double min, double max);
+
+    /**
+     * Clear one controller's integral and derivative history
+     */
+    void reset(size_t i);
+
+    /**
+     * Clear every controller's integral and derivative history
+     */
+    void resetAll();
+
+    double getKp(size_t i) const { return kp[i]; }
+    double getKi(size_t i) const { return ki[i]; }
+    double getKd(size_t i) const { return kd[i]; }
+    double getIntegral(size_t i) const { return integral[i]; }
+    double getPreviousError(size_t i) const { return previous_error[i]; }
+
+private:
+    // Gains and limits
+    std::vector<double> kp, ki, kd;
+    std::vector<double> output_min, output_max;
+    std::vector<double> max_integral; // Anti-windup bound, cached from Ki and the limits
+
+    // State
+    std::vector<double> integral;
+    std::vector<double> previous_error;
+    std::vector<double> has_previous; // 0 before the first update, 1 after
+
+    void updateIntegralLimit(size_t i);
+};
+
+#endif
@@ -0,0 +1,377 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include "binary_io.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Live progress counters of a batch (scenario files, Monte Carlo runs)
+//
+// Every pool thread owns one cache-line slot (see ThreadPool::threadIndex)
+// and is its only writer: counters advance by a relaxed load and store,
+// plain moves with no locked read-modify-write and no line shared with
+// another writer, so workers never contend. Readers (ProgressReporter) only
+// load. Workers report steps and finished jobs as they go, and bracket the
+// time they spend working with beginWork()/endWork() for utilization.
+class BatchProgress
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // One slot per thread of the pool that runs the batch
+    explicit BatchProgress(size_t threads)
+        : slots(std::max<size_t>(1, threads)), start(Clock::now())
+    {
+    }
+
+    // Jobs in the batch, `done` of them finished before this run (resumed)
+    void setJobs(uint64_t total, uint64_t done = 0)
+    {
+        jobsTotal.store(total, std::memory_order_relaxed);
+        jobsBefore.store(done, std::memory_order_relaxed);
+    }
+
+    // Worker side: the calling thread's slot
+    void addSteps(uint64_t n) { bump(slot().steps, n); }
+    void addJobs(uint64_t n) { bump(slot().jobs, n); }
+    void beginWork() { slot().busySince.store(nanoseconds(), std::memory_order_relaxed); }
+    void endWork()
+    {
+        Slot &s = slot();
+        int64_t since = s.busySince.load(std::memory_order_relaxed);
+        if (since < 0)
+            return;
+        s.busySince.store(-1, std::memory_order_relaxed);
+        s.busyNs.store(s.busyNs.load(std::memory_order_relaxed) + nanoseconds() - since, std::memory_order_relaxed);
+    }
+
+    size_t workers() const { return slots.size(); }
+
+    // Totals so far (a consistent view per counter, not across counters)
+    struct Sample
+    {
+        double elapsed = 0.0; // s since the batch started
+        uint64_t jobs_total = 0;
+        uint64_t jobs_done = 0;   // Including those done before a resume
+        uint64_t jobs_before = 0; // Done before this run
+        uint64_t steps = 0;
+        std::vector<uint64_t> worker_steps;
+        std::vector<double> worker_busy; // s, including a job in progress
+    };
+
+    Sample sample() const
+    {
+        Sample s;
+        const int64_t now = nanoseconds();
+        s.elapsed = 1e-9 * static_cast<double>(now);
+        s.jobs_total = jobsTotal.load(std::memory_order_relaxed);
+        s.jobs_before = jobsBefore.load(std::memory_order_relaxed);
+        s.jobs_done = s.jobs_before;
+        for (const Slot &slot : slots)
+        {
+            uint64_t steps = slot.steps.load(std::memory_order_relaxed);
+            int64_t busy = slot.busyNs.load(std::memory_order_relaxed);
+            int64_t since = slot.busySince.load(std::memory_order_relaxed);
+            if (since >= 0)
+                busy += std::max<int64_t>(0, now - since);
+            s.steps += steps;
+            s.jobs_done += slot.jobs.load(std::memory_order_relaxed);
+            s.worker_steps.push_back(steps);
+            s.worker_busy.push_back(1e-9 * static_cast<double>(busy));
+        }
+        return s;
+    }
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> steps{0};
+        std::atomic<uint64_t> jobs{0};
+        std::atomic<int64_t> busyNs{0};     // Finished work
+        std::atomic<int64_t> busySince{-1}; // Start of the work in progress (ns), -1 when idle
+    };
+
+    std::vector<Slot> slots;
+    Clock::time_point start;
+    std::atomic<uint64_t> jobsTotal{0};
+    std::atomic<uint64_t> jobsBefore{0};
+
+    Slot &slot() { return slots[ThreadPool::threadIndex() % slots.size()]; }
+
+    static void bump(std::atomic<uint64_t> &counter, uint64_t n)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    int64_t nanoseconds() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+};
+
+// Rates over the interval between two samples
+struct BatchRates
+{
+    double steps_per_second = 0.0;
+    double eta = std::numeric_limits<double>::quiet_NaN(); // s; NaN until a job finishes
+    std::vector<double> worker_utilization;                // Busy fraction, 0 .. 1
+};
+
+inline BatchRates batchRates(const BatchProgress::Sample &previous, const BatchProgress::Sample &current)
+{
+    BatchRates r;
+    const double dt = current.elapsed - previous.elapsed;
+    if (dt > 0.0)
+        r.steps_per_second = static_cast<double>(current.steps - previous.steps) / dt;
+    // Jobs left at the average rate of this run
+    const uint64_t doneHere = current.jobs_done - current.jobs_before;
+    if (current.jobs_done >= current.jobs_total && current.jobs_total > 0)
+        r.eta = 0.0;
+    else if (doneHere > 0 && current.elapsed > 0.0)
+        r.eta = static_cast<double>(current.jobs_total - current.jobs_done) * current.elapsed /
+                static_cast<double>(doneHere);
+    for (size_t i = 0; i < current.worker_busy.size(); i++)
+    {
+        double busy = current.worker_busy[i] - (i < previous.worker_busy.size() ? previous.worker_busy[i] : 0.0);
+        r.worker_utilization.push_back(dt > 0.0 ? std::clamp(busy / dt, 0.0, 1.0) : 0.0);
+    }
+    return r;
+}
+
+// One-line summary, e.g.
+// [  12.0 s] 1.25e+06 steps/s | jobs 340/1000 (660 left) | ETA 24 s | workers 98% 97% 12% 99%
+inline std::string formatBatchStatus(const BatchProgress::Sample &s, const BatchRates &r)
+{
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer), "[%6.1f s] %9.3g steps/s | jobs %llu/%llu (%llu left) | ETA ", s.elapsed,
+                  r.steps_per_second, static_cast<unsigned long long>(s.jobs_done),
+                  static_cast<unsigned long long>(s.jobs_total),
+                  static_cast<unsigned long long>(s.jobs_total > s.jobs_done ? s.jobs_total - s.jobs_done : 0));
+    std::string line = buffer;
+    if (std::isnan(r.eta))
+        line += "--";
+    else
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.0f s", r.eta);
+        line += buffer;
+    }
+    line += " | workers";
+    for (double u : r.worker_utilization)
+    {
+        std::snprintf(buffer, sizeof(buffer), " %3.0f%%", 100.0 * u);
+        line += buffer;
+    }
+    return line;
+}
+
+// Prometheus text exposition format (version 0.0.4), for the node exporter
+// textfile collector; every series carries a batch="<name>" label
+inline std::string formatBatchMetrics(const std::string &batch, const BatchProgress::Sample &s, const BatchRates &r)
+{
+    std::string label;
+    for (char c : batch)
+    {
+        if (c == '\\' || c == '"')
+            label += '\\';
+        if (c == '\n')
+            label += "\\n";
+        else
+            label += c;
+    }
+    std::ostringstream out;
+    out.precision(17);
+    auto metric = [&](const char *name, const char *type, const char *help)
+    { out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n"; };
+    auto value = [&](double v)
+    {
+        if (std::isnan(v))
+            out << "NaN";
+        else
+            out << v;
+        out << "\n";
+    };
+    auto series = [&](const char *name)
+    { out << name << "{batch=\"" << label << "\"} "; };
+    auto workerSeries = [&](const char *name, size_t worker)
+    { out << name << "{batch=\"" << label << "\",worker=\"" << worker << "\"} "; };
+
+    metric("flightsim_batch_elapsed_seconds", "gauge", "Wall time since the batch started");
+    series("flightsim_batch_elapsed_seconds");
+    value(s.elapsed);
+    metric("flightsim_batch_jobs", "gauge", "Jobs in the batch");
+    series("flightsim_batch_jobs");
+    value(static_cast<double>(s.jobs_total));
+    metric("flightsim_batch_jobs_done", "gauge", "Jobs finished, including those before a resume");
+    series("flightsim_batch_jobs_done");
+    value(static_cast<double>(s.jobs_done));
+    metric("flightsim_batch_steps_per_second", "gauge", "Aircraft steps per second over the last interval");
+    series("flightsim_batch_steps_per_second");
+    value(r.steps_per_second);
+    metric("flightsim_batch_eta_seconds", "gauge", "Estimated time to finish the remaining jobs");
+    series("flightsim_batch_eta_seconds");
+    value(r.eta);
+    metric("flightsim_batch_steps_total", "counter", "Aircraft steps simulated per worker");
+    for (size_t i = 0; i < s.worker_steps.size(); i++)
+    {
+        workerSeries("flightsim_batch_steps_total", i);
+        value(static_cast<double>(s.worker_steps[i]));
+    }
+    metric("flightsim_batch_worker_busy_seconds_total", "counter", "Time each worker spent on jobs");
+    for (size_t i = 0; i < s.worker_busy.size(); i++)
+    {
+        workerSeries("flightsim_batch_worker_busy_seconds_total", i);
+        value(s.worker_busy[i]);
+    }
+    metric("flightsim_batch_worker_utilization", "gauge", "Busy fraction of each worker over the last interval");
+    for (size_t i = 0; i < r.worker_utilization.size(); i++)
+    {
+        workerSeries("flightsim_batch_worker_utilization", i);
+        value(r.worker_utilization[i]);
+    }
+    return out.str();
+}
+
+// Whether standard error is a terminal (status lines then overwrite each other)
+inline bool stderrIsTerminal()
+{
+#ifdef _WIN32
+    return _isatty(_fileno(stderr)) != 0;
+#else
+    return isatty(fileno(stderr)) != 0;
+#endif
+}
+
+// Reports a batch's progress every interval from its own thread: a status
+// line to a stream and/or the metrics to a Prometheus text file, replaced
+// atomically so a scraper never reads half a file. stop() (or destruction)
+// reports once more and ends the status line. A metrics file that cannot be
+// written never ends the batch: reports go on, and the first failure is kept
+// for error().
+class ProgressReporter
+{
+public:
+    struct Options
+    {
+        std::string batch = "batch";           // Metrics label
+        std::ostream *status = nullptr;        // Status line target, none if null
+        bool overwrite = false;                // End lines with \r (a terminal) instead of \n
+        std::filesystem::path metrics_file;    // Prometheus file, none if empty
+        double interval = 1.0;                 // s; <= 0 reports only on report() and stop()
+    };
+
+    ProgressReporter(const BatchProgress &progress_, Options options_)
+        : progress(progress_), options(std::move(options_)), previous(progress.sample())
+    {
+        if (options.interval > 0.0)
+            worker = std::thread([this]
+                                 { run(); });
+    }
+
+    ProgressReporter(const ProgressReporter &) = delete;
+    ProgressReporter &operator=(const ProgressReporter &) = delete;
+
+    ~ProgressReporter()
+    {
+        try
+        {
+            stop();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopped)
+                return;
+            stopped = true;
+        }
+        wake.notify_all();
+        if (worker.joinable())
+            worker.join();
+        tryReport();
+        if (options.status && options.overwrite)
+            *options.status << "\n" << std::flush;
+    }
+
+    // Sample now and write the outputs
+    void report()
+    {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        BatchProgress::Sample current = progress.sample();
+        BatchRates rates = batchRates(previous, current);
+        if (options.status)
+            *options.status << formatBatchStatus(current, rates) << (options.overwrite ? "\r" : "\n") << std::flush;
+        if (!options.metrics_file.empty())
+        {
+            std::string text = formatBatchMetrics(options.batch, current, rates);
+            writeFileAtomically(options.metrics_file, std::vector<uint8_t>(text.begin(), text.end()));
+        }
+        previous = std::move(current);
+    }
+
+    // First failed report, empty if none; read after stop()
+    const std::string &error() const { return failure; }
+
+private:
+    const BatchProgress &progress;
+    Options options;
+    BatchProgress::Sample previous;
+    std::thread worker;
+    std::mutex mutex;       // Guards stopped
+    std::mutex reportMutex; // One report at a time
+    std::condition_variable wake;
+    bool stopped = false;
+    std::string failure; // Set by tryReport() alone: the worker, then stop()
+
+    void run()
+    {
+        const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(options.interval));
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, period, [this]
+                              { return stopped; }))
+        {
+            lock.unlock();
+            tryReport();
+            lock.lock();
+        }
+    }
+
+    void tryReport()
+    {
+        try
+        {
+            report();
+        }
+        catch (const std::exception &e)
+        {
+            if (failure.empty())
+                failure = e.what();
+        }
+    }
+};
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Little-endian binary encoding into a growable buffer, and bounds-checked
+// decoding of one (as telemetry_frame.hpp does for fixed-size datagrams)
+class BinaryWriter
+{
+public:
+    std::vector<uint8_t> bytes;
+
+    void u8(uint8_t v) { bytes.push_back(v); }
+    void u32(uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            bytes.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+    void u64(uint64_t v)
+    {
+        for (int i = 0; i < 8; i++)
+            bytes.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+    void f32(float v)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u32(bits);
+    }
+    void f64(double v)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u64(bits);
+    }
+    // LEB128 varint: 7 bits per byte, small values in one byte
+    void uvarint(uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            bytes.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(v));
+    }
+    // Signed varint, zigzag mapped (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...)
+    void svarint(int64_t v) { uvarint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+    void string(const std::string &s)
+    {
+        u32(static_cast<uint32_t>(s.size()));
+        bytes.insert(bytes.end(), s.begin(), s.end());
+    }
+    void raw(const void *data, size_t size)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        bytes.insert(bytes.end(), p, p + size);
+    }
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(const uint8_t *data, size_t size) : p(data), end(data + size) {}
+    explicit BinaryReader(const std::vector<uint8_t> &bytes) : BinaryReader(bytes.data(), bytes.size()) {}
+
+    uint8_t u8()
+    {
+        need(1);
+        return *p++;
+    }
+    uint32_t u32()
+    {
+        need(4);
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++)
+            v |= static_cast<uint32_t>(*p++) << (8 * i);
+        return v;
+    }
+    uint64_t u64()
+    {
+        need(8);
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++)
+            v |= static_cast<uint64_t>(*p++) << (8 * i);
+        return v;
+    }
+    float f32()
+    {
+        uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    double f64()
+    {
+        uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    uint64_t uvarint()
+    {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            need(1);
+            uint8_t byte = *p++;
+            v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return v;
+        }
+        throw std::runtime_error("Malformed varint");
+    }
+    int64_t svarint()
+    {
+        uint64_t z = uvarint();
+        return static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+    }
+    std::string string()
+    {
+        uint32_t size = u32();
+        need(size);
+        std::string s(reinterpret_cast<const char *>(p), size);
+        p += size;
+        return s;
+    }
+    void raw(void *data, size_t size)
+    {
+        need(size);
+        std::memcpy(data, p, size);
+        p += size;
+    }
+
+    // The next size bytes, in place
+    const uint8_t *skip(size_t size)
+    {
+        need(size);
+        const uint8_t *at = p;
+        p += size;
+        return at;
+    }
+
+    // Element count of a list that follows, checked against the data left
+    // (so a corrupt count fails here rather than in a huge allocation)
+    size_t count(size_t elementSize)
+    {
+        size_t n = u32();
+        need(n * elementSize);
+        return n;
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end - p); }
+
+private:
+    const uint8_t *p;
+    const uint8_t *end;
+
+    void need(size_t n) const
+    {
+        if (static_cast<size_t>(end - p) < n)
+            throw std::runtime_error("Truncated binary data");
+    }
+};
+
+// 64-bit FNV-1a hash, e.g. to fingerprint the settings a file was made with
+inline uint64_t fnv1a64(const std::vector<uint8_t> &bytes)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (uint8_t b : bytes)
+    {
+        h ^= b;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+// Replace a file in one step: write <path>.tmp, sync it to the disk, then
+// rename it over the target and sync the directory entry. A crash of the
+// process or of the machine leaves either the old file or the new one, never
+// a torn mix (rename within a directory is atomic on POSIX and NTFS). On
+// Windows the directory is not synced; NTFS journals the rename itself.
+inline void writeFileAtomically(const std::filesystem::path &path, const std::vector<uint8_t> &bytes)
+{
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    std::FILE *file = std::fopen(tmp.string().c_str(), "wb");
+    if (!file)
+        throw std::runtime_error("Failed to open " + tmp.string());
+    bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+    written = written && _commit(_fileno(file)) == 0;
+#else
+    written = written && ::fsync(fileno(file)) == 0;
+#endif
+    written = std::fclose(file) == 0 && written;
+    if (!written)
+        throw std::runtime_error("Failed to write " + tmp.string());
+
+    std::error_code error;
+    std::filesystem::rename(tmp, path, error);
+    if (error)
+        throw std::runtime_error("Failed to replace " + path.string() + ": " + error.message());
+#ifndef _WIN32
+    std::filesystem::path dir = path.parent_path();
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open directory of " + path.string());
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    if (!synced)
+        throw std::runtime_error("Failed to sync directory of " + path.string());
+#endif
+}
+
+inline std::vector<uint8_t> readFileBytes(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open " + path.string());
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Counter-based random numbers (Philox4x32-10, Salmon et al., "Parallel
+// random numbers: as easy as 1, 2, 3", SC 2011)
+//
+// A Philox block is a pure function of a 128-bit counter and a 64-bit key:
+// ten rounds of two 32x32->64 multiplies and xors scramble the counter into
+// four random words. There is no generator state to carry, split or store,
+// so any number can be recomputed from its coordinates alone, on any thread
+// and in any order, and a sweep can be rerun in part with identical draws.
+using PhiloxCounter = std::array<uint32_t, 4>;
+using PhiloxKey = std::array<uint32_t, 2>;
+
+namespace philox_detail
+{
+    constexpr uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u; // Round multipliers
+    constexpr uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u; // Key schedule (golden ratio, sqrt 3)
+    constexpr int Rounds = 10;
+
+    // Philox on W independent counters in lane arrays: the same rounds as
+    // philox4x32() written as plain loops over lanes, which compilers turn
+    // into SIMD multiplies (see simd_pack.hpp for the approach)
+    template <size_t W>
+    inline void philoxLanes(uint32_t (&c)[4][W], PhiloxKey key)
+    {
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int r = 0; r < Rounds; r++)
+        {
+            for (size_t i = 0; i < W; i++)
+            {
+                uint64_t p0 = uint64_t(M0) * c[0][i];
+                uint64_t p1 = uint64_t(M1) * c[2][i];
+                uint32_t x0 = uint32_t(p1 >> 32) ^ c[1][i] ^ k0;
+                uint32_t x1 = uint32_t(p1);
+                uint32_t x2 = uint32_t(p0 >> 32) ^ c[3][i] ^ k1;
+                uint32_t x3 = uint32_t(p0);
+                c[0][i] = x0;
+                c[1][i] = x1;
+                c[2][i] = x2;
+                c[3][i] = x3;
+            }
+            k0 += W0;
+            k1 += W1;
+        }
+    }
+
+    // 53-bit uniform in [0, 1) from two words
+    inline double toUniform(uint32_t hi, uint32_t lo)
+    {
+        return static_cast<double>(((uint64_t(hi) << 32) | lo) >> 11) * 0x1.0p-53;
+    }
+
+    // Box-Muller pair from one block (the first uniform kept off zero)
+    inline void toNormals(const uint32_t w[4], double &a, double &b)
+    {
+        double u1 = toUniform(w[0], w[1]) + 0x1.0p-54;
+        double u2 = toUniform(w[2], w[3]);
+        double r = std::sqrt(-2.0 * std::log(u1));
+        a = r * std::cos(2.0 * M_PI * u2);
+        b = r * std::sin(2.0 * M_PI * u2);
+    }
+}
+
+// One Philox4x32-10 block
+inline std::array<uint32_t, 4> philox4x32(const PhiloxCounter &counter, const PhiloxKey &key)
+{
+    uint32_t c[4][1] = {{counter[0]}, {counter[1]}, {counter[2]}, {counter[3]}};
+    philox_detail::philoxLanes<1>(c, key);
+    return {c[0][0], c[1][0], c[2][0], c[3][0]};
+}
+
+// Random numbers addressed by (seed, run, stream, step, index)
+// The seed is the Philox key; the counter holds (index, step, stream, run),
+// so every run, stream (one per stochastic feature) and step has its own
+// sequence, indexed from zero. Uniform i and normal i both come from block
+// i / 2: uniforms from its two halves, normals as its Box-Muller pair.
+// The fill functions compute sixteen blocks per pass in lanes and return
+// exactly what the element-wise calls return.
+class CounterRng
+{
+public:
+    static constexpr size_t Lanes = 16;
+
+    explicit CounterRng(uint64_t seed, uint32_t run = 0, uint32_t stream = 0)
+        : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}, run_(run), stream_(stream)
+    {
+    }
+
+    uint32_t run() const { return run_; }
+    uint32_t stream() const { return stream_; }
+
+    std::array<uint32_t, 4> block(uint32_t step, uint32_t index) const
+    {
+        return philox4x32({index, step, stream_, run_}, key);
+    }
+
+    // Uniform in [0, 1)
+    double uniform(uint32_t step, uint32_t index) const
+    {
+        std::array<uint32_t, 4> w = block(step, index / 2);
+        return (index & 1) ? philox_detail::toUniform(w[2], w[3]) : philox_detail::toUniform(w[0], w[1]);
+    }
+
+    // Standard normal
+    double normal(uint32_t step, uint32_t index) const
+    {
+        std::array<uint32_t, 4> w = block(step, index / 2);
+        double a, b;
+        philox_detail::toNormals(w.data(), a, b);
+        return (index & 1) ? b : a;
+    }
+
+    // Raw blocks first .. first + count - 1 of a step, four words each
+    void fill(uint32_t step, uint32_t first, uint32_t *out, size_t count) const
+    {
+        uint32_t c[4][Lanes];
+        for (size_t base = 0; base < count; base += Lanes)
+        {
+            generate(step, first + static_cast<uint32_t>(base), c);
+            const size_t n = std::min(Lanes, count - base);
+            for (size_t i = 0; i < n; i++)
+                for (size_t j = 0; j < 4; j++)
+                    out[4 * (base + i) + j] = c[j][i];
+        }
+    }
+
+    // Uniforms first .. first + count - 1 of a step
+    void fillUniform(uint32_t step, uint32_t first, double *out, size_t count) const
+    {
+        fillPairs(step, first, out, count, [](const uint32_t (&c)[4][Lanes], double (&v)[2 * Lanes])
+                  {
+            for (size_t i = 0; i < Lanes; i++)
+            {
+                v[2 * i] = philox_detail::toUniform(c[0][i], c[1][i]);
+                v[2 * i + 1] = philox_detail::toUniform(c[2][i], c[3][i]);
+            } });
+    }
+
+    // Normals first .. first + count - 1 of a step
+    void fillNormal(uint32_t step, uint32_t first, double *out, size_t count) const
+    {
+        fillPairs(step, first, out, count, [](const uint32_t (&c)[4][Lanes], double (&v)[2 * Lanes])
+                  {
+            for (size_t i = 0; i < Lanes; i++)
+            {
+                const uint32_t w[4] = {c[0][i], c[1][i], c[2][i], c[3][i]};
+                philox_detail::toNormals(w, v[2 * i], v[2 * i + 1]);
+            } });
+    }
+
+private:
+    PhiloxKey key;
+    uint32_t run_;
+    uint32_t stream_;
+
+    // Blocks first .. first + Lanes - 1 of a step, in lanes
+    void generate(uint32_t step, uint32_t first, uint32_t (&c)[4][Lanes]) const
+    {
+        for (size_t i = 0; i < Lanes; i++)
+        {
+            c[0][i] = first + static_cast<uint32_t>(i);
+            c[1][i] = step;
+            c[2][i] = stream_;
+            c[3][i] = run_;
+        }
+        philox_detail::philoxLanes<Lanes>(c, key);
+    }
+
+    // Two values per block, converted Lanes blocks at a time; an odd start
+    // skips the first half block
+    template <typename Convert>
+    void fillPairs(uint32_t step, uint32_t first, double *out, size_t count, Convert &&convert) const
+    {
+        uint32_t c[4][Lanes];
+        double values[2 * Lanes];
+        size_t skip = first & 1;
+        size_t done = 0;
+        for (uint32_t index = first / 2; done < count; index += Lanes)
+        {
+            generate(step, index, c);
+            convert(c, values);
+            const size_t n = std::min(2 * Lanes - skip, count - done);
+            std::copy(values + skip, values + skip + n, out + done);
+            done += n;
+            skip = 0;
+        }
+    }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Solve (A + lambda diag(A)) x = b by Cholesky; false if not positive definite
+// A is a dense symmetric n x n matrix (row-major), typically J^T J of a
+// Levenberg-Marquardt step. Parameters the data does not excite have zero
+// rows in A; the diagonal floor keeps them at their starting values.
+inline bool solveDampedCholesky(const std::vector<double> &A, const std::vector<double> &b, double lambda,
+                                std::vector<double> &x)
+{
+    const size_t n = b.size();
+    double max_diag = 0.0;
+    for (size_t i = 0; i < n; i++)
+        max_diag = std::max(max_diag, A[i * n + i]);
+    const double floor = std::max(max_diag, 1.0) * 1e-12;
+
+    std::vector<double> Lm(A);
+    for (size_t i = 0; i < n; i++)
+        Lm[i * n + i] += lambda * std::max(A[i * n + i], floor);
+
+    for (size_t j = 0; j < n; j++)
+    {
+        double d = Lm[j * n + j];
+        for (size_t k = 0; k < j; k++)
+            d -= Lm[j * n + k] * Lm[j * n + k];
+        if (!(d > 0.0))
+            return false;
+        d = std::sqrt(d);
+        Lm[j * n + j] = d;
+        for (size_t i = j + 1; i < n; i++)
+        {
+            double s = Lm[i * n + j];
+            for (size_t k = 0; k < j; k++)
+                s -= Lm[i * n + k] * Lm[j * n + k];
+            Lm[i * n + j] = s / d;
+        }
+    }
+
+    x.assign(n, 0.0);
+    for (size_t i = 0; i < n; i++) // L y = b
+    {
+        double s = b[i];
+        for (size_t k = 0; k < i; k++)
+            s -= Lm[i * n + k] * x[k];
+        x[i] = s / Lm[i * n + i];
+    }
+    for (size_t i = n; i-- > 0;) // L^T x = y
+    {
+        double s = x[i];
+        for (size_t k = i + 1; k < n; k++)
+            s -= Lm[k * n + i] * x[k];
+        x[i] = s / Lm[i * n + i];
+    }
+    return true;
+}
@@ -0,0 +1,155 @@
+#ifndef DUAL_HPP
+#define DUAL_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+// Dual number for forward-mode automatic differentiation
+// Carries a value and its derivatives with respect to N independent inputs,
+// so one evaluation of a generic function gives the function and its full
+// gradient. Seed input i with Dual::variable(x, i); every other number
+// (literals, constants converted from double) has zero derivatives.
+// Comparisons look at the value only, so branches follow the primal
+// computation and the derivative is that of the branch taken.
+template <size_t N>
+struct Dual
+{
+    using value_type = double;
+    static constexpr size_t size = N;
+
+    double v = 0.0;            // Value
+    std::array<double, N> d{}; // d(value) / d(input i)
+
+    Dual() = default;
+    Dual(double value) : v(value) {} // Constant
+
+    static Dual variable(double value, size_t index)
+    {
+        Dual r(value);
+        r.d[index] = 1.0;
+        return r;
+    }
+
+    // Chain rule for a scalar function f with f(x.v) = value, f'(x.v) = slope
+    static Dual apply(const Dual &x, double value, double slope)
+    {
+        Dual r(value);
+        for (size_t i = 0; i < N; i++)
+            r.d[i] = slope * x.d[i];
+        return r;
+    }
+
+    Dual operator-() const
+    {
+        Dual r(-v);
+        for (size_t i = 0; i < N; i++)
+            r.d[i] = -d[i];
+        return r;
+    }
+
+    Dual &operator+=(const Dual &o)
+    {
+        v += o.v;
+        for (size_t i = 0; i < N; i++)
+            d[i] += o.d[i];
+        return *this;
+    }
+
+    Dual &operator-=(const Dual &o)
+    {
+        v -= o.v;
+        for (size_t i = 0; i < N; i++)
+            d[i] -= o.d[i];
+        return *this;
+    }
+
+    Dual &operator*=(const Dual &o)
+    {
+        for (size_t i = 0; i < N; i++)
+            d[i] = d[i] * o.v + v * o.d[i];
+        v *= o.v;
+        return *this;
+    }
+
+    Dual &operator/=(const Dual &o)
+    {
+        double q = v / o.v;
+        for (size_t i = 0; i < N; i++)
+            d[i] = (d[i] - q * o.d[i]) / o.v;
+        v = q;
+        return *this;
+    }
+
+    // Arithmetic; plain numbers convert to constants, products and quotients
+    // with a double skip the zero derivatives
+    friend Dual operator+(Dual a, const Dual &b) { return a += b; }
+    friend Dual operator-(Dual a, const Dual &b) { return a -= b; }
+    friend Dual operator*(Dual a, const Dual &b) { return a *= b; }
+    friend Dual operator/(Dual a, const Dual &b) { return a /= b; }
+
+    friend Dual operator*(Dual a, double s)
+    {
+        a.v *= s;
+        for (size_t i = 0; i < N; i++)
+            a.d[i] *= s;
+        return a;
+    }
+    friend Dual operator*(double s, const Dual &a) { return a * s; }
+    friend Dual operator/(const Dual &a, double s) { return a * (1.0 / s); }
+
+    friend bool operator<(const Dual &a, const Dual &b) { return a.v < b.v; }
+    friend bool operator<=(const Dual &a, const Dual &b) { return a.v <= b.v; }
+    friend bool operator>(const Dual &a, const Dual &b) { return a.v > b.v; }
+    friend bool operator>=(const Dual &a, const Dual &b) { return a.v >= b.v; }
+    friend bool operator==(const Dual &a, const Dual &b) { return a.v == b.v; }
+    friend bool operator!=(const Dual &a, const Dual &b) { return a.v != b.v; }
+
+    // Math functions, found by argument-dependent lookup from generic code
+    // At 0 the slope is infinite; take 0 (e.g. the speed of an aircraft at
+    // rest) instead of spreading inf * 0 = NaN into every derivative
+    friend Dual sqrt(const Dual &x)
+    {
+        double r = std::sqrt(x.v);
+        return apply(x, r, r > 0.0 ? 0.5 / r : 0.0);
+    }
+    friend Dual sin(const Dual &x) { return apply(x, std::sin(x.v), std::cos(x.v)); }
+    friend Dual cos(const Dual &x) { return apply(x, std::cos(x.v), -std::sin(x.v)); }
+    friend Dual exp(const Dual &x)
+    {
+        double e = std::exp(x.v);
+        return apply(x, e, e);
+    }
+    friend Dual log(const Dual &x) { return apply(x, std::log(x.v), 1.0 / x.v); }
+    friend Dual pow(const Dual &x, double p) { return apply(x, std::pow(x.v, p), p * std::pow(x.v, p - 1.0)); }
+    friend Dual fabs(const Dual &x) { return x.v < 0.0 ? -x : x; }
+
+    friend Dual atan2(const Dual &y, const Dual &x)
+    {
+        double r2 = x.v * x.v + y.v * y.v;
+        Dual r(std::atan2(y.v, x.v));
+        if (r2 > 0.0) // Undefined at the origin: no derivative rather than NaN
+            for (size_t i = 0; i < N; i++)
+                r.d[i] = (x.v * y.d[i] - y.v * x.d[i]) / r2;
+        return r;
+    }
+};
+
+// The plain value of a scalar: the number itself, or a dual number's value
+inline double scalarValue(double x) { return x; }
+
+template <size_t N>
+inline double scalarValue(const Dual<N> &x) { return x.v; }
+
+template <typename T>
+struct IsDual : std::false_type
+{
+};
+
+template <size_t N>
+struct IsDual<Dual<N>> : std::true_type
+{
+};
+
+#endif // DUAL_HPP
@@ -0,0 +1,227 @@
+#ifndef FAST_MATH_HPP
+#define FAST_MATH_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Polynomial approximations for the transcendental calls in the physics step
+//
+// Every kernel reduces its argument to a small interval and evaluates a short
+// polynomial there. Maximum errors (measured against the C library over the
+// ranges below, checked by tests/fast_math_tests.cpp):
+//
+//   fastSin / fastCos / fastSinCos   |x| <= 1e5        abs error < 1e-13
+//   fastAtan2                        any finite y, x   abs error < 1e-11 rad
+//   fastLog                          normal x > 0      abs error < 1e-12
+//   fastExp                          |x| <= 700        rel error < 1e-13
+//   fastPow (x > 0)                  |y * log x| < 700 rel error < 1e-10
+//
+// That is far below the 1e-6 relative error batch sweeps tolerate, while the
+// kernels are branch-light and inline into the step.
+//
+// Non-finite or out-of-range inputs fall back to the C library so results
+// never silently go wrong, only slower.
+
+// Accuracy tier used by the physics step
+enum class MathTier
+{
+    Exact, // C library (default)
+    Fast   // Polynomial kernels above
+};
+
+namespace fastmath_detail
+{
+    // pi/2 split so that k * PIO2_HI is exact for |k| < 2^20 (Cody-Waite)
+    constexpr double PIO2_HI = 1.57079632673412561417e+00;
+    constexpr double PIO2_LO = 6.07710050650619224932e-11;
+    constexpr double TWO_OVER_PI = 6.36619772367581382433e-01;
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double PI_2 = 1.57079632679489661923;
+    constexpr double PI_4 = 0.78539816339744830962;
+    constexpr double TAN_PI_8 = 0.41421356237309504880;
+
+    constexpr double LN2_HI = 6.93147180369123816490e-01;
+    constexpr double LN2_LO = 1.90821492927058770002e-10;
+    constexpr double INV_LN2 = 1.44269504088896338700e+00;
+    constexpr double SQRT2 = 1.41421356237309504880;
+
+    // sin(r) on |r| <= pi/4, Taylor to r^13 (truncation < 3e-14)
+    inline double sinKernel(double r)
+    {
+        double r2 = r * r;
+        return r + r * r2 * (-1.0 / 6.0 + r2 * (1.0 / 120.0 + r2 * (-1.0 / 5040.0 + r2 * (1.0 / 362880.0 + r2 * (-1.0 / 39916800.0 + r2 * (1.0 / 6227020800.0))))));
+    }
+
+    // cos(r) on |r| <= pi/4, Taylor to r^14 (truncation < 2e-15)
+    inline double cosKernel(double r)
+    {
+        double r2 = r * r;
+        return 1.0 + r2 * (-0.5 + r2 * (1.0 / 24.0 + r2 * (-1.0 / 720.0 + r2 * (1.0 / 40320.0 + r2 * (-1.0 / 3628800.0 + r2 * (1.0 / 479001600.0 + r2 * (-1.0 / 87178291200.0)))))));
+    }
+
+    // atan(u) on |u| <= tan(pi/8), odd Taylor series to u^25 (truncation < 2e-12)
+    inline double atanKernel(double u)
+    {
+        double u2 = u * u;
+        double p = 1.0 / 25.0;
+        p = -1.0 / 23.0 + u2 * p;
+        p = 1.0 / 21.0 + u2 * p;
+        p = -1.0 / 19.0 + u2 * p;
+        p = 1.0 / 17.0 + u2 * p;
+        p = -1.0 / 15.0 + u2 * p;
+        p = 1.0 / 13.0 + u2 * p;
+        p = -1.0 / 11.0 + u2 * p;
+        p = 1.0 / 9.0 + u2 * p;
+        p = -1.0 / 7.0 + u2 * p;
+        p = 1.0 / 5.0 + u2 * p;
+        p = -1.0 / 3.0 + u2 * p;
+        return u + u * u2 * p;
+    }
+
+    inline uint64_t toBits(double x)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return bits;
+    }
+
+    inline double fromBits(uint64_t bits)
+    {
+        double x;
+        std::memcpy(&x, &bits, sizeof(x));
+        return x;
+    }
+}
+
+// sin and cos of the same angle with a single range reduction
+inline void fastSinCos(double x, double &s, double &c)
+{
+    using namespace fastmath_detail;
+    if (!(std::fabs(x) <= 1e5))
+    {
+        s = std::sin(x);
+        c = std::cos(x);
+        return;
+    }
+
+    double k = std::floor(x * TWO_OVER_PI + 0.5);
+    double r = (x - k * PIO2_HI) - k * PIO2_LO;
+    double sr = sinKernel(r);
+    double cr = cosKernel(r);
+
+    switch (static_cast<int64_t>(k) & 3)
+    {
+    case 0:
+        s = sr;
+        c = cr;
+        break;
+    case 1:
+        s = cr;
+        c = -sr;
+        break;
+    case 2:
+        s = -sr;
+        c = -cr;
+        break;
+    default:
+        s = -cr;
+        c = sr;
+        break;
+    }
+}
+
+inline double fastSin(double x)
+{
+    double s, c;
+    fastSinCos(x, s, c);
+    return s;
+}
+
+inline double fastCos(double x)
+{
+    double s, c;
+    fastSinCos(x, s, c);
+    return c;
+}
+
+// Four-quadrant arctangent with the same signed-zero conventions as std::atan2
+inline double fastAtan2(double y, double x)
+{
+    using namespace fastmath_detail;
+    if (!std::isfinite(x) || !std::isfinite(y))
+        return std::atan2(y, x);
+
+    double ax = std::fabs(x);
+    double ay = std::fabs(y);
+    double mx = ax > ay ? ax : ay;
+    double mn = ax > ay ? ay : ax;
+    double t = mx > 0.0 ? mn / mx : 0.0; // t in [0, 1]
+
+    // Shift t > tan(pi/8) around pi/4 so the series argument stays small
+    double a;
+    if (t > TAN_PI_8)
+        a = PI_4 + atanKernel((t - 1.0) / (t + 1.0));
+    else
+        a = atanKernel(t);
+
+    if (ay > ax)
+        a = PI_2 - a;
+    if (std::signbit(x))
+        a = PI - a;
+    return std::copysign(a, y);
+}
+
+// Natural log for normal positive x
+inline double fastLog(double x)
+{
+    using namespace fastmath_detail;
+    uint64_t bits = toBits(x);
+    int exponent = static_cast<int>((bits >> 52) & 0x7ff);
+    if (x <= 0.0 || exponent == 0 || exponent == 0x7ff)
+        return std::log(x);
+
+    // x = m * 2^e with m in [sqrt(2)/2, sqrt(2))
+    int e = exponent - 1023;
+    double m = fromBits((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    if (m > SQRT2)
+    {
+        m *= 0.5;
+        e++;
+    }
+
+    // log(m) = 2 atanh(s), s = (m - 1) / (m + 1), |s| <= 0.1716
+    double s = (m - 1.0) / (m + 1.0);
+    double s2 = s * s;
+    double p = 2.0 * s * (1.0 + s2 * (1.0 / 3.0 + s2 * (1.0 / 5.0 + s2 * (1.0 / 7.0 + s2 * (1.0 / 9.0 + s2 * (1.0 / 11.0 + s2 * (1.0 / 13.0)))))));
+    return (e * LN2_HI + p) + e * LN2_LO;
+}
+
+inline double fastExp(double x)
+{
+    using namespace fastmath_detail;
+    if (!(std::fabs(x) <= 700.0))
+        return std::exp(x);
+
+    // x = k ln2 + r with |r| <= ln2 / 2
+    double k = std::floor(x * INV_LN2 + 0.5);
+    double r = (x - k * LN2_HI) - k * LN2_LO;
+    double p = 1.0 + r * (1.0 + r * (1.0 / 2.0 + r * (1.0 / 6.0 + r * (1.0 / 24.0 + r * (1.0 / 120.0 + r * (1.0 / 720.0 + r * (1.0 / 5040.0 + r * (1.0 / 40320.0 + r * (1.0 / 362880.0 + r * (1.0 / 3628800.0 + r * (1.0 / 39916800.0)))))))))));
+
+    // Scale by 2^k by building the exponent directly (k is within [-1010, 1010])
+    double scale = fromBits(static_cast<uint64_t>(static_cast<int64_t>(k) + 1023) << 52);
+    return p * scale;
+}
+
+// x^y for x > 0 via exp(y log x); other bases use std::pow
+inline double fastPow(double x, double y)
+{
+    if (!(x > 0.0))
+        return std::pow(x, y);
+    double ylogx = y * fastLog(x);
+    if (!(std::fabs(ylogx) <= 700.0))
+        return std::pow(x, y);
+    return fastExp(ylogx);
+}
+
+#endif // FAST_MATH_HPP
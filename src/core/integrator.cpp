@@ -21,27 +21,8 @@
 //   position: dx/dt = velocity
 //   velocity: dv/dt = acceleration
 //
+// The double overload is kept as a real function so existing callers link
+// against integrator.o; the generic template in integrator.hpp does the work.
 void integrateRK4(Vec2& position, Vec2& velocity, const Vec2& acceleration, double dt) {
-    // k1: derivatives at current state
-    Vec2 k1_vel = acceleration;
-    Vec2 k1_pos = velocity;
-    
-    // k2: derivatives at midpoint using k1
-    Vec2 vel_mid1 = velocity + k1_vel * (dt * 0.5);
-    Vec2 k2_vel = acceleration;  // acceleration is constant over this step
-    Vec2 k2_pos = vel_mid1;
-    
-    // k3: derivatives at midpoint using k2
-    Vec2 vel_mid2 = velocity + k2_vel * (dt * 0.5);
-    Vec2 k3_vel = acceleration;
-    Vec2 k3_pos = vel_mid2;
-    
-    // k4: derivatives at endpoint using k3
-    Vec2 vel_end = velocity + k3_vel * dt;
-    Vec2 k4_vel = acceleration;
-    Vec2 k4_pos = vel_end;
-    
-    // Update position and velocity using weighted average
-    velocity = velocity + (k1_vel + k2_vel * 2.0 + k3_vel * 2.0 + k4_vel) * (dt / 6.0);
-    position = position + (k1_pos + k2_pos * 2.0 + k3_pos * 2.0 + k4_pos) * (dt / 6.0);
+    integrateRK4<double>(position, velocity, acceleration, dt);
 }
@@ -7,4 +7,63 @@
 // Uses Runge-Kutta 4th order method (RK4)
 void integrateRK4(Vec2& position, Vec2& velocity, const Vec2& acceleration, double dt);
 
+// Scalar-generic RK4 step (float, double, dual numbers or SIMD packs)
+// Same arithmetic as the double version above, see integrator.cpp for the method.
+template <typename T>
+inline void integrateRK4(Vec2T<T>& position, Vec2T<T>& velocity, const Vec2T<T>& acceleration,
+                         const typename Vec2T<T>::value_type& dt)
+{
+    T half_dt = dt * T(0.5);
+
+    Vec2T<T> k1_vel = acceleration;
+    Vec2T<T> k1_pos = velocity;
+
+    Vec2T<T> k2_vel = acceleration;
+    Vec2T<T> k2_pos = velocity + k1_vel * half_dt;
+
+    Vec2T<T> k3_vel = acceleration;
+    Vec2T<T> k3_pos = velocity + k2_vel * half_dt;
+
+    Vec2T<T> k4_vel = acceleration;
+    Vec2T<T> k4_pos = velocity + k3_vel * dt;
+
+    T sixth_dt = dt / T(6.0);
+    velocity = velocity + (k1_vel + k2_vel * T(2.0) + k3_vel * T(2.0) + k4_vel) * sixth_dt;
+    position = position + (k1_pos + k2_pos * T(2.0) + k3_pos * T(2.0) + k4_pos) * sixth_dt;
+}
+
+// Integrator policies for compile-time selection in the physics step
+// Each provides step(position, velocity, acceleration, dt) for any scalar type.
+enum class IntegratorType
+{
+    RK4,
+    SemiImplicitEuler
+};
+
+struct RK4Integrator
+{
+    static constexpr IntegratorType type = IntegratorType::RK4;
+
+    template <typename T>
+    static void step(Vec2T<T>& position, Vec2T<T>& velocity, const Vec2T<T>& acceleration,
+                     const typename Vec2T<T>::value_type& dt)
+    {
+        integrateRK4(position, velocity, acceleration, dt);
+    }
+};
+
+// First order, but cheaper; velocity is updated first so energy stays bounded
+struct SemiImplicitEulerIntegrator
+{
+    static constexpr IntegratorType type = IntegratorType::SemiImplicitEuler;
+
+    template <typename T>
+    static void step(Vec2T<T>& position, Vec2T<T>& velocity, const Vec2T<T>& acceleration,
+                     const typename Vec2T<T>::value_type& dt)
+    {
+        velocity = velocity + acceleration * dt;
+        position = position + velocity * dt;
+    }
+};
+
 #endif
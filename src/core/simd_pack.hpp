@@ -0,0 +1,223 @@
+#ifndef SIMD_PACK_HPP
+#define SIMD_PACK_HPP
+
+#include "vec2.hpp"
+#include <cmath>
+#include <cstddef>
+
+// Fixed-width pack of N scalars that behaves like a single scalar
+// All operators work lane by lane in plain loops over aligned storage, which
+// GCC/Clang/MSVC turn into SIMD instructions at -O2/-O3 (/O2). Because the
+// pack models the same operator surface as float/double, generic code such as
+// Vec2T<T> or the RK4 integrator runs N independent problems per call.
+template <typename T, size_t N>
+struct alignas(sizeof(T) * N) SimdPack
+{
+    static_assert((N & (N - 1)) == 0, "SimdPack width must be a power of two");
+
+    using value_type = T;
+    static constexpr size_t width = N;
+
+    T v[N];
+
+    SimdPack() = default;
+
+    // Broadcast a scalar to every lane (implicit so that `pack * 2.0` works)
+    SimdPack(T scalar)
+    {
+        for (size_t i = 0; i < N; i++)
+            v[i] = scalar;
+    }
+
+    static SimdPack load(const T *src)
+    {
+        SimdPack p;
+        for (size_t i = 0; i < N; i++)
+            p.v[i] = src[i];
+        return p;
+    }
+
+    void store(T *dst) const
+    {
+        for (size_t i = 0; i < N; i++)
+            dst[i] = v[i];
+    }
+
+    T &operator[](size_t i) { return v[i]; }
+    const T &operator[](size_t i) const { return v[i]; }
+
+    SimdPack operator-() const
+    {
+        SimdPack r;
+        for (size_t i = 0; i < N; i++)
+            r.v[i] = -v[i];
+        return r;
+    }
+
+#define SIMD_PACK_COMPOUND_OP(op)                   \
+    SimdPack &operator op##=(const SimdPack &other) \
+    {                                               \
+        for (size_t i = 0; i < N; i++)              \
+            v[i] op##= other.v[i];                  \
+        return *this;                               \
+    }
+    SIMD_PACK_COMPOUND_OP(+)
+    SIMD_PACK_COMPOUND_OP(-)
+    SIMD_PACK_COMPOUND_OP(*)
+    SIMD_PACK_COMPOUND_OP(/)
+#undef SIMD_PACK_COMPOUND_OP
+};
+
+// Lane mask produced by pack comparisons
+template <size_t N>
+struct SimdMask
+{
+    bool m[N];
+
+    bool operator[](size_t i) const { return m[i]; }
+
+    bool any() const
+    {
+        bool r = false;
+        for (size_t i = 0; i < N; i++)
+            r |= m[i];
+        return r;
+    }
+
+    bool all() const
+    {
+        bool r = true;
+        for (size_t i = 0; i < N; i++)
+            r &= m[i];
+        return r;
+    }
+};
+
+#define SIMD_PACK_BINARY_OP(op)                                                       \
+    template <typename T, size_t N>                                                   \
+    inline SimdPack<T, N> operator op(const SimdPack<T, N> &a, const SimdPack<T, N> &b) \
+    {                                                                                 \
+        SimdPack<T, N> r;                                                             \
+        for (size_t i = 0; i < N; i++)                                                \
+            r.v[i] = a.v[i] op b.v[i];                                                \
+        return r;                                                                     \
+    }                                                                                 \
+    template <typename T, size_t N>                                                   \
+    inline SimdPack<T, N> operator op(const SimdPack<T, N> &a, typename SimdPack<T, N>::value_type b) \
+    {                                                                                 \
+        return a op SimdPack<T, N>(b);                                                \
+    }                                                                                 \
+    template <typename T, size_t N>                                                   \
+    inline SimdPack<T, N> operator op(typename SimdPack<T, N>::value_type a, const SimdPack<T, N> &b) \
+    {                                                                                 \
+        return SimdPack<T, N>(a) op b;                                                \
+    }
+SIMD_PACK_BINARY_OP(+)
+SIMD_PACK_BINARY_OP(-)
+SIMD_PACK_BINARY_OP(*)
+SIMD_PACK_BINARY_OP(/)
+#undef SIMD_PACK_BINARY_OP
+
+#define SIMD_PACK_COMPARE_OP(op)                                                 \
+    template <typename T, size_t N>                                              \
+    inline SimdMask<N> operator op(const SimdPack<T, N> &a, const SimdPack<T, N> &b) \
+    {                                                                            \
+        SimdMask<N> r;                                                           \
+        for (size_t i = 0; i < N; i++)                                           \
+            r.m[i] = a.v[i] op b.v[i];                                           \
+        return r;                                                                \
+    }
+SIMD_PACK_COMPARE_OP(<)
+SIMD_PACK_COMPARE_OP(<=)
+SIMD_PACK_COMPARE_OP(>)
+SIMD_PACK_COMPARE_OP(>=)
+#undef SIMD_PACK_COMPARE_OP
+
+// Blend: lanes where the mask is set take if_true
+template <typename T, size_t N>
+inline SimdPack<T, N> vecSelect(const SimdMask<N> &mask, const SimdPack<T, N> &if_true, const SimdPack<T, N> &if_false)
+{
+    SimdPack<T, N> r;
+    for (size_t i = 0; i < N; i++)
+        r.v[i] = mask.m[i] ? if_true.v[i] : if_false.v[i];
+    return r;
+}
+
+// Lane-wise math, found by ADL from generic code
+#define SIMD_PACK_UNARY_FN(fn)                                \
+    template <typename T, size_t N>                           \
+    inline SimdPack<T, N> fn(const SimdPack<T, N> &a)         \
+    {                                                         \
+        SimdPack<T, N> r;                                     \
+        for (size_t i = 0; i < N; i++)                        \
+            r.v[i] = std::fn(a.v[i]);                         \
+        return r;                                             \
+    }
+SIMD_PACK_UNARY_FN(sqrt)
+SIMD_PACK_UNARY_FN(sin)
+SIMD_PACK_UNARY_FN(cos)
+SIMD_PACK_UNARY_FN(abs)
+SIMD_PACK_UNARY_FN(exp)
+SIMD_PACK_UNARY_FN(log)
+#undef SIMD_PACK_UNARY_FN
+
+template <typename T, size_t N>
+inline SimdPack<T, N> atan2(const SimdPack<T, N> &y, const SimdPack<T, N> &x)
+{
+    SimdPack<T, N> r;
+    for (size_t i = 0; i < N; i++)
+        r.v[i] = std::atan2(y.v[i], x.v[i]);
+    return r;
+}
+
+template <typename T, size_t N>
+inline SimdPack<T, N> pow(const SimdPack<T, N> &a, const SimdPack<T, N> &b)
+{
+    SimdPack<T, N> r;
+    for (size_t i = 0; i < N; i++)
+        r.v[i] = std::pow(a.v[i], b.v[i]);
+    return r;
+}
+
+template <typename T, size_t N>
+inline SimdPack<T, N> min(const SimdPack<T, N> &a, const SimdPack<T, N> &b)
+{
+    SimdPack<T, N> r;
+    for (size_t i = 0; i < N; i++)
+        r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+    return r;
+}
+
+template <typename T, size_t N>
+inline SimdPack<T, N> max(const SimdPack<T, N> &a, const SimdPack<T, N> &b)
+{
+    SimdPack<T, N> r;
+    for (size_t i = 0; i < N; i++)
+        r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+    return r;
+}
+
+// Packed 2D vectors: N vectors stored as one x pack and one y pack (SoA)
+template <typename T, size_t N>
+using Vec2xN = Vec2T<SimdPack<T, N>>;
+
+// Read one lane of a packed vector
+template <typename T, size_t N>
+inline Vec2T<T> extractLane(const Vec2xN<T, N> &packed, size_t lane)
+{
+    return Vec2T<T>(packed.x[lane], packed.y[lane]);
+}
+
+// Write one lane of a packed vector
+template <typename T, size_t N>
+inline void insertLane(Vec2xN<T, N> &packed, size_t lane, const Vec2T<T> &value)
+{
+    packed.x[lane] = value.x;
+    packed.y[lane] = value.y;
+}
+
+// Common widths: 4 doubles or 8 floats fill a 256-bit AVX register
+using Vec2x4d = Vec2xN<double, 4>;
+using Vec2x8f = Vec2xN<float, 8>;
+
+#endif // SIMD_PACK_HPP
@@ -0,0 +1,380 @@
+#pragma once
+
+#include "binary_io.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Streaming estimators with constant memory, mergeable across workers
+// Each worker fills its own estimator and the results are combined with
+// merge(); merging in a fixed order gives the same result however the work
+// was scheduled. save() and load() store an estimator exactly, so a restored
+// one continues as if it had never been stored. All three skip NaN and
+// infinite values alike and count them apart (nonFinite()), so one bad
+// outcome cannot leave the moments and the quantiles describing different
+// data.
+
+// Count, mean, variance and range (Welford's update, Chan's parallel merge)
+class RunningStats
+{
+public:
+    void add(double x)
+    {
+        if (!std::isfinite(x))
+        {
+            skipped++;
+            return;
+        }
+        n++;
+        double delta = x - mean_;
+        mean_ += delta / static_cast<double>(n);
+        m2 += delta * (x - mean_);
+        min_ = std::min(min_, x);
+        max_ = std::max(max_, x);
+    }
+
+    void merge(const RunningStats &o)
+    {
+        skipped += o.skipped;
+        if (o.n == 0)
+            return;
+        if (n == 0)
+        {
+            const uint64_t total = skipped;
+            *this = o;
+            skipped = total;
+            return;
+        }
+        const double na = static_cast<double>(n), nb = static_cast<double>(o.n);
+        const double delta = o.mean_ - mean_;
+        n += o.n;
+        mean_ += delta * nb / static_cast<double>(n);
+        m2 += o.m2 + delta * delta * na * nb / static_cast<double>(n);
+        min_ = std::min(min_, o.min_);
+        max_ = std::max(max_, o.max_);
+    }
+
+    uint64_t count() const { return n; }
+    uint64_t nonFinite() const { return skipped; }
+    double mean() const { return n > 0 ? mean_ : std::numeric_limits<double>::quiet_NaN(); }
+    double variance() const { return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0; } // Sample variance
+    double stddev() const { return std::sqrt(variance()); }
+    double min() const { return n > 0 ? min_ : std::numeric_limits<double>::quiet_NaN(); }
+    double max() const { return n > 0 ? max_ : std::numeric_limits<double>::quiet_NaN(); }
+
+    void save(BinaryWriter &out) const
+    {
+        out.u64(n);
+        out.u64(skipped);
+        out.f64(mean_);
+        out.f64(m2);
+        out.f64(min_);
+        out.f64(max_);
+    }
+
+    static RunningStats load(BinaryReader &in)
+    {
+        RunningStats s;
+        s.n = in.u64();
+        s.skipped = in.u64();
+        s.mean_ = in.f64();
+        s.m2 = in.f64();
+        s.min_ = in.f64();
+        s.max_ = in.f64();
+        return s;
+    }
+
+private:
+    uint64_t n = 0;
+    uint64_t skipped = 0; // Non-finite values
+    double mean_ = 0.0;
+    double m2 = 0.0; // Sum of squared deviations from the mean
+    double min_ = std::numeric_limits<double>::infinity();
+    double max_ = -std::numeric_limits<double>::infinity();
+};
+
+// Quantile sketch: merging t-digest (Dunning & Ertl)
+// Values are buffered and periodically merged into about compression / 2
+// centroids, which are kept small near the tails (arcsine scale function):
+// at the default compression the rank error is a few 1e-4 around the
+// median and less towards the extremes.
+// Merging two digests pools their centroids and compresses once more.
+class QuantileDigest
+{
+public:
+    explicit QuantileDigest(double compression_ = 200.0)
+        : compression(compression_)
+    {
+        if (!(compression >= 10.0))
+            throw std::runtime_error("t-digest compression must be at least 10");
+    }
+
+    void add(double x, double weight = 1.0)
+    {
+        if (!std::isfinite(x))
+        {
+            skipped++;
+            return;
+        }
+        buffer.push_back({x, weight});
+        total += weight;
+        min_ = std::min(min_, x);
+        max_ = std::max(max_, x);
+        if (buffer.size() >= bufferLimit())
+            compress();
+    }
+
+    void merge(const QuantileDigest &o)
+    {
+        for (const Centroid &c : o.centroids)
+            buffer.push_back(c);
+        for (const Centroid &c : o.buffer)
+            buffer.push_back(c);
+        total += o.total;
+        skipped += o.skipped;
+        min_ = std::min(min_, o.min_);
+        max_ = std::max(max_, o.max_);
+        compress();
+    }
+
+    // Value below which a fraction q of the weight lies (NaN if empty)
+    double quantile(double q) const
+    {
+        if (!buffer.empty())
+        {
+            QuantileDigest flushed(*this);
+            flushed.compress();
+            return flushed.quantile(q);
+        }
+        if (centroids.empty())
+            return std::numeric_limits<double>::quiet_NaN();
+        q = std::clamp(q, 0.0, 1.0);
+        if (centroids.size() == 1)
+            return centroids[0].mean;
+
+        // Centroid means sit at the middle of their weight; interpolate
+        // between neighbouring midpoints, and towards min/max in the tails
+        const double index = q * total;
+        const Centroid &first = centroids.front();
+        if (index < 0.5 * first.weight)
+            return first.weight > 1.0 ? min_ + (first.mean - min_) * index / (0.5 * first.weight) : min_;
+        double cumulative = 0.0;
+        for (size_t i = 0; i + 1 < centroids.size(); i++)
+        {
+            const Centroid &a = centroids[i], &b = centroids[i + 1];
+            double left = cumulative + 0.5 * a.weight;
+            double right = cumulative + a.weight + 0.5 * b.weight;
+            if (index < right)
+                return a.mean + (b.mean - a.mean) * (index - left) / (right - left);
+            cumulative += a.weight;
+        }
+        const Centroid &last = centroids.back();
+        if (last.weight <= 1.0)
+            return max_;
+        return max_ - (max_ - last.mean) * std::max(0.0, total - index) / (0.5 * last.weight);
+    }
+
+    double count() const { return total; }
+    uint64_t nonFinite() const { return skipped; }
+    double min() const { return min_; }
+    double max() const { return max_; }
+    size_t centroidCount() const { return centroids.size(); }
+
+    // Centroids and unmerged values both, so the next compression is the
+    // same as without the round trip
+    void save(BinaryWriter &out) const
+    {
+        out.f64(compression);
+        out.f64(total);
+        out.u64(skipped);
+        out.f64(min_);
+        out.f64(max_);
+        for (const std::vector<Centroid> *list : {&centroids, &buffer})
+        {
+            out.u32(static_cast<uint32_t>(list->size()));
+            for (const Centroid &c : *list)
+            {
+                out.f64(c.mean);
+                out.f64(c.weight);
+            }
+        }
+    }
+
+    static QuantileDigest load(BinaryReader &in)
+    {
+        QuantileDigest d(in.f64());
+        d.total = in.f64();
+        d.skipped = in.u64();
+        d.min_ = in.f64();
+        d.max_ = in.f64();
+        for (std::vector<Centroid> *list : {&d.centroids, &d.buffer})
+        {
+            list->resize(in.count(2 * sizeof(double)));
+            for (Centroid &c : *list)
+            {
+                c.mean = in.f64();
+                c.weight = in.f64();
+            }
+        }
+        return d;
+    }
+
+private:
+    struct Centroid
+    {
+        double mean;
+        double weight;
+    };
+
+    double compression;
+    std::vector<Centroid> centroids; // Sorted by mean after compress()
+    std::vector<Centroid> buffer;    // Unmerged values
+    double total = 0.0;
+    uint64_t skipped = 0; // Non-finite values
+    double min_ = std::numeric_limits<double>::infinity();
+    double max_ = -std::numeric_limits<double>::infinity();
+
+    size_t bufferLimit() const { return static_cast<size_t>(5.0 * compression); }
+
+    // Arcsine scale function and its inverse: a centroid may span one unit of k
+    double scale(double q) const { return compression / (2.0 * M_PI) * std::asin(2.0 * q - 1.0); }
+    double inverseScale(double k) const
+    {
+        if (k >= 0.25 * compression)
+            return 1.0;
+        return 0.5 * (std::sin(2.0 * M_PI * k / compression) + 1.0);
+    }
+
+    void compress()
+    {
+        if (buffer.empty())
+            return;
+        buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+        std::sort(buffer.begin(), buffer.end(), [](const Centroid &a, const Centroid &b)
+                  { return a.mean < b.mean; });
+
+        centroids.clear();
+        Centroid current = buffer[0];
+        double before = 0.0; // Weight of the centroids already emitted
+        double limit = inverseScale(scale(0.0) + 1.0) * total;
+        for (size_t i = 1; i < buffer.size(); i++)
+        {
+            const Centroid &c = buffer[i];
+            if (before + current.weight + c.weight <= limit)
+            {
+                current.weight += c.weight;
+                current.mean += (c.mean - current.mean) * c.weight / current.weight;
+            }
+            else
+            {
+                centroids.push_back(current);
+                before += current.weight;
+                limit = inverseScale(scale(before / total) + 1.0) * total;
+                current = c;
+            }
+        }
+        centroids.push_back(current);
+        buffer.clear();
+    }
+};
+
+// Fixed-bin histogram over [lo, hi) with underflow and overflow counts
+// Histograms only merge with the same binning.
+class Histogram
+{
+public:
+    Histogram() = default;
+
+    Histogram(double lo_, double hi_, size_t bins)
+        : lo(lo_), hi(hi_), counts(bins, 0)
+    {
+        if (bins == 0 || !(hi > lo))
+            throw std::runtime_error("Histogram needs at least one bin and hi > lo");
+    }
+
+    void add(double x)
+    {
+        if (counts.empty())
+            return;
+        if (!std::isfinite(x))
+        {
+            skipped++;
+            return;
+        }
+        if (x < lo)
+            under++;
+        else if (x >= hi)
+            over++;
+        else
+            counts[std::min(counts.size() - 1, static_cast<size_t>((x - lo) / (hi - lo) * counts.size()))]++;
+    }
+
+    void merge(const Histogram &o)
+    {
+        if (o.counts.empty())
+            return;
+        if (counts.empty())
+        {
+            *this = o;
+            return;
+        }
+        if (o.lo != lo || o.hi != hi || o.counts.size() != counts.size())
+            throw std::runtime_error("Cannot merge histograms with different bins");
+        for (size_t i = 0; i < counts.size(); i++)
+            counts[i] += o.counts[i];
+        under += o.under;
+        over += o.over;
+        skipped += o.skipped;
+    }
+
+    bool empty() const { return counts.empty(); }
+    size_t bins() const { return counts.size(); }
+    double binLow(size_t i) const { return lo + (hi - lo) * static_cast<double>(i) / static_cast<double>(counts.size()); }
+    double binHigh(size_t i) const { return binLow(i + 1); }
+    uint64_t operator[](size_t i) const { return counts[i]; }
+    uint64_t underflow() const { return under; }
+    uint64_t overflow() const { return over; }
+    uint64_t nonFinite() const { return skipped; }
+    double low() const { return lo; }
+    double high() const { return hi; }
+
+    void save(BinaryWriter &out) const
+    {
+        out.f64(lo);
+        out.f64(hi);
+        out.u32(static_cast<uint32_t>(counts.size()));
+        for (uint64_t c : counts)
+            out.u64(c);
+        out.u64(under);
+        out.u64(over);
+        out.u64(skipped);
+    }
+
+    static Histogram load(BinaryReader &in)
+    {
+        Histogram h;
+        h.lo = in.f64();
+        h.hi = in.f64();
+        h.counts.resize(in.count(sizeof(uint64_t)));
+        for (uint64_t &c : h.counts)
+            c = in.u64();
+        h.under = in.u64();
+        h.over = in.u64();
+        h.skipped = in.u64();
+        return h;
+    }
+
+private:
+    double lo = 0.0, hi = 0.0;
+    std::vector<uint64_t> counts;
+    uint64_t under = 0, over = 0;
+    uint64_t skipped = 0; // Non-finite values
+};
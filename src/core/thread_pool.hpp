@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool for data-parallel loops
+// The calling thread always takes part in the work, so a pool of size 1 has no
+// worker threads and runs everything inline.
+class ThreadPool
+{
+public:
+    // threadCount = 0 uses one thread per hardware core
+    explicit ThreadPool(size_t threadCount = 0)
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        for (size_t i = 1; i < threadCount; i++)
+        {
+            workers.emplace_back([this, i]
+                                 {
+                currentIndex() = i;
+                workerLoop(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeCv.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Total number of threads that execute work (workers + caller)
+    size_t size() const { return workers.size() + 1; }
+
+    // Run fn(begin, end) over [0, count) in chunks of `grain` items
+    // Blocks until every chunk has finished. The first exception thrown by fn is
+    // rethrown here once all chunks are done.
+    template <typename Func>
+    void parallelFor(size_t count, size_t grain, Func &&fn)
+    {
+        if (count == 0)
+            return;
+        grain = std::max<size_t>(1, grain);
+
+        size_t chunks = (count + grain - 1) / grain;
+        if (workers.empty() || chunks == 1)
+        {
+            fn(size_t(0), count);
+            return;
+        }
+
+        // One loop in flight at a time
+        std::lock_guard<std::mutex> submitLock(submitMutex);
+
+        auto job = std::make_shared<Job>();
+        job->fn = std::forward<Func>(fn);
+        job->count = count;
+        job->grain = grain;
+        job->chunks = chunks;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = job;
+            generation++;
+        }
+        wakeCv.notify_all();
+
+        runChunks(*job);
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            doneCv.wait(lock, [&]
+                        { return job->done.load() == job->chunks; });
+            current.reset();
+        }
+
+        if (job->error)
+            std::rethrow_exception(job->error);
+    }
+
+    // Index of the calling thread within its pool: 1 .. size() - 1 for the
+    // workers, 0 for any other thread (the one calling parallelFor). Lets
+    // per-thread state such as counters be kept in a slot per thread.
+    static size_t threadIndex() { return currentIndex(); }
+
+private:
+    struct Job
+    {
+        std::function<void(size_t, size_t)> fn;
+        size_t count = 0;
+        size_t grain = 1;
+        size_t chunks = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::once_flag errorOnce;
+        std::exception_ptr error;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::mutex submitMutex;
+    std::condition_variable wakeCv;
+    std::condition_variable doneCv;
+    std::shared_ptr<Job> current;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    static size_t &currentIndex()
+    {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    void runChunks(Job &job)
+    {
+        size_t chunk;
+        while ((chunk = job.next.fetch_add(1)) < job.chunks)
+        {
+            size_t begin = chunk * job.grain;
+            size_t end = std::min(job.count, begin + job.grain);
+            try
+            {
+                job.fn(begin, end);
+            }
+            catch (...)
+            {
+                std::call_once(job.errorOnce, [&]
+                               { job.error = std::current_exception(); });
+            }
+
+            if (job.done.fetch_add(1) + 1 == job.chunks)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                doneCv.notify_all();
+            }
+        }
+    }
+
+    void workerLoop()
+    {
+        uint64_t seen = 0;
+        for (;;)
+        {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeCv.wait(lock, [&]
+                            { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                job = current;
+            }
+            if (job)
+                runChunks(*job);
+        }
+    }
+};
@@ -2,80 +2,147 @@
 #define VEC2_HPP
 
 #include <cmath>
-#include <iostream>
-#include <iomanip>
-#include <string>
-
-// 2D Vector class for flight dynamics
-struct Vec2 {
-    double x, y;
-    
-    Vec2(double x = 0.0, double y = 0.0) : x(x), y(y) {}
-    
+#include <type_traits>
+
+// Lane-wise select used by generic vector code
+// Plain scalars (and dual numbers, which compare on their value) branch here;
+// SIMD packs provide their own overload that blends lanes with a mask.
+template <typename T>
+inline T vecSelect(bool condition, const T &if_true, const T &if_false)
+{
+    return condition ? if_true : if_false;
+}
+
+// 2D Vector for flight dynamics, generic over the scalar type
+// T can be float, double, a dual number (see dual.hpp) or a SIMD pack
+// (see simd_pack.hpp). Math functions are called unqualified so that the
+// overloads for non-builtin scalars are found by argument-dependent lookup.
+template <typename T>
+struct Vec2T
+{
+    using value_type = T;
+
+    T x, y;
+
+    Vec2T(T x = T(0), T y = T(0)) : x(x), y(y) {}
+
+    // Convert between scalar types (e.g. double -> float)
+    template <typename U>
+    explicit Vec2T(const Vec2T<U> &other) : x(static_cast<T>(other.x)), y(static_cast<T>(other.y)) {}
+
     // Vector addition
-    Vec2 operator+(const Vec2& other) const {
-        return Vec2(x + other.x, y + other.y);
+    Vec2T operator+(const Vec2T &other) const
+    {
+        return Vec2T(x + other.x, y + other.y);
     }
-    
+
     // Vector subtraction
-    Vec2 operator-(const Vec2& other) const {
-        return Vec2(x - other.x, y - other.y);
+    Vec2T operator-(const Vec2T &other) const
+    {
+        return Vec2T(x - other.x, y - other.y);
+    }
+
+    // Negation
+    Vec2T operator-() const
+    {
+        return Vec2T(-x, -y);
     }
-    
+
     // Scalar multiplication
-    Vec2 operator*(double scalar) const {
-        return Vec2(x * scalar, y * scalar);
+    Vec2T operator*(const T &scalar) const
+    {
+        return Vec2T(x * scalar, y * scalar);
     }
-    
+
     // Scalar division
-    Vec2 operator/(double scalar) const {
-        return Vec2(x / scalar, y / scalar);
+    Vec2T operator/(const T &scalar) const
+    {
+        return Vec2T(x / scalar, y / scalar);
+    }
+
+    Vec2T &operator+=(const Vec2T &other)
+    {
+        x += other.x;
+        y += other.y;
+        return *this;
     }
-    
+
+    Vec2T &operator-=(const Vec2T &other)
+    {
+        x -= other.x;
+        y -= other.y;
+        return *this;
+    }
+
+    Vec2T &operator*=(const T &scalar)
+    {
+        x *= scalar;
+        y *= scalar;
+        return *this;
+    }
+
     // Dot product
-    double dot(const Vec2& other) const {
+    T dot(const Vec2T &other) const
+    {
         return x * other.x + y * other.y;
     }
-    
+
     // Magnitude (length)
-    double magnitude() const {
-        return std::sqrt(x * x + y * y);
+    T magnitude() const
+    {
+        using std::sqrt;
+        return sqrt(x * x + y * y);
     }
-    
+
     // Magnitude squared (useful for comparisons without sqrt)
-    double magnitudeSquared() const {
+    T magnitudeSquared() const
+    {
         return x * x + y * y;
     }
-    
+
     // Normalize (return unit vector)
-    Vec2 normalized() const {
-        double mag = magnitude();
-        if (mag < 1e-9) return Vec2(0, 0);
-        return Vec2(x / mag, y / mag);
+    Vec2T normalized() const
+    {
+        T mag = magnitude();
+        auto tiny = mag < T(1e-9);
+        return Vec2T(vecSelect(tiny, T(0), x / mag), vecSelect(tiny, T(0), y / mag));
     }
-    
+
     // Rotate by angle (radians)
-    Vec2 rotated(double angle) const {
-        double cos_a = std::cos(angle);
-        double sin_a = std::sin(angle);
-        return Vec2(x * cos_a - y * sin_a, x * sin_a + y * cos_a);
+    Vec2T rotated(const T &angle) const
+    {
+        using std::cos;
+        using std::sin;
+        T cos_a = cos(angle);
+        T sin_a = sin(angle);
+        return Vec2T(x * cos_a - y * sin_a, x * sin_a + y * cos_a);
     }
-    
-    // Get angle (radians)
-    double angle() const {
-        return std::atan2(y, x);
+
+    // Rotate by +90 degrees (exact component swap, no trig)
+    Vec2T perpendicular() const
+    {
+        return Vec2T(-y, x);
     }
-    
-    // Print helper
-    void print(const std::string& name = "") const {
-        std::cout << name << "(" << std::fixed << std::setprecision(2) 
-                  << x << ", " << y << ")";
+
+    // Get angle (radians)
+    T angle() const
+    {
+        using std::atan2;
+        return atan2(y, x);
     }
 };
 
 // Scalar * Vector (for commutative multiplication)
-inline Vec2 operator*(double scalar, const Vec2& vec) {
-    return vec * scalar;
+// Accepts plain numbers for any scalar type, e.g. 2.0 * Vec2T<float>
+template <typename S, typename T,
+          typename = std::enable_if_t<std::is_arithmetic<S>::value || std::is_same<S, T>::value>>
+inline Vec2T<T> operator*(const S &scalar, const Vec2T<T> &vec)
+{
+    return vec * T(scalar);
 }
 
+// Double precision is the default used throughout the simulator
+using Vec2 = Vec2T<double>;
+using Vec2f = Vec2T<float>;
+
 #endif // VEC2_HPP
@@ -0,0 +1,27 @@
+#ifndef VEC2_IO_HPP
+#define VEC2_IO_HPP
+
+#include "vec2.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+// Stream and print helpers for Vec2T, kept out of vec2.hpp so that physics
+// translation units don't pull in <iostream>
+
+// Writes "(x, y)" using the stream's current formatting
+template <typename T>
+inline std::ostream &operator<<(std::ostream &os, const Vec2T<T> &vec)
+{
+    return os << "(" << vec.x << ", " << vec.y << ")";
+}
+
+// Print helper: "name(x, y)" with two decimals
+template <typename T>
+inline void printVec2(const Vec2T<T> &vec, const std::string &name = "")
+{
+    std::cout << name << "(" << std::fixed << std::setprecision(2)
+              << vec.x << ", " << vec.y << ")";
+}
+
+#endif // VEC2_IO_HPP
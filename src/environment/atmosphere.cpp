@@ -1,26 +1,72 @@
 #include "atmosphere.hpp"
+#include "../core/fast_math.hpp"
 #include <cmath>
 
-// Temperature in Kelvin (linear lapse in troposphere)
+namespace {
+
+// Layer lookup for the property functions (isothermal above the standard's top)
+const IsaLayer &layerAt(double h) {
+    return h > IsaTopAltitude ? IsaAboveTopLayer : IsaLayers[isaLayerIndex(h)];
+}
+
+// Pressure within a layer; Pow and Exp are the exact or fast-math kernels.
+// In the troposphere this is p0 * pow(1 - L*h/T0, g/(R*L)) * exp(0), bit for
+// bit the single-layer formula.
+template <typename Pow, typename Exp>
+inline double layerPressure(const IsaLayer &layer, double h, Pow pow_fn, Exp exp_fn) {
+    double dh = h - layer.base_altitude;
+    return layer.base_pressure
+         * pow_fn(1 + ((layer.lapse_rate * dh) / layer.base_temperature), layer.pressure_exponent)
+         * exp_fn(-layer.isothermal_decay * dh);
+}
+
+double exactPow(double x, double y) { return std::pow(x, y); }
+double exactExp(double x) { return std::exp(x); }
+
+} // namespace
+
+// Temperature in Kelvin (piecewise linear over the layers)
 double getTemperature(double h) {
-    return T0 - L * h;
+    const IsaLayer &layer = layerAt(h);
+    return layer.base_temperature + layer.lapse_rate * (h - layer.base_altitude);
 }
 
-// Pressure using barometric formula
+// Pressure using the barometric formula of the layer
 double getPressure(double h) {
-    double T = getTemperature(h);
-    return p0 * pow(1 - ((L * h) / T0), g / (R * L));
+    return layerPressure(layerAt(h), h, exactPow, exactExp);
 }
 
-// Density using ideal gas law
+// Density using ideal gas law (one layer lookup for both)
 double getDensity(double h) {
-    double p = getPressure(h);
-    double T = getTemperature(h);
+    const IsaLayer &layer = layerAt(h);
+    double p = layerPressure(layer, h, exactPow, exactExp);
+    double T = layer.base_temperature + layer.lapse_rate * (h - layer.base_altitude);
+    return p / (R * T);
+}
+
+// Density with the fast-math kernels (used by the fast physics tier)
+// The pow and the isothermal exp fold into a single exp(n log(T/Tb) - k dh).
+double getDensityFast(double h) {
+    const IsaLayer &layer = layerAt(h);
+    double dh = h - layer.base_altitude;
+    double T = layer.base_temperature + layer.lapse_rate * dh;
+    double p = layer.base_pressure
+             * fastExp(layer.pressure_exponent * fastLog(T / layer.base_temperature) - layer.isothermal_decay * dh);
     return p / (R * T);
 }
 
+// Density gradient: hydrostatic pressure change (dp/dh = -rho g) and the
+// layer's lapse rate in d(rho)/rho = dp/p - dT/T
+double getDensityGradient(double h) {
+    const IsaLayer &layer = layerAt(h);
+    double p = layerPressure(layer, h, exactPow, exactExp);
+    double T = layer.base_temperature + layer.lapse_rate * (h - layer.base_altitude);
+    double rho = p / (R * T);
+    return -rho * (g / (R * T) + layer.lapse_rate / T);
+}
+
 // Speed of sound
 double getSpeedOfSound(double h) {
     double T = getTemperature(h);
-    return sqrt(gamma * R * T);
-}
\ No newline at end of file
+    return sqrt(gamma_air * R * T);
+}
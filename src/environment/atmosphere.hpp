@@ -1,18 +1,163 @@
 #ifndef ATMOSPHERE_HPP
 #define ATMOSPHERE_HPP
 
+#include <array>
+
 // Constants for ISA
-const double T0 = 288.15;      // Sea level temperature [K]
-const double p0 = 101325.0;    // Sea level pressure [Pa]
-const double L  = 0.0065;      // Temperature lapse rate [K/m]
-const double R  = 287.0;       // Gas constant [J/kgK]
-const double g  = 9.80665;     // Gravity [m/s^2]
-const double gamma = 1.4;      // Heat capacity ratio
+constexpr double T0 = 288.15;      // Sea level temperature [K]
+constexpr double p0 = 101325.0;    // Sea level pressure [Pa]
+constexpr double L  = 0.0065;      // Tropospheric temperature lapse rate [K/m]
+constexpr double R  = 287.0;       // Gas constant [J/kgK]
+constexpr double g  = 9.80665;     // Gravity [m/s^2]
+constexpr double gamma_air = 1.4;  // Heat capacity ratio (not "gamma": clashes with gamma() in glibc's math.h)
 
 // Functions to calculate atmospheric properties
+// Standard from sea level to 86 km (see IsaLayers), isothermal above;
+// altitudes are in metres.
 double getTemperature(double altitude); // K
 double getPressure(double altitude);    // Pa
 double getDensity(double altitude);     // kg/m^3
 double getSpeedOfSound(double altitude);// m/s
 
-#endif
\ No newline at end of file
+// Rate of change of density with altitude, d(rho)/dh = -rho (g / (R T) + lapse / T)
+// (for differentiating through the density, see sensitivity.hpp)
+double getDensityGradient(double altitude); // kg/m^4
+
+// Density using the polynomial pow/exp from fast_math.hpp (rel. error < 1e-10)
+double getDensityFast(double altitude); // kg/m^3
+
+/**
+ * One layer of the standard atmosphere, valid from base_altitude up to the
+ * next layer's base. Within it
+ *   T(h) = base_temperature + lapse_rate * (h - base)
+ *   p(h) = base_pressure * (T / base_temperature)^pressure_exponent
+ *                        * exp(-isothermal_decay * (h - base))
+ * Gradient layers have isothermal_decay = 0, isothermal ones
+ * pressure_exponent = 0, so one expression covers both without a branch.
+ */
+struct IsaLayer
+{
+    double base_altitude;     // m
+    double base_temperature;  // K
+    double lapse_rate;        // dT/dh [K/m]
+    double base_pressure;     // Pa
+    double pressure_exponent; // -g / (R * lapse_rate), 0 if isothermal
+    double isothermal_decay;  // g / (R * base_temperature) if isothermal, else 0 [1/m]
+};
+
+namespace isa_detail
+{
+    // exp and log usable in constant expressions (std:: ones are not in C++17)
+    constexpr double exp(double x)
+    {
+        int halvings = 0;
+        while (x > 0.125 || x < -0.125)
+        {
+            x *= 0.5;
+            halvings++;
+        }
+        double term = 1.0, sum = 1.0;
+        for (int n = 1; n < 20; n++)
+        {
+            term *= x / n;
+            sum += term;
+        }
+        while (halvings-- > 0)
+            sum *= sum;
+        return sum;
+    }
+
+    constexpr double log(double x) // x > 0
+    {
+        int twos = 0;
+        while (x > 1.5)
+        {
+            x *= 0.5;
+            twos++;
+        }
+        while (x < 0.75)
+        {
+            x *= 2.0;
+            twos--;
+        }
+        // log x = 2 atanh((x - 1) / (x + 1))
+        double y = (x - 1.0) / (x + 1.0), y2 = y * y, power = y, sum = 0.0;
+        for (int n = 1; n < 80; n += 2)
+        {
+            sum += power / n;
+            power *= y2;
+        }
+        return 2.0 * sum + twos * 0.69314718055994530942;
+    }
+}
+
+// The standard is defined by the layer base altitudes and lapse rates (US
+// Standard Atmosphere 1976, identical to ISA up to 32 km); base temperatures
+// and pressures follow by integrating up from sea level. Altitudes are
+// geopotential, as in the tropospheric formula this replaces; 84852 m is the
+// standard's 86 km geometric top. Above it the temperature is held at its
+// top value (IsaAboveTopLayer), so pressure and density keep falling
+// exponentially but stay finite and positive.
+constexpr int IsaLayerCount = 7;
+constexpr double IsaTopAltitude = 84852.0; // m
+
+constexpr std::array<IsaLayer, IsaLayerCount> makeIsaLayers()
+{
+    const double bases[IsaLayerCount + 1] = {0.0, 11000.0, 20000.0, 32000.0, 47000.0, 51000.0, 71000.0, IsaTopAltitude};
+    const double lapses[IsaLayerCount] = {-L, 0.0, 0.001, 0.0028, 0.0, -0.0028, -0.002};
+
+    std::array<IsaLayer, IsaLayerCount> layers{};
+    double T = T0, p = p0;
+    for (int i = 0; i < IsaLayerCount; i++)
+    {
+        IsaLayer &layer = layers[i];
+        layer.base_altitude = bases[i];
+        layer.base_temperature = T;
+        layer.lapse_rate = lapses[i];
+        layer.base_pressure = p;
+        layer.pressure_exponent = lapses[i] != 0.0 ? -g / (R * lapses[i]) : 0.0;
+        layer.isothermal_decay = lapses[i] != 0.0 ? 0.0 : g / (R * T);
+
+        // Conditions at the top of the layer are the next layer's base
+        double dh = bases[i + 1] - bases[i];
+        double T_top = T + lapses[i] * dh;
+        p *= isa_detail::exp(layer.pressure_exponent * isa_detail::log(T_top / T) - layer.isothermal_decay * dh);
+        T = T_top;
+    }
+    return layers;
+}
+
+inline constexpr std::array<IsaLayer, IsaLayerCount> IsaLayers = makeIsaLayers();
+
+constexpr IsaLayer makeIsaAboveTopLayer()
+{
+    const IsaLayer &last = IsaLayers[IsaLayerCount - 1];
+    double dh = IsaTopAltitude - last.base_altitude;
+    double T = last.base_temperature + last.lapse_rate * dh;
+
+    IsaLayer layer{};
+    layer.base_altitude = IsaTopAltitude;
+    layer.base_temperature = T;
+    layer.lapse_rate = 0.0;
+    layer.base_pressure = last.base_pressure * isa_detail::exp(last.pressure_exponent *
+                                                                   isa_detail::log(T / last.base_temperature) -
+                                                               last.isothermal_decay * dh);
+    layer.pressure_exponent = 0.0;
+    layer.isothermal_decay = g / (R * T);
+    return layer;
+}
+
+inline constexpr IsaLayer IsaAboveTopLayer = makeIsaAboveTopLayer();
+
+// Index of the layer containing an altitude, by counting the bases at or
+// below it (compares and adds, no branches). Below sea level the troposphere
+// is extended.
+inline int isaLayerIndex(double altitude)
+{
+    int index = 0;
+    for (int i = 1; i < IsaLayerCount; i++)
+        index += altitude >= IsaLayers[i].base_altitude;
+    return index;
+}
+
+#endif
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "atmosphere.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Off-standard atmosphere: hot and cold days, measured soundings
+//
+// A profile is given as temperature levels against altitude (linear in
+// between) and a pressure at the lowest level. Pressure above it follows from
+// hydrostatic balance, dp/dh = -g p / (R T), integrated exactly for the
+// piecewise-linear temperature onto a uniform grid once at construction, so
+// temperature, pressure and density are consistent with each other and a
+// lookup is one index computation and a linear interpolation.
+//
+// Profiles are immutable and shared: a FlightParams (one aircraft, or a whole
+// FlightBatch) selects one through its `atmosphere` pointer, and null means
+// the standard ISA functions in atmosphere.hpp. Outside its altitude range a
+// profile holds its end values.
+class AtmosphereProfile
+{
+public:
+    struct Level
+    {
+        double altitude;    // m
+        double temperature; // K
+        double pressure = std::numeric_limits<double>::quiet_NaN(); // Pa, NaN if not measured
+    };
+
+    // Grid spacing of the lookup table (m)
+    static constexpr double DefaultSpacing = 10.0;
+
+    // Build from levels (sorted by altitude here). The lowest level's pressure
+    // anchors the integration; without one, standard pressure at that
+    // altitude is used. Measured pressures above the anchor are only compared
+    // against, see maxPressureMismatch().
+    static AtmosphereProfile fromLevels(std::vector<Level> levels, double spacing = DefaultSpacing)
+    {
+        if (levels.size() < 2)
+            throw std::runtime_error("Atmosphere profile needs at least two levels");
+        if (!(spacing > 0.0))
+            throw std::runtime_error("Atmosphere profile spacing must be positive");
+        std::sort(levels.begin(), levels.end(), [](const Level &a, const Level &b)
+                  { return a.altitude < b.altitude; });
+        for (size_t i = 0; i < levels.size(); i++)
+        {
+            if (!(levels[i].temperature > 0.0))
+                throw std::runtime_error("Atmosphere profile temperatures must be positive (K)");
+            if (i > 0 && !(levels[i].altitude > levels[i - 1].altitude))
+                throw std::runtime_error("Atmosphere profile altitudes must be distinct");
+        }
+
+        AtmosphereProfile profile;
+        profile.base = levels.front().altitude;
+        const double top = levels.back().altitude;
+        const size_t cells = static_cast<size_t>(std::ceil((top - profile.base) / spacing - 1e-9));
+        profile.spacing = (top - profile.base) / static_cast<double>(cells); // Grid ends exactly on the top level
+        profile.inv_spacing = 1.0 / profile.spacing;
+        profile.nodes.resize(cells + 1);
+
+        // Temperatures at the nodes
+        size_t level = 0;
+        for (size_t k = 0; k <= cells; k++)
+        {
+            double h = k == cells ? top : profile.base + static_cast<double>(k) * profile.spacing;
+            while (level + 2 < levels.size() && h > levels[level + 1].altitude)
+                level++;
+            const Level &a = levels[level], &b = levels[level + 1];
+            profile.nodes[k].temperature = a.temperature + (b.temperature - a.temperature) * (h - a.altitude) / (b.altitude - a.altitude);
+        }
+
+        // Hydrostatic pressure, cell by cell: ln(p1/p0) = -g/R * integral(dh / T)
+        double p = std::isnan(levels.front().pressure) ? getPressure(profile.base) : levels.front().pressure;
+        if (!(p > 0.0))
+            throw std::runtime_error("Atmosphere profile pressure must be positive");
+        for (size_t k = 0; k <= cells; k++)
+        {
+            Node &node = profile.nodes[k];
+            if (k > 0)
+            {
+                double T0_cell = profile.nodes[k - 1].temperature, T1_cell = node.temperature;
+                double dT = T1_cell - T0_cell;
+                double inverse_T = std::fabs(dT) > 1e-9 * T0_cell ? std::log(T1_cell / T0_cell) / dT : 1.0 / T0_cell;
+                p *= std::exp(-g / R * profile.spacing * inverse_T);
+            }
+            node.pressure = p;
+            node.density = p / (R * node.temperature);
+        }
+
+        for (size_t i = 1; i < levels.size(); i++)
+        {
+            if (!std::isnan(levels[i].pressure))
+            {
+                double mismatch = std::fabs(profile.pressure(levels[i].altitude) / levels[i].pressure - 1.0);
+                profile.pressure_mismatch = std::max(profile.pressure_mismatch, mismatch);
+            }
+        }
+        return profile;
+    }
+
+    // Standard atmosphere shifted by a temperature offset (hot day: ISA+20,
+    // cold day: ISA-15), with the given sea-level pressure, up to 86 km
+    static AtmosphereProfile isaDeviation(double temperature_offset, double sea_level_pressure = p0,
+                                          double spacing = DefaultSpacing)
+    {
+        std::vector<Level> levels;
+        for (const IsaLayer &layer : IsaLayers)
+            levels.push_back({layer.base_altitude, layer.base_temperature + temperature_offset});
+        levels.push_back({IsaTopAltitude, getTemperature(IsaTopAltitude) + temperature_offset});
+        levels.front().pressure = sea_level_pressure;
+        return fromLevels(levels, spacing);
+    }
+
+    // Load a sounding from CSV
+    // Format: altitude (m), temperature (K)[, pressure (Pa)] with optional header row
+    static AtmosphereProfile loadFromCSV(const std::string &filepath, double spacing = DefaultSpacing)
+    {
+        std::ifstream file(filepath);
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open atmosphere profile: " + filepath);
+
+        std::vector<Level> levels;
+        std::string line;
+        bool firstLine = true;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line.find_first_not_of(" \t\r\n") == std::string::npos)
+                continue;
+            if (firstLine)
+            {
+                firstLine = false;
+                if (std::isalpha(static_cast<unsigned char>(line[0])))
+                    continue;
+            }
+
+            std::stringstream ss(line);
+            std::string token;
+            Level level;
+            if (!std::getline(ss, token, ','))
+                continue;
+            level.altitude = std::stod(token);
+            if (!std::getline(ss, token, ','))
+                throw std::runtime_error("Missing temperature in " + filepath + ": " + line);
+            level.temperature = std::stod(token);
+            if (std::getline(ss, token, ',') && token.find_first_not_of(" \t\r") != std::string::npos)
+                level.pressure = std::stod(token);
+            levels.push_back(level);
+        }
+
+        try
+        {
+            return fromLevels(levels, spacing);
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error(filepath + ": " + e.what());
+        }
+    }
+
+    double temperature(double altitude) const { return interpolate(altitude, &Node::temperature); }
+    double pressure(double altitude) const { return interpolate(altitude, &Node::pressure); }
+    double density(double altitude) const { return interpolate(altitude, &Node::density); }
+
+    // Slope of the interpolated density (kg/m^4), zero where the profile
+    // holds its end values
+    double densityGradient(double altitude) const
+    {
+        double s = (altitude - base) * inv_spacing;
+        if (!(s > 0.0 && s < static_cast<double>(nodes.size() - 1))) // NaN too
+            return 0.0;
+        size_t i = static_cast<size_t>(s);
+        return (nodes[i + 1].density - nodes[i].density) * inv_spacing;
+    }
+
+    double minAltitude() const { return base; }
+    double maxAltitude() const { return base + spacing * static_cast<double>(nodes.size() - 1); }
+    size_t tableSize() const { return nodes.size(); }
+
+    // Largest relative difference between measured pressures above the lowest
+    // level and the hydrostatic ones (0 if none were given); a quality check
+    // for soundings
+    double maxPressureMismatch() const { return pressure_mismatch; }
+
+private:
+    struct Node
+    {
+        double temperature;
+        double pressure;
+        double density;
+    };
+
+    double base = 0.0;
+    double spacing = DefaultSpacing;
+    double inv_spacing = 1.0 / DefaultSpacing;
+    double pressure_mismatch = 0.0;
+    std::vector<Node> nodes;
+
+    // O(1) lookup: clamp to the table, index, interpolate (selects, no branches)
+    // A NaN altitude gets the lowest level, as the ISA gives its sea-level
+    // layer, instead of reaching the index conversion
+    double interpolate(double altitude, double Node::*field) const
+    {
+        const double last = static_cast<double>(nodes.size() - 1);
+        double s = (altitude - base) * inv_spacing;
+        s = s > 0.0 ? std::min(s, last) : 0.0;
+        size_t i = std::min(static_cast<size_t>(s), nodes.size() - 2);
+        double frac = s - static_cast<double>(i);
+        double a = nodes[i].*field, b = nodes[i + 1].*field;
+        return a + frac * (b - a);
+    }
+};
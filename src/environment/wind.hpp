@@ -0,0 +1,216 @@
+#pragma once
+
+#include "../core/vec2.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Dryden turbulence spectrum parameters (x = horizontal, w = vertical)
+// Intensities are RMS gust velocities, length scales set the spatial
+// correlation. The defaults are the medium/high-altitude length scale of
+// MIL-HDBK-1797 (1750 ft) for both components.
+struct DrydenParameters
+{
+    double sigma_u = 0.0;     // Horizontal RMS (m/s)
+    double sigma_w = 0.0;     // Vertical RMS (m/s)
+    double length_u = 533.4;  // Horizontal length scale (m)
+    double length_w = 533.4;  // Vertical length scale (m)
+
+    // "light", "moderate" or "severe" (about 1.5, 3 and 6 m/s RMS)
+    static DrydenParameters preset(const std::string &level)
+    {
+        DrydenParameters p;
+        double sigma;
+        if (level == "light")
+            sigma = 1.5;
+        else if (level == "moderate")
+            sigma = 3.0;
+        else if (level == "severe")
+            sigma = 6.0;
+        else
+            throw std::runtime_error("Unknown turbulence level: " + level);
+        p.sigma_u = sigma;
+        p.sigma_w = sigma;
+        return p;
+    }
+
+    bool operator==(const DrydenParameters &o) const
+    {
+        return sigma_u == o.sigma_u && sigma_w == o.sigma_w && length_u == o.length_u && length_w == o.length_w;
+    }
+};
+
+// Frozen Dryden turbulence field, precomputed in one block
+//
+// The gust velocities are sampled along the distance flown through the air
+// mass (Taylor's frozen turbulence), every `spacing` metres. The whole block
+// is generated up front: white noise in bulk, then one pass of the Dryden
+// shaping filters over it, so a step only interpolates two table entries.
+// Many runs share one field read-only and pick their realization by starting
+// at a different distance into it (offsets more than ~10 length scales apart
+// are uncorrelated); distinct seeds give independent fields.
+//
+// Horizontal component, first order:  Phi_u = sigma_u^2 (2 L_u / pi) / (1 + (L_u W)^2)
+// Vertical component, second order:   Phi_w = sigma_w^2 (L_w / pi) (1 + 3 (L_w W)^2) / (1 + (L_w W)^2)^2
+// The horizontal filter is the exact discretization of its first-order lag;
+// the vertical one is two cascaded lags with the sqrt(3) L_w lead. Each block
+// is shifted and scaled to exactly zero mean and the requested RMS.
+// The field repeats after samples * spacing metres (327 km by default).
+class TurbulenceField
+{
+public:
+    static constexpr size_t DefaultSamples = size_t(1) << 16;
+
+    // samples must be a power of two (the lookup wraps with a mask)
+    TurbulenceField(const DrydenParameters &params, uint64_t seed, double spacing = 5.0,
+                    size_t samples = DefaultSamples)
+        : params_(params), seed_(seed), spacing_(spacing), mask_(samples - 1)
+    {
+        if (samples < 2 || (samples & (samples - 1)) != 0)
+            throw std::runtime_error("Turbulence field size must be a power of two");
+        if (!(spacing > 0.0) || !(params.length_u > 0.0) || !(params.length_w > 0.0))
+            throw std::runtime_error("Turbulence spacing and length scales must be positive");
+
+        // White noise for both channels in one go (Box-Muller on mt19937_64,
+        // which unlike std::normal_distribution is the same on every platform)
+        const size_t warmup = static_cast<size_t>(std::ceil(8.0 * std::max(params.length_u, params.length_w) / spacing));
+        const size_t total = samples + warmup;
+        std::vector<double> noise(2 * total);
+        std::mt19937_64 rng(seed);
+        const double scale = 1.0 / 9007199254740992.0; // 2^-53
+        for (size_t i = 0; i < noise.size(); i += 2)
+        {
+            double u1 = (static_cast<double>(rng() >> 11) + 0.5) * scale; // (0, 1)
+            double u2 = static_cast<double>(rng() >> 11) * scale;
+            double r = std::sqrt(-2.0 * std::log(u1));
+            noise[i] = r * std::cos(2.0 * M_PI * u2);
+            noise[i + 1] = r * std::sin(2.0 * M_PI * u2);
+        }
+
+        // Shaping filters over the block; the warm-up reaches the stationary state
+        const double au = std::exp(-spacing / params.length_u);
+        const double aw = std::exp(-spacing / params.length_w);
+        const double bu = std::sqrt(1.0 - au * au);
+        const double bw = std::sqrt(1.0 - aw * aw);
+        const double lead = std::sqrt(3.0);
+        std::vector<double> u(samples), w(samples);
+        double xu = 0.0, y1 = 0.0, y2 = 0.0;
+        for (size_t i = 0; i < total; i++)
+        {
+            xu = au * xu + bu * noise[2 * i];
+            y1 = aw * y1 + bw * noise[2 * i + 1];
+            y2 = aw * y2 + (1.0 - aw) * y1;
+            if (i >= warmup)
+            {
+                u[i - warmup] = xu;
+                w[i - warmup] = lead * y1 + (1.0 - lead) * y2;
+            }
+        }
+        normalize(u, params.sigma_u);
+        normalize(w, params.sigma_w);
+
+        field_.resize(2 * samples);
+        for (size_t i = 0; i < samples; i++)
+        {
+            field_[2 * i] = static_cast<float>(u[i]);
+            field_[2 * i + 1] = static_cast<float>(w[i]);
+        }
+    }
+
+    // Gust velocity (horizontal, vertical) at a distance into the field,
+    // linearly interpolated between samples
+    Vec2 at(double distance) const
+    {
+        double s = distance / spacing_;
+        double base = std::floor(s);
+        double frac = s - base;
+        size_t i0 = static_cast<size_t>(static_cast<int64_t>(base)) & mask_; // Wraps negative distances too
+        size_t i1 = (i0 + 1) & mask_;
+        const float *a = &field_[2 * i0];
+        const float *b = &field_[2 * i1];
+        return Vec2(a[0] + frac * (b[0] - a[0]), a[1] + frac * (b[1] - a[1]));
+    }
+
+    const DrydenParameters &parameters() const { return params_; }
+    uint64_t seed() const { return seed_; }
+    double spacing() const { return spacing_; }
+    size_t samples() const { return mask_ + 1; }
+    double length() const { return spacing_ * static_cast<double>(samples()); } // Repeat distance (m)
+
+private:
+    DrydenParameters params_;
+    uint64_t seed_;
+    double spacing_;
+    size_t mask_;
+    std::vector<float> field_; // Interleaved (u, w) pairs, one cache line per lookup
+
+    static void normalize(std::vector<double> &v, double sigma)
+    {
+        double mean = 0.0;
+        for (double x : v)
+            mean += x;
+        mean /= static_cast<double>(v.size());
+        double var = 0.0;
+        for (double x : v)
+            var += (x - mean) * (x - mean);
+        var /= static_cast<double>(v.size());
+        double k = var > 0.0 ? sigma / std::sqrt(var) : 0.0;
+        for (double &x : v)
+            x = (x - mean) * k;
+    }
+};
+
+// Discrete "1-cosine" gust: rises from zero to its amplitude and back over
+// the duration, starting at a fixed simulation time
+struct DiscreteGust
+{
+    double start = 0.0;    // s
+    double duration = 1.0; // s
+    Vec2 amplitude{0.0, 0.0}; // Peak (horizontal, vertical) gust velocity (m/s)
+
+    Vec2 at(double t) const
+    {
+        double tau = t - start;
+        if (tau <= 0.0 || tau >= duration)
+            return Vec2(0.0, 0.0);
+        return amplitude * (0.5 * (1.0 - std::cos(2.0 * M_PI * tau / duration)));
+    }
+};
+
+// Air mass motion seen by one aircraft: steady wind, turbulence and gusts
+// Velocities are in the world frame (x forward, y up), so a headwind for an
+// aircraft flying along +x has steady.x < 0. The turbulence field is sampled
+// at the aircraft's position in the air mass (x minus the steady drift), plus
+// turbulence_offset, which selects the realization.
+struct WindModel
+{
+    Vec2 steady{0.0, 0.0};
+    std::shared_ptr<const TurbulenceField> turbulence;
+    double turbulence_offset = 0.0; // m into the field
+    std::vector<DiscreteGust> gusts;
+
+    bool active() const
+    {
+        return turbulence != nullptr || !gusts.empty() || steady.x != 0.0 || steady.y != 0.0;
+    }
+
+    // Wind velocity at horizontal position x and time t
+    Vec2 at(double x, double t) const
+    {
+        Vec2 wind = steady;
+        if (turbulence)
+            wind += turbulence->at(x - steady.x * t + turbulence_offset);
+        for (const DiscreteGust &gust : gusts)
+            wind += gust.at(t);
+        return wind;
+    }
+};
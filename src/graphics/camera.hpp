@@ -31,6 +31,17 @@ public:
         return ImVec2(screen_x, screen_y);
     }
 
+    // World-space rectangle covered by the canvas (used to cull off-screen geometry)
+    void visibleWorldRect(ImVec2 canvas_p0, ImVec2 canvas_p1, float &min_x, float &min_z, float &max_x, float &max_z) const
+    {
+        float width = canvas_p1.x - canvas_p0.x;
+        float height = canvas_p1.y - canvas_p0.y;
+        min_x = -view_offset.x / view_scale;
+        max_x = (width - view_offset.x) / view_scale;
+        min_z = view_offset.y / view_scale;
+        max_z = (height + view_offset.y) / view_scale;
+    }
+
     // Auto-follow the aircraft
     void followAircraft(float aircraft_x, float aircraft_y, ImVec2 canvas_p0, ImVec2 canvas_p1, bool paused)
     {
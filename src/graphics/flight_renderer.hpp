@@ -3,6 +3,8 @@
 #include "imgui.h"
 #include "camera.hpp"
 #include "../simulation/simulation_state.hpp"
+#include "../simulation/simulation_scene.hpp"
+#include "../telemetry/telemetry_record.hpp"
 #include "../core/vec2.hpp"
 #include <vector>
 
@@ -14,7 +16,9 @@ public:
 
     FlightRenderer() : vector_scale(0.05f) {}
 
-    void render(const SimulationState &state, Camera &camera, bool show_vectors, ImVec2 canvas_p0, ImVec2 canvas_sz)
+    // Draw every aircraft in the scene; force vectors for the selected one come from its latest telemetry
+    void render(const SimulationScene &scene, const TelemetryRecord &telemetry, Camera &camera, bool show_vectors,
+                ImVec2 canvas_p0, ImVec2 canvas_sz)
     {
         ImVec2 canvas_p1 = ImVec2(canvas_p0.x + canvas_sz.x, canvas_p0.y + canvas_sz.y);
 
@@ -25,9 +29,16 @@ public:
         draw_list->AddRectFilled(canvas_p0, canvas_p1, IM_COL32(50, 50, 50, 255));
         draw_list->AddRect(canvas_p0, canvas_p1, IM_COL32(255, 255, 255, 255));
 
-        // Auto-follow aircraft
-        camera.followAircraft(static_cast<float>(state.position.x), static_cast<float>(state.position.y),
-                              canvas_p0, canvas_p1, state.paused);
+        if (scene.empty())
+        {
+            draw_list->PopClipRect();
+            return;
+        }
+
+        // Auto-follow the selected aircraft
+        const SimulationState &selected = scene.selectedState();
+        camera.followAircraft(static_cast<float>(selected.position.x), static_cast<float>(selected.position.y),
+                              canvas_p0, canvas_p1, selected.paused);
 
         // Draw ground line
         ImVec2 ground_p0 = camera.worldToScreen(-10000.0f, 0.0f, canvas_p0, canvas_p1);
@@ -37,38 +48,103 @@ public:
         // Draw grid lines
         drawGrid(draw_list, camera, canvas_p0, canvas_p1);
 
-        // Draw flight path
-        if (state.flightPath.size() > 1)
+        // Draw all flight paths in one pass, skipping segments outside the view
+        float min_x, min_z, max_x, max_z;
+        camera.visibleWorldRect(canvas_p0, canvas_p1, min_x, min_z, max_x, max_z);
+        for (size_t i = 0; i < scene.size(); i++)
         {
-            for (size_t i = 0; i < state.flightPath.size() - 1; i++)
-            {
-                ImVec2 p1 = camera.worldToScreen(state.flightPath[i].x, state.flightPath[i].z, canvas_p0, canvas_p1);
-                ImVec2 p2 = camera.worldToScreen(state.flightPath[i + 1].x, state.flightPath[i + 1].z, canvas_p0, canvas_p1);
-                draw_list->AddLine(p1, p2, IM_COL32(255, 255, 0, 255), 2.0f);
-            }
+            bool is_selected = static_cast<int>(i) == scene.selected;
+            drawTrail(draw_list, camera, scene.states[i].flightPath, min_x, min_z, max_x, max_z,
+                      trailColor(i), is_selected ? 2.5f : 1.5f, canvas_p0, canvas_p1);
+        }
+
+        // Draw aircraft markers (selected one last so it stays on top)
+        for (size_t i = 0; i < scene.size(); i++)
+        {
+            if (static_cast<int>(i) == scene.selected || scene.states[i].flightPath.empty())
+                continue;
+
+            float x = static_cast<float>(scene.states[i].position.x);
+            float z = static_cast<float>(scene.states[i].position.y);
+            if (x < min_x || x > max_x || z < min_z || z > max_z)
+                continue;
+
+            ImVec2 pos = camera.worldToScreen(x, z, canvas_p0, canvas_p1);
+            draw_list->AddCircleFilled(pos, 4.0f, trailColor(i));
+            draw_list->AddText(ImVec2(pos.x + 6, pos.y - 14), trailColor(i), scene.labels[i].c_str());
+        }
+
+        if (selected.flightPath.size() > 1)
+        {
+            ImVec2 aircraft_pos = camera.worldToScreen(static_cast<float>(selected.position.x),
+                                                       static_cast<float>(selected.position.y), canvas_p0, canvas_p1);
+            draw_list->AddCircleFilled(aircraft_pos, 5.0f, IM_COL32(255, 0, 0, 255));
 
-            // Draw aircraft
-            if (!state.flightPath.empty())
+            // Draw force vectors
+            if (show_vectors)
             {
-                ImVec2 aircraft_pos = camera.worldToScreen(static_cast<float>(state.position.x),
-                                                           static_cast<float>(state.position.y), canvas_p0, canvas_p1);
-                draw_list->AddCircleFilled(aircraft_pos, 5.0f, IM_COL32(255, 0, 0, 255));
-
-                // Draw force vectors
-                if (show_vectors)
-                {
-                    drawForceVector(draw_list, aircraft_pos, state.F_thrust_viz, IM_COL32(0, 255, 0, 255), "Thrust");
-                    drawForceVector(draw_list, aircraft_pos, state.F_drag_viz, IM_COL32(255, 128, 0, 255), "Drag");
-                    drawForceVector(draw_list, aircraft_pos, state.F_lift_viz, IM_COL32(0, 255, 255, 255), "Lift");
-                    drawForceVector(draw_list, aircraft_pos, state.F_weight_viz, IM_COL32(255, 0, 255, 255), "Weight");
-                }
+                drawForceVector(draw_list, aircraft_pos, telemetry.F_thrust, IM_COL32(0, 255, 0, 255), "Thrust");
+                drawForceVector(draw_list, aircraft_pos, telemetry.F_drag, IM_COL32(255, 128, 0, 255), "Drag");
+                drawForceVector(draw_list, aircraft_pos, telemetry.F_lift, IM_COL32(0, 255, 255, 255), "Lift");
+                drawForceVector(draw_list, aircraft_pos, telemetry.F_weight, IM_COL32(255, 0, 255, 255), "Weight");
             }
         }
 
         draw_list->PopClipRect();
     }
 
+    // Per-aircraft trail color, shared with the scene panel
+    static ImU32 trailColor(size_t index)
+    {
+        static const ImU32 palette[] = {
+            IM_COL32(255, 255, 0, 255),
+            IM_COL32(0, 200, 255, 255),
+            IM_COL32(255, 120, 200, 255),
+            IM_COL32(120, 255, 120, 255),
+            IM_COL32(255, 160, 60, 255),
+            IM_COL32(180, 140, 255, 255),
+            IM_COL32(255, 255, 255, 255),
+            IM_COL32(0, 255, 180, 255)};
+        return palette[index % (sizeof(palette) / sizeof(palette[0]))];
+    }
+
 private:
+    // Scratch buffer for visible polyline runs, reused across frames
+    std::vector<ImVec2> run_points;
+
+    // Emit the visible parts of a trail as polylines
+    // A segment is dropped when both endpoints lie beyond the same edge of the view.
+    void drawTrail(ImDrawList *draw_list, const Camera &camera, const std::vector<FlightPoint> &path,
+                   float min_x, float min_z, float max_x, float max_z,
+                   ImU32 color, float thickness, ImVec2 canvas_p0, ImVec2 canvas_p1)
+    {
+        run_points.clear();
+        for (size_t i = 0; i + 1 < path.size(); i++)
+        {
+            const FlightPoint &a = path[i];
+            const FlightPoint &b = path[i + 1];
+            bool culled = (a.x < min_x && b.x < min_x) || (a.x > max_x && b.x > max_x) ||
+                          (a.z < min_z && b.z < min_z) || (a.z > max_z && b.z > max_z);
+            if (culled)
+            {
+                flushRun(draw_list, color, thickness);
+                continue;
+            }
+
+            if (run_points.empty())
+                run_points.push_back(camera.worldToScreen(a.x, a.z, canvas_p0, canvas_p1));
+            run_points.push_back(camera.worldToScreen(b.x, b.z, canvas_p0, canvas_p1));
+        }
+        flushRun(draw_list, color, thickness);
+    }
+
+    void flushRun(ImDrawList *draw_list, ImU32 color, float thickness)
+    {
+        if (run_points.size() > 1)
+            draw_list->AddPolyline(run_points.data(), static_cast<int>(run_points.size()), color, 0, thickness);
+        run_points.clear();
+    }
+
     void drawGrid(ImDrawList *draw_list, const Camera &camera, ImVec2 canvas_p0, ImVec2 canvas_p1)
     {
         int grid_spacing = 100;
@@ -2,11 +2,15 @@
 
 #include "imgui.h"
 #include "../simulation/simulation_state.hpp"
+#include "../simulation/simulation_scene.hpp"
 #include "../environment/atmosphere.hpp"
 #include "../aircraft/aircraft_loader.hpp"
+#include "../telemetry/telemetry_record.hpp"
+#include "flight_renderer.hpp"
 #include <string>
 #include <vector>
 #include <cmath>
+#include <cstdio>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -50,8 +54,101 @@ struct UIState
     }
 };
 
+// Load an aircraft from a config entry (empty path means the built-in default)
+inline Aircraft loadAircraftConfig(const AircraftConfigUI &config)
+{
+    if (config.filepath.empty())
+        return Aircraft();
+    return AircraftLoader::loadFromJSON(config.filepath);
+}
+
+// Render the scene panel: aircraft list, selection and batch actions
+inline void renderScenePanel(SimulationScene &scene, UIState &ui_state)
+{
+    ImGui::SetNextWindowPos(ImVec2(1280, 10), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(300, 400), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Scene");
+
+    ImGui::Text("Aircraft in scene: %zu", scene.size());
+    if (ImGui::BeginListBox("##aircraft", ImVec2(-1.0f, 200.0f)))
+    {
+        for (size_t i = 0; i < scene.size(); i++)
+        {
+            const SimulationState &state = scene.states[i];
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(FlightRenderer::trailColor(i)), "#");
+            ImGui::SameLine();
+
+            char label[160];
+            std::snprintf(label, sizeof(label), "%s  %.0f m  %.1f m/s%s", scene.labels[i].c_str(),
+                          state.position.y, state.velocity.magnitude(), state.paused ? "  [paused]" : "");
+            if (ImGui::Selectable(label, scene.selected == static_cast<int>(i)))
+                scene.selected = static_cast<int>(i);
+            ImGui::PopID();
+        }
+        ImGui::EndListBox();
+    }
+
+    // Adding aircraft uses the config chosen in the Flight Controls combo
+    if (ImGui::Button("Add Config"))
+    {
+        const AircraftConfigUI &config = ui_state.aircraft_configs[ui_state.selected_aircraft];
+        try
+        {
+            scene.selected = scene.add(config.name, loadAircraftConfig(config));
+            ui_state.load_message = std::string("Added: ") + config.name;
+            ui_state.load_error = false;
+        }
+        catch (const std::exception &e)
+        {
+            ui_state.load_message = std::string("Error: ") + e.what();
+            ui_state.load_error = true;
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Add All Configs"))
+    {
+        for (const auto &config : ui_state.aircraft_configs)
+        {
+            try
+            {
+                scene.add(config.name, loadAircraftConfig(config));
+            }
+            catch (const std::exception &e)
+            {
+                ui_state.load_message = std::string("Error: ") + e.what();
+                ui_state.load_error = true;
+            }
+        }
+    }
+
+    if (ImGui::Button("Duplicate"))
+    {
+        int index = scene.duplicate(scene.selected);
+        if (index >= 0)
+            scene.selected = index;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Remove"))
+    {
+        scene.remove(scene.selected);
+    }
+
+    ImGui::Separator();
+    if (ImGui::Button("Pause All"))
+        scene.setPaused(true);
+    ImGui::SameLine();
+    if (ImGui::Button("Resume All"))
+        scene.setPaused(false);
+    ImGui::SameLine();
+    if (ImGui::Button("Reset All"))
+        scene.requestResetAll();
+
+    ImGui::End();
+}
+
 // Render the flight controls panel
-inline void renderControlPanel(SimulationState &state, UIState &ui_state)
+inline void renderControlPanel(SimulationState &state, UIState &ui_state, const TelemetryRecord &telemetry)
 {
     ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowSize(ImVec2(400, 0), ImGuiCond_FirstUseEver);
@@ -86,6 +183,13 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
         ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "[AUTO]");
     }
 
+    // Gain scheduling replaces the fixed gains below while enabled
+    if (state.aircraft.hasGainSchedule())
+    {
+        ImGui::Separator();
+        ImGui::Checkbox("Gain Scheduling (q, altitude)", &state.gain_scheduling);
+    }
+
     // Speed Autopilot
     ImGui::Separator();
     ImGui::Text("Autopilot - Speed Control:");
@@ -99,18 +203,22 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
     {
         ImGui::SliderFloat("Target Speed (m/s)", &state.speed_setpoint, 10.0f, 100.0f, "%.1f");
         ImGui::Text("PID Gains:");
-        if (ImGui::SliderFloat("Kp (Proportional)", &state.pid_kp, 0.0f, 0.1f, "%.4f"))
-            state.speed_pid = PIDController(state.pid_kp, state.pid_ki, state.pid_kd, 0.0, 1.0);
-        if (ImGui::SliderFloat("Ki (Integral)", &state.pid_ki, 0.0f, 0.01f, "%.5f"))
-            state.speed_pid = PIDController(state.pid_kp, state.pid_ki, state.pid_kd, 0.0, 1.0);
-        if (ImGui::SliderFloat("Kd (Derivative)", &state.pid_kd, 0.0f, 0.05f, "%.4f"))
-            state.speed_pid = PIDController(state.pid_kp, state.pid_ki, state.pid_kd, 0.0, 1.0);
+        if (state.gainsScheduled())
+        {
+            ImGui::Text("  Scheduled  Kp: %.4f  Ki: %.5f  Kd: %.4f",
+                        state.speed_pid.getKp(), state.speed_pid.getKi(), state.speed_pid.getKd());
+        }
+        else
+        {
+            // Loaded in place by syncControllerGains, keeping the integrator state
+            ImGui::SliderFloat("Kp (Proportional)", &state.pid_kp, 0.0f, 0.1f, "%.4f");
+            ImGui::SliderFloat("Ki (Integral)", &state.pid_ki, 0.0f, 0.01f, "%.5f");
+            ImGui::SliderFloat("Kd (Derivative)", &state.pid_kd, 0.0f, 0.05f, "%.4f");
+        }
 
         ImGui::Text("PID Terms:");
         ImGui::Text("  P: %.4f  I: %.4f  D: %.4f",
-                    state.speed_pid.getProportionalTerm(),
-                    state.speed_pid.getIntegralTerm(),
-                    state.speed_pid.getDerivativeTerm());
+                    telemetry.speed_p, telemetry.speed_i, telemetry.speed_d);
         ImGui::Text("Speed Error: %.2f m/s", state.speed_setpoint - state.velocity.magnitude());
     }
 
@@ -127,18 +235,21 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
     {
         ImGui::SliderFloat("Target Altitude (m)", &state.altitude_setpoint, 0.0f, 1000.0f, "%.1f");
         ImGui::Text("PID Gains:");
-        if (ImGui::SliderFloat("Kp (Proportional)##alt", &state.alt_pid_kp, 0.0f, 1.0f, "%.4f"))
-            state.altitude_pid = PIDController(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd, -10.0, 15.0);
-        if (ImGui::SliderFloat("Ki (Integral)##alt", &state.alt_pid_ki, 0.0f, 0.01f, "%.5f"))
-            state.altitude_pid = PIDController(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd, -10.0, 15.0);
-        if (ImGui::SliderFloat("Kd (Derivative)##alt", &state.alt_pid_kd, 0.0f, 2.0f, "%.4f"))
-            state.altitude_pid = PIDController(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd, -10.0, 15.0);
+        if (state.gainsScheduled())
+        {
+            ImGui::Text("  Scheduled  Kp: %.4f  Ki: %.5f  Kd: %.4f",
+                        state.altitude_pid.getKp(), state.altitude_pid.getKi(), state.altitude_pid.getKd());
+        }
+        else
+        {
+            ImGui::SliderFloat("Kp (Proportional)##alt", &state.alt_pid_kp, 0.0f, 1.0f, "%.4f");
+            ImGui::SliderFloat("Ki (Integral)##alt", &state.alt_pid_ki, 0.0f, 0.01f, "%.5f");
+            ImGui::SliderFloat("Kd (Derivative)##alt", &state.alt_pid_kd, 0.0f, 2.0f, "%.4f");
+        }
 
         ImGui::Text("PID Terms:");
         ImGui::Text("  P: %.4f  I: %.4f  D: %.4f",
-                    state.altitude_pid.getProportionalTerm(),
-                    state.altitude_pid.getIntegralTerm(),
-                    state.altitude_pid.getDerivativeTerm());
+                    telemetry.altitude_p, telemetry.altitude_i, telemetry.altitude_d);
         ImGui::Text("Altitude Error: %.2f m", state.altitude_setpoint - state.position.y);
     }
 
@@ -209,18 +320,9 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
     {
         try
         {
-            if (ui_state.aircraft_configs[ui_state.selected_aircraft].filepath.empty())
-            {
-                state.aircraft = Aircraft();
-                ui_state.load_message = std::string("Loaded: ") + ui_state.aircraft_configs[ui_state.selected_aircraft].name;
-                ui_state.load_error = false;
-            }
-            else
-            {
-                state.aircraft = AircraftLoader::loadFromJSON(ui_state.aircraft_configs[ui_state.selected_aircraft].filepath);
-                ui_state.load_message = std::string("Loaded: ") + ui_state.aircraft_configs[ui_state.selected_aircraft].name;
-                ui_state.load_error = false;
-            }
+            state.aircraft = loadAircraftConfig(ui_state.aircraft_configs[ui_state.selected_aircraft]);
+            ui_state.load_message = std::string("Loaded: ") + ui_state.aircraft_configs[ui_state.selected_aircraft].name;
+            ui_state.load_error = false;
         }
         catch (const std::exception &e)
         {
@@ -244,6 +346,18 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
     ImGui::Text("Frame Time:   %.2f ms", ui_state.avg_frame_time);
     ImGui::Text("Sim Step:     %.3f ms", state.dt * 1000.0);
 
+    static const char *integrator_names[] = {"RK4", "Semi-implicit Euler"};
+    int integrator_index = static_cast<int>(state.integrator);
+    ImGui::SetNextItemWidth(150);
+    if (ImGui::Combo("Integrator", &integrator_index, integrator_names, 2))
+        state.integrator = static_cast<IntegratorType>(integrator_index);
+
+    static const char *math_tier_names[] = {"Exact", "Fast (polynomial)"};
+    int math_tier_index = static_cast<int>(state.math_tier);
+    ImGui::SetNextItemWidth(150);
+    if (ImGui::Combo("Math Tier", &math_tier_index, math_tier_names, 2))
+        state.math_tier = static_cast<MathTier>(math_tier_index);
+
 #ifdef NDEBUG
     ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Build: Release");
 #else
@@ -257,8 +371,8 @@ inline void renderControlPanel(SimulationState &state, UIState &ui_state)
     ImGui::End();
 }
 
-// Render the instrumentation panel
-inline void renderInstrumentationPanel(const SimulationState &state)
+// Render the instrumentation panel from the latest telemetry record
+inline void renderInstrumentationPanel(const TelemetryRecord &telemetry, uint64_t telemetry_dropped)
 {
     ImGui::SetNextWindowPos(ImVec2(420, 520), ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowSize(ImVec2(850, 190), ImGuiCond_FirstUseEver);
@@ -267,35 +381,40 @@ inline void renderInstrumentationPanel(const SimulationState &state)
     // Gauges
     ImGui::BeginGroup();
     ImGui::Text("Altitude");
-    ImGui::ProgressBar(static_cast<float>(state.position.y / 1000.0), ImVec2(0.0f, 0.0f));
-    ImGui::Text("%.0f m", state.position.y);
+    ImGui::ProgressBar(static_cast<float>(telemetry.position.y / 1000.0), ImVec2(0.0f, 0.0f));
+    ImGui::Text("%.0f m", telemetry.position.y);
     ImGui::EndGroup();
 
     ImGui::SameLine();
 
     ImGui::BeginGroup();
     ImGui::Text("Airspeed");
-    ImGui::ProgressBar(static_cast<float>(state.velocity.magnitude() / 100.0), ImVec2(0.0f, 0.0f));
-    ImGui::Text("%.0f m/s", state.velocity.magnitude());
+    ImGui::ProgressBar(static_cast<float>(telemetry.velocity.magnitude() / 100.0), ImVec2(0.0f, 0.0f));
+    ImGui::Text("%.0f m/s", telemetry.velocity.magnitude());
     ImGui::EndGroup();
 
     ImGui::SameLine();
 
     ImGui::BeginGroup();
     ImGui::Text("Throttle");
-    ImGui::ProgressBar(state.throttle, ImVec2(0.0f, 0.0f));
-    ImGui::Text("%.0f %%", state.throttle * 100.0f);
+    ImGui::ProgressBar(telemetry.throttle, ImVec2(0.0f, 0.0f));
+    ImGui::Text("%.0f %%", telemetry.throttle * 100.0f);
     ImGui::EndGroup();
 
     ImGui::Separator();
 
     // Atmospheric data
-    double alt = std::max(0.0, state.position.y);
+    double alt = std::max(0.0, telemetry.position.y);
     ImGui::Text("Atmospheric Conditions:");
     ImGui::Text("Temperature: %.1f °C", getTemperature(alt) - 273.15);
     ImGui::Text("Pressure:    %.0f Pa", getPressure(alt));
     ImGui::Text("Density:     %.3f kg/m³", getDensity(alt));
     ImGui::Text("Sound Speed: %.1f m/s", getSpeedOfSound(alt));
 
+    ImGui::Separator();
+    ImGui::Text("Telemetry: record #%llu, %llu dropped",
+                static_cast<unsigned long long>(telemetry.sequence),
+                static_cast<unsigned long long>(telemetry_dropped));
+
     ImGui::End();
 }
@@ -8,6 +8,19 @@
 // Simulation
 #include "simulation/simulation_state.hpp"
 #include "simulation/physics_update.hpp"
+#include "simulation/simulation_scene.hpp"
+#include "simulation/batch_engine.hpp"
+
+// Telemetry
+#include "telemetry/telemetry_hub.hpp"
+#include "telemetry/telemetry_exporter.hpp"
+#include <memory>
+#include <string>
+
+// External control
+#ifndef _WIN32
+#include "shm/shm_control.hpp"
+#endif
 
 // Graphics
 #include "graphics/camera.hpp"
@@ -20,8 +33,20 @@
 // Utils
 #include "utils/aircraft_config_manager.hpp"
 
-int main(int, char **)
+int main(int argc, char **argv)
 {
+    // Optional telemetry stream: --telemetry udp://host:port | unix:///path
+    // Optional shared-memory control of the selected aircraft: --shm /name
+    std::string telemetry_endpoint;
+    std::string shm_name;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--telemetry")
+            telemetry_endpoint = argv[i + 1];
+        else if (std::string(argv[i]) == "--shm")
+            shm_name = argv[i + 1];
+    }
+
     // Initialize SDL
     if (!SDL_Init(SDL_INIT_VIDEO))
     {
@@ -72,12 +97,46 @@ int main(int, char **)
     ImGui_ImplOpenGL3_Init("#version 130");
 
     // Initialize systems
-    SimulationState sim_state;
+    SimulationScene scene;
+    BatchEngine engine;
     Camera camera;
     FlightRenderer renderer;
     CameraInput camera_input;
     UIState ui_state;
 
+    // Telemetry: this thread publishes after each step; the panels read their own consumer
+    TelemetryHub telemetry;
+    TelemetryHub::Consumer ui_telemetry = telemetry.attach();
+    TelemetryRecord ui_record{};
+    std::unique_ptr<TelemetryExporter> telemetry_exporter;
+    if (!telemetry_endpoint.empty())
+    {
+        try
+        {
+            telemetry_exporter = std::make_unique<TelemetryExporter>(telemetry, telemetry_endpoint);
+        }
+        catch (const std::exception &e)
+        {
+            SDL_Log("Telemetry export disabled: %s", e.what());
+        }
+    }
+
+#ifndef _WIN32
+    // External commands override the sliders whenever a new one arrives
+    std::unique_ptr<ShmControlServer> shm_control;
+    if (!shm_name.empty())
+    {
+        try
+        {
+            shm_control = std::make_unique<ShmControlServer>(shm_name);
+        }
+        catch (const std::exception &e)
+        {
+            SDL_Log("Shared-memory control disabled: %s", e.what());
+        }
+    }
+#endif
+
     // Load aircraft configurations
     auto configs = AircraftConfigManager::scanConfigs();
     for (const auto &config : configs)
@@ -90,6 +149,9 @@ int main(int, char **)
         ui_state.aircraft_names.push_back(name.c_str());
     }
 
+    // Start with a single default aircraft; more can be added from the Scene panel
+    scene.add("Default", Aircraft());
+
     // Performance tracking
     Uint64 last_frame_time = SDL_GetPerformanceCounter();
     Uint64 perf_frequency = SDL_GetPerformanceFrequency();
@@ -135,17 +197,45 @@ int main(int, char **)
         ImGui_ImplSDL3_NewFrame();
         ImGui::NewFrame();
 
-        // Reset if requested
-        if (sim_state.reset_requested)
+#ifndef _WIN32
+        if (shm_control)
+            shm_control->applyCommands(scene.selectedState());
+#endif
+
+        // Update simulation (handles pending resets)
+        engine.step(scene.states);
+
+#ifndef _WIN32
+        if (shm_control && !scene.selectedState().paused)
+            shm_control->publish(scene.selectedState());
+#endif
+
+        // One record per aircraft that stepped this frame
+        for (size_t i = 0; i < scene.size(); i++)
         {
-            sim_state.reset();
+            if (!scene.states[i].paused)
+                telemetry.publish(makeTelemetryRecord(scene.states[i], static_cast<uint32_t>(i)));
         }
 
-        // Update simulation
-        updatePhysics(sim_state);
-
-        // Render UI panels
-        renderControlPanel(sim_state, ui_state);
+        // Scene panel may add or remove aircraft, so take the selection afterwards
+        renderScenePanel(scene, ui_state);
+        SimulationState &sim_state = scene.selectedState();
+
+        // Latest record for the selected aircraft; a paused (or just changed)
+        // selection has none this frame, so snapshot its state directly
+        bool have_record = false;
+        ui_telemetry.drain([&](const TelemetryRecord &record)
+                           {
+            if (static_cast<int>(record.aircraft) == scene.selected)
+            {
+                ui_record = record;
+                have_record = true;
+            } });
+        if (!have_record)
+            ui_record = makeTelemetryRecord(sim_state, static_cast<uint32_t>(scene.selected));
+
+        // Render UI panels for the selected aircraft
+        renderControlPanel(sim_state, ui_state, ui_record);
 
         // Flight Path Visualization
         ImGui::SetNextWindowPos(ImVec2(420, 10), ImGuiCond_FirstUseEver);
@@ -166,7 +256,7 @@ int main(int, char **)
         camera_input.handleInput(camera, canvas_p0, canvas_sz, is_hovered);
 
         // Render flight visualization
-        renderer.render(sim_state, camera, ui_state.show_vectors, canvas_p0, canvas_sz);
+        renderer.render(scene, ui_record, camera, ui_state.show_vectors, canvas_p0, canvas_sz);
 
         ImGui::Text("Controls: Left-click drag to pan, Mouse wheel to zoom");
         ImGui::Text("Zoom: %.2fx | Position: (%.0f, %.0f) m", camera.view_scale, sim_state.position.x, sim_state.position.y);
@@ -193,7 +283,7 @@ int main(int, char **)
         ImGui::End();
 
         // Instrumentation Panel
-        renderInstrumentationPanel(sim_state);
+        renderInstrumentationPanel(ui_record, ui_telemetry.dropped());
 
         // Optional windows
         if (ui_state.show_demo)
@@ -1,120 +1,261 @@
 #include <iostream>
 #include <iomanip>
+#include <string>
 #include <vector>
-#include <cmath>
-#include "core/vec2.hpp"
-#include "environment/atmosphere.hpp"
-#include "aerodynamics/aero.hpp"
-#include "core/integrator.hpp"
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include "scenario/scenario_runner.hpp"
+#include "telemetry/telemetry_exporter.hpp"
+#ifndef _WIN32
+#include "shm/shm_control.hpp"
 #endif
 
-int main()
+// Headless scenario runner
+// Usage: FlightDynamics <scenario.json | scenario_dir> [--out <dir>] [--threads <n>] [--format csv|trj]
+//                       [--telemetry <endpoint>] [--shm <name>] [--realtime] [--progress] [--metrics <file.prom>]
+
+static void printUsage()
+{
+    std::cout << "Usage: FlightDynamics <scenario.json | scenario_dir> [--out <dir>] [--threads <n>] [--format csv|trj]\n"
+              << "                      [--telemetry <endpoint>] [--shm <name>] [--realtime] [--progress]\n"
+              << "                      [--metrics <file.prom>]\n"
+              << "  Runs one scenario file, or every *.json in a directory in parallel.\n"
+              << "  Trajectories are written to <dir>/<scenario>.csv (default: results),\n"
+              << "  located events (stops, \"detect\" crossings) to <dir>/<scenario>.events.csv.\n"
+              << "  --format trj writes compressed trajectory archives (<scenario>.trj) instead of CSV.\n"
+              << "  --telemetry udp://host:port | unix:///path streams a single scenario file's steps.\n"
+              << "  --shm /name exposes a single scenario file's state and control inputs in shared memory.\n"
+              << "  --realtime paces a single scenario file's steps to the wall clock.\n"
+              << "  --progress prints a directory batch's status every second (steps/s, jobs left, ETA,\n"
+              << "  worker use); --metrics writes the same to a Prometheus text file (node exporter\n"
+              << "  textfile collector).\n";
+}
+
+int main(int argc, char *argv[])
 {
-    // Aircraft state vectors
-    Vec2 position(0.0, 0.0);   // (x, z) position in m
-    Vec2 velocity(50.0, 10.0); // (x, z) velocity in m/s
-    double speed = velocity.magnitude();
-    Vec2 velocityDir = velocity.normalized();
-
-    // Aircraft parameters
-    double mass = 1200.0;      // kg
-    double S = 16.0;           // wing area m^2
-    double CL_alpha = 5.7;     // lift curve slope 1/rad
-    double CD0 = 0.025;        // parasitic drag
-    double k = 0.04;           // induced drag factor
-    double maxThrust = 5000.0; // N
-
-    // Control inputs
-    double throttle = 0.7;             // 70% throttle
-    double alpha = 5.0 * M_PI / 180.0; // 5 degree angle of attack
-
-    // Aircraft body axis direction (angle from horizontal)
-    Vec2 alpha_dir(std::cos(alpha), std::sin(alpha));
-
-    // Atmospheric properties
-    double rho = getDensity(0.0);
-
-    std::cout << "INITIAL STATE:\n";
-    std::cout << "  Position: ";
-    position.print();
-    std::cout << " m\n";
-    std::cout << "  Velocity: ";
-    velocity.print();
-    std::cout << " m/s\n";
-    std::cout << "  Speed: " << speed << " m/s\n\n";
-
-    // Calculate aerodynamic coefficients
-    double CL = calcCL(alpha, CL_alpha);
-    double CD = calcCD(CL, CD0, k);
-
-    // Calculate force magnitudes
-    double L_mag = calcLift(rho, speed, S, CL);
-    double D_mag = calcDrag(rho, speed, S, CD);
-    double W_mag = calcWeight(mass, g);
-    double T_mag = calcThrust(throttle, maxThrust);
-
-    // === FORCE VECTOR DECOMPOSITION ===
-
-    // 1. THRUST: Acts along aircraft body axis (alpha direction)
-    Vec2 F_thrust = alpha_dir * T_mag;
-
-    // 2. DRAG: Acts opposite to velocity direction
-    Vec2 F_drag = velocityDir * (-D_mag);
-
-    // 3. LIFT: Acts perpendicular to velocity (rotated 90° CCW from velocity)
-    Vec2 liftDir(-velocityDir.y, velocityDir.x);
-    Vec2 F_lift = liftDir * L_mag;
-
-    // 4. WEIGHT: Always acts in -z direction (downward)
-    Vec2 F_weight(0.0, -W_mag);
-
-    // 5. NET FORCE: Sum all force vectors
-    Vec2 F_net = F_thrust + F_drag + F_lift + F_weight;
-    Vec2 acceleration = F_net / mass; // a = F/m
-
-    std::cout << "FORCES:\n";
-    std::cout << "  Thrust: ";
-    F_thrust.print();
-    std::cout << " N\n";
-    std::cout << "  Drag:   ";
-    F_drag.print();
-    std::cout << " N\n";
-    std::cout << "  Lift:   ";
-    F_lift.print();
-    std::cout << " N\n";
-    std::cout << "  Weight: ";
-    F_weight.print();
-    std::cout << " N\n";
-    std::cout << "  Net:    ";
-    F_net.print();
-    std::cout << " N\n\n";
-
-    std::cout << "ACCELERATION:\n";
-    std::cout << "  ";
-    acceleration.print();
-    std::cout << " m/s²\n\n";
-
-    // === INTEGRATION STEP ===
-    double dt = 0.1; // 0.1 second time step
-
-    std::cout << "INTEGRATING (RK4) with dt=" << dt << "s:\n";
-    integrateRK4(position, velocity, acceleration, dt);
-
-    for (int i = 0; i < 10; i++)
+    std::filesystem::path scenarioPath;
+    std::filesystem::path outputDir = "results";
+    size_t threads = 0;
+    std::string telemetryEndpoint;
+    std::string shmName;
+    bool realtime = false;
+    std::string extension = ".csv";
+    bool showProgress = false;
+    std::filesystem::path metricsFile;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--out" && i + 1 < argc)
+            {
+                outputDir = argv[++i];
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                threads = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--telemetry" && i + 1 < argc)
+            {
+                telemetryEndpoint = argv[++i];
+            }
+            else if (arg == "--shm" && i + 1 < argc)
+            {
+                shmName = argv[++i];
+            }
+            else if (arg == "--format" && i + 1 < argc)
+            {
+                std::string format = argv[++i];
+                if (format != "csv" && format != "trj")
+                {
+                    std::cerr << "Unknown format: " << format << "\n";
+                    return 1;
+                }
+                extension = "." + format;
+            }
+            else if (arg == "--realtime")
+            {
+                realtime = true;
+            }
+            else if (arg == "--progress")
+            {
+                showProgress = true;
+            }
+            else if (arg == "--metrics" && i + 1 < argc)
+            {
+                metricsFile = argv[++i];
+            }
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage();
+                return 0;
+            }
+            else if (scenarioPath.empty() && arg.rfind("--", 0) != 0)
+            {
+                scenarioPath = arg;
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                printUsage();
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        printUsage();
+        return 1;
+    }
+
+    if (scenarioPath.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> files;
+    try
+    {
+        files = findScenarioFiles(scenarioPath);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    if (files.empty())
     {
-        integrateRK4(position, velocity, acceleration, dt);
-        speed = velocity.magnitude();
-        std::cout << "  Step " << i + 1 << ": Position ";
-        position.print();
-        std::cout << " m\n";
-        std::cout << "           Velocity ";
-        velocity.print();
-        std::cout << " m/s\n";
-        std::cout << "           Speed: " << speed << " m/s\n";
+        std::cerr << "No scenario files found in " << scenarioPath.string() << "\n";
+        return 1;
     }
 
-    return 0;
-}
\ No newline at end of file
+#ifdef _WIN32
+    if (!shmName.empty())
+    {
+        std::cerr << "Error: --shm needs POSIX shared memory\n";
+        return 1;
+    }
+#endif
+
+    // Options of the other mode are errors, never silently ignored
+    const bool batch = std::filesystem::is_directory(scenarioPath);
+    bool interactive = !telemetryEndpoint.empty() || !shmName.empty() || realtime;
+    if (interactive && batch)
+    {
+        std::cerr << "Error: --telemetry, --shm and --realtime run a single scenario file, not a directory\n";
+        printUsage();
+        return 1;
+    }
+    if ((showProgress || !metricsFile.empty()) && !batch)
+    {
+        std::cerr << "Error: --progress and --metrics report a directory batch, not a single scenario file\n";
+        printUsage();
+        return 1;
+    }
+
+    std::vector<ScenarioResult> results;
+    auto start = std::chrono::steady_clock::now();
+
+    if (interactive)
+    {
+        // Single run on this thread; the exporter thread does the socket I/O
+        std::cout << "Running 1 scenario" << (realtime ? " in real time" : "") << "\n";
+        try
+        {
+            Scenario scenario = ScenarioLoader::loadFromFile(files[0]);
+            scenario.realtime = scenario.realtime || realtime;
+            std::filesystem::path outputFile = outputDir / (files[0].stem().string() + extension);
+            std::filesystem::create_directories(outputDir);
+
+            TelemetryHub hub(1 << 16);
+            std::unique_ptr<TelemetryExporter> exporter;
+            if (!telemetryEndpoint.empty())
+            {
+                exporter = std::make_unique<TelemetryExporter>(hub, telemetryEndpoint);
+                std::cout << "Streaming telemetry to " << telemetryEndpoint << "\n";
+            }
+            TelemetryHub *telemetry = exporter ? &hub : nullptr;
+
+#ifndef _WIN32
+            if (!shmName.empty())
+            {
+                ShmControlServer control(shmName);
+                std::cout << "Shared-memory control on " << shmName << "\n";
+                results.push_back(runScenario(scenario, outputFile, telemetry, &control));
+                std::cout << "Shared memory: " << control.commandsApplied() << " commands applied\n";
+            }
+            else
+#endif
+            {
+                results.push_back(runScenario(scenario, outputFile, telemetry));
+            }
+
+            if (exporter)
+            {
+                exporter->stop();
+                TelemetryExporter::Stats stats = exporter->stats();
+                std::cout << "Telemetry: " << stats.frames << " frames in " << stats.packets << " packets, "
+                          << stats.dropped << " dropped, " << stats.sendErrors << " send errors\n";
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        ThreadPool pool(threads);
+        std::cout << "Running " << files.size() << " scenario(s) on " << pool.size() << " thread(s)\n";
+        BatchProgress progress(pool.size());
+        std::optional<ProgressReporter> reporter;
+        if (showProgress || !metricsFile.empty())
+        {
+            ProgressReporter::Options report;
+            report.batch = scenarioPath.filename().string();
+            report.status = showProgress ? &std::cerr : nullptr;
+            report.overwrite = stderrIsTerminal();
+            report.metrics_file = metricsFile;
+            reporter.emplace(progress, report);
+        }
+        results = runScenarioFiles(files, outputDir, pool, extension, reporter ? &progress : nullptr);
+        if (reporter)
+        {
+            reporter->stop();
+            if (!reporter->error().empty())
+                std::cerr << "Warning: metrics not written: " << reporter->error() << "\n";
+        }
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t totalSteps = 0;
+    int failures = 0;
+    std::cout << std::fixed;
+    for (const ScenarioResult &r : results)
+    {
+        if (!r.ok())
+        {
+            std::cout << "  FAILED " << r.name << ": " << r.error << "\n";
+            failures++;
+            continue;
+        }
+        totalSteps += r.steps;
+        std::cout << "  " << std::left << std::setw(28) << r.name << std::right
+                  << std::setw(10) << r.steps << " steps  "
+                  << std::setprecision(2) << std::setw(9) << r.sim_time << " s sim  "
+                  << std::setw(14) << r.stop_reason << std::setw(4) << r.events.size() << " events  "
+                  << std::setprecision(0) << std::setw(12) << r.stepsPerSecond() << " steps/s  -> "
+                  << r.outputFile.string() << "\n";
+    }
+
+    std::cout << "Total: " << totalSteps << " steps in " << std::setprecision(3) << wall << " s ("
+              << std::setprecision(0) << (wall > 0.0 ? totalSteps / wall : 0.0) << " steps/s)\n";
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include "scenario/monte_carlo.hpp"
+
+// Monte Carlo dispersion study of a scenario, statistics only
+// Usage: MonteCarlo <study.json> [--runs <n>] [--seed <n>] [--out <dir>] [--threads <n>]
+//                   [--checkpoint <file>] [--checkpoint-interval <s>] [--time-limit <s>] [--resume]
+//                   [--progress] [--metrics <file.prom>]
+
+static void printUsage()
+{
+    std::cout << "Usage: MonteCarlo <study.json> [--runs <n>] [--seed <n>] [--out <dir>] [--threads <n>]\n"
+              << "                  [--checkpoint <file>] [--checkpoint-interval <s>] [--time-limit <s>] [--resume]\n"
+              << "                  [--progress] [--metrics <file.prom>]\n"
+              << "  Flies the study's scenario with perturbed aircraft, initial state and wind and keeps only\n"
+              << "  streaming statistics of each run's outcome (mean, standard deviation, quantiles,\n"
+              << "  histograms), so memory does not grow with the run count. Writes\n"
+              << "  <dir>/<study>.summary.csv and <dir>/<study>.histograms.csv (default: results).\n"
+              << "  Progress is checkpointed to <dir>/<study>.checkpoint every 300 s (or --checkpoint-interval)\n"
+              << "  and removed when the study completes; --resume continues from it. --time-limit stops at\n"
+              << "  a checkpoint after that many seconds (exit code 2) for a later --resume.\n"
+              << "  --progress prints a status line every second (steps/s, runs left, ETA, worker use);\n"
+              << "  --metrics writes the same to a Prometheus text file (node exporter textfile collector).\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::filesystem::path studyPath;
+    std::filesystem::path outputDir = "results";
+    uint64_t runs = 0, seed = 0;
+    bool seedSet = false;
+    size_t threads = 0;
+    std::filesystem::path checkpointFile;
+    double checkpointInterval = -1.0, timeLimit = -1.0;
+    bool resume = false;
+    bool showProgress = false;
+    std::filesystem::path metricsFile;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--runs" && i + 1 < argc)
+            {
+                runs = std::stoull(argv[++i]);
+            }
+            else if (arg == "--seed" && i + 1 < argc)
+            {
+                seed = std::stoull(argv[++i]);
+                seedSet = true;
+            }
+            else if (arg == "--out" && i + 1 < argc)
+            {
+                outputDir = argv[++i];
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                threads = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--checkpoint" && i + 1 < argc)
+            {
+                checkpointFile = argv[++i];
+            }
+            else if (arg == "--checkpoint-interval" && i + 1 < argc)
+            {
+                checkpointInterval = std::stod(argv[++i]);
+            }
+            else if (arg == "--time-limit" && i + 1 < argc)
+            {
+                timeLimit = std::stod(argv[++i]);
+            }
+            else if (arg == "--resume")
+            {
+                resume = true;
+            }
+            else if (arg == "--progress")
+            {
+                showProgress = true;
+            }
+            else if (arg == "--metrics" && i + 1 < argc)
+            {
+                metricsFile = argv[++i];
+            }
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage();
+                return 0;
+            }
+            else if (studyPath.empty() && arg.rfind("--", 0) != 0)
+            {
+                studyPath = arg;
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                printUsage();
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (studyPath.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    try
+    {
+        DispersionStudy study = DispersionLoader::loadFromFile(studyPath);
+        if (runs > 0)
+            study.options.runs = runs;
+        if (seedSet)
+            study.options.seed = seed;
+
+        const std::string stem = studyPath.stem().string();
+        std::filesystem::create_directories(outputDir);
+        MonteCarloOptions &options = study.options;
+        options.checkpoint_file = checkpointFile.empty() ? outputDir / (stem + ".checkpoint") : checkpointFile;
+        if (checkpointInterval >= 0.0)
+            options.checkpoint_interval = checkpointInterval;
+        if (timeLimit >= 0.0)
+            options.time_limit = timeLimit;
+        options.resume = resume;
+        const bool resumed = resume && std::filesystem::exists(options.checkpoint_file);
+        if (resumed)
+            std::cout << "Resuming from " << options.checkpoint_file.string() << "\n";
+
+        ThreadPool pool(threads);
+        std::cout << "Running " << options.runs << " dispersed runs of " << study.scenario.name << " on "
+                  << pool.size() << " thread(s)\n";
+        auto start = std::chrono::steady_clock::now();
+        BatchProgress progress(pool.size());
+        std::optional<ProgressReporter> reporter;
+        if (showProgress || !metricsFile.empty())
+        {
+            ProgressReporter::Options report;
+            report.batch = stem;
+            report.status = showProgress ? &std::cerr : nullptr;
+            report.overwrite = stderrIsTerminal();
+            report.metrics_file = metricsFile;
+            reporter.emplace(progress, report);
+        }
+        MonteCarloSummary summary =
+            runMonteCarlo(study.scenario, study.model, options, pool, reporter ? &progress : nullptr);
+        if (reporter)
+        {
+            reporter->stop();
+            if (!reporter->error().empty())
+                std::cerr << "Warning: metrics not written: " << reporter->error() << "\n";
+        }
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (summary.runs < options.runs)
+        {
+            std::cout << "Time limit reached after " << std::fixed << std::setprecision(1) << wall
+                      << " s; progress saved to " << options.checkpoint_file.string()
+                      << ", continue with --resume\n";
+            return 2;
+        }
+
+        std::filesystem::path summaryFile = outputDir / (stem + ".summary.csv");
+        std::filesystem::path histogramFile = outputDir / (stem + ".histograms.csv");
+        std::cout << std::fixed << std::setprecision(3) << "  " << std::left << std::setw(16) << "metric"
+                  << std::right << std::setw(12) << "mean" << std::setw(12) << "stddev" << std::setw(12) << "p01"
+                  << std::setw(12) << "p50" << std::setw(12) << "p99" << "\n";
+        for (size_t m = 0; m < DispersionMetricCount; m++)
+        {
+            const MetricSummary &s = summary.metrics[m];
+            const char *name = dispersionMetricName(m);
+            std::cout << "  " << std::left << std::setw(16) << name << std::right << std::setw(12) << s.stats.mean()
+                      << std::setw(12) << s.stats.stddev() << std::setw(12) << s.quantiles.quantile(0.01)
+                      << std::setw(12) << s.quantiles.quantile(0.5) << std::setw(12) << s.quantiles.quantile(0.99)
+                      << "\n";
+        }
+
+        std::cout << "Stops:";
+        for (const auto &entry : summary.stop_reasons)
+            std::cout << " " << entry.first << " " << entry.second;
+        std::cout << "\n"
+                  << "Total: " << summary.runs << " runs, " << summary.steps << " steps";
+        if (resumed) // The steps include earlier sessions
+            std::cout << " (" << std::setprecision(3) << wall << " s in this session)\n";
+        else
+            std::cout << " in " << std::setprecision(3) << wall << " s (" << std::setprecision(0)
+                      << (wall > 0.0 ? summary.steps / wall : 0.0) << " steps/s)\n";
+        try
+        {
+            completeMonteCarloStudy(summary, summaryFile, histogramFile, options.checkpoint_file);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << "; the finished study is kept in "
+                      << options.checkpoint_file.string() << ", write it again with --resume\n";
+            return 1;
+        }
+        std::cout << "Wrote " << summaryFile.string() << " and " << histogramFile.string() << "\n";
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
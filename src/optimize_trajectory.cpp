@@ -0,0 +1,211 @@
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "aircraft/aircraft_loader.hpp"
+#include "simulation/trajectory_optimizer.hpp"
+
+// Optimal throttle and elevator schedules by multiple shooting
+// Usage: OptimizeTrajectory [--aircraft <config.json>] [--objective min-time|max-range] [--out <scenario.json>]
+//                           [--altitude <m>] [--speed <m/s>] [--pitch <deg>] [--throttle <0-1>]
+//                           [--target-altitude <m>] [--target-speed <m/s>] [--level] [--energy <J>]
+//                           [--duration <s>] [--min-duration <s>] [--max-duration <s>] [--segments <n>]
+//                           [--max-step <s>] [--max-alpha <deg>] [--integrator rk4|euler]
+//                           [--max-iterations <n>] [--threads <n>]
+
+static void printUsage()
+{
+    std::cout << "Usage: OptimizeTrajectory [--aircraft <config.json>] [--objective min-time|max-range]\n"
+              << "                          [--out <scenario.json>] [--altitude <m>] [--speed <m/s>] [--pitch <deg>]\n"
+              << "                          [--throttle <0-1>] [--target-altitude <m>] [--target-speed <m/s>] [--level]\n"
+              << "                          [--energy <J>] [--duration <s>] [--min-duration <s>] [--max-duration <s>]\n"
+              << "                          [--segments <n>] [--max-step <s>] [--max-alpha <deg>]\n"
+              << "                          [--integrator rk4|euler] [--max-iterations <n>] [--threads <n>]\n"
+              << "  Optimizes piecewise constant throttle and elevator from level flight at the given altitude\n"
+              << "  and airspeed: the fastest way to the target altitude/airspeed (min-time, default), or the\n"
+              << "  longest distance within --energy joules of propulsive work (max-range). --level ends in\n"
+              << "  level flight; --duration is the initial guess. Writes the schedule as a scenario\n"
+              << "  (default: optimized_schedule.json) for FlightDynamics.\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::string aircraftPath, outPath = "optimized_schedule.json";
+    TrajectoryOptions options;
+    FlightState initial;
+    initial.position = Vec2(0.0, 100.0);
+    initial.velocity = Vec2(30.0, 0.0);
+    initial.pitch_deg = 3.0f;
+    initial.throttle = 0.5f;
+    size_t threads = 0;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--aircraft" && i + 1 < argc)
+            {
+                aircraftPath = argv[++i];
+            }
+            else if (arg == "--objective" && i + 1 < argc)
+            {
+                std::string name = argv[++i];
+                if (name == "min-time")
+                    options.objective = TrajectoryObjective::MinimumTime;
+                else if (name == "max-range")
+                    options.objective = TrajectoryObjective::MaximumRange;
+                else
+                    throw std::runtime_error("Unknown objective: " + name);
+            }
+            else if (arg == "--out" && i + 1 < argc)
+            {
+                outPath = argv[++i];
+            }
+            else if (arg == "--altitude" && i + 1 < argc)
+            {
+                initial.position.y = std::stod(argv[++i]);
+            }
+            else if (arg == "--speed" && i + 1 < argc)
+            {
+                initial.velocity = Vec2(std::stod(argv[++i]), 0.0);
+            }
+            else if (arg == "--pitch" && i + 1 < argc)
+            {
+                initial.pitch_deg = std::stof(argv[++i]);
+            }
+            else if (arg == "--throttle" && i + 1 < argc)
+            {
+                initial.throttle = std::stof(argv[++i]);
+            }
+            else if (arg == "--target-altitude" && i + 1 < argc)
+            {
+                options.final_altitude = std::stod(argv[++i]);
+            }
+            else if (arg == "--target-speed" && i + 1 < argc)
+            {
+                options.final_speed = std::stod(argv[++i]);
+            }
+            else if (arg == "--level")
+            {
+                options.final_vz = 0.0;
+            }
+            else if (arg == "--energy" && i + 1 < argc)
+            {
+                options.energy_budget = std::stod(argv[++i]);
+            }
+            else if (arg == "--duration" && i + 1 < argc)
+            {
+                options.duration = std::stod(argv[++i]);
+            }
+            else if (arg == "--min-duration" && i + 1 < argc)
+            {
+                options.min_duration = std::stod(argv[++i]);
+            }
+            else if (arg == "--max-duration" && i + 1 < argc)
+            {
+                options.max_duration = std::stod(argv[++i]);
+            }
+            else if (arg == "--segments" && i + 1 < argc)
+            {
+                options.segments = std::stoi(argv[++i]);
+            }
+            else if (arg == "--max-step" && i + 1 < argc)
+            {
+                options.max_step = std::stod(argv[++i]);
+            }
+            else if (arg == "--max-alpha" && i + 1 < argc)
+            {
+                options.max_alpha_deg = std::stod(argv[++i]);
+            }
+            else if (arg == "--integrator" && i + 1 < argc)
+            {
+                std::string name = argv[++i];
+                if (name == "rk4")
+                    options.integrator = IntegratorType::RK4;
+                else if (name == "euler")
+                    options.integrator = IntegratorType::SemiImplicitEuler;
+                else
+                    throw std::runtime_error("Unknown integrator: " + name);
+            }
+            else if (arg == "--max-iterations" && i + 1 < argc)
+            {
+                options.max_iterations = std::stoi(argv[++i]);
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                threads = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage();
+                return 0;
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                printUsage();
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (options.objective == TrajectoryObjective::MinimumTime && std::isnan(options.final_altitude) &&
+        std::isnan(options.final_speed) && std::isnan(options.final_vz))
+    {
+        std::cerr << "Error: min-time needs a target (--target-altitude, --target-speed or --level)\n";
+        return 1;
+    }
+    if (options.objective == TrajectoryObjective::MaximumRange && !std::isfinite(options.energy_budget) &&
+        std::isnan(options.final_altitude))
+    {
+        std::cerr << "Error: max-range needs --energy or --target-altitude\n";
+        return 1;
+    }
+
+    try
+    {
+        Aircraft aircraft;
+        std::string aircraftRef = "default";
+        if (!aircraftPath.empty())
+        {
+            aircraft = AircraftLoader::loadFromJSON(aircraftPath);
+            // The scenario resolves the aircraft relative to its own directory
+            std::filesystem::path outDir = std::filesystem::absolute(outPath).parent_path();
+            aircraftRef = std::filesystem::relative(std::filesystem::absolute(aircraftPath), outDir).generic_string();
+        }
+        ThreadPool pool(threads);
+
+        std::cout << "Optimizing " << options.segments << " segments on " << pool.size() << " threads\n";
+        TrajectoryResult result = optimizeTrajectory(initial, aircraft, options, pool);
+
+        std::cout << result.iterations << " iterations, " << result.outer_iterations << " multiplier updates"
+                  << (result.converged ? "" : " (not converged)") << "\n"
+                  << std::fixed << std::setprecision(3) << "Duration " << result.duration << " s, range "
+                  << result.range << " m, propulsive work " << std::setprecision(0) << result.energy << " J\n"
+                  << std::setprecision(3) << "Final altitude " << result.nodes.back().position.y << " m, airspeed "
+                  << result.nodes.back().velocity.magnitude() << " m/s, vz " << result.nodes.back().velocity.y
+                  << " m/s\n";
+        for (size_t k = 0; k < result.throttle.size(); k++)
+        {
+            std::cout << "  t=" << std::setw(8) << k * result.segment_duration << "  throttle " << result.throttle[k]
+                      << "  elevator " << std::setw(7) << result.elevator[k] << "  alpha "
+                      << std::setw(7) << result.nodes[k + 1].alpha_deg << " deg\n";
+        }
+
+        writeScheduleScenario(result, outPath, aircraftRef, "Optimized schedule");
+        std::cout << "Wrote " << outPath << "\n";
+        return result.converged ? 0 : 2;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
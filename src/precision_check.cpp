@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "aircraft/aircraft_loader.hpp"
+#include "simulation/precision_drift.hpp"
+
+// Float vs double drift report for every aircraft config
+// Usage: PrecisionCheck [config_dir] [--duration <s>] [--dt <s>] [--lanes <n>] [--tolerance <m>]
+//                       [--integrator rk4|euler] [--fast-math] [--csv <file>]
+
+static void printUsage()
+{
+    std::cout << "Usage: PrecisionCheck [config_dir] [--duration <s>] [--dt <s>] [--lanes <n>] [--tolerance <m>]\n"
+              << "                      [--integrator rk4|euler] [--fast-math] [--csv <file>]\n"
+              << "  Flies every aircraft config (*.json in config_dir, default: config) through trimmed,\n"
+              << "  open-loop and autopilot maneuvers in double and float precision and reports how far\n"
+              << "  the float trajectories drift from the double ones.\n"
+              << "  Exit code 2 if any maneuver exceeds the position tolerance (default 1 m).\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::filesystem::path configDir = "config";
+    std::string csvPath;
+    DriftOptions options;
+    bool configGiven = false;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--duration" && i + 1 < argc)
+            {
+                options.duration = std::stod(argv[++i]);
+            }
+            else if (arg == "--dt" && i + 1 < argc)
+            {
+                options.dt = std::stod(argv[++i]);
+            }
+            else if (arg == "--lanes" && i + 1 < argc)
+            {
+                options.lanes = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--tolerance" && i + 1 < argc)
+            {
+                options.tolerance = std::stod(argv[++i]);
+            }
+            else if (arg == "--integrator" && i + 1 < argc)
+            {
+                std::string name = argv[++i];
+                if (name == "rk4")
+                    options.integrator = IntegratorType::RK4;
+                else if (name == "euler")
+                    options.integrator = IntegratorType::SemiImplicitEuler;
+                else
+                    throw std::runtime_error("Unknown integrator: " + name);
+            }
+            else if (arg == "--fast-math")
+            {
+                options.math_tier = MathTier::Fast;
+            }
+            else if (arg == "--csv" && i + 1 < argc)
+            {
+                csvPath = argv[++i];
+            }
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage();
+                return 0;
+            }
+            else if (!configGiven && arg.rfind("--", 0) != 0)
+            {
+                configDir = arg;
+                configGiven = true;
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                printUsage();
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (!(options.dt > 0.0) || !(options.duration > 0.0))
+    {
+        std::cerr << "Error: --dt and --duration must be positive\n";
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> configs;
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(configDir, ec))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".json")
+            configs.push_back(entry.path());
+    }
+    if (ec || configs.empty())
+    {
+        std::cerr << "No aircraft configs found in " << configDir.string() << "\n";
+        return 1;
+    }
+    std::sort(configs.begin(), configs.end());
+
+    std::ofstream csv;
+    if (!csvPath.empty())
+    {
+        csv.open(csvPath);
+        if (!csv.is_open())
+        {
+            std::cerr << "Failed to open " << csvPath << "\n";
+            return 1;
+        }
+        csv << "config,maneuver,lanes,steps,max_position_error,max_velocity_error,max_pitch_error,final_position_rms,time_to_tolerance\n";
+        csv << std::setprecision(9);
+    }
+
+    std::cout << "Float vs double drift: " << options.duration << " s at dt " << options.dt
+              << ", tolerance " << options.tolerance << " m\n";
+    std::cout << std::left << std::setw(24) << "config" << std::setw(11) << "maneuver" << std::right
+              << std::setw(6) << "lanes" << std::setw(13) << "max pos (m)" << std::setw(14) << "max vel (m/s)"
+              << std::setw(16) << "max pitch (deg)" << std::setw(13) << "rms end (m)" << std::setw(11) << "t_tol (s)"
+              << "  verdict\n";
+
+    bool allWithin = true;
+    const DriftManeuver maneuvers[] = {DriftManeuver::Trim, DriftManeuver::OpenLoop, DriftManeuver::Autopilot};
+    for (const auto &path : configs)
+    {
+        Aircraft aircraft;
+        try
+        {
+            aircraft = AircraftLoader::loadFromJSON(path.string());
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Skipping " << path.filename().string() << ": " << e.what() << "\n";
+            continue;
+        }
+
+        std::string name = path.stem().string();
+        for (DriftManeuver maneuver : maneuvers)
+        {
+            DriftReport r = measureDrift(aircraft, maneuver, options);
+            std::string verdict = r.lanes == 0 ? "n/a" : (r.withinTolerance() ? "ok" : "exceeds");
+            if (r.lanes > 0 && !r.withinTolerance())
+                allWithin = false;
+
+            std::cout << std::left << std::setw(24) << name << std::setw(11) << r.maneuver << std::right
+                      << std::setw(6) << r.lanes << std::scientific << std::setprecision(2)
+                      << std::setw(13) << r.max_position_error << std::setw(14) << r.max_velocity_error
+                      << std::setw(16) << r.max_pitch_error << std::setw(13) << r.final_position_rms
+                      << std::fixed << std::setprecision(1) << std::setw(11);
+            if (r.withinTolerance())
+                std::cout << "-";
+            else
+                std::cout << r.time_to_tolerance;
+            std::cout << "  " << verdict << "\n";
+
+            if (csv.is_open())
+            {
+                csv << name << "," << r.maneuver << "," << r.lanes << "," << r.steps << ","
+                    << r.max_position_error << "," << r.max_velocity_error << "," << r.max_pitch_error << ","
+                    << r.final_position_rms << "," << r.time_to_tolerance << "\n";
+            }
+        }
+    }
+
+    return allWithin ? 0 : 2;
+}
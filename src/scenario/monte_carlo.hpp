@@ -0,0 +1,992 @@
+#pragma once
+
+#include "scenario.hpp"
+#include "../simulation/physics_update.hpp"
+#include "../simulation/flight_events.hpp"
+#include "../core/streaming_stats.hpp"
+#include "../core/counter_rng.hpp"
+#include "../core/thread_pool.hpp"
+#include "../core/batch_progress.hpp"
+#include "../core/binary_io.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Random perturbations of a scenario for dispersion studies
+// Aircraft parameters are scaled by (1 + sigma z), z standard normal, so
+// their sigmas are fractions of the nominal value; initial state and steady
+// wind sigmas are absolute. The wing area scales both aero models, the CD0
+// and CL_alpha sigmas only affect aircraft without an aero table. With
+// turbulence, every run starts at its own random distance into the
+// scenario's field, i.e. flies an independent realization.
+struct DispersionModel
+{
+    // Relative 1-sigma
+    double mass = 0.0;
+    double thrust = 0.0;
+    double wing_area = 0.0;
+    double cd0 = 0.0;
+    double cl_alpha = 0.0;
+
+    // Absolute 1-sigma
+    double altitude = 0.0;  // m
+    double speed = 0.0;     // m/s, along the initial velocity
+    double pitch_deg = 0.0; // deg
+    Vec2 steady_wind{0.0, 0.0}; // m/s per component
+
+    bool turbulence_realizations = true;
+};
+
+// Outcome of one dispersed run, reduced to the quantities the study keeps
+enum class DispersionMetric
+{
+    Range,         // Final x (m)
+    FinalAltitude, // m
+    FinalSpeed,    // m/s
+    FlightTime,    // s
+    MaxAltitude,   // m
+    MinSpeed,      // m/s
+    MaxAlpha,      // deg
+    Count
+};
+
+constexpr size_t DispersionMetricCount = static_cast<size_t>(DispersionMetric::Count);
+
+inline const char *dispersionMetricName(size_t metric)
+{
+    static const char *const names[DispersionMetricCount] = {
+        "range", "final_altitude", "final_speed", "flight_time", "max_altitude", "min_speed", "max_alpha_deg"};
+    return metric < DispersionMetricCount ? names[metric] : "unknown";
+}
+
+struct DispersionRun
+{
+    std::array<double, DispersionMetricCount> metrics{};
+    const char *stop_reason = "duration";
+    size_t steps = 0;
+};
+
+// Streaming statistics of one metric: moments, quantiles and a histogram
+struct MetricSummary
+{
+    RunningStats stats;
+    QuantileDigest quantiles;
+    Histogram histogram; // Empty until binned (see MonteCarloOptions)
+
+    void add(double x)
+    {
+        stats.add(x);
+        quantiles.add(x);
+        histogram.add(x);
+    }
+
+    void merge(const MetricSummary &o)
+    {
+        stats.merge(o.stats);
+        quantiles.merge(o.quantiles);
+        histogram.merge(o.histogram);
+    }
+};
+
+// Aggregate of any number of runs; its size does not grow with the run count
+struct MonteCarloSummary
+{
+    uint64_t runs = 0;
+    uint64_t steps = 0;
+    std::array<MetricSummary, DispersionMetricCount> metrics;
+    std::map<std::string, uint64_t> stop_reasons;
+
+    const MetricSummary &operator[](DispersionMetric m) const { return metrics[static_cast<size_t>(m)]; }
+
+    void add(const DispersionRun &run)
+    {
+        runs++;
+        steps += run.steps;
+        for (size_t m = 0; m < DispersionMetricCount; m++)
+            metrics[m].add(run.metrics[m]);
+        stop_reasons[run.stop_reason]++;
+    }
+
+    void merge(const MonteCarloSummary &o)
+    {
+        runs += o.runs;
+        steps += o.steps;
+        for (size_t m = 0; m < DispersionMetricCount; m++)
+            metrics[m].merge(o.metrics[m]);
+        for (const auto &entry : o.stop_reasons)
+            stop_reasons[entry.first] += entry.second;
+    }
+
+    void save(BinaryWriter &out) const
+    {
+        out.u64(runs);
+        out.u64(steps);
+        for (const MetricSummary &m : metrics)
+        {
+            m.stats.save(out);
+            m.quantiles.save(out);
+            m.histogram.save(out);
+        }
+        out.u32(static_cast<uint32_t>(stop_reasons.size()));
+        for (const auto &entry : stop_reasons)
+        {
+            out.string(entry.first);
+            out.u64(entry.second);
+        }
+    }
+
+    static MonteCarloSummary load(BinaryReader &in)
+    {
+        MonteCarloSummary s;
+        s.runs = in.u64();
+        s.steps = in.u64();
+        for (MetricSummary &m : s.metrics)
+        {
+            m.stats = RunningStats::load(in);
+            m.quantiles = QuantileDigest::load(in);
+            m.histogram = Histogram::load(in);
+        }
+        for (size_t n = in.count(12); n > 0; n--) // Name length and count at least
+        {
+            std::string reason = in.string();
+            s.stop_reasons[reason] = in.u64();
+        }
+        return s;
+    }
+};
+
+struct MonteCarloOptions
+{
+    uint64_t runs = 1000;
+    uint64_t seed = 1;
+    size_t block = 64;        // Runs per work item, each with its own summary
+    size_t wave_blocks = 256; // Blocks in flight between merges (bounds memory)
+    double compression = 200.0; // t-digest compression
+    size_t histogram_bins = 40;
+
+    // Histogram range per metric; NaN takes it from the first block of runs,
+    // widened by half its spread on either side
+    std::array<double, DispersionMetricCount> histogram_min;
+    std::array<double, DispersionMetricCount> histogram_max;
+
+    // Checkpoints (off without a file): every checkpoint_interval seconds
+    // the progress is saved to checkpoint_file, replacing the previous one;
+    // with resume, a study continues from the file if it exists. After
+    // time_limit seconds the driver checkpoints and returns early, with a
+    // summary of fewer than `runs` runs.
+    std::filesystem::path checkpoint_file;
+    double checkpoint_interval = 300.0; // s of wall time
+    double time_limit = std::numeric_limits<double>::infinity(); // s
+    bool resume = false;
+
+    MonteCarloOptions()
+    {
+        histogram_min.fill(std::numeric_limits<double>::quiet_NaN());
+        histogram_max.fill(std::numeric_limits<double>::quiet_NaN());
+    }
+};
+
+namespace monte_carlo_detail
+{
+    // Random stream of the perturbations (see CounterRng); each one has its
+    // own index, so enabling one dispersion leaves the others' draws alone
+    constexpr uint32_t PerturbationStream = 0;
+    enum Draw : uint32_t
+    {
+        Mass,
+        Thrust,
+        WingArea,
+        Cd0,
+        ClAlpha,
+        Altitude,
+        Speed,
+        Pitch,
+        WindX,
+        WindZ,
+        TurbulenceOffset
+    };
+
+    inline double scaled(double nominal, double sigma, double z)
+    {
+        return nominal * std::max(0.05, 1.0 + sigma * z); // Never flips sign or vanishes
+    }
+}
+
+// Apply one draw of the dispersions to a copy of the scenario's initial state
+// The draws are counter-based random numbers of (seed, run), so any run can
+// be re-flown on its own.
+inline SimulationState disperseInitialState(const Scenario &scenario, const DispersionModel &model,
+                                            uint64_t seed, uint32_t run)
+{
+    using namespace monte_carlo_detail;
+    const CounterRng random(seed, run, PerturbationStream);
+    auto normal = [&](Draw d)
+    { return random.normal(0, d); };
+
+    SimulationState state = scenario.initial;
+    state.maxPathPoints = 0;
+    state.flightPath.clear();
+
+    Aircraft &a = state.aircraft;
+    a.mass = scaled(a.mass, model.mass, normal(Mass));
+    a.maxThrust = scaled(a.maxThrust, model.thrust, normal(Thrust));
+    a.S = scaled(a.S, model.wing_area, normal(WingArea));
+    a.CD0 = scaled(a.CD0, model.cd0, normal(Cd0));
+    a.CL_alpha = scaled(a.CL_alpha, model.cl_alpha, normal(ClAlpha));
+
+    state.position.y = std::max(0.0, state.position.y + model.altitude * normal(Altitude));
+    double speed = state.velocity.magnitude();
+    double dv = model.speed * normal(Speed);
+    if (speed > 0.0)
+        state.velocity = state.velocity * (std::max(0.0, speed + dv) / speed);
+    else
+        state.velocity.x = std::max(0.0, dv);
+    state.pitch_deg += static_cast<float>(model.pitch_deg * normal(Pitch));
+
+    state.wind.steady += Vec2(model.steady_wind.x * normal(WindX), model.steady_wind.y * normal(WindZ));
+    if (state.wind.turbulence && model.turbulence_realizations)
+        state.wind.turbulence_offset += random.uniform(0, TurbulenceOffset) * state.wind.turbulence->length();
+    return state;
+}
+
+// One dispersion run of a scenario, flown without output as runScenario
+// does (events, stop conditions located within the step) while tracking the
+// dispersion metrics, in slices of steps
+//
+// A paused run can be saved and loaded again onto the same scenario and
+// dispersion model: its parameters are rebuilt from the run's draws and the
+// events already applied, its hot state, controllers and trackers are read
+// back, so it continues exactly as if it had not been stopped. Every field
+// is written on its own, little-endian, so checkpoints move between builds
+// and machines.
+class DispersionFlight
+{
+public:
+    DispersionFlight(const Scenario &scenario_, SimulationState initial, uint32_t id_ = 0)
+        : scenario(&scenario_), state(std::move(initial)), id(id_)
+    {
+        totalSteps = static_cast<size_t>(std::ceil(scenario->duration / state.dt - 1e-9));
+        const StopConditions &stop = scenario->stop;
+        detector.watchGroundContact(stop.ground_contact);
+        detector.watchLimit("min_altitude", true, stop.min_altitude, false);
+        detector.watchLimit("max_altitude", true, stop.max_altitude, true);
+        detector.watchLimit("min_speed", false, stop.min_speed, false);
+        detector.watchLimit("max_speed", false, stop.max_speed, true);
+
+        maxAltitude = state.position.y;
+        minSpeed = state.velocity.magnitude();
+        maxAlpha = state.alpha_deg;
+    }
+
+    uint32_t runId() const { return id; }
+    bool finished() const { return stopped || run.steps >= totalSteps; }
+    size_t steps() const { return run.steps; }
+
+    // Fly up to maxSteps more steps; true once the run is over
+    bool advance(size_t maxSteps)
+    {
+        for (size_t n = 0; n < maxSteps && !finished(); n++)
+        {
+            const double dt = state.dt;
+            if (nextEvent < scenario->events.size() && scenario->events[nextEvent].time <= state.t + 0.5 * dt)
+            {
+                while (nextEvent < scenario->events.size() && scenario->events[nextEvent].time <= state.t + 0.5 * dt)
+                    scenario->events[nextEvent++].apply(state);
+                step = nullptr;
+            }
+            if (!step)
+            {
+                syncControllerGains(state);
+                step = selectPhysicsStep(state);
+            }
+
+            const FlightState before = state;
+            step(state);
+            run.steps++;
+
+            const FlightEvent *terminal = detector.detect(before, state, events);
+            if (terminal)
+            {
+                static_cast<FlightState &>(state) = terminal->state;
+                run.stop_reason = terminal->name;
+                stopped = true;
+            }
+            maxAltitude = std::max(maxAltitude, state.position.y);
+            minSpeed = std::min(minSpeed, state.velocity.magnitude());
+            maxAlpha = std::max(maxAlpha, static_cast<double>(state.alpha_deg));
+            events.clear(); // Only the stop matters
+        }
+        return finished();
+    }
+
+    DispersionRun result() const
+    {
+        DispersionRun r = run;
+        auto set = [&](DispersionMetric m, double v)
+        { r.metrics[static_cast<size_t>(m)] = v; };
+        set(DispersionMetric::Range, state.position.x);
+        set(DispersionMetric::FinalAltitude, state.position.y);
+        set(DispersionMetric::FinalSpeed, state.velocity.magnitude());
+        set(DispersionMetric::FlightTime, state.t - scenario->initial.t);
+        set(DispersionMetric::MaxAltitude, maxAltitude);
+        set(DispersionMetric::MinSpeed, minSpeed);
+        set(DispersionMetric::MaxAlpha, maxAlpha);
+        return r;
+    }
+
+    // A run in progress (a finished one is reduced to its result instead)
+    void save(BinaryWriter &out) const
+    {
+        out.u32(id);
+        out.u64(run.steps);
+        out.u64(nextEvent);
+        out.u8(detector.wasAirborne() ? 1 : 0);
+        out.f64(maxAltitude);
+        out.f64(minSpeed);
+        out.f64(maxAlpha);
+        out.f64(state.position.x);
+        out.f64(state.position.y);
+        out.f64(state.velocity.x);
+        out.f64(state.velocity.y);
+        out.f64(state.t);
+        for (float v : {state.throttle, state.elevator, state.pitch_deg, state.pitch_rate, state.alpha_deg})
+            out.f32(v);
+        savePid(out, state.speed_pid);
+        savePid(out, state.altitude_pid);
+    }
+
+    static DispersionFlight load(const Scenario &scenario, const DispersionModel &model, uint64_t seed,
+                                 BinaryReader &in)
+    {
+        const uint32_t id = in.u32();
+        DispersionFlight f(scenario, disperseInitialState(scenario, model, seed, id), id);
+        f.run.steps = static_cast<size_t>(in.u64());
+        f.nextEvent = static_cast<size_t>(in.u64());
+        if (f.run.steps >= f.totalSteps || f.nextEvent > scenario.events.size())
+            throw std::runtime_error("Saved run does not fit the scenario");
+        for (size_t e = 0; e < f.nextEvent; e++)
+            scenario.events[e].apply(f.state);
+        f.detector.restoreAirborne(in.u8() != 0);
+        f.maxAltitude = in.f64();
+        f.minSpeed = in.f64();
+        f.maxAlpha = in.f64();
+
+        SimulationState &s = f.state;
+        s.position.x = in.f64();
+        s.position.y = in.f64();
+        s.velocity.x = in.f64();
+        s.velocity.y = in.f64();
+        s.t = in.f64();
+        for (float *v : {&s.throttle, &s.elevator, &s.pitch_deg, &s.pitch_rate, &s.alpha_deg})
+            *v = in.f32();
+        loadPid(in, s.speed_pid);
+        loadPid(in, s.altitude_pid);
+        return f;
+    }
+
+private:
+    const Scenario *scenario;
+    SimulationState state;
+    uint32_t id;
+    FlightEventDetector detector;
+    std::vector<FlightEvent> events;
+    DispersionRun run;
+    size_t totalSteps = 0;
+    size_t nextEvent = 0;
+    PhysicsStepFn step = nullptr; // Selected again after events and on resume
+    bool stopped = false;
+    double maxAltitude, minSpeed, maxAlpha;
+
+    static void savePid(BinaryWriter &out, const PIDController &pid)
+    {
+        const PIDController::Snapshot p = pid.snapshot();
+        for (double v : {p.Kp, p.Ki, p.Kd, p.output_min, p.output_max, p.integral, p.previous_error, p.p_term,
+                         p.i_term, p.d_term})
+            out.f64(v);
+        out.u8(p.first_update ? 1 : 0);
+    }
+
+    static void loadPid(BinaryReader &in, PIDController &pid)
+    {
+        PIDController::Snapshot p;
+        for (double *v : {&p.Kp, &p.Ki, &p.Kd, &p.output_min, &p.output_max, &p.integral, &p.previous_error,
+                          &p.p_term, &p.i_term, &p.d_term})
+            *v = in.f64();
+        p.first_update = in.u8() != 0;
+        pid.restore(p);
+    }
+};
+
+// Fly one run of a scenario to the end
+inline DispersionRun flyDispersionRun(const Scenario &scenario, SimulationState state)
+{
+    DispersionFlight flight(scenario, std::move(state));
+    flight.advance(std::numeric_limits<size_t>::max());
+    return flight.result();
+}
+
+namespace monte_carlo_detail
+{
+    constexpr uint32_t CheckpointMagic = 0x434d5346; // "FSMC"
+    constexpr uint32_t CheckpointVersion = 3;
+    constexpr size_t SliceSteps = 1024; // Steps between deadline checks while checkpointing
+
+    // A block of runs part-way through: its finished runs, the next one to
+    // start and the one in flight
+    struct BlockProgress
+    {
+        MonteCarloSummary summary;
+        uint64_t next = 0;
+        std::optional<DispersionFlight> flight;
+    };
+
+    inline void fingerprintOptional(BinaryWriter &w, const std::optional<float> &v)
+    {
+        w.u8(v ? 1 : 0);
+        w.f32(v.value_or(0.0f));
+    }
+
+    inline void fingerprintOptional(BinaryWriter &w, const std::optional<bool> &v)
+    {
+        w.u8(v ? (*v ? 2 : 1) : 0);
+    }
+
+    inline void fingerprintOptional(BinaryWriter &w, const std::optional<std::array<float, 3>> &v)
+    {
+        w.u8(v ? 1 : 0);
+        for (float g : v.value_or(std::array<float, 3>{}))
+            w.f32(g);
+    }
+
+    // The resolved aircraft and flight parameters; tables and profiles are
+    // hashed through their public accessors, at their own breakpoints
+    inline void fingerprintParams(BinaryWriter &w, const FlightParams &p)
+    {
+        const Aircraft &a = p.aircraft;
+        for (double v : {a.mass, a.S, a.CL_alpha, a.CD0, a.k, a.maxThrust})
+            w.f64(v);
+        w.u64(a.aeroTable ? a.aeroTable->points().size() + 1 : 0);
+        if (a.aeroTable)
+            for (const AeroDataTable::DataPoint &point : a.aeroTable->points())
+                for (double v : {point.alpha, point.CL, point.CD})
+                    w.f64(v);
+        w.u8(a.gainSchedule ? 1 : 0);
+        if (a.gainSchedule)
+        {
+            const std::vector<double> &qs = a.gainSchedule->dynamicPressures();
+            const std::vector<double> &hs = a.gainSchedule->altitudes();
+            w.u64(qs.size());
+            w.u64(hs.size());
+            for (double q : qs)
+                for (double h : hs)
+                {
+                    ScheduledGains g = a.gainSchedule->lookup(q, h);
+                    for (double v : {q, h, g.speed[0], g.speed[1], g.speed[2], g.altitude[0], g.altitude[1],
+                                     g.altitude[2]})
+                        w.f64(v);
+                }
+        }
+
+        w.f64(p.dt);
+        w.u32(static_cast<uint32_t>(p.integrator));
+        w.u32(static_cast<uint32_t>(p.math_tier));
+        for (double v : {p.wind.steady.x, p.wind.steady.y, p.wind.turbulence_offset})
+            w.f64(v);
+        w.u8(p.wind.turbulence ? 1 : 0);
+        if (p.wind.turbulence)
+        {
+            const TurbulenceField &field = *p.wind.turbulence;
+            const DrydenParameters &dryden = field.parameters();
+            for (double v : {dryden.sigma_u, dryden.sigma_w, dryden.length_u, dryden.length_w, field.spacing()})
+                w.f64(v);
+            w.u64(field.seed());
+            w.u64(field.samples());
+        }
+        w.u64(p.wind.gusts.size());
+        for (const DiscreteGust &gust : p.wind.gusts)
+            for (double v : {gust.start, gust.duration, gust.amplitude.x, gust.amplitude.y})
+                w.f64(v);
+        w.u8(p.atmosphere ? 1 : 0);
+        if (p.atmosphere)
+        {
+            const AtmosphereProfile &profile = *p.atmosphere;
+            w.u64(profile.tableSize());
+            const double last = static_cast<double>(profile.tableSize() - 1);
+            for (size_t i = 0; i < profile.tableSize(); i++)
+            {
+                double h = profile.minAltitude() +
+                           (profile.maxAltitude() - profile.minAltitude()) * static_cast<double>(i) / last;
+                for (double v : {h, profile.temperature(h), profile.pressure(h)})
+                    w.f64(v);
+            }
+        }
+
+        w.u8(p.autopilot_speed ? 1 : 0);
+        w.u8(p.autopilot_altitude ? 1 : 0);
+        w.u8(p.gain_scheduling ? 1 : 0);
+        for (float v : {p.speed_setpoint, p.pid_kp, p.pid_ki, p.pid_kd, p.altitude_setpoint, p.alt_pid_kp,
+                        p.alt_pid_ki, p.alt_pid_kd})
+            w.f32(v);
+    }
+
+    // Everything a checkpoint's contents depend on: the resolved scenario
+    // (initial state, aircraft and its tables, wind, atmosphere, controller
+    // settings, events, stop conditions and watched events), the dispersion
+    // model and the study options. Only file paths and output settings are
+    // left out, so resuming after editing any of the rest is refused.
+    inline uint64_t studyFingerprint(const Scenario &scenario, const DispersionModel &model,
+                                     const MonteCarloOptions &options)
+    {
+        BinaryWriter w;
+        w.string(scenario.name);
+        w.f64(scenario.duration);
+        const SimulationState &s = scenario.initial;
+        for (double v : {s.position.x, s.position.y, s.velocity.x, s.velocity.y, s.t})
+            w.f64(v);
+        for (float v : {s.throttle, s.elevator, s.pitch_deg, s.pitch_rate, s.alpha_deg})
+            w.f32(v);
+        fingerprintParams(w, s);
+
+        w.u64(scenario.events.size());
+        for (const ScenarioEvent &event : scenario.events)
+        {
+            w.f64(event.time);
+            fingerprintOptional(w, event.throttle);
+            fingerprintOptional(w, event.elevator);
+            fingerprintOptional(w, event.autopilot_speed);
+            fingerprintOptional(w, event.speed_setpoint);
+            fingerprintOptional(w, event.speed_gains);
+            fingerprintOptional(w, event.autopilot_altitude);
+            fingerprintOptional(w, event.altitude_setpoint);
+            fingerprintOptional(w, event.altitude_gains);
+            fingerprintOptional(w, event.gain_scheduling);
+        }
+        const StopConditions &stop = scenario.stop;
+        w.u8(stop.ground_contact ? 1 : 0);
+        for (double v : {stop.min_altitude, stop.max_altitude, stop.min_speed, stop.max_speed})
+            w.f64(v);
+        const EventWatchList &watch = scenario.watch;
+        w.u64(watch.altitudes.size());
+        for (double v : watch.altitudes)
+            w.f64(v);
+        w.u64(watch.speeds.size());
+        for (double v : watch.speeds)
+            w.f64(v);
+        w.f64(watch.stall_alpha_deg);
+        w.u8(watch.captures ? 1 : 0);
+
+        for (double v : {model.mass, model.thrust, model.wing_area, model.cd0, model.cl_alpha, model.altitude,
+                         model.speed, model.pitch_deg, model.steady_wind.x, model.steady_wind.y})
+            w.f64(v);
+        w.u8(model.turbulence_realizations ? 1 : 0);
+        for (uint64_t v : {options.runs, options.seed, uint64_t(options.block), uint64_t(options.wave_blocks),
+                           uint64_t(options.histogram_bins)})
+            w.u64(v);
+        w.f64(options.compression);
+        for (size_t m = 0; m < DispersionMetricCount; m++)
+        {
+            w.f64(options.histogram_min[m]);
+            w.f64(options.histogram_max[m]);
+        }
+        return fnv1a64(w.bytes);
+    }
+}
+
+// Run a Monte Carlo dispersion study of a scenario
+//
+// Runs are split into fixed blocks of options.block runs; each work item
+// flies one block into its own summary (t-digest, moments, histograms).
+// After every wave of blocks the block summaries are merged, in block order,
+// into the total and reused, so memory depends on the wave size and not on
+// the run count. Run i's perturbations are counter-based random numbers of
+// (seed, i) alone and the merge order is fixed, so the summary is the same
+// for any thread count.
+//
+// With a checkpoint file, workers look at the clock every SliceSteps steps;
+// when a checkpoint is due they pause their block and return, and the
+// progress is written: the merged total, each block of the current wave
+// (finished runs as a summary, the run in flight as its state) and where
+// the wave starts. Runs finished before a checkpoint are never flown again,
+// and since blocks still merge in order, a study interrupted and resumed
+// any number of times ends with the same summary as one flown in one go.
+//
+// A progress, if given, counts the runs as jobs (those of a resumed
+// checkpoint as done before) and the steps flown, a slice at a time.
+inline MonteCarloSummary runMonteCarlo(const Scenario &scenario, const DispersionModel &model,
+                                       const MonteCarloOptions &options, ThreadPool &pool,
+                                       BatchProgress *progress = nullptr)
+{
+    using namespace monte_carlo_detail;
+    if (options.block == 0 || options.wave_blocks == 0 || options.histogram_bins == 0)
+        throw std::runtime_error("Monte Carlo block, wave and histogram sizes must be positive");
+    if (options.runs > (uint64_t(1) << 32))
+        throw std::runtime_error("Monte Carlo run ids are 32-bit");
+
+    auto emptySummary = [&](const std::array<Histogram, DispersionMetricCount> &bins)
+    {
+        MonteCarloSummary s;
+        for (size_t m = 0; m < DispersionMetricCount; m++)
+        {
+            s.metrics[m].quantiles = QuantileDigest(options.compression);
+            s.metrics[m].histogram = bins[m];
+        }
+        return s;
+    };
+    auto startRun = [&](uint64_t run)
+    {
+        const uint32_t id = static_cast<uint32_t>(run);
+        return DispersionFlight(scenario, disperseInitialState(scenario, model, options.seed, id), id);
+    };
+
+    const bool checkpointing = !options.checkpoint_file.empty();
+    const uint64_t blocks = (options.runs + options.block - 1) / options.block;
+    const uint64_t fingerprint = studyFingerprint(scenario, model, options);
+    std::array<Histogram, DispersionMetricCount> bins;
+    MonteCarloSummary total;
+    uint64_t waveStart = 0;
+    std::vector<BlockProgress> wave; // Empty between waves
+
+    auto writeCheckpoint = [&]()
+    {
+        BinaryWriter out;
+        out.u32(CheckpointMagic);
+        out.u32(CheckpointVersion);
+        out.u64(fingerprint);
+        for (const Histogram &h : bins)
+        {
+            out.f64(h.low());
+            out.f64(h.high());
+        }
+        total.save(out);
+        out.u64(waveStart);
+        out.u32(static_cast<uint32_t>(wave.size()));
+        for (size_t b = 0; b < wave.size(); b++)
+        {
+            const BlockProgress &p = wave[b];
+            const bool started = p.next > (waveStart + b) * options.block;
+            out.u8(started ? 1 : 0);
+            if (!started)
+                continue;
+            out.u64(p.next);
+            p.summary.save(out);
+            out.u8(p.flight ? 1 : 0);
+            if (p.flight)
+                p.flight->save(out);
+        }
+        writeFileAtomically(options.checkpoint_file, out.bytes);
+    };
+
+    auto readCheckpoint = [&]()
+    {
+        std::vector<uint8_t> bytes = readFileBytes(options.checkpoint_file);
+        BinaryReader in(bytes);
+        if (in.u32() != CheckpointMagic || in.u32() != CheckpointVersion)
+            throw std::runtime_error(options.checkpoint_file.string() + " is not a Monte Carlo checkpoint");
+        if (in.u64() != fingerprint)
+            throw std::runtime_error(options.checkpoint_file.string() + " was written for a different study");
+        for (Histogram &h : bins)
+        {
+            double lo = in.f64();
+            double hi = in.f64();
+            h = Histogram(lo, hi, options.histogram_bins);
+        }
+        total = MonteCarloSummary::load(in);
+        waveStart = in.u64();
+        wave.resize(in.count(1));
+        if (waveStart > blocks || waveStart % options.wave_blocks != 0 ||
+            (!wave.empty() && wave.size() != std::min<uint64_t>(options.wave_blocks, blocks - waveStart)))
+            throw std::runtime_error(options.checkpoint_file.string() + " is corrupt");
+        for (size_t b = 0; b < wave.size(); b++)
+        {
+            BlockProgress &p = wave[b];
+            p.summary = emptySummary(bins);
+            p.next = (waveStart + b) * options.block;
+            if (in.u8() == 0)
+                continue;
+            p.next = in.u64();
+            p.summary = MonteCarloSummary::load(in);
+            if (in.u8() != 0)
+                p.flight.emplace(DispersionFlight::load(scenario, model, options.seed, in));
+        }
+    };
+
+    if (checkpointing && options.resume && std::filesystem::exists(options.checkpoint_file))
+    {
+        readCheckpoint();
+    }
+    else
+    {
+        // Histogram ranges: configured, or from the first block (flown again
+        // below like any other, so the ranges do not depend on scheduling)
+        const uint64_t pilotRuns = std::min<uint64_t>(options.runs, options.block);
+        MonteCarloSummary pilot = emptySummary(bins);
+        bool needPilot = false;
+        for (size_t m = 0; m < DispersionMetricCount; m++)
+            needPilot = needPilot || std::isnan(options.histogram_min[m]) || std::isnan(options.histogram_max[m]);
+        if (needPilot)
+            for (uint64_t run = 0; run < pilotRuns; run++)
+                pilot.add(flyDispersionRun(scenario, disperseInitialState(scenario, model, options.seed,
+                                                                          static_cast<uint32_t>(run))));
+        for (size_t m = 0; m < DispersionMetricCount; m++)
+        {
+            double lo = options.histogram_min[m], hi = options.histogram_max[m];
+            if (std::isnan(lo) || std::isnan(hi))
+            {
+                const RunningStats &s = pilot.metrics[m].stats;
+                double spread = s.count() > 0 ? s.max() - s.min() : 0.0;
+                double margin = spread > 0.0 ? 0.5 * spread : std::max(1.0, 0.1 * std::fabs(s.max()));
+                if (std::isnan(lo))
+                    lo = s.count() > 0 ? s.min() - margin : 0.0;
+                if (std::isnan(hi))
+                    hi = s.count() > 0 ? s.max() + margin : 1.0;
+            }
+            bins[m] = Histogram(lo, hi, options.histogram_bins);
+        }
+        total = emptySummary(bins);
+    }
+    if (progress)
+    {
+        uint64_t done = total.runs;
+        for (const BlockProgress &p : wave)
+            done += p.summary.runs;
+        progress->setJobs(options.runs, done);
+    }
+
+    // Blocks pause once the deadline (s since start) has passed, after at
+    // least one slice each so every pass makes progress
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&]()
+    { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    double nextCheckpoint = options.checkpoint_interval;
+    double deadline = std::min(nextCheckpoint, options.time_limit);
+
+    auto blockEnd = [&](size_t b)
+    { return std::min<uint64_t>(options.runs, (waveStart + b + 1) * options.block); };
+    auto blockDone = [&](size_t b)
+    { return !wave[b].flight && wave[b].next >= blockEnd(b); };
+    auto flyBlock = [&](size_t b)
+    {
+        BlockProgress &p = wave[b];
+        if (progress)
+            progress->beginWork();
+        while (!blockDone(b))
+        {
+            if (!p.flight)
+                p.flight.emplace(startRun(p.next++));
+            const size_t stepsBefore = p.flight->steps();
+            const bool finished =
+                p.flight->advance(checkpointing || progress ? SliceSteps : std::numeric_limits<size_t>::max());
+            if (progress)
+                progress->addSteps(p.flight->steps() - stepsBefore);
+            if (finished)
+            {
+                p.summary.add(p.flight->result());
+                p.flight.reset();
+                if (progress)
+                    progress->addJobs(1);
+            }
+            if (checkpointing && elapsed() >= deadline)
+                break;
+        }
+        if (progress)
+            progress->endWork();
+    };
+
+    for (; waveStart < blocks; waveStart += options.wave_blocks)
+    {
+        const size_t waveSize = static_cast<size_t>(std::min<uint64_t>(options.wave_blocks, blocks - waveStart));
+        if (wave.empty())
+        {
+            wave.resize(waveSize);
+            for (size_t b = 0; b < waveSize; b++)
+            {
+                wave[b].summary = emptySummary(bins);
+                wave[b].next = (waveStart + b) * options.block;
+            }
+        }
+        while (true)
+        {
+            pool.parallelFor(waveSize, 1, [&](size_t begin, size_t end)
+                             {
+                for (size_t b = begin; b < end; b++)
+                    flyBlock(b); });
+            bool done = true;
+            for (size_t b = 0; b < waveSize; b++)
+                done = done && blockDone(b);
+            if (done)
+                break;
+
+            writeCheckpoint();
+            if (elapsed() >= options.time_limit)
+                return total;
+            nextCheckpoint = elapsed() + options.checkpoint_interval;
+            deadline = std::min(nextCheckpoint, options.time_limit);
+        }
+        for (const BlockProgress &p : wave)
+            total.merge(p.summary);
+        wave.clear();
+    }
+    if (checkpointing)
+        writeCheckpoint(); // Complete: resuming returns the total at once
+    return total;
+}
+
+// Quantiles of each metric in the summary CSV
+inline constexpr double SummaryQuantiles[] = {0.01, 0.05, 0.5, 0.95, 0.99};
+
+// Write a finished study's summary CSV (one row per metric) and histogram
+// CSV (one row per bin, outliers as open-ended bins), then remove its
+// checkpoint. A file that cannot be fully written throws with its name and
+// the checkpoint is kept, so a failed write never loses the study.
+inline void completeMonteCarloStudy(const MonteCarloSummary &summary, const std::filesystem::path &summaryFile,
+                                    const std::filesystem::path &histogramFile,
+                                    const std::filesystem::path &checkpointFile)
+{
+    std::ofstream csv(summaryFile, std::ios::out | std::ios::trunc);
+    if (!csv.is_open())
+        throw std::runtime_error("Failed to open output file: " + summaryFile.string());
+    std::ofstream hist(histogramFile, std::ios::out | std::ios::trunc);
+    if (!hist.is_open())
+        throw std::runtime_error("Failed to open output file: " + histogramFile.string());
+    csv << "metric,count,non_finite,mean,stddev,min,p01,p05,p50,p95,p99,max\n" << std::setprecision(10);
+    hist << "metric,low,high,count\n" << std::setprecision(10);
+    for (size_t m = 0; m < DispersionMetricCount; m++)
+    {
+        const MetricSummary &s = summary.metrics[m];
+        const char *name = dispersionMetricName(m);
+        csv << name << "," << s.stats.count() << "," << s.stats.nonFinite() << "," << s.stats.mean() << ","
+            << s.stats.stddev() << "," << s.stats.min();
+        for (double q : SummaryQuantiles)
+            csv << "," << s.quantiles.quantile(q);
+        csv << "," << s.stats.max() << "\n";
+
+        const Histogram &h = s.histogram;
+        hist << name << ",-inf," << h.low() << "," << h.underflow() << "\n";
+        for (size_t b = 0; b < h.bins(); b++)
+            hist << name << "," << h.binLow(b) << "," << h.binHigh(b) << "," << h[b] << "\n";
+        hist << name << "," << h.high() << ",inf," << h.overflow() << "\n";
+    }
+    csv.close();
+    if (!csv)
+        throw std::runtime_error("Failed to write " + summaryFile.string());
+    hist.close();
+    if (!hist)
+        throw std::runtime_error("Failed to write " + histogramFile.string());
+    std::filesystem::remove(checkpointFile);
+}
+
+// Loader for dispersion study files
+//
+// {
+//   "scenario": "../scenarios/power_off_glide.json",  relative to this file
+//   "runs": 10000, "seed": 1,
+//   "aircraft": { "mass": 0.05, "thrust": 0.05, "wing_area": 0.02,
+//                 "cd0": 0.1, "cl_alpha": 0.05 },             relative 1-sigma
+//   "initial": { "altitude": 5, "speed": 1, "pitch_deg": 0.5 }, absolute 1-sigma
+//   "wind": { "steady": [2, 0.5], "turbulence_realizations": true },
+//   "histograms": { "bins": 40, "range": [0, 6000], "final_speed": [10, 40] }
+// }
+//
+// Histogram ranges are keyed by metric name (see dispersionMetricName);
+// metrics without one are binned from the first block of runs.
+struct DispersionStudy
+{
+    Scenario scenario;
+    DispersionModel model;
+    MonteCarloOptions options;
+};
+
+class DispersionLoader
+{
+public:
+    static DispersionStudy loadFromFile(const std::filesystem::path &filepath)
+    {
+        JsonValue root = JsonValue::parseFile(filepath.string());
+        try
+        {
+            return fromJSON(root, filepath.parent_path());
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error(filepath.string() + ": " + e.what());
+        }
+    }
+
+    static DispersionStudy fromJSON(const JsonValue &root, const std::filesystem::path &baseDir)
+    {
+        DispersionStudy study;
+        study.scenario = ScenarioLoader::loadFromFile(baseDir / root["scenario"].asString());
+
+        MonteCarloOptions &o = study.options;
+        double runs = root.numberOr("runs", static_cast<double>(o.runs));
+        if (!(runs >= 1.0))
+            throw std::runtime_error("runs must be at least 1");
+        o.runs = static_cast<uint64_t>(runs);
+        o.seed = static_cast<uint64_t>(root.numberOr("seed", static_cast<double>(o.seed)));
+
+        DispersionModel &m = study.model;
+        if (const JsonValue *aircraft = root.find("aircraft"))
+        {
+            m.mass = aircraft->numberOr("mass", m.mass);
+            m.thrust = aircraft->numberOr("thrust", m.thrust);
+            m.wing_area = aircraft->numberOr("wing_area", m.wing_area);
+            m.cd0 = aircraft->numberOr("cd0", m.cd0);
+            m.cl_alpha = aircraft->numberOr("cl_alpha", m.cl_alpha);
+        }
+        if (const JsonValue *initial = root.find("initial"))
+        {
+            m.altitude = initial->numberOr("altitude", m.altitude);
+            m.speed = initial->numberOr("speed", m.speed);
+            m.pitch_deg = initial->numberOr("pitch_deg", m.pitch_deg);
+        }
+        if (const JsonValue *wind = root.find("wind"))
+        {
+            if (const JsonValue *steady = wind->find("steady"))
+            {
+                if (steady->size() != 2)
+                    throw std::runtime_error("Steady wind dispersion must be [vx, vz]");
+                m.steady_wind = Vec2((*steady)[0].asNumber(), (*steady)[1].asNumber());
+            }
+            m.turbulence_realizations = wind->boolOr("turbulence_realizations", m.turbulence_realizations);
+        }
+        for (double sigma : {m.mass, m.thrust, m.wing_area, m.cd0, m.cl_alpha, m.altitude, m.speed, m.pitch_deg,
+                             m.steady_wind.x, m.steady_wind.y})
+        {
+            if (!(sigma >= 0.0))
+                throw std::runtime_error("Dispersion sigmas must be non-negative");
+        }
+
+        if (const JsonValue *histograms = root.find("histograms"))
+        {
+            double bins = histograms->numberOr("bins", static_cast<double>(o.histogram_bins));
+            if (!(bins >= 1.0))
+                throw std::runtime_error("Histograms need at least one bin");
+            o.histogram_bins = static_cast<size_t>(bins);
+            for (size_t metric = 0; metric < DispersionMetricCount; metric++)
+                if (const JsonValue *range = histograms->find(dispersionMetricName(metric)))
+                    setRange(o, metric, *range);
+        }
+        return study;
+    }
+
+private:
+    static void setRange(MonteCarloOptions &o, size_t metric, const JsonValue &range)
+    {
+        if (range.size() != 2 || !(range[1].asNumber() > range[0].asNumber()))
+            throw std::runtime_error(std::string("Histogram range for ") + dispersionMetricName(metric) +
+                                     " must be [min, max] with max > min");
+        o.histogram_min[metric] = range[0].asNumber();
+        o.histogram_max[metric] = range[1].asNumber();
+    }
+};
@@ -0,0 +1,335 @@
+#pragma once
+
+#include "../simulation/simulation_state.hpp"
+#include "../simulation/flight_events.hpp"
+#include "../aircraft/aircraft_loader.hpp"
+#include "../utils/json_value.hpp"
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Timed change to controls or autopilot, applied at the start of the step
+// nearest its time (the first step with t >= time - dt/2), so a time that
+// falls on a step is never delayed by rounding in the accumulated t and
+// one between steps may apply up to half a step early.
+// Unset fields leave the corresponding state untouched.
+struct ScenarioEvent
+{
+    double time = 0.0;
+    std::optional<float> throttle;
+    std::optional<float> elevator;
+    std::optional<bool> autopilot_speed;
+    std::optional<float> speed_setpoint;
+    std::optional<std::array<float, 3>> speed_gains; // kp, ki, kd
+    std::optional<bool> autopilot_altitude;
+    std::optional<float> altitude_setpoint;
+    std::optional<std::array<float, 3>> altitude_gains;
+    std::optional<bool> gain_scheduling;
+
+    void apply(SimulationState &state) const
+    {
+        if (throttle)
+            state.throttle = *throttle;
+        if (elevator)
+            state.elevator = *elevator;
+        if (autopilot_speed)
+            state.autopilot_speed = *autopilot_speed;
+        if (speed_setpoint)
+            state.speed_setpoint = *speed_setpoint;
+        if (speed_gains)
+        {
+            state.pid_kp = (*speed_gains)[0];
+            state.pid_ki = (*speed_gains)[1];
+            state.pid_kd = (*speed_gains)[2];
+        }
+        if (autopilot_altitude)
+            state.autopilot_altitude = *autopilot_altitude;
+        if (altitude_setpoint)
+            state.altitude_setpoint = *altitude_setpoint;
+        if (altitude_gains)
+        {
+            state.alt_pid_kp = (*altitude_gains)[0];
+            state.alt_pid_ki = (*altitude_gains)[1];
+            state.alt_pid_kd = (*altitude_gains)[2];
+        }
+        if (gain_scheduling)
+            state.gain_scheduling = *gain_scheduling;
+    }
+};
+
+// Conditions that end a run before its duration elapses
+// Limits default to +/- infinity so unused ones never trigger.
+struct StopConditions
+{
+    bool ground_contact = true; // Stop on touchdown after having been airborne
+    double min_altitude = -std::numeric_limits<double>::infinity();
+    double max_altitude = std::numeric_limits<double>::infinity();
+    double min_speed = -std::numeric_limits<double>::infinity();
+    double max_speed = std::numeric_limits<double>::infinity();
+};
+
+// One headless run: initial state, schedule and stop conditions
+struct Scenario
+{
+    std::string name;
+    std::filesystem::path sourceFile;
+    SimulationState initial; // Aircraft, initial kinematics, dt, integrator, math tier
+    double duration = 60.0;
+    double output_interval = 0.1; // Seconds between CSV rows (0 = every step)
+    bool realtime = false; // Pace steps to the wall clock (external control in the loop)
+    std::vector<ScenarioEvent> events; // Sorted by time
+    StopConditions stop;
+    EventWatchList watch; // Events reported besides the stop conditions
+};
+
+// Loader for JSON scenario files
+//
+// {
+//   "name": "climb",                      optional, defaults to the file stem
+//   "aircraft": "../aircraft_config.json", relative to the scenario file, or "default"
+//   "initial": { "x": 0, "altitude": 100, "vx": 30, "vz": 0,
+//                "pitch_deg": 2, "pitch_rate": 0, "throttle": 0.5, "elevator": 0 },
+//   "duration": 120, "dt": 0.01, "output_interval": 0.1, "realtime": false,
+//   "integrator": "rk4" | "euler", "math": "exact" | "fast",
+//   "atmosphere": { "temperature_offset": 20, "sea_level_pressure": 101325 }
+//               | { "file": "../atmosphere_sounding.csv" },
+//   "wind": { "steady": [vx, vz], "seed": 1, "offset": 0,
+//             "turbulence": "light" | "moderate" | "severe"
+//                         | { "sigma_u": 2, "sigma_w": 2, "length_u": 533, "length_w": 533 },
+//             "gusts": [ { "t": 20, "duration": 2, "horizontal": 0, "vertical": 5 } ] },
+//   "controls":  [ { "t": 10, "throttle": 0.8, "elevator": 0.1 } ],
+//   "autopilot": [ { "t": 0, "speed": 30, "altitude": 150,
+//                    "speed_pid": [kp, ki, kd], "altitude_pid": [kp, ki, kd],
+//                    "gain_scheduling": true },
+//                  { "t": 60, "altitude": false } ],
+//   "stop": { "ground_contact": true, "min_altitude": 0, "max_altitude": 500,
+//             "min_speed": 5, "max_speed": 80 },
+//   "detect": { "altitudes": [50, 150], "speeds": [30], "stall_alpha_deg": 14,
+//               "captures": true }
+// }
+//
+// An autopilot "speed"/"altitude" number engages that loop at the setpoint,
+// false disengages it. Fixed "*_pid" gains only apply while gain scheduling
+// is off or the aircraft has no schedule. Wind velocities are in the world
+// frame (x forward, z up); the turbulence "seed" and "offset" (m into the
+// field) select the realization. Without "atmosphere" the run uses standard
+// ISA; sounding files are relative to the scenario file. "detect" lists
+// events to locate and report besides the stop conditions: altitude and
+// ground speed crossings, the stall angle of attack (the aircraft model has
+// none of its own) and autopilot setpoint captures.
+class ScenarioLoader
+{
+public:
+    static Scenario loadFromFile(const std::filesystem::path &filepath)
+    {
+        JsonValue root = JsonValue::parseFile(filepath.string());
+        try
+        {
+            Scenario scenario = fromJSON(root, filepath.parent_path(), filepath.stem().string());
+            scenario.sourceFile = filepath;
+            return scenario;
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error(filepath.string() + ": " + e.what());
+        }
+    }
+
+    // baseDir resolves relative aircraft paths; defaultName is used if "name" is absent
+    static Scenario fromJSON(const JsonValue &root, const std::filesystem::path &baseDir, const std::string &defaultName)
+    {
+        Scenario scenario;
+        scenario.name = root.stringOr("name", defaultName);
+
+        SimulationState &state = scenario.initial;
+        std::string aircraftFile = root.stringOr("aircraft", "default");
+        if (aircraftFile != "default")
+            state.aircraft = AircraftLoader::loadFromJSON((baseDir / aircraftFile).string());
+
+        if (const JsonValue *initial = root.find("initial"))
+        {
+            state.position = Vec2(initial->numberOr("x", 0.0), initial->numberOr("altitude", 0.0));
+            state.velocity = Vec2(initial->numberOr("vx", 0.0), initial->numberOr("vz", 0.0));
+            state.pitch_deg = static_cast<float>(initial->numberOr("pitch_deg", 0.0));
+            state.pitch_rate = static_cast<float>(initial->numberOr("pitch_rate", 0.0));
+            state.throttle = static_cast<float>(initial->numberOr("throttle", 0.0));
+            state.elevator = static_cast<float>(initial->numberOr("elevator", 0.0));
+        }
+
+        scenario.duration = root.numberOr("duration", scenario.duration);
+        state.dt = root.numberOr("dt", 0.01);
+        scenario.output_interval = root.numberOr("output_interval", scenario.output_interval);
+        scenario.realtime = root.boolOr("realtime", false);
+        if (!(scenario.duration > 0.0) || !(state.dt > 0.0) || scenario.output_interval < 0.0)
+            throw std::runtime_error("duration and dt must be positive, output_interval non-negative");
+
+        std::string integrator = root.stringOr("integrator", "rk4");
+        if (integrator == "rk4")
+            state.integrator = IntegratorType::RK4;
+        else if (integrator == "euler")
+            state.integrator = IntegratorType::SemiImplicitEuler;
+        else
+            throw std::runtime_error("Unknown integrator: " + integrator);
+
+        std::string math = root.stringOr("math", "exact");
+        if (math == "exact")
+            state.math_tier = MathTier::Exact;
+        else if (math == "fast")
+            state.math_tier = MathTier::Fast;
+        else
+            throw std::runtime_error("Unknown math tier: " + math);
+
+        if (const JsonValue *atmosphere = root.find("atmosphere"))
+            state.atmosphere = parseAtmosphere(*atmosphere, baseDir);
+
+        if (const JsonValue *wind = root.find("wind"))
+            state.wind = parseWind(*wind);
+
+        if (const JsonValue *controls = root.find("controls"))
+        {
+            for (const JsonValue &entry : controls->elements())
+            {
+                ScenarioEvent event;
+                event.time = entry["t"].asNumber();
+                if (const JsonValue *v = entry.find("throttle"))
+                    event.throttle = static_cast<float>(v->asNumber());
+                if (const JsonValue *v = entry.find("elevator"))
+                    event.elevator = static_cast<float>(v->asNumber());
+                scenario.events.push_back(event);
+            }
+        }
+
+        if (const JsonValue *autopilot = root.find("autopilot"))
+        {
+            for (const JsonValue &entry : autopilot->elements())
+            {
+                ScenarioEvent event;
+                event.time = entry["t"].asNumber();
+                parseLoop(entry, "speed", event.autopilot_speed, event.speed_setpoint);
+                parseLoop(entry, "altitude", event.autopilot_altitude, event.altitude_setpoint);
+                if (const JsonValue *v = entry.find("speed_pid"))
+                    event.speed_gains = parseGains(*v);
+                if (const JsonValue *v = entry.find("altitude_pid"))
+                    event.altitude_gains = parseGains(*v);
+                if (const JsonValue *v = entry.find("gain_scheduling"))
+                    event.gain_scheduling = v->asBool();
+                scenario.events.push_back(event);
+            }
+        }
+
+        // Stable so that controls and autopilot entries at the same time keep file order
+        std::stable_sort(scenario.events.begin(), scenario.events.end(),
+                         [](const ScenarioEvent &a, const ScenarioEvent &b)
+                         { return a.time < b.time; });
+
+        if (const JsonValue *stop = root.find("stop"))
+        {
+            StopConditions &s = scenario.stop;
+            s.ground_contact = stop->boolOr("ground_contact", s.ground_contact);
+            s.min_altitude = stop->numberOr("min_altitude", s.min_altitude);
+            s.max_altitude = stop->numberOr("max_altitude", s.max_altitude);
+            s.min_speed = stop->numberOr("min_speed", s.min_speed);
+            s.max_speed = stop->numberOr("max_speed", s.max_speed);
+        }
+
+        if (const JsonValue *detect = root.find("detect"))
+        {
+            EventWatchList &w = scenario.watch;
+            if (const JsonValue *v = detect->find("altitudes"))
+                for (const JsonValue &h : v->elements())
+                    w.altitudes.push_back(h.asNumber());
+            if (const JsonValue *v = detect->find("speeds"))
+                for (const JsonValue &speed : v->elements())
+                    w.speeds.push_back(speed.asNumber());
+            w.stall_alpha_deg = detect->numberOr("stall_alpha_deg", w.stall_alpha_deg);
+            w.captures = detect->boolOr("captures", w.captures);
+        }
+
+        return scenario;
+    }
+
+private:
+    static void parseLoop(const JsonValue &entry, const std::string &key,
+                          std::optional<bool> &engaged, std::optional<float> &setpoint)
+    {
+        const JsonValue *v = entry.find(key);
+        if (!v)
+            return;
+        if (v->isBool())
+        {
+            engaged = v->asBool();
+        }
+        else
+        {
+            engaged = true;
+            setpoint = static_cast<float>(v->asNumber());
+        }
+    }
+
+    static std::shared_ptr<const AtmosphereProfile> parseAtmosphere(const JsonValue &value, const std::filesystem::path &baseDir)
+    {
+        if (const JsonValue *file = value.find("file"))
+            return std::make_shared<const AtmosphereProfile>(AtmosphereProfile::loadFromCSV((baseDir / file->asString()).string()));
+        return std::make_shared<const AtmosphereProfile>(AtmosphereProfile::isaDeviation(
+            value.numberOr("temperature_offset", 0.0), value.numberOr("sea_level_pressure", p0)));
+    }
+
+    static WindModel parseWind(const JsonValue &value)
+    {
+        WindModel wind;
+        if (const JsonValue *steady = value.find("steady"))
+        {
+            if (steady->size() != 2)
+                throw std::runtime_error("Steady wind must be [vx, vz]");
+            wind.steady = Vec2((*steady)[0].asNumber(), (*steady)[1].asNumber());
+        }
+
+        if (const JsonValue *turbulence = value.find("turbulence"))
+        {
+            DrydenParameters dryden;
+            if (turbulence->isString())
+            {
+                dryden = DrydenParameters::preset(turbulence->asString());
+            }
+            else
+            {
+                dryden.sigma_u = turbulence->numberOr("sigma_u", 0.0);
+                dryden.sigma_w = turbulence->numberOr("sigma_w", 0.0);
+                dryden.length_u = turbulence->numberOr("length_u", dryden.length_u);
+                dryden.length_w = turbulence->numberOr("length_w", dryden.length_w);
+            }
+            uint64_t seed = static_cast<uint64_t>(value.numberOr("seed", 1.0));
+            wind.turbulence = std::make_shared<const TurbulenceField>(dryden, seed);
+            wind.turbulence_offset = value.numberOr("offset", 0.0);
+        }
+
+        if (const JsonValue *gusts = value.find("gusts"))
+        {
+            for (const JsonValue &entry : gusts->elements())
+            {
+                DiscreteGust gust;
+                gust.start = entry["t"].asNumber();
+                gust.duration = entry.numberOr("duration", gust.duration);
+                gust.amplitude = Vec2(entry.numberOr("horizontal", 0.0), entry.numberOr("vertical", 0.0));
+                if (!(gust.duration > 0.0))
+                    throw std::runtime_error("Gust duration must be positive");
+                wind.gusts.push_back(gust);
+            }
+        }
+        return wind;
+    }
+
+    static std::array<float, 3> parseGains(const JsonValue &value)
+    {
+        if (value.size() != 3)
+            throw std::runtime_error("PID gains must be [kp, ki, kd]");
+        return {static_cast<float>(value[0].asNumber()),
+                static_cast<float>(value[1].asNumber()),
+                static_cast<float>(value[2].asNumber())};
+    }
+};
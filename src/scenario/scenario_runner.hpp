@@ -0,0 +1,337 @@
+#pragma once
+
+#include "scenario.hpp"
+#include "../simulation/physics_update.hpp"
+#include "../simulation/flight_events.hpp"
+#include "../core/thread_pool.hpp"
+#include "../core/batch_progress.hpp"
+#include "../telemetry/telemetry_hub.hpp"
+#include "../telemetry/trajectory_codec.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Placeholder external control for runs without one (see runScenario)
+struct NoExternalControl
+{
+    bool applyCommands(SimulationState &) { return false; }
+    void publish(const SimulationState &) {}
+};
+
+// Outcome of one headless run
+struct ScenarioResult
+{
+    std::string name;
+    std::filesystem::path outputFile;
+    std::filesystem::path eventsFile; // Empty if no events occurred
+    size_t steps = 0;
+    size_t rows = 0;
+    double sim_time = 0.0;
+    double wall_seconds = 0.0;
+    std::string stop_reason; // "duration", "ground_contact", "min_altitude", ...
+    std::string error;       // Non-empty if the run failed
+    std::vector<FlightEvent> events; // Located events in time order; a stop is the last one
+
+    bool ok() const { return error.empty(); }
+    double stepsPerSecond() const { return wall_seconds > 0.0 ? steps / wall_seconds : 0.0; }
+};
+
+// Buffered CSV writer for trajectory rows
+// Rows are formatted into a fixed line buffer and handed to a stream with a
+// large buffer, so disk writes happen in big blocks off the per-step path.
+class TrajectoryCsvWriter
+{
+public:
+    explicit TrajectoryCsvWriter(const std::filesystem::path &filepath)
+        : buffer(1 << 20)
+    {
+        file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.open(filepath, std::ios::out | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open output file: " + filepath.string());
+        file << "t,x,altitude,vx,vz,speed,pitch_deg,alpha_deg,throttle,elevator\n";
+    }
+
+    void write(const SimulationState &state)
+    {
+        char line[256];
+        int len = std::snprintf(line, sizeof(line), "%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.3f,%.3f,%.4f,%.4f\n",
+                                state.t, state.position.x, state.position.y,
+                                state.velocity.x, state.velocity.y, state.velocity.magnitude(),
+                                state.pitch_deg, state.alpha_deg, state.throttle, state.elevator);
+        file.write(line, len);
+    }
+
+private:
+    std::vector<char> buffer; // Declared first: must outlive the stream
+    std::ofstream file;
+};
+
+// Channels of a compressed trajectory: the CSV columns, each kept to within
+// half a unit in the last digit the CSV prints
+inline std::vector<TrajectoryChannel> trajectoryChannels()
+{
+    return {{"t", 5e-5}, {"x", 5e-5}, {"altitude", 5e-5}, {"vx", 5e-5}, {"vz", 5e-5}, {"speed", 5e-5},
+            {"pitch_deg", 5e-4}, {"alpha_deg", 5e-4}, {"throttle", 5e-5}, {"elevator", 5e-5}};
+}
+
+// Trajectory rows to a CSV file, or to a compressed archive if the file
+// name ends in .trj (see trajectory_codec.hpp)
+class TrajectoryWriter
+{
+public:
+    explicit TrajectoryWriter(const std::filesystem::path &filepath)
+    {
+        if (filepath.extension() == ".trj")
+            archive.emplace(filepath, trajectoryChannels());
+        else
+            csv.emplace(filepath);
+    }
+
+    void write(const SimulationState &state)
+    {
+        if (csv)
+        {
+            csv->write(state);
+            return;
+        }
+        const double row[] = {state.t, state.position.x, state.position.y, state.velocity.x, state.velocity.y,
+                              state.velocity.magnitude(), state.pitch_deg, state.alpha_deg, state.throttle,
+                              state.elevator};
+        archive->append(row);
+    }
+
+    // Complete the file (an archive writes its index)
+    void close()
+    {
+        if (archive)
+            archive->close();
+    }
+
+private:
+    std::optional<TrajectoryCsvWriter> csv;
+    std::optional<TrajectoryArchiveWriter> archive;
+};
+
+// Events of a run as CSV: one row per event with the interpolated state
+inline void writeEventsCsv(const std::filesystem::path &filepath, const std::vector<FlightEvent> &events)
+{
+    std::ofstream file(filepath, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open events file: " + filepath.string());
+    file << "t,event,threshold,direction,x,altitude,vx,vz,speed,pitch_deg,alpha_deg\n";
+    for (const FlightEvent &e : events)
+    {
+        char line[256];
+        int len = std::snprintf(line, sizeof(line), "%.6f,%s,%.4f,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.3f,%.3f\n",
+                                e.state.t, e.name, e.threshold, e.direction,
+                                e.state.position.x, e.state.position.y, e.state.velocity.x, e.state.velocity.y,
+                                e.state.velocity.magnitude(), e.state.pitch_deg, e.state.alpha_deg);
+        file.write(line, len);
+    }
+}
+
+// Path of the events file next to a trajectory: <stem>.events.csv
+inline std::filesystem::path eventsFileFor(const std::filesystem::path &outputFile)
+{
+    std::filesystem::path path = outputFile;
+    return path.replace_extension(".events.csv");
+}
+
+// Run one scenario to completion, streaming rows to outputFile (CSV, or a
+// compressed archive for a .trj file)
+// The step specialization is selected once and re-selected only when a
+// scheduled event changes the configuration. If a telemetry hub is given,
+// every step is also published to it from the calling thread. An external
+// control (e.g. ShmControlServer) gets applyCommands() before and publish()
+// after every step. Steps are also counted into a batch's progress, if
+// given, a thousand or so at a time.
+//
+// Stop conditions and the scenario's watch list are located within each
+// step (see FlightEventDetector): a run that stops ends on the interpolated
+// state at the event, not at the end of the step that crossed it. Events
+// are returned in the result and written next to the trajectory as
+// <stem>.events.csv.
+template <typename ExternalControl = NoExternalControl>
+inline ScenarioResult runScenario(const Scenario &scenario, const std::filesystem::path &outputFile,
+                                  TelemetryHub *telemetry = nullptr, ExternalControl *control = nullptr,
+                                  BatchProgress *progress = nullptr)
+{
+    ScenarioResult result;
+    result.name = scenario.name;
+    result.outputFile = outputFile;
+
+    SimulationState state = scenario.initial;
+    state.maxPathPoints = 0; // No trail needed, the output file is the record
+    state.flightPath.clear();
+
+    TrajectoryWriter trajectory(outputFile);
+
+    const double dt = state.dt;
+    const size_t totalSteps = static_cast<size_t>(std::ceil(scenario.duration / dt - 1e-9));
+    const size_t stride = std::max<size_t>(1, static_cast<size_t>(std::llround(scenario.output_interval / dt)));
+    const StopConditions &stop = scenario.stop;
+
+    FlightEventDetector detector;
+    detector.watchGroundContact(stop.ground_contact);
+    detector.watchLimit("min_altitude", true, stop.min_altitude, false);
+    detector.watchLimit("max_altitude", true, stop.max_altitude, true);
+    detector.watchLimit("min_speed", false, stop.min_speed, false);
+    detector.watchLimit("max_speed", false, stop.max_speed, true);
+    detector.watch(scenario.watch);
+
+    size_t nextEvent = 0;
+    bool lastRowWritten = false;
+    PhysicsStepFn step = nullptr;
+    size_t stepsReported = 0;
+
+    trajectory.write(state);
+    result.rows++;
+    result.stop_reason = "duration";
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < totalSteps; i++)
+    {
+        // Events fire at the step nearest their scheduled time
+        if (nextEvent < scenario.events.size() && scenario.events[nextEvent].time <= state.t + 0.5 * dt)
+        {
+            while (nextEvent < scenario.events.size() && scenario.events[nextEvent].time <= state.t + 0.5 * dt)
+                scenario.events[nextEvent++].apply(state);
+            step = nullptr;
+        }
+        if (!step)
+        {
+            syncControllerGains(state);
+            step = selectPhysicsStep(state);
+        }
+
+        if (control)
+            control->applyCommands(state);
+        const FlightState before = state;
+        step(state);
+        result.steps++;
+        if (progress && result.steps - stepsReported >= 1024)
+        {
+            progress->addSteps(result.steps - stepsReported);
+            stepsReported = result.steps;
+        }
+        if (telemetry)
+            telemetry->publish(makeTelemetryRecord(state));
+        if (control)
+            control->publish(state);
+        if (scenario.realtime)
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                      std::chrono::duration<double>(state.t - scenario.initial.t)));
+
+        // A stop ends the run on the state at the event
+        if (const FlightEvent *terminal = detector.detect(before, state, result.events))
+        {
+            static_cast<FlightState &>(state) = terminal->state;
+            result.stop_reason = terminal->name;
+            lastRowWritten = false;
+            break;
+        }
+
+        lastRowWritten = (result.steps % stride) == 0;
+        if (lastRowWritten)
+        {
+            trajectory.write(state);
+            result.rows++;
+        }
+    }
+    result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (progress)
+        progress->addSteps(result.steps - stepsReported);
+
+    // Always record the final state
+    if (!lastRowWritten && result.steps > 0)
+    {
+        trajectory.write(state);
+        result.rows++;
+    }
+    trajectory.close();
+    result.sim_time = state.t;
+
+    if (!result.events.empty())
+    {
+        result.eventsFile = eventsFileFor(outputFile);
+        writeEventsCsv(result.eventsFile, result.events);
+    }
+    else
+    {
+        std::error_code ignored; // No stale events from an earlier run
+        std::filesystem::remove(eventsFileFor(outputFile), ignored);
+    }
+    return result;
+}
+
+// Load and run a batch of scenario files in parallel, one file per task
+// Each result lands in outputDir/<file stem><extension> (.csv, or .trj for
+// compressed archives). Load or run errors are reported in the result
+// instead of aborting the other runs. A progress, if given, counts the
+// files as jobs (failed ones included) and the steps flown.
+inline std::vector<ScenarioResult> runScenarioFiles(const std::vector<std::filesystem::path> &files,
+                                                    const std::filesystem::path &outputDir,
+                                                    ThreadPool &pool, const std::string &extension = ".csv",
+                                                    BatchProgress *progress = nullptr)
+{
+    std::filesystem::create_directories(outputDir);
+    if (progress)
+        progress->setJobs(files.size());
+
+    std::vector<ScenarioResult> results(files.size());
+    pool.parallelFor(files.size(), 1, [&](size_t begin, size_t end)
+                     {
+        for (size_t i = begin; i < end; i++)
+        {
+            std::filesystem::path outputFile = outputDir / (files[i].stem().string() + extension);
+            if (progress)
+                progress->beginWork();
+            try
+            {
+                results[i] = runScenario<NoExternalControl>(ScenarioLoader::loadFromFile(files[i]), outputFile,
+                                                            nullptr, nullptr, progress);
+            }
+            catch (const std::exception &e)
+            {
+                results[i].name = files[i].stem().string();
+                results[i].error = e.what();
+            }
+            if (progress)
+            {
+                progress->endWork();
+                progress->addJobs(1);
+            }
+        } });
+    return results;
+}
+
+// Collect *.json scenario files: the path itself, or every file in a directory (sorted)
+inline std::vector<std::filesystem::path> findScenarioFiles(const std::filesystem::path &path)
+{
+    std::vector<std::filesystem::path> files;
+    if (std::filesystem::is_directory(path))
+    {
+        for (const auto &entry : std::filesystem::directory_iterator(path))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".json")
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+    }
+    else if (std::filesystem::exists(path))
+    {
+        files.push_back(path);
+    }
+    else
+    {
+        throw std::runtime_error("Scenario path not found: " + path.string());
+    }
+    return files;
+}
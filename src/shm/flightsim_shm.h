@@ -0,0 +1,140 @@
+/*
+ * Shared-memory layout for external control of a running simulation
+ *
+ * Plain C so the same header serves the C++ simulator and C clients.
+ * POSIX only; the atomics use GCC/Clang __atomic builtins.
+ *
+ * The segment holds two single-writer seqlocks:
+ *   state    written by the simulator after every step, read by clients
+ *   command  written by the controlling client, read by the simulator
+ *
+ * A seqlock reader never blocks the writer: it copies the payload and retries
+ * if the sequence was odd (write in progress) or changed during the copy.
+ * Payloads are copied as 64-bit words with relaxed atomics, so a torn copy is
+ * detected rather than being a data race.
+ */
+#ifndef FLIGHTSIM_SHM_H
+#define FLIGHTSIM_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FSIM_SHM_MAGIC 0x4D534446u /* "FDSM" */
+#define FSIM_SHM_VERSION 1u
+#define FSIM_SHM_DEFAULT_NAME "/flightsim"
+
+/* Command flags: which fields of a command are valid */
+#define FSIM_CMD_THROTTLE 1u
+#define FSIM_CMD_ELEVATOR 2u
+
+/* State published by the simulator (all 64-bit fields) */
+typedef struct fsim_shm_state
+{
+    double t;          /* Simulation time (s) */
+    double x;          /* Horizontal position (m) */
+    double altitude;   /* m */
+    double vx;         /* m/s */
+    double vz;         /* m/s */
+    double pitch_deg;
+    double pitch_rate; /* deg/s */
+    double alpha_deg;
+    double throttle;   /* Control inputs in effect for this step */
+    double elevator;
+    uint64_t step;               /* Steps published since the segment was created */
+    uint64_t command_id;         /* Last command applied (0 = none) */
+    int64_t command_sent_ns;     /* Its client timestamp (CLOCK_MONOTONIC) */
+    int64_t command_applied_ns;  /* When the simulator applied it (CLOCK_MONOTONIC) */
+} fsim_shm_state;
+
+/* Command written by the client; the simulator applies each new id once */
+typedef struct fsim_shm_command
+{
+    uint64_t id;      /* Increases with every command, 0 = none yet */
+    uint32_t flags;   /* FSIM_CMD_* */
+    float throttle;   /* 0..1 */
+    float elevator;   /* -1..1 */
+    uint32_t reserved;
+    int64_t sent_ns;  /* Client timestamp (CLOCK_MONOTONIC) */
+} fsim_shm_command;
+
+#define FSIM_ALIGN64 __attribute__((aligned(64)))
+
+/* The whole segment; each seqlock sits on its own cache line */
+typedef struct fsim_shm_segment
+{
+    uint32_t magic; /* Stored last by the creator, once the segment is initialized */
+    uint32_t version;
+    uint32_t size;
+    uint32_t sim_pid;
+
+    FSIM_ALIGN64 uint64_t state_seq;
+    fsim_shm_state state;
+
+    FSIM_ALIGN64 uint64_t command_seq;
+    fsim_shm_command command;
+} fsim_shm_segment;
+
+/* Monotonic clock shared by all processes on the host */
+static inline int64_t fsim_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Seqlock write (single writer). Claims the sequence with a CAS so an
+   accidental second writer spins instead of corrupting the payload. */
+static inline void fsim_seqlock_write(uint64_t *seq, void *dst, const void *src, size_t bytes)
+{
+    uint64_t *out = (uint64_t *)dst;
+    const uint64_t *in = (const uint64_t *)src;
+    size_t words = bytes / sizeof(uint64_t);
+    size_t i;
+    uint64_t s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        if ((s & 1u) == 0u &&
+            __atomic_compare_exchange_n(seq, &s, s + 1u, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+        s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (i = 0; i < words; i++)
+        __atomic_store_n(&out[i], in[i], __ATOMIC_RELAXED);
+    __atomic_store_n(seq, s + 2u, __ATOMIC_RELEASE);
+}
+
+/* Seqlock read. Returns 1 with a consistent copy in dst, or 0 if no
+   consistent copy was obtained within maxTries attempts. */
+static inline int fsim_seqlock_read(const uint64_t *seq, const void *src, void *dst, size_t bytes, int maxTries)
+{
+    const uint64_t *in = (const uint64_t *)src;
+    uint64_t *out = (uint64_t *)dst;
+    size_t words = bytes / sizeof(uint64_t);
+    size_t i;
+    int attempt;
+    for (attempt = 0; attempt < maxTries; attempt++)
+    {
+        uint64_t s1 = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1u)
+            continue;
+        for (i = 0; i < words; i++)
+            out[i] = __atomic_load_n(&in[i], __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(seq, __ATOMIC_RELAXED) == s1)
+            return 1;
+    }
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLIGHTSIM_SHM_H */
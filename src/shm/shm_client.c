@@ -0,0 +1,100 @@
+/* Minimal C client for the shared-memory control interface (see shm_client.h) */
+#define _POSIX_C_SOURCE 200809L
+
+#include "shm_client.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct fsim_client
+{
+    fsim_shm_segment *segment;
+    uint64_t next_id;
+};
+
+fsim_client *fsim_client_open(const char *name)
+{
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(fsim_shm_segment))
+    {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    void *mem = mmap(NULL, sizeof(fsim_shm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+        return NULL;
+
+    fsim_shm_segment *segment = (fsim_shm_segment *)mem;
+    if (__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != FSIM_SHM_MAGIC ||
+        segment->version != FSIM_SHM_VERSION || segment->size != sizeof(fsim_shm_segment))
+    {
+        munmap(mem, sizeof(fsim_shm_segment));
+        errno = EPROTO;
+        return NULL;
+    }
+
+    fsim_client *client = (fsim_client *)malloc(sizeof(fsim_client));
+    if (!client)
+    {
+        munmap(mem, sizeof(fsim_shm_segment));
+        return NULL;
+    }
+    client->segment = segment;
+
+    /* Continue numbering after whatever a previous client sent */
+    fsim_shm_command last;
+    client->next_id = 1;
+    if (fsim_seqlock_read(&segment->command_seq, &segment->command, &last, sizeof(last), 1000))
+        client->next_id = last.id + 1;
+    return client;
+}
+
+void fsim_client_close(fsim_client *client)
+{
+    if (!client)
+        return;
+    munmap(client->segment, sizeof(fsim_shm_segment));
+    free(client);
+}
+
+int fsim_client_read_state(fsim_client *client, fsim_shm_state *out)
+{
+    return fsim_seqlock_read(&client->segment->state_seq, &client->segment->state, out, sizeof(*out), 1000);
+}
+
+uint64_t fsim_client_send(fsim_client *client, uint32_t flags, float throttle, float elevator)
+{
+    fsim_shm_command command;
+    command.id = client->next_id++;
+    command.flags = flags;
+    command.throttle = throttle;
+    command.elevator = elevator;
+    command.reserved = 0;
+    command.sent_ns = fsim_now_ns();
+    fsim_seqlock_write(&client->segment->command_seq, &client->segment->command, &command, sizeof(command));
+    return command.id;
+}
+
+int fsim_client_wait_applied(fsim_client *client, uint64_t id, int64_t timeout_ns, fsim_shm_state *out)
+{
+    int64_t deadline = fsim_now_ns() + timeout_ns;
+    do
+    {
+        if (fsim_client_read_state(client, out) && out->command_id >= id)
+            return 1;
+        sched_yield(); /* Let the simulator run if it shares this core */
+    } while (fsim_now_ns() < deadline);
+    return 0;
+}
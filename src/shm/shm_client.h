@@ -0,0 +1,45 @@
+/*
+ * Minimal C client for the simulator's shared-memory control interface
+ *
+ *   fsim_client *c = fsim_client_open("/flightsim");
+ *   fsim_shm_state s;
+ *   if (fsim_client_read_state(c, &s))
+ *       fsim_client_send(c, FSIM_CMD_THROTTLE, 0.8f, 0.0f);
+ *   fsim_client_close(c);
+ *
+ * Only one client should send commands at a time; any number may read state.
+ */
+#ifndef FLIGHTSIM_SHM_CLIENT_H
+#define FLIGHTSIM_SHM_CLIENT_H
+
+#include "flightsim_shm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct fsim_client fsim_client;
+
+/* Map a segment created by the simulator. Returns NULL (with errno set) if it
+   does not exist or has an unexpected layout. */
+fsim_client *fsim_client_open(const char *name);
+void fsim_client_close(fsim_client *client);
+
+/* Copy the latest published state. Returns 1 on success, 0 if the simulator
+   kept writing through every retry (practically never). */
+int fsim_client_read_state(fsim_client *client, fsim_shm_state *out);
+
+/* Post a command (flags select which fields apply). Returns its id; the
+   simulator echoes it in fsim_shm_state.command_id once applied. */
+uint64_t fsim_client_send(fsim_client *client, uint32_t flags, float throttle, float elevator);
+
+/* Poll (yielding) until the simulator has applied command id, up to timeout_ns.
+   Returns 1 and fills out with the first state showing it, 0 on timeout. */
+int fsim_client_wait_applied(fsim_client *client, uint64_t id, int64_t timeout_ns, fsim_shm_state *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLIGHTSIM_SHM_CLIENT_H */
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "flightsim_shm.h"
+#include "../simulation/simulation_state.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(fsim_shm_state) % sizeof(uint64_t) == 0, "seqlock payloads are copied in 64-bit words");
+static_assert(sizeof(fsim_shm_command) % sizeof(uint64_t) == 0, "seqlock payloads are copied in 64-bit words");
+
+// Simulator side of the shared-memory control interface (POSIX only)
+//
+// Creates the segment, publishes state through its seqlock after every step,
+// and takes throttle/elevator from the command mailbox before every step.
+// Neither call blocks: a command that is mid-write is picked up next step.
+// The segment is unlinked when the server is destroyed. A segment of the
+// same name left by a simulator that is no longer running is replaced; one
+// whose simulator is still alive, or that is not a simulator segment at all,
+// is left alone and the constructor throws.
+//
+// Typical loop:
+//   control.applyCommands(state);
+//   step(state);
+//   control.publish(state);
+class ShmControlServer
+{
+public:
+    explicit ShmControlServer(const std::string &name = FSIM_SHM_DEFAULT_NAME)
+        : name(name)
+    {
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0 && errno == EEXIST)
+        {
+            removeStaleSegment(name); // Throws if the segment is in use
+            fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        }
+        if (fd < 0)
+            throw std::runtime_error("Failed to create shared memory " + name + ": " + std::strerror(errno));
+        if (::ftruncate(fd, sizeof(fsim_shm_segment)) != 0)
+        {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Failed to size shared memory " + name);
+        }
+        void *mem = ::mmap(nullptr, sizeof(fsim_shm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED)
+        {
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Failed to map shared memory " + name);
+        }
+
+        segment = new (mem) fsim_shm_segment{};
+        segment->version = FSIM_SHM_VERSION;
+        segment->size = sizeof(fsim_shm_segment);
+        segment->sim_pid = static_cast<uint32_t>(::getpid());
+        __atomic_store_n(&segment->magic, FSIM_SHM_MAGIC, __ATOMIC_RELEASE);
+    }
+
+    ShmControlServer(const ShmControlServer &) = delete;
+    ShmControlServer &operator=(const ShmControlServer &) = delete;
+
+    ~ShmControlServer()
+    {
+        ::munmap(segment, sizeof(fsim_shm_segment));
+        ::shm_unlink(name.c_str());
+    }
+
+    // Apply the latest command if it is new; returns true if one was applied
+    // (its non-finite fields, if any, are ignored)
+    bool applyCommands(SimulationState &state)
+    {
+        fsim_shm_command command{};
+        if (!fsim_seqlock_read(&segment->command_seq, &segment->command, &command, sizeof(command), 2))
+            return false;
+        if (command.id == lastCommand.id)
+            return false;
+
+        // A NaN would pass through the clamp and poison the run: non-finite
+        // inputs are dropped and the previous ones kept
+        if ((command.flags & FSIM_CMD_THROTTLE) && std::isfinite(command.throttle))
+            state.throttle = std::clamp(command.throttle, 0.0f, 1.0f);
+        if ((command.flags & FSIM_CMD_ELEVATOR) && std::isfinite(command.elevator))
+            state.elevator = std::clamp(command.elevator, -1.0f, 1.0f);
+
+        lastCommand = command;
+        lastAppliedNs = fsim_now_ns();
+        applied++;
+        return true;
+    }
+
+    // Publish the state after a step
+    void publish(const SimulationState &state)
+    {
+        fsim_shm_state out;
+        out.t = state.t;
+        out.x = state.position.x;
+        out.altitude = state.position.y;
+        out.vx = state.velocity.x;
+        out.vz = state.velocity.y;
+        out.pitch_deg = state.pitch_deg;
+        out.pitch_rate = state.pitch_rate;
+        out.alpha_deg = state.alpha_deg;
+        out.throttle = state.throttle;
+        out.elevator = state.elevator;
+        out.step = ++published;
+        out.command_id = lastCommand.id;
+        out.command_sent_ns = lastCommand.sent_ns;
+        out.command_applied_ns = lastAppliedNs;
+        fsim_seqlock_write(&segment->state_seq, &segment->state, &out, sizeof(out));
+    }
+
+    const std::string &segmentName() const { return name; }
+    uint64_t commandsApplied() const { return applied; }
+    uint64_t statesPublished() const { return published; }
+
+private:
+    std::string name;
+    fsim_shm_segment *segment = nullptr;
+    fsim_shm_command lastCommand{};
+    int64_t lastAppliedNs = 0;
+    uint64_t applied = 0;
+    uint64_t published = 0;
+
+    // Unlink an existing segment whose simulator has exited (a crashed run)
+    static void removeStaleSegment(const std::string &name)
+    {
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return; // Gone in the meantime
+        struct stat info;
+        void *mem = MAP_FAILED;
+        if (::fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(fsim_shm_segment)))
+            mem = ::mmap(nullptr, sizeof(fsim_shm_segment), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED)
+            throw std::runtime_error("Shared memory " + name + " exists and is not a simulator segment");
+
+        const fsim_shm_segment *existing = static_cast<const fsim_shm_segment *>(mem);
+        const uint32_t magic = __atomic_load_n(&existing->magic, __ATOMIC_ACQUIRE);
+        const pid_t owner = static_cast<pid_t>(existing->sim_pid);
+        ::munmap(mem, sizeof(fsim_shm_segment));
+        if (magic != FSIM_SHM_MAGIC)
+            throw std::runtime_error("Shared memory " + name + " exists and is not a simulator segment");
+        if (owner > 0 && (::kill(owner, 0) == 0 || errno == EPERM))
+            throw std::runtime_error("Shared memory " + name + " is in use by process " + std::to_string(owner));
+        ::shm_unlink(name.c_str());
+    }
+};
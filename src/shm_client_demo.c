@@ -0,0 +1,63 @@
+/*
+ * Example external controller using the C shared-memory client
+ * Usage: ShmClientDemo [/name] [target_speed] [seconds]
+ *
+ * Holds airspeed with a proportional throttle law at 1 kHz against a
+ * simulator started with --shm (e.g. FlightDynamics scenario.json --shm /flightsim --realtime).
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "shm/shm_client.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+int main(int argc, char **argv)
+{
+    const char *name = argc > 1 ? argv[1] : FSIM_SHM_DEFAULT_NAME;
+    double target_speed = argc > 2 ? atof(argv[2]) : 40.0;
+    double seconds = argc > 3 ? atof(argv[3]) : 30.0;
+
+    fsim_client *client = fsim_client_open(name);
+    if (!client)
+    {
+        perror("fsim_client_open");
+        fprintf(stderr, "Is the simulator running with --shm %s?\n", name);
+        return 1;
+    }
+
+    const int64_t period_ns = 1000000; /* 1 kHz */
+    int64_t start = fsim_now_ns();
+    int64_t next = start;
+    uint64_t last_step = 0;
+    int64_t last_print = start;
+
+    while (fsim_now_ns() - start < (int64_t)(seconds * 1e9))
+    {
+        fsim_shm_state s;
+        if (fsim_client_read_state(client, &s) && s.step != last_step)
+        {
+            last_step = s.step;
+            double speed = sqrt(s.vx * s.vx + s.vz * s.vz);
+            double throttle = 0.5 + 0.1 * (target_speed - speed);
+            throttle = throttle < 0.0 ? 0.0 : (throttle > 1.0 ? 1.0 : throttle);
+            fsim_client_send(client, FSIM_CMD_THROTTLE, (float)throttle, 0.0f);
+
+            if (fsim_now_ns() - last_print >= 1000000000)
+            {
+                last_print = fsim_now_ns();
+                printf("t=%7.2f  alt=%7.1f m  speed=%5.1f m/s  throttle=%.2f\n", s.t, s.altitude, speed, throttle);
+                fflush(stdout);
+            }
+        }
+
+        next += period_ns;
+        struct timespec ts = {(time_t)(next / 1000000000), (long)(next % 1000000000)};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+
+    fsim_client_close(client);
+    return 0;
+}
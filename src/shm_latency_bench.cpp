@@ -0,0 +1,169 @@
+// Command latency benchmark for the shared-memory control interface
+// Usage: ShmLatencyBench [--samples N] [--rate Hz] [--name /name]
+//
+// Forks a simulator process (default aircraft, stepping free-running or at
+// --rate Hz) and measures from the parent, through the C client:
+//   apply  client send -> simulator applies the command (before its next step)
+//   round  client send -> client sees the state that echoes the command
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "shm/shm_control.hpp"
+#include "shm/shm_client.h"
+#include "simulation/physics_update.hpp"
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void onTerminate(int) { stopRequested = 1; }
+
+static int runSimulator(const std::string &name, double rateHz)
+{
+    std::signal(SIGTERM, onTerminate);
+    ShmControlServer control(name);
+
+    SimulationState state;
+    state.maxPathPoints = 0;
+    state.position = Vec2(0.0, 500.0);
+    state.velocity = Vec2(40.0, 0.0);
+    state.pitch_deg = 6.0f;
+    state.throttle = 0.5f;
+    state.dt = 0.001;
+    syncControllerGains(state);
+    PhysicsStepFn step = selectPhysicsStep(state);
+
+    const int64_t periodNs = rateHz > 0.0 ? static_cast<int64_t>(1e9 / rateHz) : 0;
+    int64_t next = fsim_now_ns();
+    while (!stopRequested)
+    {
+        control.applyCommands(state);
+        step(state);
+        control.publish(state);
+
+        // Keep the aircraft flying for arbitrarily long benchmarks
+        if (state.position.y < 100.0 || state.position.y > 2000.0)
+        {
+            state.position.y = 500.0;
+            state.velocity = Vec2(40.0, 0.0);
+            state.pitch_deg = 6.0f;
+            state.pitch_rate = 0.0f;
+        }
+
+        if (periodNs > 0)
+        {
+            next += periodNs;
+            timespec ts{static_cast<time_t>(next / 1000000000), static_cast<long>(next % 1000000000)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+        }
+    }
+    return 0;
+}
+
+static void printPercentiles(const char *label, std::vector<int64_t> ns)
+{
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&](double p)
+    { return ns[std::min(ns.size() - 1, static_cast<size_t>(p * ns.size()))] / 1000.0; };
+    std::printf("  %-6s min %8.2f  p50 %8.2f  p90 %8.2f  p99 %8.2f  p99.9 %8.2f  max %8.2f  us\n",
+                label, ns.front() / 1000.0, pct(0.5), pct(0.9), pct(0.99), pct(0.999), ns.back() / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t samples = 100000;
+    double rateHz = 0.0;
+    std::string name = "/flightsim_bench";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--samples" && i + 1 < argc)
+            samples = std::stoul(argv[++i]);
+        else if (arg == "--rate" && i + 1 < argc)
+            rateHz = std::stod(argv[++i]);
+        else if (arg == "--name" && i + 1 < argc)
+            name = argv[++i];
+        else
+        {
+            std::printf("Usage: ShmLatencyBench [--samples N] [--rate Hz] [--name /name]\n");
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+    if (samples == 0)
+        samples = 1;
+
+    pid_t child = fork();
+    if (child < 0)
+    {
+        std::perror("fork");
+        return 1;
+    }
+    if (child == 0)
+        return runSimulator(name, rateHz);
+
+    // Wait for the simulator to create the segment and publish a first state
+    fsim_client *client = nullptr;
+    fsim_shm_state state;
+    for (int attempt = 0; attempt < 2000 && !client; attempt++)
+    {
+        client = fsim_client_open(name.c_str());
+        if (!client)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bool running = false;
+    for (int attempt = 0; client && attempt < 2000 && !running; attempt++)
+    {
+        running = fsim_client_read_state(client, &state) && state.step > 0;
+        if (!running)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!running)
+    {
+        std::fprintf(stderr, "Simulator did not come up on %s\n", name.c_str());
+        fsim_client_close(client);
+        kill(child, SIGTERM);
+        waitpid(child, nullptr, 0);
+        return 1;
+    }
+
+    std::printf("Simulator pid %d on %s, %s, %zu samples\n", static_cast<int>(child), name.c_str(),
+                rateHz > 0.0 ? (std::to_string(static_cast<long>(rateHz)) + " Hz").c_str() : "free-running", samples);
+
+    std::vector<int64_t> apply, round;
+    apply.reserve(samples);
+    round.reserve(samples);
+    size_t timeouts = 0;
+    for (size_t i = 0; i < samples; i++)
+    {
+        float throttle = (i % 2) ? 0.55f : 0.45f;
+        uint64_t id = fsim_client_send(client, FSIM_CMD_THROTTLE, throttle, 0.0f);
+        if (!fsim_client_wait_applied(client, id, 1000000000, &state) || state.command_id != id)
+        {
+            timeouts++;
+            continue;
+        }
+        int64_t now = fsim_now_ns();
+        apply.push_back(state.command_applied_ns - state.command_sent_ns);
+        round.push_back(now - state.command_sent_ns);
+    }
+
+    fsim_client_close(client);
+    kill(child, SIGTERM);
+    waitpid(child, nullptr, 0);
+
+    if (apply.empty())
+    {
+        std::fprintf(stderr, "No command was acknowledged\n");
+        return 1;
+    }
+    printPercentiles("apply", apply);
+    printPercentiles("round", round);
+    if (timeouts)
+        std::printf("  %zu samples timed out or were overtaken\n", timeouts);
+    return 0;
+}
@@ -0,0 +1,482 @@
+#pragma once
+
+#include "physics_update.hpp"
+#include "../aircraft/aircraft_loader.hpp"
+#include "../core/damped_cholesky.hpp"
+#include "../core/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Aerodynamic coefficient identification from recorded flight data
+//
+// Fits either the legacy polar (CL_alpha, CD0, k) or every node of an aero
+// table (CL and CD at each alpha) so the simulator's force model reproduces a
+// flight log. The log is cut into segments of a few seconds; each segment is
+// replayed from its recorded first state with the recorded pitch attitude
+// and throttle as inputs, so the fit sees the aerodynamics only (mass, wing
+// area and thrust come from the starting aircraft, the pitch response model
+// plays no part). Residuals are the replayed altitude and velocity against the
+// recorded ones at every log row.
+//
+// Levenberg-Marquardt minimizes the sum of squared residuals. Residuals and
+// their Jacobian (central differences, like the linearizer) are evaluated
+// per segment across a thread pool; segments are independent because every
+// one restarts from the log.
+
+// One recorded sample
+struct FlightLogRow
+{
+    double t;
+    double x = 0.0;
+    double altitude;
+    double vx, vz;
+    double pitch_deg;
+    double throttle;
+};
+
+struct FlightLog
+{
+    std::vector<FlightLogRow> rows;
+
+    // CSV with a header row naming the columns, in any order. Needs t,
+    // altitude, vx, vz, pitch_deg and throttle; x is optional (wind lookup).
+    // The simulator's trajectory CSVs have this format.
+    static FlightLog loadFromCSV(const std::string &filepath)
+    {
+        std::ifstream file(filepath);
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open flight log: " + filepath);
+
+        std::string line;
+        if (!std::getline(file, line))
+            throw std::runtime_error("Empty flight log: " + filepath);
+
+        std::vector<std::string> columns = splitRow(line);
+        auto column = [&](const char *name, bool required) -> int
+        {
+            for (size_t i = 0; i < columns.size(); i++)
+                if (columns[i] == name)
+                    return static_cast<int>(i);
+            if (required)
+                throw std::runtime_error(filepath + ": missing column '" + name + "'");
+            return -1;
+        };
+        const int ct = column("t", true), cx = column("x", false), calt = column("altitude", true);
+        const int cvx = column("vx", true), cvz = column("vz", true);
+        const int cpitch = column("pitch_deg", true), cthrottle = column("throttle", true);
+
+        FlightLog log;
+        while (std::getline(file, line))
+        {
+            if (line.find_first_not_of(" \t\r\n") == std::string::npos)
+                continue;
+            std::vector<std::string> cells = splitRow(line);
+            if (cells.size() < columns.size())
+                throw std::runtime_error(filepath + ": short row: " + line);
+
+            FlightLogRow row;
+            row.t = std::stod(cells[ct]);
+            row.x = cx >= 0 ? std::stod(cells[cx]) : 0.0;
+            row.altitude = std::stod(cells[calt]);
+            row.vx = std::stod(cells[cvx]);
+            row.vz = std::stod(cells[cvz]);
+            row.pitch_deg = std::stod(cells[cpitch]);
+            row.throttle = std::stod(cells[cthrottle]);
+            if (!log.rows.empty() && !(row.t > log.rows.back().t))
+                throw std::runtime_error(filepath + ": times must increase (t = " + cells[ct] + ")");
+            log.rows.push_back(row);
+        }
+        return log;
+    }
+
+private:
+    static std::vector<std::string> splitRow(const std::string &line)
+    {
+        std::vector<std::string> cells;
+        std::stringstream ss(line);
+        std::string cell;
+        while (std::getline(ss, cell, ','))
+        {
+            cell.erase(0, cell.find_first_not_of(" \t"));
+            cell.erase(cell.find_last_not_of(" \t\r") + 1);
+            cells.push_back(cell);
+        }
+        return cells;
+    }
+};
+
+enum class AeroFitMode
+{
+    Polar, // CL_alpha, CD0, k of the legacy model
+    Table  // CL and CD at every node of an aero table
+};
+
+struct AeroFitOptions
+{
+    AeroFitMode mode = AeroFitMode::Table;
+    double segment_duration = 5.0;                   // s per replayed segment
+    double max_step = 0.01;                          // s, longest replay step (log intervals are subdivided)
+    IntegratorType integrator = IntegratorType::RK4; // Replay integrator
+    double position_scale = 1.0;                     // m of altitude error per unit residual
+    double velocity_scale = 0.1;                     // m/s of velocity error per unit residual
+    int max_iterations = 100;
+    double tolerance = 1e-10; // Stop when an accepted step lowers the cost by less than this fraction
+};
+
+struct AeroFitResult
+{
+    Aircraft aircraft; // Fitted (table mode: with the fitted table, aeroDataFile unset)
+    std::vector<std::string> parameter_names;
+    std::vector<double> parameters;
+    double initial_rms = 0.0; // Residual RMS in scaled units (see AeroFitOptions)
+    double final_rms = 0.0;
+    int iterations = 0;
+    bool converged = false;
+    size_t segments = 0;
+    size_t residuals = 0;
+};
+
+namespace aero_fit_detail
+{
+    struct Segment
+    {
+        size_t first, last; // Log rows, inclusive
+    };
+
+    // Consecutive airborne rows, cut every segment_duration seconds; a cut
+    // row ends one segment and starts the next
+    inline std::vector<Segment> makeSegments(const FlightLog &log, double duration)
+    {
+        std::vector<Segment> segments;
+        size_t i = 0;
+        while (i < log.rows.size())
+        {
+            if (!(log.rows[i].altitude > 0.0))
+            {
+                i++;
+                continue;
+            }
+            size_t j = i;
+            while (j + 1 < log.rows.size() && log.rows[j + 1].altitude > 0.0 &&
+                   log.rows[j + 1].t - log.rows[i].t <= duration + 1e-9)
+                j++;
+            if (j == i)
+            {
+                i++;
+                continue;
+            }
+            segments.push_back({i, j});
+            i = j;
+        }
+        return segments;
+    }
+
+    // Replay one segment and write its residuals (altitude, vx, vz per row
+    // after the first). Each log interval uses the attitude and throttle of
+    // its end row, which is how the simulator's step records them.
+    template <typename AeroModel, typename Integrator>
+    inline void replaySegment(const FlightLog &log, const Segment &segment, const FlightParams &params,
+                              const AeroFitOptions &options, double *residuals)
+    {
+        const FlightLogRow &start = log.rows[segment.first];
+        FlightState flight;
+        flight.position = Vec2(start.x, start.altitude);
+        flight.velocity = Vec2(start.vx, start.vz);
+        flight.t = start.t;
+
+        for (size_t r = segment.first + 1; r <= segment.last; r++)
+        {
+            const FlightLogRow &row = log.rows[r];
+            const double interval = row.t - log.rows[r - 1].t;
+            const int steps = std::max(1, static_cast<int>(std::ceil(interval / options.max_step - 1e-9)));
+            const double dt = interval / steps;
+            for (int k = 0; k < steps; k++)
+            {
+                FlightCondition c = flightCondition(flight, params);
+                ForceSet forces = computeForces<AeroModel>(params.aircraft, c.air_velocity, c.speed, c.rho,
+                                                           row.pitch_deg, row.throttle);
+                Integrator::step(flight.position, flight.velocity, forces.net() / params.aircraft.mass, dt);
+                flight.t += dt;
+            }
+
+            *residuals++ = (flight.position.y - row.altitude) / options.position_scale;
+            *residuals++ = (flight.velocity.x - row.vx) / options.velocity_scale;
+            *residuals++ = (flight.velocity.y - row.vz) / options.velocity_scale;
+        }
+    }
+
+    using ReplayFn = void (*)(const FlightLog &, const Segment &, const FlightParams &, const AeroFitOptions &, double *);
+
+    template <typename AeroModel>
+    inline ReplayFn selectReplay(IntegratorType integrator)
+    {
+        if (integrator == IntegratorType::SemiImplicitEuler)
+            return &replaySegment<AeroModel, SemiImplicitEulerIntegrator>;
+        return &replaySegment<AeroModel, RK4Integrator>;
+    }
+}
+
+// The parameter vector of a fit and its mapping onto an aircraft
+class AeroFitProblem
+{
+public:
+    AeroFitProblem(const Aircraft &initial, AeroFitMode mode) : base(initial), mode(mode)
+    {
+        if (mode == AeroFitMode::Polar)
+        {
+            names = {"CL_alpha", "CD0", "k"};
+            start = {initial.CL_alpha, initial.CD0, initial.k};
+            return;
+        }
+
+        // Table nodes: the aircraft's own table, or its polar sampled from
+        // -10 to 20 deg (table CD excludes CD0, which the table model adds)
+        if (initial.hasAeroTable() && !initial.aeroTable->isEmpty())
+        {
+            nodes = initial.aeroTable->points();
+        }
+        else
+        {
+            for (int deg = -10; deg <= 20; deg += 2)
+            {
+                double alpha = deg * M_PI / 180.0;
+                double CL = calcCL(alpha, initial.CL_alpha);
+                nodes.push_back({alpha, CL, initial.k * CL * CL});
+            }
+        }
+        for (const AeroDataTable::DataPoint &p : nodes)
+        {
+            char label[32];
+            std::snprintf(label, sizeof(label), "@%.2fdeg", p.alpha * 180.0 / M_PI);
+            names.push_back(std::string("CL") + label);
+            start.push_back(p.CL);
+            names.push_back(std::string("CD") + label);
+            start.push_back(p.CD);
+        }
+    }
+
+    const std::vector<std::string> &parameterNames() const { return names; }
+    const std::vector<double> &initialParameters() const { return start; }
+
+    Aircraft aircraft(const std::vector<double> &theta) const
+    {
+        Aircraft ac = base;
+        if (mode == AeroFitMode::Polar)
+        {
+            ac.CL_alpha = theta[0];
+            ac.CD0 = theta[1];
+            ac.k = theta[2];
+            ac.aeroTable = nullptr;
+            ac.aeroDataFile.clear();
+            return ac;
+        }
+
+        std::vector<AeroDataTable::DataPoint> points = nodes;
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            points[i].CL = theta[2 * i];
+            points[i].CD = theta[2 * i + 1];
+        }
+        ac.aeroTable = std::make_shared<const AeroDataTable>(AeroDataTable::fromPoints(std::move(points)));
+        ac.aeroDataFile.clear();
+        return ac;
+    }
+
+private:
+    Aircraft base;
+    AeroFitMode mode;
+    std::vector<AeroDataTable::DataPoint> nodes;
+    std::vector<std::string> names;
+    std::vector<double> start;
+};
+
+// Fit the aircraft's aerodynamics to a flight log
+// `environment` supplies the atmosphere and wind of the flight (its aircraft
+// is ignored). Throws if the log has no airborne segment.
+inline AeroFitResult fitAeroCoefficients(const FlightLog &log, const Aircraft &initial, const AeroFitOptions &options,
+                                         ThreadPool &pool, const FlightParams &environment = FlightParams())
+{
+    using namespace aero_fit_detail;
+
+    const std::vector<Segment> segments = makeSegments(log, options.segment_duration);
+    if (segments.empty())
+        throw std::runtime_error("Flight log has no airborne segment to fit");
+
+    // Residual offsets per segment
+    std::vector<size_t> offset(segments.size() + 1, 0);
+    for (size_t s = 0; s < segments.size(); s++)
+        offset[s + 1] = offset[s] + 3 * (segments[s].last - segments[s].first);
+    const size_t m = offset.back();
+
+    const AeroFitProblem problem(initial, options.mode);
+    std::vector<double> theta = problem.initialParameters();
+    const size_t n = theta.size();
+    const ReplayFn replay = options.mode == AeroFitMode::Table ? selectReplay<TableAeroModel>(options.integrator)
+                                                               : selectReplay<LegacyAeroModel>(options.integrator);
+
+    auto paramsFor = [&](const std::vector<double> &p)
+    {
+        FlightParams params = environment;
+        params.aircraft = problem.aircraft(p);
+        return params;
+    };
+
+    // Residuals, and optionally the Jacobian (row-major m x n), segment by segment
+    auto evaluate = [&](const std::vector<double> &p, std::vector<double> &r, std::vector<double> *J)
+    {
+        r.assign(m, 0.0);
+        if (J)
+            J->assign(m * n, 0.0);
+        const FlightParams params = paramsFor(p);
+        pool.parallelFor(segments.size(), 1, [&](size_t begin, size_t end)
+                         {
+            std::vector<double> plus, minus;
+            for (size_t s = begin; s < end; s++)
+            {
+                const size_t rows = offset[s + 1] - offset[s];
+                replay(log, segments[s], params, options, r.data() + offset[s]);
+                if (!J)
+                    continue;
+
+                plus.resize(rows);
+                minus.resize(rows);
+                for (size_t j = 0; j < n; j++)
+                {
+                    const double h = 1e-6 * std::max(std::fabs(p[j]), 1e-2);
+                    std::vector<double> q = p;
+                    q[j] = p[j] + h;
+                    replay(log, segments[s], paramsFor(q), options, plus.data());
+                    q[j] = p[j] - h;
+                    replay(log, segments[s], paramsFor(q), options, minus.data());
+                    for (size_t i = 0; i < rows; i++)
+                        (*J)[(offset[s] + i) * n + j] = (plus[i] - minus[i]) / (2.0 * h);
+                }
+            } });
+    };
+
+    auto costOf = [](const std::vector<double> &r)
+    {
+        double c = 0.0;
+        for (double v : r)
+            c += v * v;
+        return 0.5 * c;
+    };
+
+    AeroFitResult result;
+    result.parameter_names = problem.parameterNames();
+    result.segments = segments.size();
+    result.residuals = m;
+
+    std::vector<double> r, J, trial_r;
+    evaluate(theta, r, &J);
+    double cost = costOf(r);
+    result.initial_rms = std::sqrt(2.0 * cost / static_cast<double>(m));
+
+    double lambda = 1e-3;
+    bool progressed = false; // Some step has lowered the cost
+    std::vector<double> A(n * n), gradient(n), delta;
+    for (result.iterations = 0; result.iterations < options.max_iterations;)
+    {
+        // Normal equations J^T J delta = -J^T r
+        std::fill(A.begin(), A.end(), 0.0);
+        std::fill(gradient.begin(), gradient.end(), 0.0);
+        for (size_t i = 0; i < m; i++)
+        {
+            const double *row = &J[i * n];
+            for (size_t a = 0; a < n; a++)
+            {
+                if (row[a] == 0.0)
+                    continue;
+                gradient[a] -= row[a] * r[i];
+                for (size_t b = a; b < n; b++)
+                    A[a * n + b] += row[a] * row[b];
+            }
+        }
+        for (size_t a = 0; a < n; a++)
+            for (size_t b = 0; b < a; b++)
+                A[a * n + b] = A[b * n + a];
+
+        // Raise the damping until a step lowers the cost
+        bool accepted = false;
+        double reduction = 0.0;
+        std::vector<double> trial;
+        while (lambda < 1e12)
+        {
+            if (!solveDampedCholesky(A, gradient, lambda, delta))
+            {
+                lambda *= 10.0;
+                continue;
+            }
+            trial = theta;
+            for (size_t j = 0; j < n; j++)
+                trial[j] += delta[j];
+            evaluate(trial, trial_r, nullptr);
+            double trial_cost = costOf(trial_r);
+            if (trial_cost < cost)
+            {
+                reduction = (cost - trial_cost) / cost;
+                accepted = true;
+                break;
+            }
+            lambda *= 10.0;
+        }
+        result.iterations++;
+
+        if (!accepted)
+        {
+            // No step lowers the cost: at a minimum to working precision if
+            // earlier steps got here (or the fit is exact), else stuck
+            result.converged = progressed || cost == 0.0;
+            break;
+        }
+
+        progressed = true;
+        theta = trial;
+        lambda = std::max(lambda * 0.1, 1e-12);
+        if (reduction < options.tolerance || cost * (1.0 - reduction) == 0.0)
+        {
+            evaluate(theta, r, nullptr);
+            cost = costOf(r);
+            result.converged = true;
+            break;
+        }
+        evaluate(theta, r, &J);
+        cost = costOf(r);
+    }
+
+    result.parameters = theta;
+    result.aircraft = problem.aircraft(theta);
+    result.final_rms = std::sqrt(2.0 * cost / static_cast<double>(m));
+    return result;
+}
+
+// Write a fit as an aircraft config AircraftLoader loads directly: the JSON,
+// and in table mode the aero table next to it (<name>_aero.csv, referenced
+// by file name). The gain schedule reference is dropped, since the output
+// need not live next to the original config. Returns the table path (empty
+// in polar mode).
+inline std::filesystem::path writeFittedAircraft(const AeroFitResult &result, const std::filesystem::path &jsonPath)
+{
+    Aircraft ac = result.aircraft;
+    ac.gainSchedule = nullptr;
+    ac.gainScheduleFile.clear();
+
+    std::filesystem::path tablePath;
+    if (ac.hasAeroTable())
+    {
+        tablePath = jsonPath;
+        tablePath.replace_filename(jsonPath.stem().string() + "_aero.csv");
+        ac.aeroTable->saveToCSV(tablePath.string());
+        ac.aeroDataFile = tablePath.filename().string();
+    }
+    AircraftLoader::saveToJSON(ac, jsonPath.string());
+    return tablePath;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "physics_update.hpp"
+#include "../core/thread_pool.hpp"
+#include <vector>
+
+// Steps many independent aircraft per frame
+// Each SimulationState only reads shared immutable data (aero tables), so the
+// batch is split into chunks and stepped in parallel on a persistent pool.
+class BatchEngine
+{
+public:
+    // Aircraft per work item; small batches are stepped on the calling thread
+    size_t grain;
+
+    explicit BatchEngine(size_t threadCount = 0, size_t grain_ = 8)
+        : grain(grain_), pool(threadCount)
+    {
+    }
+
+    void step(std::vector<SimulationState> &states)
+    {
+        pool.parallelFor(states.size(), grain, [&states](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (states[i].reset_requested)
+                    states[i].reset();
+                updatePhysics(states[i]);
+            } });
+    }
+
+    size_t threadCount() const { return pool.size(); }
+
+private:
+    ThreadPool pool;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include "physics_update.hpp"
+#include "../control/pid_bank.hpp"
+#include "../core/thread_pool.hpp"
+#include <array>
+#include <vector>
+
+// Many aircraft sharing one configuration, stepped in lockstep
+// Only the hot state (64 bytes in double, 40 in float) is stored per aircraft;
+// the aircraft, dt, integrator and autopilot settings live once in params, and
+// there is no per-aircraft UI or visualization data, so a million aircraft
+// take 64 MB (40 MB in float) and a step streams straight through them.
+//
+// With the autopilot off a step just advances every aircraft in parallel
+// chunks. With it on, the controllers run on PID banks (one lane per
+// aircraft) in three passes:
+//   1. measure airspeed and altitude (and look up scheduled gains)
+//   2. update every speed / altitude controller in one vectorized loop
+//   3. apply the commands and advance every aircraft
+// In double precision each lane matches what stepPhysics() does for a
+// SimulationState with the same parameters. The float batch (FlightBatchF)
+// steps the same model on float states; controllers stay in double.
+// A wind in params is one frozen air mass for the whole batch: lanes at
+// different x fly through different parts of its turbulence field.
+template <typename T>
+class FlightBatchT
+{
+public:
+    using State = FlightStateT<T>;
+
+    // Shared by every aircraft; may be edited between steps
+    FlightParams params;
+
+    // Aircraft per work item
+    size_t grain;
+
+    explicit FlightBatchT(const FlightParams &params_ = FlightParams(), size_t threadCount = 0, size_t grain_ = 4096)
+        : params(params_), grain(grain_), pool(threadCount)
+    {
+    }
+
+    // Add an aircraft; returns its index
+    size_t add(const State &state)
+    {
+        flights.push_back(state);
+        return flights.size() - 1;
+    }
+
+    void reserve(size_t count) { flights.reserve(count); }
+
+    // Remove every aircraft and its controller state
+    void clear()
+    {
+        flights.clear();
+        speedBank = PIDBank();
+        altitudeBank = PIDBank();
+    }
+
+    size_t size() const { return flights.size(); }
+    State &operator[](size_t i) { return flights[i]; }
+    const State &operator[](size_t i) const { return flights[i]; }
+    const std::vector<State> &states() const { return flights; }
+
+    size_t threadCount() const { return pool.size(); }
+
+    void step()
+    {
+        const size_t n = flights.size();
+        FlightRangeFnT<T> advance = selectFlightRange<T>(params);
+        State *data = flights.data();
+        const FlightParams &p = params;
+
+        if (!p.autopilot_speed && !p.autopilot_altitude)
+        {
+            pool.parallelFor(n, grain, [&](size_t begin, size_t end)
+                             { advance(data + begin, end - begin, p); });
+            return;
+        }
+
+        prepareControllers(n);
+        const bool speedLoop = p.autopilot_speed;
+        const bool altitudeLoop = p.autopilot_altitude;
+        const bool scheduled = p.gainsScheduled();
+        const bool fastDensity = p.math_tier == MathTier::Fast;
+
+        // 1. Measurements (airspeed, altitude), and scheduled gains for each lane's flight condition
+        pool.parallelFor(n, grain, [&](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+            {
+                const State &f = data[i];
+                speeds[i] = static_cast<double>(airVelocity(f, p).magnitude());
+                altitudes[i] = static_cast<double>(f.position.y);
+                if (scheduled)
+                {
+                    double altitude = std::max(0.0, altitudes[i]);
+                    double rho = fastDensity ? airDensity<FastMath>(p, altitude) : airDensity<ExactMath>(p, altitude);
+                    ScheduledGains gains = p.aircraft.gainSchedule->lookup(0.5 * rho * speeds[i] * speeds[i], altitudes[i]);
+                    if (speedLoop)
+                        speedBank.setGains(i, gains.speed[0], gains.speed[1], gains.speed[2]);
+                    if (altitudeLoop)
+                        altitudeBank.setGains(i, gains.altitude[0], gains.altitude[1], gains.altitude[2]);
+                }
+            } });
+
+        // 2. Controllers, one pass over all lanes each
+        if (speedLoop)
+        {
+            setpoints.assign(n, p.speed_setpoint);
+            speedBank.update(setpoints.data(), speeds.data(), p.dt, throttleCommands.data());
+        }
+        if (altitudeLoop)
+        {
+            setpoints.assign(n, p.altitude_setpoint);
+            altitudeBank.update(setpoints.data(), altitudes.data(), p.dt, elevatorCommands.data());
+        }
+
+        // 3. Apply the commands and advance
+        pool.parallelFor(n, grain, [&](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (speedLoop)
+                    data[i].throttle = static_cast<float>(throttleCommands[i]);
+                if (altitudeLoop)
+                    data[i].elevator = static_cast<float>(elevatorCommands[i]);
+            }
+            advance(data + begin, end - begin, p); });
+    }
+
+private:
+    std::vector<State> flights;
+    ThreadPool pool;
+
+    // Autopilot state, allocated once a loop is engaged
+    PIDBank speedBank;
+    PIDBank altitudeBank;
+    std::array<float, 6> fixedGains{}; // Fixed gains last loaded into the banks
+    bool fixedGainsLoaded = false;
+
+    // Per-step scratch (autopilot only)
+    std::vector<double> speeds, altitudes, setpoints;
+    std::vector<double> throttleCommands, elevatorCommands;
+
+    // Size the banks and scratch arrays to the batch and load edited fixed
+    // gains (in place, like syncControllerGains)
+    void prepareControllers(size_t n)
+    {
+        const FlightParams &p = params;
+        while (speedBank.size() < n)
+            speedBank.add(p.pid_kp, p.pid_ki, p.pid_kd, 0.0, 1.0);
+        while (altitudeBank.size() < n)
+            altitudeBank.add(p.alt_pid_kp, p.alt_pid_ki, p.alt_pid_kd, -1.0, 1.0);
+
+        speeds.resize(n);
+        altitudes.resize(n);
+        throttleCommands.resize(n);
+        elevatorCommands.resize(n);
+
+        if (p.gainsScheduled())
+        {
+            fixedGainsLoaded = false;
+            return;
+        }
+
+        std::array<float, 6> gains = {p.pid_kp, p.pid_ki, p.pid_kd, p.alt_pid_kp, p.alt_pid_ki, p.alt_pid_kd};
+        if (fixedGainsLoaded && gains == fixedGains)
+            return;
+        for (size_t i = 0; i < n; i++)
+        {
+            speedBank.setGains(i, gains[0], gains[1], gains[2]);
+            altitudeBank.setGains(i, gains[3], gains[4], gains[5]);
+        }
+        fixedGains = gains;
+        fixedGainsLoaded = true;
+    }
+};
+
+using FlightBatch = FlightBatchT<double>;
+using FlightBatchF = FlightBatchT<float>;
@@ -0,0 +1,383 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Continuous trajectory over one physics step (dense output)
+//
+// Both integrators hold the step's acceleration constant, so the motion
+// between the step endpoints follows from the state before the step, that
+// acceleration and dt. Position is the cubic Hermite through the start and
+// the unconstrained end (before the ground clamp) with their velocities: for
+// RK4 this is the exact p0 + v0 t + a t^2 / 2 of the step, for semi-implicit
+// Euler a smooth curve through both of its endpoints. Pitch and pitch rate
+// are linear over the step.
+class StepInterpolant
+{
+public:
+    // acceleration is the one the step applied (net force / mass)
+    StepInterpolant(const FlightState &before, const FlightState &after, const Vec2 &acceleration,
+                    const FlightParams &params)
+        : start(before), end(after), params(params), dt(params.dt)
+    {
+        // Recompute the end state without the ground constraint
+        Vec2 p1 = before.position, v1 = before.velocity;
+        if (params.integrator == IntegratorType::SemiImplicitEuler)
+            SemiImplicitEulerIntegrator::step(p1, v1, acceleration, dt);
+        else
+            RK4Integrator::step(p1, v1, acceleration, dt);
+        end_position = p1;
+        end_velocity = v1;
+
+        Vec2 delta = p1 - before.position - before.velocity * dt;
+        Vec2 dv = (v1 - before.velocity) * dt;
+        c2 = (delta * 3.0 - dv) / (dt * dt);
+        c3 = (dv - delta * 2.0) / (dt * dt * dt);
+
+        pitch_change = after.pitch_deg - before.pitch_deg; // Unwrapped across +/-180
+        if (pitch_change > 180.0)
+            pitch_change -= 360.0;
+        else if (pitch_change < -180.0)
+            pitch_change += 360.0;
+    }
+
+    // From a SimulationState just stepped by stepPhysics, which leaves the
+    // step's forces in the visualization vectors
+    StepInterpolant(const FlightState &before, const SimulationState &after)
+        : StepInterpolant(before, after,
+                          (after.F_thrust_viz + after.F_drag_viz + after.F_lift_viz + after.F_weight_viz) / after.aircraft.mass,
+                          after)
+    {
+    }
+
+    double duration() const { return dt; }
+
+    // tau in [0, dt] from the start of the step; the ends are exact
+    Vec2 position(double tau) const
+    {
+        if (tau >= dt)
+            return end_position;
+        return start.position + (start.velocity + (c2 + c3 * tau) * tau) * tau;
+    }
+
+    Vec2 velocity(double tau) const
+    {
+        if (tau >= dt)
+            return end_velocity;
+        return start.velocity + (c2 * 2.0 + c3 * (3.0 * tau)) * tau;
+    }
+
+    double pitchDeg(double tau) const
+    {
+        return start.pitch_deg + pitch_change * (tau / dt);
+    }
+
+    // Velocity relative to the air and the angle of attack it gives (deg)
+    Vec2 airVelocity(double tau) const
+    {
+        Vec2 v = velocity(tau);
+        if (!params.wind.active())
+            return v;
+        return v - params.wind.at(position(tau).x, start.t + tau);
+    }
+
+    // Wrapped to [-180, 180)
+    double alphaDeg(double tau) const
+    {
+        Vec2 air = airVelocity(tau);
+        double alpha = pitchDeg(tau) - std::atan2(air.y, air.x) * 180.0 / M_PI;
+        return alpha - 360.0 * std::floor((alpha + 180.0) / 360.0);
+    }
+
+    // Full state at tau (controls as set for the step)
+    FlightState at(double tau) const
+    {
+        FlightState s = end;
+        s.t = start.t + tau;
+        s.position = position(tau);
+        s.velocity = velocity(tau);
+        float pitch = static_cast<float>(pitchDeg(tau));
+        s.pitch_deg = pitch > 180.0f ? pitch - 360.0f : (pitch < -180.0f ? pitch + 360.0f : pitch);
+        s.pitch_rate = start.pitch_rate + static_cast<float>((end.pitch_rate - start.pitch_rate) * (tau / dt));
+        s.alpha_deg = static_cast<float>(alphaDeg(tau));
+        return s;
+    }
+
+private:
+    FlightState start;
+    FlightState end;
+    const FlightParams &params;
+    double dt;
+    Vec2 end_position, end_velocity; // Unconstrained
+    Vec2 c2, c3;                     // Cubic coefficients of position
+    double pitch_change;
+};
+
+// Zero of g on [a, b] given g(a) and g(b) of opposite sign or g(b) = 0
+// Illinois variant of regula falsi: superlinear on smooth functions, and
+// it always keeps a bracket. Returns the end of the final bracket on b's
+// side, so the returned point is at or past the crossing.
+template <typename Func>
+inline double locateCrossing(Func g, double a, double b, double ga, double gb, double tolerance = 1e-10)
+{
+    int side = 0;
+    for (int i = 0; i < 100 && gb != 0.0 && b - a > tolerance; i++)
+    {
+        double c = (a * gb - b * ga) / (gb - ga);
+        if (!(c > a && c < b)) // Rounding at a tiny bracket: bisect
+            c = 0.5 * (a + b);
+        double gc = g(c);
+        if ((gc < 0.0) == (gb < 0.0) && (gc != 0.0 || gb == 0.0))
+        {
+            b = c;
+            gb = gc;
+            if (side == -1)
+                ga *= 0.5;
+            side = -1;
+        }
+        else
+        {
+            a = c;
+            ga = gc;
+            if (side == 1)
+                gb *= 0.5;
+            side = 1;
+        }
+    }
+    return b;
+}
+
+// An event located within a step
+struct FlightEvent
+{
+    const char *name;  // "ground_contact", "altitude", "stall", ... (see FlightEventDetector)
+    double threshold;  // Altitude (m), speed (m/s) or angle of attack (deg) crossed
+    int direction;     // +1 crossed upwards, -1 downwards
+    bool terminal;     // Ends the run (a stop condition)
+    FlightState state; // Interpolated state at the event; state.t is the event time
+};
+
+// Events a run reports in addition to its stop conditions
+struct EventWatchList
+{
+    std::vector<double> altitudes; // m, every crossing in either direction
+    std::vector<double> speeds;    // m/s ground speed, every crossing
+    double stall_alpha_deg = std::numeric_limits<double>::quiet_NaN(); // Upward crossings (NaN = off)
+    bool captures = false;         // First crossing of each engaged autopilot setpoint
+
+    bool empty() const { return altitudes.empty() && speeds.empty() && std::isnan(stall_alpha_deg) && !captures; }
+};
+
+// Locates events inside each step by root finding on its dense output
+//
+// Each watched quantity is evaluated at both ends of the step; a sign change
+// against its threshold is then narrowed down to the crossing time on the
+// StepInterpolant, so event times and states do not depend on dt. A crossing
+// that enters and leaves within a single step is not seen.
+//
+// Terminal watches are the scenario stop conditions. If a limit is violated
+// at the end of a step without a crossing inside it (already outside at the
+// start, or touching down while resting on the ground), the event is the
+// end of the step, as before event location.
+class FlightEventDetector
+{
+public:
+    // Stop conditions; infinite limits are not watched
+    void watchGroundContact(bool terminal)
+    {
+        watches.push_back({Quantity::Altitude, "ground_contact", 0.0, -1, terminal, false, true});
+    }
+
+    void watchLimit(const char *name, bool altitude, double limit, bool upper)
+    {
+        if (std::isfinite(limit))
+            watches.push_back({altitude ? Quantity::Altitude : Quantity::Speed, name, limit, upper ? 1 : -1, true, false});
+    }
+
+    void watch(const EventWatchList &list)
+    {
+        for (double h : list.altitudes)
+            watches.push_back({Quantity::Altitude, "altitude", h, 0, false, false});
+        for (double v : list.speeds)
+            watches.push_back({Quantity::Speed, "speed", v, 0, false, false});
+        if (!std::isnan(list.stall_alpha_deg))
+            watches.push_back({Quantity::Alpha, "stall", list.stall_alpha_deg, 1, false, false});
+        if (list.captures)
+        {
+            watches.push_back({Quantity::Airspeed, "speed_capture", 0.0, 0, false, true});
+            watches.push_back({Quantity::Altitude, "altitude_capture", 0.0, 0, false, true});
+        }
+    }
+
+    bool empty() const { return watches.empty(); }
+
+    // Whether the aircraft has been off the ground (the ground stop waits
+    // for it); kept when a paused run is saved and restored
+    bool wasAirborne() const { return airborne; }
+    void restoreAirborne(bool value) { airborne = value; }
+
+    // Events in the step from `before` to `after` (a state just advanced by
+    // stepPhysics), appended to `events` in time order. Events after the first
+    // terminal one did not happen and are dropped. Returns that terminal
+    // event, or nullptr if the run goes on.
+    const FlightEvent *detect(const FlightState &before, const SimulationState &after, std::vector<FlightEvent> &events)
+    {
+        const size_t first = events.size();
+        airborne = airborne || before.position.y > 0.0;
+        const double dt = after.dt;
+
+        // Altitude and speed at the ends are the step's own states unless
+        // the ground clamp moved the end; the interpolant is only built when
+        // it is needed
+        std::optional<StepInterpolant> interpolant;
+        auto step = [&]() -> const StepInterpolant &
+        {
+            if (!interpolant)
+                interpolant.emplace(before, after);
+            return *interpolant;
+        };
+        const bool clamped = after.position.y <= 0.0;
+
+        for (Watch &w : watches)
+        {
+            double threshold = w.threshold;
+            if (w.capture && !armCapture(w, after, threshold))
+                continue;
+
+            auto g = [&](double tau)
+            { return value(w.quantity, step(), tau) - threshold; };
+            double g0, g1;
+            if (!clamped && (w.quantity == Quantity::Altitude || w.quantity == Quantity::Speed))
+            {
+                g0 = stateValue(w.quantity, before) - threshold;
+                g1 = stateValue(w.quantity, after) - threshold;
+            }
+            else
+            {
+                g0 = g(0.0);
+                g1 = g(dt);
+            }
+            if (w.quantity == Quantity::Alpha && !alphaContinuous(step(), g0, g1))
+                continue;
+            bool up = g0 < 0.0 && g1 >= 0.0;
+            bool down = g0 > 0.0 && g1 <= 0.0;
+
+            if ((up && w.direction >= 0) || (down && w.direction <= 0))
+            {
+                double tau = locateCrossing(g, 0.0, dt, g0, g1);
+                FlightEvent e{w.name, threshold, up ? 1 : -1, w.terminal, step().at(tau)};
+                if (w.quantity == Quantity::Altitude)
+                    e.state.position.y = threshold; // Exactly on the ground or the level
+                events.push_back(e);
+                w.armed = false;
+            }
+            else if (w.terminal && violatedAtEnd(w, after))
+            {
+                events.push_back({w.name, threshold, w.direction, true, after});
+            }
+        }
+        airborne = airborne || after.position.y > 0.0;
+
+        // Time order; stable so simultaneous events keep the watch order
+        std::stable_sort(events.begin() + static_cast<std::ptrdiff_t>(first), events.end(),
+                         [](const FlightEvent &a, const FlightEvent &b)
+                         { return a.state.t < b.state.t; });
+        for (size_t i = first; i < events.size(); i++)
+        {
+            if (events[i].terminal)
+            {
+                events.resize(i + 1);
+                return &events[i];
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    enum class Quantity
+    {
+        Altitude,
+        Speed,    // Ground speed, as in the trajectory CSV and stop limits
+        Airspeed, // What the speed autopilot holds
+        Alpha     // deg
+    };
+
+    struct Watch
+    {
+        Quantity quantity;
+        const char *name;
+        double threshold;
+        int direction; // +1 upwards only, -1 downwards only, 0 both
+        bool terminal;
+        bool capture;  // Threshold is the autopilot setpoint
+        bool ground = false;
+
+        // Capture state: armed when the loop engages or its setpoint changes
+        bool armed = false;
+        bool engaged = false;
+        double setpoint = 0.0;
+    };
+
+    std::vector<Watch> watches;
+    bool airborne = false;
+
+    static double value(Quantity quantity, const StepInterpolant &step, double tau)
+    {
+        switch (quantity)
+        {
+        case Quantity::Altitude:
+            return step.position(tau).y;
+        case Quantity::Speed:
+            return step.velocity(tau).magnitude();
+        case Quantity::Airspeed:
+            return step.airVelocity(tau).magnitude();
+        case Quantity::Alpha:
+        default:
+            return step.alphaDeg(tau);
+        }
+    }
+
+    static double stateValue(Quantity quantity, const FlightState &state)
+    {
+        return quantity == Quantity::Altitude ? state.position.y : state.velocity.magnitude();
+    }
+
+    static bool armCapture(Watch &w, const FlightParams &params, double &threshold)
+    {
+        bool speed = w.quantity == Quantity::Airspeed;
+        bool engaged = speed ? params.autopilot_speed : params.autopilot_altitude;
+        double setpoint = speed ? params.speed_setpoint : params.altitude_setpoint;
+        if (engaged && (!w.engaged || setpoint != w.setpoint))
+            w.armed = true;
+        w.engaged = engaged;
+        w.setpoint = setpoint;
+        threshold = setpoint;
+        return engaged && w.armed;
+    }
+
+    // Angle of attack is only meaningful with air flowing past the wing, and
+    // a jump by more than half a turn is the wrap at +/-180, not a crossing
+    static bool alphaContinuous(const StepInterpolant &step, double g0, double g1)
+    {
+        const double min_airspeed = 1.0; // m/s
+        return std::fabs(g1 - g0) < 180.0 && step.airVelocity(0.0).magnitude() > min_airspeed &&
+               step.airVelocity(step.duration()).magnitude() > min_airspeed;
+    }
+
+    // The stop condition checks made at the end of a step
+    bool violatedAtEnd(const Watch &w, const FlightState &after) const
+    {
+        double v = stateValue(w.quantity, after);
+        if (w.ground)
+            return airborne && v <= 0.0;
+        return w.direction > 0 ? v > w.threshold : v < w.threshold;
+    }
+};
@@ -0,0 +1,370 @@
+#pragma once
+
+#include "physics_update.hpp"
+#include "../core/thread_pool.hpp"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Longitudinal state-space models around an operating point
+//
+// State x = [vx, vz, pitch, pitch rate, altitude] in the simulation's own
+// units (m/s, deg, deg/s, m), input u = [throttle, elevator]. The continuous
+// dynamics xdot = f(x, u) use the same force model and pitch response as the
+// physics step, so the Jacobians A = df/dx and B = df/du describe what the
+// simulator actually flies. Horizontal position does not affect the dynamics
+// and is left out.
+
+enum LinearState
+{
+    LinVx,
+    LinVz,
+    LinPitch,
+    LinPitchRate,
+    LinAltitude,
+    LinStateCount
+};
+
+enum LinearInput
+{
+    LinThrottle,
+    LinElevator,
+    LinInputCount
+};
+
+using LinearStateVector = std::array<double, LinStateCount>;
+using LinearInputVector = std::array<double, LinInputCount>;
+
+// Flight condition to linearize around (need not be trimmed)
+struct OperatingPoint
+{
+    LinearStateVector x{};
+    LinearInputVector u{};
+
+    static OperatingPoint fromState(const SimulationState &state)
+    {
+        OperatingPoint p;
+        p.x = {state.velocity.x, state.velocity.y, state.pitch_deg, state.pitch_rate, state.position.y};
+        p.u = {state.throttle, state.elevator};
+        return p;
+    }
+
+    bool operator==(const OperatingPoint &other) const { return x == other.x && u == other.u; }
+};
+
+// xdot ~= xdot0 + A (x - x0) + B (u - u0)
+struct LinearModel
+{
+    OperatingPoint point;
+    LinearStateVector xdot{}; // f(x0, u0); zero at a trim point
+    std::array<std::array<double, LinStateCount>, LinStateCount> A{};
+    std::array<std::array<double, LinInputCount>, LinStateCount> B{};
+};
+
+// Continuous longitudinal dynamics, specialized like the physics step
+template <typename AeroModel, typename Math = ExactMath>
+inline void longitudinalDerivatives(const Aircraft &aircraft, const LinearStateVector &x,
+                                    const LinearInputVector &u, LinearStateVector &xdot)
+{
+    Vec2 velocity(x[LinVx], x[LinVz]);
+    double speed = velocity.magnitude();
+    double rho = Math::density(std::max(0.0, x[LinAltitude]));
+    double q_dynamic = 0.5 * rho * speed * speed;
+
+    ForceSet forces = computeForces<AeroModel, Math>(aircraft, velocity, speed, rho, x[LinPitch], u[LinThrottle]);
+    Vec2 acceleration = forces.net() / aircraft.mass;
+
+    xdot[LinVx] = acceleration.x;
+    xdot[LinVz] = acceleration.y;
+    xdot[LinPitch] = x[LinPitchRate];
+    xdot[LinPitchRate] = pitchAcceleration(u[LinElevator], x[LinPitchRate], q_dynamic);
+    xdot[LinAltitude] = x[LinVz];
+}
+
+using DerivativeFn = void (*)(const Aircraft &, const LinearStateVector &, const LinearInputVector &, LinearStateVector &);
+
+// Pick the derivative specialization for an aircraft, as selectPhysicsStep does
+inline DerivativeFn selectDerivatives(const Aircraft &aircraft, MathTier tier = MathTier::Exact)
+{
+    bool table = aircraft.hasAeroTable() && !aircraft.aeroTable->isEmpty();
+    if (table)
+        return tier == MathTier::Fast ? &longitudinalDerivatives<TableAeroModel, FastMath>
+                                      : &longitudinalDerivatives<TableAeroModel, ExactMath>;
+    return tier == MathTier::Fast ? &longitudinalDerivatives<LegacyAeroModel, FastMath>
+                                  : &longitudinalDerivatives<LegacyAeroModel, ExactMath>;
+}
+
+namespace linearizer_detail
+{
+    // Central-difference step, relative to the magnitude of the variable
+    inline double step(double value) { return 1e-5 * std::max(1.0, std::fabs(value)); }
+
+    // Column `column` of [A | B] (or xdot0 for column == LinStateCount + LinInputCount)
+    inline void evaluateColumn(DerivativeFn f, const Aircraft &aircraft, LinearModel &model, size_t column)
+    {
+        const OperatingPoint &p = model.point;
+        if (column == LinStateCount + LinInputCount)
+        {
+            f(aircraft, p.x, p.u, model.xdot);
+            return;
+        }
+
+        LinearStateVector x = p.x;
+        LinearInputVector u = p.u;
+        double *var = column < LinStateCount ? &x[column] : &u[column - LinStateCount];
+        double center = *var;
+        double h = step(center);
+
+        LinearStateVector plus, minus;
+        *var = center + h;
+        f(aircraft, x, u, plus);
+        *var = center - h;
+        f(aircraft, x, u, minus);
+
+        for (size_t row = 0; row < LinStateCount; row++)
+        {
+            double derivative = (plus[row] - minus[row]) / (2.0 * h);
+            if (column < LinStateCount)
+                model.A[row][column] = derivative;
+            else
+                model.B[row][column - LinStateCount] = derivative;
+        }
+    }
+
+    constexpr size_t ColumnsPerPoint = LinStateCount + LinInputCount + 1;
+}
+
+// Linearize one operating point (14 derivative evaluations)
+inline LinearModel linearize(const Aircraft &aircraft, const OperatingPoint &point, MathTier tier = MathTier::Exact)
+{
+    DerivativeFn f = selectDerivatives(aircraft, tier);
+    LinearModel model;
+    model.point = point;
+    for (size_t column = 0; column < linearizer_detail::ColumnsPerPoint; column++)
+        linearizer_detail::evaluateColumn(f, aircraft, model, column);
+    return model;
+}
+
+// Linearize many operating points; every perturbation column is an independent
+// work item, so both large grids and small batches spread over the pool
+inline std::vector<LinearModel> linearizeAll(const Aircraft &aircraft, const std::vector<OperatingPoint> &points,
+                                             ThreadPool &pool, MathTier tier = MathTier::Exact)
+{
+    DerivativeFn f = selectDerivatives(aircraft, tier);
+    std::vector<LinearModel> models(points.size());
+    for (size_t i = 0; i < points.size(); i++)
+        models[i].point = points[i];
+
+    const size_t columns = linearizer_detail::ColumnsPerPoint;
+    pool.parallelFor(points.size() * columns, 256, [&](size_t begin, size_t end)
+                     {
+        for (size_t item = begin; item < end; item++)
+            linearizer_detail::evaluateColumn(f, aircraft, models[item / columns], item % columns); });
+    return models;
+}
+
+// Level-flight trim at a speed and altitude: pitch and throttle such that
+// both accelerations vanish with the elevator centered and no pitch rate.
+// Returns nothing if it would need throttle outside [0, 1] or does not converge.
+inline std::optional<OperatingPoint> trimLevelFlight(const Aircraft &aircraft, double speed, double altitude,
+                                                     MathTier tier = MathTier::Exact)
+{
+    DerivativeFn f = selectDerivatives(aircraft, tier);
+    OperatingPoint p;
+    p.x = {speed, 0.0, 5.0, 0.0, altitude};
+    p.u = {0.5, 0.0};
+
+    auto residual = [&](double pitch, double throttle, double &ax, double &az)
+    {
+        LinearStateVector x = p.x;
+        LinearInputVector u = p.u;
+        x[LinPitch] = pitch;
+        u[LinThrottle] = throttle;
+        LinearStateVector xdot;
+        f(aircraft, x, u, xdot);
+        ax = xdot[LinVx];
+        az = xdot[LinVz];
+    };
+
+    // Newton iteration on (pitch, throttle) with a finite-difference Jacobian
+    for (int iteration = 0; iteration < 50; iteration++)
+    {
+        double pitch = p.x[LinPitch], throttle = p.u[LinThrottle];
+        double ax, az;
+        residual(pitch, throttle, ax, az);
+        if (std::fabs(ax) < 1e-9 && std::fabs(az) < 1e-9)
+        {
+            if (throttle < 0.0 || throttle > 1.0)
+                return std::nullopt;
+            return p;
+        }
+
+        const double hp = 1e-4, ht = 1e-4;
+        double ax_p, az_p, ax_t, az_t;
+        residual(pitch + hp, throttle, ax_p, az_p);
+        residual(pitch, throttle + ht, ax_t, az_t);
+        double j11 = (ax_p - ax) / hp, j12 = (ax_t - ax) / ht;
+        double j21 = (az_p - az) / hp, j22 = (az_t - az) / ht;
+        double det = j11 * j22 - j12 * j21;
+        if (std::fabs(det) < 1e-12)
+            return std::nullopt;
+
+        // Limit the pitch step so the iteration stays on the linear part of the lift curve
+        double dPitch = std::clamp((-ax * j22 + az * j12) / det, -5.0, 5.0);
+        double dThrottle = (-az * j11 + ax * j21) / det;
+        p.x[LinPitch] = pitch + dPitch;
+        p.u[LinThrottle] = throttle + dThrottle;
+    }
+    return std::nullopt;
+}
+
+// Thread-safe cache of linear models per aircraft and operating point
+//
+// Aircraft are identified by their mass, geometry, coefficients and aero
+// table instance, so copies of the same configuration share entries. Entries
+// hold a reference to their aero table, so a table stays alive (and its
+// address cannot be reused by another table) until clear().
+class LinearizationCache
+{
+public:
+    // Cached model, computed on first use
+    LinearModel get(const Aircraft &aircraft, const OperatingPoint &point, MathTier tier = MathTier::Exact)
+    {
+        Key key = makeKey(aircraft, point, tier);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (it != entries.end())
+            {
+                hitCount++;
+                return it->second;
+            }
+        }
+        LinearModel model = linearize(aircraft, point, tier);
+        std::lock_guard<std::mutex> lock(mutex);
+        missCount++;
+        entries.emplace(key, model);
+        return model;
+    }
+
+    // Models for a whole grid; only the missing points are linearized, in parallel
+    std::vector<LinearModel> getAll(const Aircraft &aircraft, const std::vector<OperatingPoint> &points,
+                                    ThreadPool &pool, MathTier tier = MathTier::Exact)
+    {
+        std::vector<LinearModel> models(points.size());
+        std::vector<OperatingPoint> missing;
+        std::vector<size_t> missingIndex;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                auto it = entries.find(makeKey(aircraft, points[i], tier));
+                if (it != entries.end())
+                {
+                    models[i] = it->second;
+                    hitCount++;
+                }
+                else
+                {
+                    missing.push_back(points[i]);
+                    missingIndex.push_back(i);
+                }
+            }
+        }
+
+        std::vector<LinearModel> computed = linearizeAll(aircraft, missing, pool, tier);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t j = 0; j < computed.size(); j++)
+        {
+            models[missingIndex[j]] = computed[j];
+            entries.emplace(makeKey(aircraft, missing[j], tier), computed[j]);
+        }
+        missCount += computed.size();
+        return models;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    uint64_t hits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hitCount;
+    }
+
+    uint64_t misses() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return missCount;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+    }
+
+private:
+    struct Key
+    {
+        std::array<double, 6> aircraft; // mass, S, CL_alpha, CD0, k, maxThrust
+        std::shared_ptr<const AeroDataTable> table; // Compared by instance
+        OperatingPoint point;
+        MathTier tier;
+
+        bool operator==(const Key &other) const
+        {
+            return aircraft == other.aircraft && table == other.table && point == other.point && tier == other.tier;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            uint64_t h = 1469598103934665603ull; // FNV-1a over the raw values
+            auto mix = [&h](double value)
+            {
+                if (value == 0.0)
+                    value = 0.0; // -0.0 == 0.0, so both must hash alike
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                h = (h ^ bits) * 1099511628211ull;
+            };
+            for (double v : key.aircraft)
+                mix(v);
+            for (double v : key.point.x)
+                mix(v);
+            for (double v : key.point.u)
+                mix(v);
+            h = (h ^ reinterpret_cast<uintptr_t>(key.table.get())) * 1099511628211ull;
+            h = (h ^ static_cast<uint64_t>(key.tier)) * 1099511628211ull;
+            return static_cast<size_t>(h);
+        }
+    };
+
+    static Key makeKey(const Aircraft &aircraft, const OperatingPoint &point, MathTier tier)
+    {
+        bool table = aircraft.hasAeroTable() && !aircraft.aeroTable->isEmpty();
+        return Key{{aircraft.mass, aircraft.S, aircraft.CL_alpha, aircraft.CD0, aircraft.k, aircraft.maxThrust},
+                   table ? aircraft.aeroTable : nullptr,
+                   point,
+                   tier};
+    }
+
+    mutable std::mutex mutex;
+    std::unordered_map<Key, LinearModel, KeyHash> entries;
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+};
@@ -4,139 +4,474 @@
 #include "../environment/atmosphere.hpp"
 #include "../aerodynamics/aero.hpp"
 #include "../core/integrator.hpp"
+#include "../core/fast_math.hpp"
+#include "../core/dual.hpp"
+#include "../control/gain_schedule.hpp"
 #include <cmath>
 #include <algorithm>
+#include <type_traits>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// Update simulation physics for one timestep
-inline void updatePhysics(SimulationState &state)
+// Scalar type of the force model for a state type: coefficients and force
+// magnitudes are evaluated in double for float and double states, and in the
+// state's own type for dual numbers (sensitivity runs)
+template <typename T>
+using PhysicsScalarT = std::conditional_t<std::is_floating_point<T>::value, double, T>;
+
+// Aerodynamic model policies
+// The physics step is instantiated once per model, so the choice between the
+// table and the legacy analytic coefficients is made at compile time.
+// A is the Aircraft, or an AirframeT whose parameters are dual numbers
+// (sensitivity.hpp); P is the physics scalar type.
+struct TableAeroModel
 {
-    if (state.paused)
-        return;
+    template <typename A, typename P>
+    static void coefficients(const A &aircraft, const P &alpha, P &CL, P &CD)
+    {
+        // Dispatcher only selects this model for a loaded, non-empty table
+        CL = aircraft.aeroTable->getCL(alpha);
+        CD = P(aircraft.CD0) + aircraft.aeroTable->getCD(alpha);
+    }
+};
 
-    double altitude = state.position.y;
-    double speed = state.velocity.magnitude();
+struct LegacyAeroModel
+{
+    template <typename A, typename P>
+    static void coefficients(const A &aircraft, const P &alpha, P &CL, P &CD)
+    {
+        CL = calcCL(alpha, P(aircraft.CL_alpha));
+        CD = calcCD(CL, P(aircraft.CD0), P(aircraft.k));
+    }
+};
 
-    // Autopilot: Speed control with PID
-    if (state.autopilot_speed)
+// Math tier policies for the transcendental calls in the step
+// The angle functions take the state's precision (double or float); the
+// density is always evaluated in double. The exact tier also takes dual
+// numbers (found by argument-dependent lookup).
+struct ExactMath
+{
+    template <typename T>
+    static T atan2(T y, T x)
     {
-        if (state.pid_kp != state.prev_pid_kp || state.pid_ki != state.prev_pid_ki || state.pid_kd != state.prev_pid_kd)
-        {
-            state.speed_pid = PIDController(state.pid_kp, state.pid_ki, state.pid_kd, 0.0, 1.0);
-            state.prev_pid_kp = state.pid_kp;
-            state.prev_pid_ki = state.pid_ki;
-            state.prev_pid_kd = state.pid_kd;
-        }
-        state.throttle = static_cast<float>(state.speed_pid.update(state.speed_setpoint, speed, state.dt));
+        using std::atan2;
+        return atan2(y, x);
     }
 
-    // Autopilot: Altitude control with PID (outputs elevator command)
-    if (state.autopilot_altitude)
+    template <typename T>
+    static void sincos(T angle, T &s, T &c)
     {
-        if (state.alt_pid_kp != state.prev_alt_pid_kp || state.alt_pid_ki != state.prev_alt_pid_ki || state.alt_pid_kd != state.prev_alt_pid_kd)
-        {
-            state.altitude_pid = PIDController(state.alt_pid_kp, state.alt_pid_ki, state.alt_pid_kd, -1.0, 1.0);
-            state.prev_alt_pid_kp = state.alt_pid_kp;
-            state.prev_alt_pid_ki = state.alt_pid_ki;
-            state.prev_alt_pid_kd = state.alt_pid_kd;
-        }
-        // PID outputs elevator deflection based on altitude error
-        double altitude_error = state.altitude_setpoint - altitude;
-        state.elevator = static_cast<float>(state.altitude_pid.update(state.altitude_setpoint, altitude, state.dt));
+        using std::cos;
+        using std::sin;
+        s = sin(angle);
+        c = cos(angle);
     }
 
-    // Flight control: Elevator controls pitch rate
-    // Simplified model: pitch_rate proportional to elevator and dynamic pressure
-    double q_dynamic = 0.5 * getDensity(std::max(0.0, altitude)) * speed * speed;
-    double pitch_authority = 50.0; // deg/s per elevator unit at unit dynamic pressure
-    double target_pitch_rate = state.elevator * pitch_authority * std::min(1.0, q_dynamic / 500.0);
+    static double density(double altitude) { return getDensity(altitude); }
+};
+
+// Polynomial kernels, see fast_math.hpp for error bounds
+// The kernels are double only; float callers get the rounded result.
+struct FastMath
+{
+    template <typename T>
+    static T atan2(T y, T x) { return static_cast<T>(fastAtan2(y, x)); }
+
+    template <typename T>
+    static void sincos(T angle, T &s, T &c)
+    {
+        double sd, cd;
+        fastSinCos(angle, sd, cd);
+        s = static_cast<T>(sd);
+        c = static_cast<T>(cd);
+    }
+
+    static double density(double altitude) { return getDensityFast(altitude); }
+};
+
+// Load edited fixed gains into the autopilot controllers, in place
+// Done once per run (or per frame in the GUI) instead of inside the step.
+// Integrator state survives the change. With gain scheduling active the step
+// loads the scheduled gains itself.
+inline void syncControllerGains(const FlightParams &params, FlightControllers &controllers)
+{
+    if (params.gainsScheduled())
+        return;
+
+    PIDController &speed = controllers.speed_pid;
+    if (speed.getKp() != params.pid_kp || speed.getKi() != params.pid_ki || speed.getKd() != params.pid_kd)
+        speed.setGains(params.pid_kp, params.pid_ki, params.pid_kd);
+
+    PIDController &alt = controllers.altitude_pid;
+    if (alt.getKp() != params.alt_pid_kp || alt.getKi() != params.alt_pid_ki || alt.getKd() != params.alt_pid_kd)
+        alt.setGains(params.alt_pid_kp, params.alt_pid_ki, params.alt_pid_kd);
+}
 
-    // Simple pitch damping and response
+inline void syncControllerGains(SimulationState &state)
+{
+    syncControllerGains(state, state);
+}
+
+// Load the scheduled gains for the current flight condition into the engaged loops
+template <bool SpeedAutopilot, bool AltitudeAutopilot, typename Controllers>
+inline void applyScheduledGains(const FlightParams &params, Controllers &controllers, double q_dynamic, double altitude)
+{
+    ScheduledGains gains = params.aircraft.gainSchedule->lookup(q_dynamic, altitude);
+    if constexpr (SpeedAutopilot)
+        controllers.speed_pid.setGains(gains.speed[0], gains.speed[1], gains.speed[2]);
+    if constexpr (AltitudeAutopilot)
+        controllers.altitude_pid.setGains(gains.altitude[0], gains.altitude[1], gains.altitude[2]);
+}
+
+// Pitch response to the elevator (deg/s^2)
+// The elevator commands a pitch rate proportional to dynamic pressure
+// (saturating at 500 Pa), which the airframe follows with first-order damping.
+template <typename T>
+inline T pitchAcceleration(const T &elevator, const T &pitch_rate, const T &q_dynamic)
+{
+    double pitch_authority = 50.0; // deg/s per elevator unit at unit dynamic pressure
+    T target_pitch_rate = elevator * pitch_authority * std::min(T(1.0), q_dynamic / 500.0);
     double pitch_damping = 5.0; // Natural damping
-    double pitch_acceleration = (target_pitch_rate - state.pitch_rate) * pitch_damping;
-    state.pitch_rate += static_cast<float>(pitch_acceleration * state.dt);
-    state.pitch_deg += state.pitch_rate * static_cast<float>(state.dt);
+    return (target_pitch_rate - pitch_rate) * pitch_damping;
+}
 
-    // Normalize pitch angle to [-180, 180] degrees to allow loops
-    while (state.pitch_deg > 180.0f)
-        state.pitch_deg -= 360.0f;
-    while (state.pitch_deg < -180.0f)
-        state.pitch_deg += 360.0f;
+// Forces acting on the aircraft in one flight condition
+template <typename T>
+struct ForceSetT
+{
+    Vec2T<T> thrust;
+    Vec2T<T> drag;
+    Vec2T<T> lift;
+    Vec2T<T> weight;
+    T alpha; // Angle of attack (rad)
 
-    // Calculate angle of attack from pitch and velocity direction
-    Vec2 velocityDir = (speed > 1e-6) ? state.velocity.normalized() : Vec2(1.0, 0.0);
-    double velocity_angle = std::atan2(state.velocity.y, state.velocity.x); // Flight path angle
-    double pitch_rad = state.pitch_deg * M_PI / 180.0;
-    double alpha = pitch_rad - velocity_angle; // AoA = pitch - flight path angle
-    state.alpha_deg = static_cast<float>(alpha * 180.0 / M_PI);
+    Vec2T<T> net() const { return thrust + drag + lift + weight; }
+};
+
+using ForceSet = ForceSetT<double>;
 
-    // Get atmospheric properties
-    double rho = getDensity(std::max(0.0, altitude));
+// Force model shared by the physics step and the linearizer
+// Thrust is aligned with pitch, lift and drag with the velocity vector.
+// T (double or float) follows the velocity; aerodynamic coefficients and
+// force magnitudes come from the double aero module and are rounded to T.
+// With dual numbers everything is evaluated in T, and the aircraft may be an
+// AirframeT carrying parameter derivatives.
+template <typename AeroModel, typename Math = ExactMath, typename T, typename A>
+inline ForceSetT<T> computeForces(const A &aircraft, const Vec2T<T> &velocity,
+                                  typename Vec2T<T>::value_type speed, typename Vec2T<T>::value_type rho,
+                                  typename Vec2T<T>::value_type pitch_deg, typename Vec2T<T>::value_type throttle)
+{
+    ForceSetT<T> f;
+
+    // Calculate angle of attack from pitch and velocity direction
+    Vec2T<T> velocityDir = (speed > T(1e-6)) ? velocity / speed : Vec2T<T>(T(1), T(0));
+    T velocity_angle = Math::atan2(velocity.y, velocity.x); // Flight path angle
+    T pitch_rad = pitch_deg * T(M_PI) / T(180.0);
+    f.alpha = pitch_rad - velocity_angle; // AoA = pitch - flight path angle
 
     // Calculate aerodynamic coefficients
-    double CL, CD;
-    if (state.aircraft.hasAeroTable())
+    using P = PhysicsScalarT<T>;
+    P CL, CD;
+    AeroModel::coefficients(aircraft, P(f.alpha), CL, CD);
+
+    // Calculate force magnitudes
+    T L_mag = static_cast<T>(calcLift(P(rho), P(speed), P(aircraft.S), CL));
+    T D_mag = static_cast<T>(calcDrag(P(rho), P(speed), P(aircraft.S), CD));
+    T W_mag = static_cast<T>(calcWeight(P(aircraft.mass), P(g)));
+    T T_mag = static_cast<T>(calcThrust(P(throttle), P(aircraft.maxThrust)));
+
+    // Force vectors
+    T sin_pitch, cos_pitch;
+    Math::sincos(pitch_rad, sin_pitch, cos_pitch);
+    Vec2T<T> thrust_dir(cos_pitch, sin_pitch);
+    f.thrust = thrust_dir * T_mag;
+    f.drag = (speed > T(1e-6)) ? velocityDir * (-D_mag) : Vec2T<T>(T(0), T(0));
+    f.lift = velocityDir.perpendicular() * L_mag;
+    f.weight = Vec2T<T>(T(0), -W_mag);
+    return f;
+}
+
+// Flight condition at the start of a step
+template <typename T>
+struct FlightConditionT
+{
+    Vec2T<T> air_velocity; // Velocity relative to the air mass
+    T speed;               // Airspeed
+    T rho;                 // Air density (kg/m^3)
+    T q_dynamic;           // Dynamic pressure (Pa)
+};
+
+using FlightCondition = FlightConditionT<double>;
+
+// Velocity relative to the air (the ground velocity in still air)
+template <typename T>
+inline Vec2T<T> airVelocity(const FlightStateT<T> &flight, const FlightParams &params)
+{
+    if (!params.wind.active())
+        return flight.velocity;
+    Vec2 wind = params.wind.at(scalarValue(flight.position.x), scalarValue(flight.t));
+    return flight.velocity - Vec2T<T>(wind);
+}
+
+// Air density from the parameter block's atmosphere profile, or standard ISA
+// through the math tier
+template <typename Math = ExactMath>
+inline double airDensity(const FlightParams &params, double altitude)
+{
+    if (params.atmosphere)
+        return params.atmosphere->density(altitude);
+    return Math::density(altitude);
+}
+
+// Air density at a dual-number altitude: the value as above (exact tier), the
+// derivatives through the density gradient (zero on and below the ground)
+template <size_t N>
+inline Dual<N> airDensity(const FlightParams &params, const Dual<N> &altitude)
+{
+    double h = altitude.v;
+    if (h <= 0.0)
+        return Dual<N>(airDensity(params, 0.0));
+    double slope = params.atmosphere ? params.atmosphere->densityGradient(h) : getDensityGradient(h);
+    return Dual<N>::apply(altitude, airDensity(params, h), slope);
+}
+
+template <typename Math = ExactMath, typename T>
+inline FlightConditionT<T> flightCondition(const FlightStateT<T> &flight, const FlightParams &params)
+{
+    FlightConditionT<T> c;
+    c.air_velocity = airVelocity(flight, params);
+    c.speed = c.air_velocity.magnitude();
+    if constexpr (IsDual<T>::value)
+        c.rho = airDensity(params, flight.position.y);
+    else
+        c.rho = static_cast<T>(airDensity<Math>(params, std::max(0.0, static_cast<double>(flight.position.y))));
+    c.q_dynamic = T(0.5) * c.rho * c.speed * c.speed;
+    return c;
+}
+
+// Dynamics of one step with the controls already set: pitch response, forces,
+// integration and the ground constraint. Reads only the hot state and the
+// parameter block, so batches can stream FlightState arrays through it.
+// Returns the forces for visualization. The aircraft is passed separately
+// so sensitivity runs can substitute an AirframeT (see computeForces).
+template <typename AeroModel, typename Integrator, typename Math = ExactMath, typename T, typename A>
+inline ForceSetT<T> advanceFlight(FlightStateT<T> &flight, const FlightParams &params, const A &aircraft,
+                                  const FlightConditionT<T> &condition)
+{
+    using C = FlightControlT<T>;
+    using P = PhysicsScalarT<T>;
+    const T dt = static_cast<T>(params.dt);
+
+    // Flight control: Elevator controls pitch rate
+    // Simplified model: pitch_rate proportional to elevator and dynamic pressure
+    P pitch_acceleration = pitchAcceleration<P>(flight.elevator, flight.pitch_rate, condition.q_dynamic);
+    flight.pitch_rate += static_cast<C>(pitch_acceleration * params.dt);
+    flight.pitch_deg += flight.pitch_rate * static_cast<C>(params.dt);
+
+    // Normalize pitch angle to [-180, 180] degrees to allow loops
+    while (flight.pitch_deg > C(180.0f))
+        flight.pitch_deg -= C(360.0f);
+    while (flight.pitch_deg < C(-180.0f))
+        flight.pitch_deg += C(360.0f);
+
+    // Forces at the updated attitude, from the velocity relative to the air
+    ForceSetT<T> forces = computeForces<AeroModel, Math>(aircraft, condition.air_velocity, condition.speed, condition.rho,
+                                                         flight.pitch_deg, flight.throttle);
+    flight.alpha_deg = static_cast<C>(forces.alpha * T(180.0) / T(M_PI));
+
+    // Net force and acceleration
+    Vec2T<T> acceleration = forces.net() / static_cast<T>(aircraft.mass);
+
+    // Integrate position and velocity
+    Integrator::step(flight.position, flight.velocity, acceleration, dt);
+
+    // Ground constraint
+    if (flight.position.y < T(0))
     {
-        // Use table-based data
-        CL = calcCL(alpha, state.aircraft.aeroTable.get());
-        CD = calcCD(alpha, state.aircraft.CD0, state.aircraft.aeroTable.get());
+        flight.position.y = T(0);
+        if (flight.velocity.y < T(0))
+            flight.velocity.y = T(0);
+        if (flight.velocity.magnitude() < T(0.1) && flight.throttle < 0.01)
+            flight.velocity = Vec2T<T>(T(0), T(0));
     }
-    else
+
+    flight.t += dt;
+    return forces;
+}
+
+template <typename AeroModel, typename Integrator, typename Math = ExactMath, typename T>
+inline ForceSetT<T> advanceFlight(FlightStateT<T> &flight, const FlightParams &params, const FlightConditionT<T> &condition)
+{
+    return advanceFlight<AeroModel, Integrator, Math>(flight, params, params.aircraft, condition);
+}
+
+// Autopilot for one step: gains for this flight condition (one table lookup
+// for both loops), then the engaged loops set throttle and elevator.
+// Controllers is FlightControllers, or the dual-number controllers of a
+// sensitivity run.
+template <bool SpeedAutopilot, bool AltitudeAutopilot, typename T, typename Controllers>
+inline void runAutopilot(FlightStateT<T> &flight, const FlightParams &params, Controllers &controllers,
+                         const FlightConditionT<T> &condition)
+{
+    using C = FlightControlT<T>;
+    const T altitude = flight.position.y;
+
+    if constexpr (SpeedAutopilot || AltitudeAutopilot)
     {
-        // Use legacy linear/parabolic model
-        CL = calcCL(alpha, state.aircraft.CL_alpha);
-        CD = calcCD(CL, state.aircraft.CD0, state.aircraft.k);
+        if (params.gainsScheduled())
+            applyScheduledGains<SpeedAutopilot, AltitudeAutopilot>(params, controllers, scalarValue(condition.q_dynamic),
+                                                                   scalarValue(altitude));
     }
 
-    // Calculate force magnitudes
-    double L_mag = calcLift(rho, speed, state.aircraft.S, CL);
-    double D_mag = calcDrag(rho, speed, state.aircraft.S, CD);
-    double W_mag = calcWeight(state.aircraft.mass, g);
-    double T_mag = calcThrust(state.throttle, state.aircraft.maxThrust);
-
-    // Force vectors (thrust aligned with pitch, lift/drag with velocity)
-    Vec2 thrust_dir(std::cos(pitch_rad), std::sin(pitch_rad));
-    Vec2 F_thrust = thrust_dir * T_mag;
-    Vec2 F_drag = (speed > 1e-6) ? velocityDir * (-D_mag) : Vec2(0.0, 0.0);
-    Vec2 F_lift = velocityDir.rotated(M_PI / 2.0) * L_mag;
-    Vec2 F_weight(0.0, -W_mag);
+    // Autopilot: Speed control with PID (holds airspeed)
+    if constexpr (SpeedAutopilot)
+    {
+        flight.throttle = static_cast<C>(controllers.speed_pid.update(params.speed_setpoint, condition.speed, params.dt));
+    }
 
-    // Net force and acceleration
-    Vec2 F_net = F_thrust + F_drag + F_lift + F_weight;
-    Vec2 acceleration = F_net / state.aircraft.mass;
+    // Autopilot: Altitude control with PID (outputs elevator command)
+    if constexpr (AltitudeAutopilot)
+    {
+        // PID outputs elevator deflection based on altitude error
+        flight.elevator = static_cast<C>(controllers.altitude_pid.update(params.altitude_setpoint, altitude, params.dt));
+    }
+}
+
+// One physics timestep, specialized on aero model, autopilot configuration,
+// integrator and math tier. All configuration branches are resolved at compile time.
+template <typename AeroModel, bool SpeedAutopilot, bool AltitudeAutopilot, typename Integrator, typename Math = ExactMath>
+inline void stepPhysics(SimulationState &state)
+{
+    FlightCondition condition = flightCondition<Math>(state, state);
+    runAutopilot<SpeedAutopilot, AltitudeAutopilot>(state, state, static_cast<FlightControllers &>(state), condition);
+
+    ForceSet forces = advanceFlight<AeroModel, Integrator, Math>(state, state, condition);
 
     // Store force vectors for visualization
-    state.F_thrust_viz = F_thrust;
-    state.F_drag_viz = F_drag;
-    state.F_lift_viz = F_lift;
-    state.F_weight_viz = F_weight;
+    state.F_thrust_viz = forces.thrust;
+    state.F_drag_viz = forces.drag;
+    state.F_lift_viz = forces.lift;
+    state.F_weight_viz = forces.weight;
 
-    // Integrate using RK4
-    integrateRK4(state.position, state.velocity, acceleration, state.dt);
+    // Update flight path (maxPathPoints = 0 disables recording)
+    if (state.maxPathPoints > 0)
+    {
+        if (state.flightPath.size() >= static_cast<size_t>(state.maxPathPoints))
+            state.flightPath.erase(state.flightPath.begin());
+        state.flightPath.push_back({static_cast<float>(state.position.x), static_cast<float>(state.position.y)});
+    }
+}
 
-    // Ground constraint
-    if (state.position.y < 0.0)
+// Pointer to one specialization of stepPhysics
+using PhysicsStepFn = void (*)(SimulationState &);
+
+namespace physics_detail
+{
+    template <typename AeroModel, bool SpeedAutopilot, bool AltitudeAutopilot, typename Integrator>
+    inline PhysicsStepFn selectMath(MathTier tier)
     {
-        state.position.y = 0.0;
-        if (state.velocity.y < 0.0)
-            state.velocity.y = 0.0;
-        if (state.velocity.magnitude() < 0.1 && state.throttle < 0.01)
-            state.velocity = Vec2(0.0, 0.0);
+        if (tier == MathTier::Fast)
+            return &stepPhysics<AeroModel, SpeedAutopilot, AltitudeAutopilot, Integrator, FastMath>;
+        return &stepPhysics<AeroModel, SpeedAutopilot, AltitudeAutopilot, Integrator, ExactMath>;
     }
 
-    // Update flight path
-    if (state.flightPath.size() < static_cast<size_t>(state.maxPathPoints))
+    template <typename AeroModel, bool SpeedAutopilot, bool AltitudeAutopilot>
+    inline PhysicsStepFn selectIntegrator(IntegratorType integrator, MathTier tier)
     {
-        state.flightPath.push_back({static_cast<float>(state.position.x), static_cast<float>(state.position.y)});
+        switch (integrator)
+        {
+        case IntegratorType::SemiImplicitEuler:
+            return selectMath<AeroModel, SpeedAutopilot, AltitudeAutopilot, SemiImplicitEulerIntegrator>(tier);
+        case IntegratorType::RK4:
+        default:
+            return selectMath<AeroModel, SpeedAutopilot, AltitudeAutopilot, RK4Integrator>(tier);
+        }
     }
-    else
+
+    template <typename AeroModel>
+    inline PhysicsStepFn selectAutopilot(bool speed, bool altitude, IntegratorType integrator, MathTier tier)
     {
-        state.flightPath.erase(state.flightPath.begin());
-        state.flightPath.push_back({static_cast<float>(state.position.x), static_cast<float>(state.position.y)});
+        if (speed && altitude)
+            return selectIntegrator<AeroModel, true, true>(integrator, tier);
+        if (speed)
+            return selectIntegrator<AeroModel, true, false>(integrator, tier);
+        if (altitude)
+            return selectIntegrator<AeroModel, false, true>(integrator, tier);
+        return selectIntegrator<AeroModel, false, false>(integrator, tier);
     }
+}
+
+// Pick the step specialization matching the state's current configuration
+// Call once per run and then invoke the returned function in the hot loop.
+// The result must be re-selected if the aircraft, autopilot switches,
+// integrator or math tier change.
+inline PhysicsStepFn selectPhysicsStep(const SimulationState &state)
+{
+    bool table = state.aircraft.hasAeroTable() && !state.aircraft.aeroTable->isEmpty();
+    if (table)
+        return physics_detail::selectAutopilot<TableAeroModel>(state.autopilot_speed, state.autopilot_altitude, state.integrator, state.math_tier);
+    return physics_detail::selectAutopilot<LegacyAeroModel>(state.autopilot_speed, state.autopilot_altitude, state.integrator, state.math_tier);
+}
+
+// Advance a contiguous run of aircraft sharing one parameter block, with the
+// controls already set (no autopilot, no visualization data)
+template <typename AeroModel, typename Integrator, typename Math, typename T>
+inline void advanceFlightRange(FlightStateT<T> *flights, size_t count, const FlightParams &params)
+{
+    for (size_t i = 0; i < count; i++)
+        advanceFlight<AeroModel, Integrator, Math>(flights[i], params, flightCondition<Math>(flights[i], params));
+}
+
+// Pointer to one specialization of advanceFlightRange
+template <typename T>
+using FlightRangeFnT = void (*)(FlightStateT<T> *, size_t, const FlightParams &);
+using FlightRangeFn = FlightRangeFnT<double>;
+
+namespace physics_detail
+{
+    template <typename T, typename AeroModel, typename Integrator>
+    inline FlightRangeFnT<T> selectRangeMath(MathTier tier)
+    {
+        if (tier == MathTier::Fast)
+            return &advanceFlightRange<AeroModel, Integrator, FastMath, T>;
+        return &advanceFlightRange<AeroModel, Integrator, ExactMath, T>;
+    }
+
+    template <typename T, typename AeroModel>
+    inline FlightRangeFnT<T> selectRangeIntegrator(IntegratorType integrator, MathTier tier)
+    {
+        switch (integrator)
+        {
+        case IntegratorType::SemiImplicitEuler:
+            return selectRangeMath<T, AeroModel, SemiImplicitEulerIntegrator>(tier);
+        case IntegratorType::RK4:
+        default:
+            return selectRangeMath<T, AeroModel, RK4Integrator>(tier);
+        }
+    }
+}
+
+// Pick the range specialization for a parameter block and state precision
+// (autopilot settings are ignored; batches run their controllers separately)
+template <typename T = double>
+inline FlightRangeFnT<T> selectFlightRange(const FlightParams &params)
+{
+    bool table = params.aircraft.hasAeroTable() && !params.aircraft.aeroTable->isEmpty();
+    if (table)
+        return physics_detail::selectRangeIntegrator<T, TableAeroModel>(params.integrator, params.math_tier);
+    return physics_detail::selectRangeIntegrator<T, LegacyAeroModel>(params.integrator, params.math_tier);
+}
+
+// Update simulation physics for one timestep
+// Convenience entry point for interactive use, where the configuration can
+// change between any two steps: syncs gains and re-selects every call.
+inline void updatePhysics(SimulationState &state)
+{
+    if (state.paused)
+        return;
 
-    state.t += state.dt;
+    syncControllerGains(state);
+    selectPhysicsStep(state)(state);
 }
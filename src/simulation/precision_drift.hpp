@@ -0,0 +1,165 @@
+#pragma once
+
+#include "flight_batch.hpp"
+#include "linearizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Drift of the float state path against the double reference
+//
+// Flies the same lanes in a FlightBatch and a FlightBatchF side by side and
+// records how far the float trajectories wander from the double ones. The
+// PrecisionCheck tool runs this for every aircraft config and maneuver so the
+// float mode can be judged per use case: neutrally stable open-loop flight
+// drifts steadily, closed loops pull both paths back together, and unstable
+// motion amplifies the rounding exponentially.
+
+enum class DriftManeuver
+{
+    Trim,      // Trimmed level flight at a spread of speeds (controls fixed)
+    OpenLoop,  // Fixed throttle and pitch settings: climbs, glides, dives
+    Autopilot  // Speed and altitude autopilot capturing new setpoints
+};
+
+inline const char *driftManeuverName(DriftManeuver maneuver)
+{
+    switch (maneuver)
+    {
+    case DriftManeuver::Trim:
+        return "trim";
+    case DriftManeuver::OpenLoop:
+        return "open_loop";
+    case DriftManeuver::Autopilot:
+    default:
+        return "autopilot";
+    }
+}
+
+struct DriftOptions
+{
+    double duration = 120.0; // Seconds of flight per maneuver
+    double dt = 0.01;
+    size_t lanes = 32;       // Aircraft per maneuver (spread of start conditions)
+    IntegratorType integrator = IntegratorType::RK4;
+    MathTier math_tier = MathTier::Exact;
+    double tolerance = 1.0;  // Position divergence (m) considered acceptable
+};
+
+struct DriftReport
+{
+    std::string maneuver;
+    size_t lanes = 0;
+    size_t steps = 0;
+    double max_position_error = 0.0;   // m, over all lanes and steps
+    double max_velocity_error = 0.0;   // m/s
+    double max_pitch_error = 0.0;      // deg
+    double final_position_rms = 0.0;   // m, RMS over lanes at the end
+    double time_to_tolerance = -1.0;   // s, first time any lane exceeds the tolerance (-1 = never)
+
+    bool withinTolerance() const { return time_to_tolerance < 0.0; }
+};
+
+// Parameters and start states of one maneuver
+inline std::vector<FlightState> driftStartStates(const Aircraft &aircraft, DriftManeuver maneuver,
+                                                 const DriftOptions &options, FlightParams &params)
+{
+    params = FlightParams();
+    params.aircraft = aircraft;
+    params.dt = options.dt;
+    params.integrator = options.integrator;
+    params.math_tier = options.math_tier;
+
+    std::vector<FlightState> starts;
+    const size_t lanes = std::max<size_t>(1, options.lanes);
+    const double spread = lanes > 1 ? 1.0 / static_cast<double>(lanes - 1) : 0.0;
+
+    for (size_t i = 0; i < lanes; i++)
+    {
+        double f = static_cast<double>(i) * spread; // 0..1 across the lanes
+        FlightState s;
+        s.position = Vec2(0.0, 300.0);
+
+        switch (maneuver)
+        {
+        case DriftManeuver::Trim:
+        {
+            // Speeds the aircraft cannot hold level are skipped
+            auto trim = trimLevelFlight(aircraft, 25.0 + 30.0 * f, 300.0, options.math_tier);
+            if (!trim)
+                continue;
+            s.velocity = Vec2(trim->x[LinVx], trim->x[LinVz]);
+            s.pitch_deg = static_cast<float>(trim->x[LinPitch]);
+            s.pitch_rate = static_cast<float>(trim->x[LinPitchRate]);
+            s.throttle = static_cast<float>(trim->u[LinThrottle]);
+            s.elevator = static_cast<float>(trim->u[LinElevator]);
+            break;
+        }
+        case DriftManeuver::OpenLoop:
+            s.velocity = Vec2(40.0, 0.0);
+            s.throttle = static_cast<float>(f);
+            s.pitch_deg = static_cast<float>(10.0 * std::fmod(7.0 * f, 1.0));
+            break;
+        case DriftManeuver::Autopilot:
+            params.autopilot_speed = true;
+            params.autopilot_altitude = true;
+            params.speed_setpoint = 45.0f;
+            params.altitude_setpoint = 350.0f;
+            s.velocity = Vec2(35.0 + 10.0 * f, 0.0);
+            s.pitch_deg = 5.0f;
+            s.throttle = 0.5f;
+            break;
+        }
+        starts.push_back(s);
+    }
+    return starts;
+}
+
+// Fly one maneuver in double and float and compare the trajectories
+inline DriftReport measureDrift(const Aircraft &aircraft, DriftManeuver maneuver, const DriftOptions &options)
+{
+    FlightParams params;
+    std::vector<FlightState> starts = driftStartStates(aircraft, maneuver, options, params);
+
+    DriftReport report;
+    report.maneuver = driftManeuverName(maneuver);
+    report.lanes = starts.size();
+    if (starts.empty())
+        return report;
+
+    FlightBatch reference(params, 1);
+    FlightBatchF single(params, 1);
+    for (const FlightState &s : starts)
+    {
+        reference.add(s);
+        single.add(convertFlightState<float>(s));
+    }
+
+    report.steps = static_cast<size_t>(std::llround(options.duration / options.dt));
+    for (size_t step = 1; step <= report.steps; step++)
+    {
+        reference.step();
+        single.step();
+
+        double sum_sq = 0.0;
+        for (size_t i = 0; i < report.lanes; i++)
+        {
+            const FlightState &d = reference[i];
+            const FlightState s = convertFlightState<double>(single[i]);
+            double position_error = (d.position - s.position).magnitude();
+            report.max_position_error = std::max(report.max_position_error, position_error);
+            report.max_velocity_error = std::max(report.max_velocity_error, (d.velocity - s.velocity).magnitude());
+            double pitch_error = std::fabs(static_cast<double>(d.pitch_deg) - s.pitch_deg);
+            pitch_error = std::min(pitch_error, 360.0 - pitch_error); // Across the +-180 wrap
+            report.max_pitch_error = std::max(report.max_pitch_error, pitch_error);
+            sum_sq += position_error * position_error;
+
+            if (report.time_to_tolerance < 0.0 && !(position_error <= options.tolerance))
+                report.time_to_tolerance = static_cast<double>(step) * options.dt;
+        }
+        if (step == report.steps)
+            report.final_position_rms = std::sqrt(sum_sq / static_cast<double>(report.lanes));
+    }
+    return report;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "physics_update.hpp"
+#include "../core/dual.hpp"
+#include <memory>
+
+// Trajectory sensitivities by forward-mode automatic differentiation
+//
+// The physics step is generic over its scalar type, so running it on dual
+// numbers seeded with the airframe parameters and autopilot gains gives the
+// trajectory and its derivatives with respect to all of them in one pass:
+// position.y.d[SensMass] is d(altitude)/d(mass) at the current time. The
+// derivatives are exact for the discrete step (same integrator, same table
+// segments, same clamps as the value run), which is what finite differences
+// of the simulator approximate.
+//
+// Scope: the exact math tier only; wind is evaluated at the trajectory but
+// not differentiated in space; scheduled gains are table values and carry no
+// derivative. Control and attitude members are doubles in a dual state where
+// the simulator keeps floats, so the values agree with a double run to float
+// rounding, not bit for bit.
+
+enum SensitivityParameter
+{
+    SensMass,
+    SensWingArea,
+    SensCD0,
+    SensInducedDrag, // k in CD = CD0 + k CL^2 (legacy model only)
+    SensMaxThrust,
+    SensSpeedKp,
+    SensSpeedKi,
+    SensSpeedKd,
+    SensAltitudeKp,
+    SensAltitudeKi,
+    SensAltitudeKd,
+    SensParameterCount
+};
+
+using SensitivityScalar = Dual<SensParameterCount>;
+
+inline const char *sensitivityParameterName(SensitivityParameter p)
+{
+    static const char *const names[SensParameterCount] = {
+        "mass", "S", "CD0", "k", "maxThrust",
+        "speed_kp", "speed_ki", "speed_kd", "alt_kp", "alt_ki", "alt_kd"};
+    return names[p];
+}
+
+// Airframe parameters in scalar type T, with the member names of Aircraft so
+// the force model takes either
+template <typename T>
+struct AirframeT
+{
+    T mass, S, CL_alpha, CD0, k, maxThrust;
+    std::shared_ptr<const AeroDataTable> aeroTable;
+
+    AirframeT() = default;
+    explicit AirframeT(const Aircraft &aircraft)
+        : mass(aircraft.mass), S(aircraft.S), CL_alpha(aircraft.CL_alpha), CD0(aircraft.CD0), k(aircraft.k),
+          maxThrust(aircraft.maxThrust), aeroTable(aircraft.aeroTable)
+    {
+    }
+};
+
+// One step in dual numbers, specialized like stepPhysics
+template <typename AeroModel, bool SpeedAutopilot, bool AltitudeAutopilot, typename Integrator>
+inline void stepSensitivity(FlightStateT<SensitivityScalar> &flight, const FlightParams &params,
+                            const AirframeT<SensitivityScalar> &airframe,
+                            FlightControllersT<SensitivityScalar> &controllers)
+{
+    FlightConditionT<SensitivityScalar> condition = flightCondition<ExactMath>(flight, params);
+    runAutopilot<SpeedAutopilot, AltitudeAutopilot>(flight, params, controllers, condition);
+    advanceFlight<AeroModel, Integrator, ExactMath>(flight, params, airframe, condition);
+}
+
+using SensitivityStepFn = void (*)(FlightStateT<SensitivityScalar> &, const FlightParams &,
+                                   const AirframeT<SensitivityScalar> &, FlightControllersT<SensitivityScalar> &);
+
+namespace sensitivity_detail
+{
+    template <typename AeroModel, bool SpeedAutopilot, bool AltitudeAutopilot>
+    inline SensitivityStepFn selectIntegrator(IntegratorType integrator)
+    {
+        if (integrator == IntegratorType::SemiImplicitEuler)
+            return &stepSensitivity<AeroModel, SpeedAutopilot, AltitudeAutopilot, SemiImplicitEulerIntegrator>;
+        return &stepSensitivity<AeroModel, SpeedAutopilot, AltitudeAutopilot, RK4Integrator>;
+    }
+
+    template <typename AeroModel>
+    inline SensitivityStepFn selectAutopilot(bool speed, bool altitude, IntegratorType integrator)
+    {
+        if (speed && altitude)
+            return selectIntegrator<AeroModel, true, true>(integrator);
+        if (speed)
+            return selectIntegrator<AeroModel, true, false>(integrator);
+        if (altitude)
+            return selectIntegrator<AeroModel, false, true>(integrator);
+        return selectIntegrator<AeroModel, false, false>(integrator);
+    }
+}
+
+// One aircraft flown in dual numbers from a simulation state
+// The configuration (aircraft, autopilot switches, integrator, setpoints) is
+// taken at construction; the controllers start reset, as in a fresh run.
+class SensitivityRun
+{
+public:
+    explicit SensitivityRun(const SimulationState &initial)
+        : flight(convertFlightState<SensitivityScalar>(static_cast<const FlightState &>(initial))),
+          parameters(initial), airframe(initial.aircraft)
+    {
+        airframe.mass = SensitivityScalar::variable(initial.aircraft.mass, SensMass);
+        airframe.S = SensitivityScalar::variable(initial.aircraft.S, SensWingArea);
+        airframe.CD0 = SensitivityScalar::variable(initial.aircraft.CD0, SensCD0);
+        airframe.k = SensitivityScalar::variable(initial.aircraft.k, SensInducedDrag);
+        airframe.maxThrust = SensitivityScalar::variable(initial.aircraft.maxThrust, SensMaxThrust);
+
+        controllers.speed_pid.setGains(SensitivityScalar::variable(initial.pid_kp, SensSpeedKp),
+                                       SensitivityScalar::variable(initial.pid_ki, SensSpeedKi),
+                                       SensitivityScalar::variable(initial.pid_kd, SensSpeedKd));
+        controllers.altitude_pid.setGains(SensitivityScalar::variable(initial.alt_pid_kp, SensAltitudeKp),
+                                          SensitivityScalar::variable(initial.alt_pid_ki, SensAltitudeKi),
+                                          SensitivityScalar::variable(initial.alt_pid_kd, SensAltitudeKd));
+
+        bool table = initial.aircraft.hasAeroTable() && !initial.aircraft.aeroTable->isEmpty();
+        stepFn = table ? sensitivity_detail::selectAutopilot<TableAeroModel>(initial.autopilot_speed, initial.autopilot_altitude, initial.integrator)
+                       : sensitivity_detail::selectAutopilot<LegacyAeroModel>(initial.autopilot_speed, initial.autopilot_altitude, initial.integrator);
+    }
+
+    void step() { stepFn(flight, parameters, airframe, controllers); }
+
+    void run(size_t steps)
+    {
+        for (size_t i = 0; i < steps; i++)
+            step();
+    }
+
+    const FlightStateT<SensitivityScalar> &state() const { return flight; }
+
+private:
+    FlightStateT<SensitivityScalar> flight;
+    FlightParams parameters;
+    AirframeT<SensitivityScalar> airframe;
+    FlightControllersT<SensitivityScalar> controllers;
+    SensitivityStepFn stepFn;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "simulation_state.hpp"
+#include <string>
+#include <vector>
+
+// A set of aircraft flown side by side
+// States and labels are kept in parallel vectors so the batch engine can step
+// the states contiguously.
+class SimulationScene
+{
+public:
+    std::vector<SimulationState> states;
+    std::vector<std::string> labels;
+    int selected;
+
+    SimulationScene() : selected(0) {}
+
+    size_t size() const { return states.size(); }
+    bool empty() const { return states.empty(); }
+
+    // Add an aircraft starting from the default reset condition
+    int add(const std::string &label, const Aircraft &aircraft)
+    {
+        SimulationState state;
+        state.aircraft = aircraft;
+        states.push_back(state);
+        labels.push_back(label);
+        return static_cast<int>(states.size()) - 1;
+    }
+
+    // Copy an aircraft (including controller gains) so variants can be compared
+    int duplicate(int index)
+    {
+        if (index < 0 || index >= static_cast<int>(states.size()))
+            return -1;
+
+        SimulationState copy = states[index];
+        std::string label = labels[index] + " (copy)";
+        states.push_back(copy);
+        labels.push_back(label);
+        return static_cast<int>(states.size()) - 1;
+    }
+
+    void remove(int index)
+    {
+        // Always keep at least one aircraft so the panels have something to show
+        if (states.size() <= 1 || index < 0 || index >= static_cast<int>(states.size()))
+            return;
+
+        states.erase(states.begin() + index);
+        labels.erase(labels.begin() + index);
+        // Keep the same aircraft selected when one before it goes
+        if (index < selected)
+            selected--;
+        else if (selected >= static_cast<int>(states.size()))
+            selected = static_cast<int>(states.size()) - 1;
+    }
+
+    SimulationState &selectedState() { return states[selected]; }
+    const SimulationState &selectedState() const { return states[selected]; }
+
+    void setPaused(bool paused)
+    {
+        for (auto &state : states)
+            state.paused = paused;
+    }
+
+    void requestResetAll()
+    {
+        for (auto &state : states)
+            state.reset_requested = true;
+    }
+};
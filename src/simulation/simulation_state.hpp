@@ -3,6 +3,12 @@
 #include "../core/vec2.hpp"
 #include "../aircraft/aircraft.hpp"
 #include "../control/pid.hpp"
+#include "../core/integrator.hpp"
+#include "../core/fast_math.hpp"
+#include "../environment/wind.hpp"
+#include "../environment/atmosphere_profile.hpp"
+#include <memory>
+#include <type_traits>
 #include <vector>
 
 // Flight history point for visualization
@@ -11,93 +17,124 @@ struct FlightPoint
     float x, z;
 };
 
-// Main simulation state
-class SimulationState
+// Type of the control and attitude members of a hot state: float next to a
+// float or double state (keeps the layouts below), the state's own type for
+// dual numbers, which carry derivatives through the attitude as well
+template <typename T>
+using FlightControlT = std::conditional_t<std::is_floating_point<T>::value, float, T>;
+
+// Hot integration state: everything a physics step reads and writes for one
+// aircraft. Batches keep these contiguous (see FlightBatchT) so stepping
+// streams one state per aircraft. T is the precision of the kinematic state
+// and its integration: double (one 64-byte cache line) for the reference
+// path, or float (40 bytes) for bandwidth-bound sweeps, see
+// precision_drift.hpp for how far the two drift apart.
+template <typename T>
+struct alignas(sizeof(T) == sizeof(double) ? 64 : alignof(T)) FlightStateT
 {
-public:
-    // Aircraft and physics state
-    Aircraft aircraft;
-    Vec2 position;
-    Vec2 velocity;
-    double t;
-    double dt;
+    using scalar_type = T;
+    using control_type = FlightControlT<T>;
+
+    Vec2T<T> position{T(0), T(0)};
+    Vec2T<T> velocity{T(0), T(0)};
+    T t = T(0);
 
     // Control inputs
-    float throttle;
-    float elevator;   // Elevator control stick (-1 to +1, + is nose up)
-    float pitch_deg;  // Pitch angle (orientation of aircraft)
-    float pitch_rate; // Pitch rate (deg/s)
-    float alpha_deg;  // Angle of attack (calculated)
-    bool paused;
-    bool reset_requested;
+    control_type throttle = 0.0f;
+    control_type elevator = 0.0f;   // Elevator control stick (-1 to +1, + is nose up)
+    control_type pitch_deg = 0.0f;  // Pitch angle (orientation of aircraft)
+    control_type pitch_rate = 0.0f; // Pitch rate (deg/s)
+    control_type alpha_deg = 0.0f;  // Angle of attack (calculated)
+};
+
+using FlightState = FlightStateT<double>;
+using FlightStateF = FlightStateT<float>;
+static_assert(sizeof(FlightState) == 64, "FlightState should fill exactly one cache line");
+static_assert(sizeof(FlightStateF) == 40, "FlightStateF should stay unpadded");
+
+// Copy a hot state into another precision
+template <typename To, typename From>
+inline FlightStateT<To> convertFlightState(const FlightStateT<From> &from)
+{
+    FlightStateT<To> to;
+    to.position = Vec2T<To>(from.position);
+    to.velocity = Vec2T<To>(from.velocity);
+    to.t = static_cast<To>(from.t);
+    to.throttle = from.throttle;
+    to.elevator = from.elevator;
+    to.pitch_deg = from.pitch_deg;
+    to.pitch_rate = from.pitch_rate;
+    to.alpha_deg = from.alpha_deg;
+    return to;
+}
+
+// Read-mostly parameters: changed between runs or from the UI, read by every
+// step. Aircraft sharing a configuration can share one block.
+struct FlightParams
+{
+    Aircraft aircraft;
+    double dt = 0.016;
+    IntegratorType integrator = IntegratorType::RK4; // Selected once per run by selectPhysicsStep
+    MathTier math_tier = MathTier::Exact;            // Exact (default) or polynomial fast-math kernels
+    WindModel wind;                                  // Still air unless set (see wind.hpp)
+    std::shared_ptr<const AtmosphereProfile> atmosphere; // Standard ISA if null
 
     // Autopilot - Speed Control
-    bool autopilot_speed;
-    float speed_setpoint;
-    float pid_kp;
-    float pid_ki;
-    float pid_kd;
-    PIDController speed_pid;
-    float prev_pid_kp, prev_pid_ki, prev_pid_kd;
+    bool autopilot_speed = false;
+    float speed_setpoint = 40.0f;
+    float pid_kp = 0.02f;
+    float pid_ki = 0.001f;
+    float pid_kd = 0.01f;
 
     // Autopilot - Altitude Control
-    bool autopilot_altitude;
-    float altitude_setpoint;
-    float alt_pid_kp;
-    float alt_pid_ki;
-    float alt_pid_kd;
-    PIDController altitude_pid;
-    float prev_alt_pid_kp, prev_alt_pid_ki, prev_alt_pid_kd;
+    bool autopilot_altitude = false;
+    float altitude_setpoint = 100.0f;
+    float alt_pid_kp = 0.1f;
+    float alt_pid_ki = 0.001f;
+    float alt_pid_kd = 0.5f;
+
+    // Take autopilot gains from the aircraft's schedule (if it has one)
+    // instead of the fixed gains above
+    bool gain_scheduling = true;
+
+    bool gainsScheduled() const { return gain_scheduling && aircraft.hasGainSchedule(); }
+};
+
+// Autopilot controller state (only touched while a loop is engaged)
+// T is double, or the dual number type of a sensitivity run.
+template <typename T>
+struct FlightControllersT
+{
+    PIDControllerT<T> speed_pid{0.02f, 0.001f, 0.01f, 0.0, 1.0};
+    PIDControllerT<T> altitude_pid{0.1f, 0.001f, 0.5f, -1.0, 1.0};
+};
+
+using FlightControllers = FlightControllersT<double>;
+
+// Cold data for the UI and visualization; never read by the physics step
+struct FlightVisuals
+{
+    bool paused = false;
+    bool reset_requested = false;
 
     // Flight path history
     std::vector<FlightPoint> flightPath;
-    int maxPathPoints;
+    int maxPathPoints = 1000; // 0 disables recording (headless runs)
 
     // Force vectors for visualization
-    Vec2 F_thrust_viz;
-    Vec2 F_drag_viz;
-    Vec2 F_lift_viz;
-    Vec2 F_weight_viz;
-
-    SimulationState()
-        : aircraft(),
-          position(0.0, 0.0),
-          velocity(0.0, 0.0),
-          t(0.0),
-          dt(0.016),
-          throttle(0.0f),
-          elevator(0.0f),
-          pitch_deg(0.0f),
-          pitch_rate(0.0f),
-          alpha_deg(0.0f),
-          paused(false),
-          reset_requested(false),
-          autopilot_speed(false),
-          speed_setpoint(40.0f),
-          pid_kp(0.02f),
-          pid_ki(0.001f),
-          pid_kd(0.01f),
-          speed_pid(0.02f, 0.001f, 0.01f, 0.0, 1.0),
-          prev_pid_kp(0.02f),
-          prev_pid_ki(0.001f),
-          prev_pid_kd(0.01f),
-          autopilot_altitude(false),
-          altitude_setpoint(100.0f),
-          alt_pid_kp(0.1f),
-          alt_pid_ki(0.001f),
-          alt_pid_kd(0.5f),
-          altitude_pid(0.1f, 0.001f, 0.5f, -1.0, 1.0),
-          prev_alt_pid_kp(0.1f),
-          prev_alt_pid_ki(0.001f),
-          prev_alt_pid_kd(0.5f),
-          maxPathPoints(1000),
-          F_thrust_viz(0.0, 0.0),
-          F_drag_viz(0.0, 0.0),
-          F_lift_viz(0.0, 0.0),
-          F_weight_viz(0.0, 0.0)
-    {
-    }
+    Vec2 F_thrust_viz{0.0, 0.0};
+    Vec2 F_drag_viz{0.0, 0.0};
+    Vec2 F_lift_viz{0.0, 0.0};
+    Vec2 F_weight_viz{0.0, 0.0};
+};
 
+// Main simulation state: one interactive or scenario aircraft
+// Composed of the blocks above, hot state first, so members are accessed as
+// before (state.position, state.aircraft, state.flightPath) while the step
+// functions can take just the parts they need.
+class SimulationState : public FlightState, public FlightParams, public FlightControllers, public FlightVisuals
+{
+public:
     void reset()
     {
         position = Vec2(0.0, 0.0);
@@ -0,0 +1,857 @@
+#pragma once
+
+#include "physics_update.hpp"
+#include "../core/damped_cholesky.hpp"
+#include "../core/dual.hpp"
+#include "../core/thread_pool.hpp"
+#include "../utils/json_value.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Optimal control profiles by direct multiple shooting
+//
+// The flight is cut into segments of equal duration, each flown with a
+// constant throttle and elevator. The decision variables are the controls of
+// every segment, the state at every segment boundary after the initial one
+// (x, altitude, vx, vz, pitch, pitch rate) and the segment duration. Each
+// segment is flown from its own start state by the simulator's dynamics
+// (advanceFlight: pitch response, force model, integrator), independently of
+// the others, so segments run in parallel on a thread pool. Continuity
+// between segments is a constraint the solver drives to zero, which lets it
+// start from a guess that cannot be flown end to end.
+//
+// Segment derivatives with respect to the start state and the controls come
+// from one dual-number run (see dual.hpp), the derivative with respect to the
+// duration from central differences. An augmented Lagrangian handles the
+// continuity, terminal and path constraints; its subproblems are solved by
+// Levenberg-Marquardt steps projected onto the control and altitude bounds.
+
+enum class TrajectoryObjective
+{
+    MinimumTime, // Reach the terminal conditions as early as possible
+    MaximumRange // Cover the most ground within the energy budget
+};
+
+struct TrajectoryOptions
+{
+    TrajectoryObjective objective = TrajectoryObjective::MinimumTime;
+    int segments = 20;         // Shooting segments (constant controls in each)
+    double duration = 30.0;    // s, initial guess of the total duration
+    double min_duration = 1.0; // s, bounds on the total duration
+    double max_duration = 600.0;
+    double max_step = 0.02; // s, step length at the initial guess (the step count per segment stays fixed)
+    IntegratorType integrator = IntegratorType::RK4;
+
+    // Terminal conditions (NaN leaves the quantity free)
+    double final_altitude = std::numeric_limits<double>::quiet_NaN();
+    double final_speed = std::numeric_limits<double>::quiet_NaN(); // Airspeed
+    double final_vz = std::numeric_limits<double>::quiet_NaN();    // 0 ends in level flight
+
+    // Path constraints. The altitude floor holds at every step (the ground
+    // contact itself has no derivatives), the others at the segment boundaries.
+    double min_altitude = 1.0;                                      // m, above the ground
+    double max_alpha_deg = 12.0;                                    // The aero models have no stall of their own
+    double energy_budget = std::numeric_limits<double>::infinity(); // J of propulsive work (thrust x airspeed)
+
+    double control_smoothing = 1e-3;     // Weight of squared control changes between segments
+    int max_iterations = 1000;           // Levenberg-Marquardt iterations over all subproblems
+    int subproblem_iterations = 20;      // Iterations per subproblem before the multipliers or penalty change
+    double constraint_tolerance = 1e-3;  // Largest scaled violation (1 = 1 m, 0.1 m/s, 0.1 deg, 1 deg/s, 1 deg alpha)
+    double optimality_tolerance = 1e-10; // Relative merit decrease that ends a subproblem
+};
+
+struct TrajectoryResult
+{
+    FlightState initial;
+    std::vector<double> throttle; // Per segment
+    std::vector<double> elevator;
+    std::vector<FlightState> nodes; // Segment boundaries: the initial state, ..., the final state
+    double segment_duration = 0.0;
+    int steps_per_segment = 0;
+    IntegratorType integrator = IntegratorType::RK4;
+
+    double duration = 0.0;
+    double range = 0.0;  // m, final minus initial x
+    double energy = 0.0; // J of propulsive work
+    double constraint_violation = 0.0; // Largest scaled violation at the solution
+    int iterations = 0;
+    int outer_iterations = 0;
+    bool converged = false;
+
+    double dt() const { return segment_duration / steps_per_segment; }
+};
+
+namespace trajectory_detail
+{
+    constexpr size_t StateSize = 6;   // x, altitude, vx, vz, pitch_deg, pitch_rate
+    constexpr size_t ControlSize = 2; // throttle, elevator
+    constexpr size_t BlockSize = ControlSize + StateSize; // Variables per segment: its controls, then its end state
+    constexpr size_t EnergyOutput = StateSize;            // Segment outputs: end state, propulsive energy,
+    constexpr size_t LowestOutput = StateSize + 1;        // lowest altitude over the step ends
+    constexpr size_t OutputSize = StateSize + 2;
+    constexpr size_t InputSize = StateSize + ControlSize + 1; // Start state, controls and duration
+    using SegmentScalar = Dual<StateSize + ControlSize>;
+
+    // One unit of scaled continuity error per state component
+    constexpr std::array<double, StateSize> StateScale = {1.0, 1.0, 0.1, 0.1, 0.1, 1.0};
+
+    inline std::array<double, StateSize> stateVector(const FlightState &flight)
+    {
+        return {flight.position.x, flight.position.y, flight.velocity.x, flight.velocity.y,
+                flight.pitch_deg, flight.pitch_rate};
+    }
+
+    // Start state of a segment; dual numbers are seeded on the state and the controls
+    template <typename T>
+    inline FlightStateT<T> seedState(const double *state, const double *controls, double t)
+    {
+        std::array<T, StateSize + ControlSize> in;
+        for (size_t i = 0; i < in.size(); i++)
+        {
+            double value = i < StateSize ? state[i] : controls[i - StateSize];
+            if constexpr (T::size > 0)
+                in[i] = T::variable(value, i);
+            else
+                in[i] = T(value);
+        }
+
+        FlightStateT<T> flight;
+        flight.position = Vec2T<T>(in[0], in[1]);
+        flight.velocity = Vec2T<T>(in[2], in[3]);
+        flight.pitch_deg = in[4];
+        flight.pitch_rate = in[5];
+        flight.throttle = in[6];
+        flight.elevator = in[7];
+        flight.t = T(t);
+        return flight;
+    }
+
+    // Fly one segment with constant controls and return the propulsive work
+    // (thrust x airspeed, summed over the step starts) and the lowest
+    // altitude a step ends at. `grounded` is set when a step ends on the
+    // ground: the ground constraint clips the descent for free and has no
+    // derivatives, so such a segment is not a valid flight.
+    template <typename AeroModel, typename Integrator, typename T>
+    inline T flySegment(FlightStateT<T> &flight, const FlightParams &params, int steps, T &lowest, bool &grounded)
+    {
+        T energy(0.0);
+        for (int i = 0; i < steps; i++)
+        {
+            FlightConditionT<T> c = flightCondition<ExactMath>(flight, params);
+            energy += flight.throttle * (params.aircraft.maxThrust * params.dt) * c.speed;
+            advanceFlight<AeroModel, Integrator, ExactMath>(flight, params, c);
+            if (i == 0 || flight.position.y < lowest)
+                lowest = flight.position.y;
+            if (flight.position.y <= T(0))
+                grounded = true;
+        }
+        return energy;
+    }
+
+    template <typename AeroModel, typename Integrator, typename T>
+    inline std::array<T, OutputSize> segmentOutputs(const double *state, const double *controls, double start_time,
+                                                    double duration, size_t index, int steps, FlightParams &params,
+                                                    bool &grounded)
+    {
+        params.dt = duration / steps;
+        FlightStateT<T> flight = seedState<T>(state, controls, start_time + index * duration);
+        T lowest(0.0);
+        T energy = flySegment<AeroModel, Integrator>(flight, params, steps, lowest, grounded);
+        return {flight.position.x, flight.position.y, flight.velocity.x, flight.velocity.y,
+                flight.pitch_deg, flight.pitch_rate, energy, lowest};
+    }
+
+    // End state and energy of one segment, and optionally their derivatives
+    // with respect to the start state, the controls and the segment duration
+    struct SegmentEvaluation
+    {
+        std::array<double, OutputSize> value;
+        std::array<std::array<double, InputSize>, OutputSize> jacobian;
+        bool grounded = false;
+    };
+
+    template <typename AeroModel, typename Integrator>
+    inline void evaluateSegment(const double *state, const double *controls, double start_time, double duration,
+                                size_t index, int steps, const FlightParams &environment, bool jacobian,
+                                SegmentEvaluation &e)
+    {
+        FlightParams params = environment;
+        e.grounded = false;
+        if (!jacobian)
+        {
+            std::array<Dual<0>, OutputSize> out = segmentOutputs<AeroModel, Integrator, Dual<0>>(state, controls, start_time, duration, index, steps, params, e.grounded);
+            for (size_t i = 0; i < OutputSize; i++)
+                e.value[i] = out[i].v;
+            return;
+        }
+
+        std::array<SegmentScalar, OutputSize> out = segmentOutputs<AeroModel, Integrator, SegmentScalar>(state, controls, start_time, duration, index, steps, params, e.grounded);
+        const double h = 1e-6 * duration;
+        bool perturbed_grounded = false; // The flag belongs to the nominal run
+        std::array<Dual<0>, OutputSize> plus = segmentOutputs<AeroModel, Integrator, Dual<0>>(state, controls, start_time, duration + h, index, steps, params, perturbed_grounded);
+        std::array<Dual<0>, OutputSize> minus = segmentOutputs<AeroModel, Integrator, Dual<0>>(state, controls, start_time, duration - h, index, steps, params, perturbed_grounded);
+        for (size_t i = 0; i < OutputSize; i++)
+        {
+            e.value[i] = out[i].v;
+            for (size_t j = 0; j < StateSize + ControlSize; j++)
+                e.jacobian[i][j] = out[i].d[j];
+            e.jacobian[i][InputSize - 1] = (plus[i].v - minus[i].v) / (2.0 * h);
+        }
+    }
+
+    using SegmentFn = void (*)(const double *, const double *, double, double, size_t, int, const FlightParams &,
+                               bool, SegmentEvaluation &);
+
+    template <typename AeroModel>
+    inline SegmentFn selectSegment(IntegratorType integrator)
+    {
+        if (integrator == IntegratorType::SemiImplicitEuler)
+            return &evaluateSegment<AeroModel, SemiImplicitEulerIntegrator>;
+        return &evaluateSegment<AeroModel, RK4Integrator>;
+    }
+
+    // Angle of attack (deg) and airspeed at a segment boundary, with their
+    // derivatives with respect to the boundary state
+    inline void boundaryAirData(const double *state, double t, const FlightParams &params,
+                                Dual<StateSize> &alpha_deg, Dual<StateSize> &speed)
+    {
+        using D = Dual<StateSize>;
+        FlightStateT<D> flight;
+        flight.position = Vec2T<D>(D::variable(state[0], 0), D::variable(state[1], 1));
+        flight.velocity = Vec2T<D>(D::variable(state[2], 2), D::variable(state[3], 3));
+        flight.t = D(t);
+        Vec2T<D> air = airVelocity(flight, params);
+        speed = air.magnitude();
+        alpha_deg = D::variable(state[4], 4) - atan2(air.y, air.x) * (180.0 / M_PI);
+    }
+
+    // Constraint or residual value with its sparse gradient
+    struct ConstraintRow
+    {
+        double value = 0.0;
+        std::vector<std::pair<size_t, double>> gradient;
+    };
+
+    // Everything the solver needs at one point
+    struct Evaluation
+    {
+        double objective = 0.0;                 // Linear part; the smoothing residuals add their squares
+        std::vector<double> objective_gradient; // Dense
+        std::vector<ConstraintRow> smoothing;
+        std::vector<ConstraintRow> equalities;   // Driven to zero
+        std::vector<ConstraintRow> inequalities; // Kept at or below zero
+        std::vector<SegmentEvaluation> segments;
+        double energy = 0.0;
+        bool grounded = false; // A segment touched the ground (see flySegment)
+    };
+}
+
+// The decision vector of an optimization and the constraints on it
+// Layout: per segment k its throttle and elevator, then the state at its
+// end; the segment duration last. The initial state is fixed.
+class TrajectoryProblem
+{
+public:
+    TrajectoryProblem(const FlightState &initial, const Aircraft &aircraft, const TrajectoryOptions &options,
+                      const FlightParams &environment)
+        : options(options), segments(static_cast<size_t>(options.segments)), params(environment),
+          start(trajectory_detail::stateVector(initial)), start_time(initial.t)
+    {
+        using namespace trajectory_detail;
+
+        if (options.segments < 1)
+            throw std::runtime_error("Trajectory optimization needs at least one segment");
+        if (!(options.max_step > 0.0) || !(options.min_duration > 0.0) ||
+            !(options.duration >= options.min_duration && options.duration <= options.max_duration))
+            throw std::runtime_error("Trajectory duration must lie within positive bounds, max_step must be positive");
+        if (!(options.min_altitude > 0.0) || options.final_altitude < options.min_altitude)
+            throw std::runtime_error("Trajectory altitudes must lie above the ground and min_altitude");
+
+        params.aircraft = aircraft;
+        params.integrator = options.integrator;
+        params.math_tier = MathTier::Exact;
+        params.autopilot_speed = false;
+        params.autopilot_altitude = false;
+        bool table = aircraft.hasAeroTable() && !aircraft.aeroTable->isEmpty();
+        segmentFn = table ? selectSegment<TableAeroModel>(options.integrator)
+                          : selectSegment<LegacyAeroModel>(options.integrator);
+
+        steps = std::max(1, static_cast<int>(std::ceil(options.duration / segments / options.max_step - 1e-9)));
+        time_scale = options.duration;
+        range_scale = std::max(1.0, initial.velocity.magnitude() * options.duration);
+        energy_scale = std::max(1.0, aircraft.maxThrust * std::max(10.0, initial.velocity.magnitude()));
+
+        lower.assign(size(), -std::numeric_limits<double>::infinity());
+        upper.assign(size(), std::numeric_limits<double>::infinity());
+        for (size_t k = 0; k < segments; k++)
+        {
+            lower[controlIndex(k)] = 0.0;
+            upper[controlIndex(k)] = 1.0;
+            lower[controlIndex(k) + 1] = -1.0;
+            upper[controlIndex(k) + 1] = 1.0;
+            lower[stateIndex(k + 1) + 1] = options.min_altitude;
+        }
+        lower[durationIndex()] = options.min_duration / segments;
+        upper[durationIndex()] = options.max_duration / segments;
+    }
+
+    size_t size() const { return segments * trajectory_detail::BlockSize + 1; }
+    size_t segmentCount() const { return segments; }
+    int stepsPerSegment() const { return steps; }
+    size_t controlIndex(size_t k) const { return k * trajectory_detail::BlockSize; }
+    size_t stateIndex(size_t k) const { return (k - 1) * trajectory_detail::BlockSize + trajectory_detail::ControlSize; } // k >= 1
+    size_t durationIndex() const { return segments * trajectory_detail::BlockSize; }
+
+    const std::vector<double> &lowerBounds() const { return lower; }
+    const std::vector<double> &upperBounds() const { return upper; }
+    const FlightParams &parameters() const { return params; }
+
+    const double *boundaryState(const std::vector<double> &z, size_t k) const
+    {
+        return k == 0 ? start.data() : &z[stateIndex(k)];
+    }
+
+    void project(std::vector<double> &z) const
+    {
+        for (size_t j = 0; j < z.size(); j++)
+            z[j] = std::min(std::max(z[j], lower[j]), upper[j]);
+    }
+
+    // Initial guess: the initial controls held throughout, boundaries from
+    // flying them end to end (then clipped to the bounds). A guess that sinks
+    // below the altitude floor is shortened until it clears it.
+    std::vector<double> initialGuess(const FlightState &initial) const
+    {
+        using namespace trajectory_detail;
+        std::vector<double> z(size(), 0.0);
+        z[durationIndex()] = options.duration / segments;
+        for (size_t k = 0; k < segments; k++)
+        {
+            z[controlIndex(k)] = initial.throttle;
+            z[controlIndex(k) + 1] = initial.elevator;
+        }
+        project(z);
+
+        for (;;)
+        {
+            bool clear = true;
+            std::array<double, StateSize> state = start;
+            for (size_t k = 0; k < segments; k++)
+            {
+                SegmentEvaluation e;
+                segmentFn(state.data(), &z[controlIndex(k)], start_time, z[durationIndex()], k, steps, params, false, e);
+                clear = clear && !e.grounded && e.value[LowestOutput] >= options.min_altitude;
+                std::copy(e.value.begin(), e.value.begin() + StateSize, state.begin());
+                std::copy(state.begin(), state.end(), z.begin() + stateIndex(k + 1));
+            }
+            if (clear || z[durationIndex()] <= lower[durationIndex()])
+                break;
+            z[durationIndex()] = std::max(0.8 * z[durationIndex()], lower[durationIndex()]);
+        }
+        project(z);
+        return z;
+    }
+
+    // Objective, constraints and (optionally) their gradients, segment by
+    // segment across the pool
+    trajectory_detail::Evaluation evaluate(const std::vector<double> &z, bool gradients, ThreadPool &pool) const
+    {
+        using namespace trajectory_detail;
+        const size_t n = size();
+        const double tau = z[durationIndex()];
+
+        std::vector<SegmentEvaluation> segs(segments);
+        pool.parallelFor(segments, 1, [&](size_t begin, size_t end)
+                         {
+            for (size_t k = begin; k < end; k++)
+                segmentFn(boundaryState(z, k), &z[controlIndex(k)], start_time, tau, k, steps, params, gradients, segs[k]); });
+
+        Evaluation ev;
+        ev.objective_gradient.assign(n, 0.0);
+        auto add = [&](ConstraintRow &row, size_t index, double slope)
+        {
+            if (gradients && slope != 0.0)
+                row.gradient.emplace_back(index, slope);
+        };
+
+        // Objective
+        const double *final_state = boundaryState(z, segments);
+        if (options.objective == TrajectoryObjective::MinimumTime)
+        {
+            ev.objective = segments * tau / time_scale;
+            ev.objective_gradient[durationIndex()] = segments / time_scale;
+        }
+        else
+        {
+            ev.objective = -(final_state[0] - start[0]) / range_scale;
+            ev.objective_gradient[stateIndex(segments)] = -1.0 / range_scale;
+        }
+
+        // Control smoothing residuals
+        const double weight = std::sqrt(options.control_smoothing);
+        if (weight > 0.0)
+        {
+            for (size_t k = 0; k + 1 < segments; k++)
+            {
+                for (size_t c = 0; c < ControlSize; c++)
+                {
+                    ConstraintRow row;
+                    row.value = weight * (z[controlIndex(k + 1) + c] - z[controlIndex(k) + c]);
+                    add(row, controlIndex(k + 1) + c, weight);
+                    add(row, controlIndex(k) + c, -weight);
+                    ev.smoothing.push_back(std::move(row));
+                }
+            }
+        }
+
+        // Gradient of segment output i, scaled, into a row
+        auto addSegment = [&](ConstraintRow &row, size_t k, size_t i, double scale)
+        {
+            const SegmentEvaluation &e = segs[k];
+            if (k > 0)
+                for (size_t j = 0; j < StateSize; j++)
+                    add(row, stateIndex(k) + j, e.jacobian[i][j] * scale);
+            for (size_t c = 0; c < ControlSize; c++)
+                add(row, controlIndex(k) + c, e.jacobian[i][StateSize + c] * scale);
+            add(row, durationIndex(), e.jacobian[i][InputSize - 1] * scale);
+        };
+
+        // Continuity: each segment ends where the next begins
+        ConstraintRow energy;
+        for (size_t k = 0; k < segments; k++)
+        {
+            const SegmentEvaluation &e = segs[k];
+            const double *next = boundaryState(z, k + 1);
+            for (size_t i = 0; i < StateSize; i++)
+            {
+                ConstraintRow row;
+                row.value = (e.value[i] - next[i]) / StateScale[i];
+                if (gradients)
+                {
+                    addSegment(row, k, i, 1.0 / StateScale[i]);
+                    add(row, stateIndex(k + 1) + i, -1.0 / StateScale[i]);
+                }
+                ev.equalities.push_back(std::move(row));
+            }
+
+            energy.value += e.value[EnergyOutput];
+            if (gradients)
+                addSegment(energy, k, EnergyOutput, 1.0);
+        }
+        ev.energy = energy.value;
+        for (const SegmentEvaluation &e : segs)
+            ev.grounded = ev.grounded || e.grounded;
+
+        // Terminal conditions
+        Dual<StateSize> final_alpha, final_speed;
+        boundaryAirData(final_state, start_time + segments * tau, params, final_alpha, final_speed);
+        auto terminal = [&](double target, double value, const double *slopes, double scale)
+        {
+            if (std::isnan(target))
+                return;
+            ConstraintRow row;
+            row.value = (value - target) / scale;
+            for (size_t j = 0; j < StateSize; j++)
+                add(row, stateIndex(segments) + j, slopes[j] / scale);
+            ev.equalities.push_back(std::move(row));
+        };
+        const double unit_altitude[StateSize] = {0, 1, 0, 0, 0, 0};
+        const double unit_vz[StateSize] = {0, 0, 0, 1, 0, 0};
+        terminal(options.final_altitude, final_state[1], unit_altitude, StateScale[1]);
+        terminal(options.final_speed, final_speed.v, final_speed.d.data(), StateScale[2]);
+        terminal(options.final_vz, final_state[3], unit_vz, StateScale[3]);
+
+        // Angle of attack at every boundary after the initial one
+        for (size_t k = 1; k <= segments; k++)
+        {
+            Dual<StateSize> alpha, speed;
+            boundaryAirData(boundaryState(z, k), start_time + k * tau, params, alpha, speed);
+            for (double sign : {1.0, -1.0})
+            {
+                ConstraintRow row;
+                row.value = sign * alpha.v - options.max_alpha_deg;
+                for (size_t j = 0; j < StateSize; j++)
+                    add(row, stateIndex(k) + j, sign * alpha.d[j]);
+                ev.inequalities.push_back(std::move(row));
+            }
+        }
+
+        // Altitude floor at every step, not only the boundaries
+        for (size_t k = 0; k < segments; k++)
+        {
+            ConstraintRow row;
+            row.value = (options.min_altitude - segs[k].value[LowestOutput]) / StateScale[1];
+            if (gradients)
+                addSegment(row, k, LowestOutput, -1.0 / StateScale[1]);
+            ev.inequalities.push_back(std::move(row));
+        }
+
+        // Energy budget
+        if (std::isfinite(options.energy_budget))
+        {
+            energy.value = (energy.value - options.energy_budget) / energy_scale;
+            for (std::pair<size_t, double> &term : energy.gradient)
+                term.second /= energy_scale;
+            ev.inequalities.push_back(std::move(energy));
+        }
+        ev.segments = std::move(segs);
+        return ev;
+    }
+
+private:
+    TrajectoryOptions options;
+    size_t segments;
+    FlightParams params;
+    std::array<double, trajectory_detail::StateSize> start;
+    double start_time;
+    trajectory_detail::SegmentFn segmentFn = nullptr;
+    int steps = 1;
+    double time_scale = 1.0, range_scale = 1.0, energy_scale = 1.0;
+    std::vector<double> lower, upper;
+};
+
+// Optimize throttle and elevator profiles from an initial state
+// `environment` supplies the atmosphere and wind (its aircraft, integrator
+// and autopilot settings are ignored). Throws on invalid options; a run that
+// does not reach the tolerances returns with converged = false.
+inline TrajectoryResult optimizeTrajectory(const FlightState &initial, const Aircraft &aircraft,
+                                           const TrajectoryOptions &options, ThreadPool &pool,
+                                           const FlightParams &environment = FlightParams())
+{
+    using namespace trajectory_detail;
+
+    const TrajectoryProblem problem(initial, aircraft, options, environment);
+    const size_t n = problem.size();
+    const std::vector<double> &lower = problem.lowerBounds();
+    const std::vector<double> &upper = problem.upperBounds();
+
+    std::vector<double> z = problem.initialGuess(initial);
+    Evaluation ev = problem.evaluate(z, true, pool);
+
+    std::vector<double> lambda(ev.equalities.size(), 0.0), mu(ev.inequalities.size(), 0.0);
+    double rho = 1.0;
+
+    // Augmented Lagrangian merit of an evaluation; infinite on the ground,
+    // so a guess that touches it accepts any step that clears it
+    auto meritOf = [&](const Evaluation &e)
+    {
+        if (e.grounded)
+            return std::numeric_limits<double>::infinity();
+        double m = e.objective;
+        for (const ConstraintRow &r : e.smoothing)
+            m += r.value * r.value;
+        for (size_t i = 0; i < e.equalities.size(); i++)
+            m += lambda[i] * e.equalities[i].value + 0.5 * rho * e.equalities[i].value * e.equalities[i].value;
+        for (size_t i = 0; i < e.inequalities.size(); i++)
+        {
+            double a = std::max(0.0, mu[i] + rho * e.inequalities[i].value);
+            m += (a * a - mu[i] * mu[i]) / (2.0 * rho);
+        }
+        return m;
+    };
+    auto violationOf = [](const Evaluation &e)
+    {
+        double v = 0.0;
+        for (const ConstraintRow &r : e.equalities)
+            v = std::max(v, std::fabs(r.value));
+        for (const ConstraintRow &r : e.inequalities)
+            v = std::max(v, r.value);
+        return v;
+    };
+
+    TrajectoryResult result;
+    double merit = meritOf(ev);
+    double accept_violation = 1.0; // Violation below which the multipliers are updated
+    double damping = 1e-3;
+    std::vector<double> G(n), H(n * n), A, b, step;
+    std::vector<size_t> free;
+
+    // Minimum-norm change of the unpinned variables that zeroes the
+    // equalities of `at` to first order (Jacobian of the current point)
+    auto correctStep = [&](std::vector<double> &x, const Evaluation &at, const std::vector<char> &pinned)
+    {
+        const size_t m = ev.equalities.size();
+        std::vector<double> M(m * m, 0.0), rhs(m), y;
+        std::vector<double> dense(n);
+        std::vector<std::vector<std::pair<size_t, double>>> rows(m);
+        for (size_t i = 0; i < m; i++)
+        {
+            rhs[i] = -at.equalities[i].value;
+            for (const std::pair<size_t, double> &term : ev.equalities[i].gradient)
+                if (!pinned[term.first])
+                    rows[i].push_back(term);
+        }
+        for (size_t a = 0; a < m; a++)
+        {
+            std::fill(dense.begin(), dense.end(), 0.0);
+            for (const std::pair<size_t, double> &term : rows[a])
+                dense[term.first] += term.second;
+            for (size_t c = 0; c < m; c++)
+            {
+                double sum = 0.0;
+                for (const std::pair<size_t, double> &term : rows[c])
+                    sum += dense[term.first] * term.second;
+                M[a * m + c] = sum;
+            }
+        }
+        if (!solveDampedCholesky(M, rhs, 1e-12, y))
+            return;
+        for (size_t i = 0; i < m; i++)
+            for (const std::pair<size_t, double> &term : rows[i])
+                x[term.first] += term.second * y[i];
+        problem.project(x);
+    };
+
+    while (result.iterations < options.max_iterations)
+    {
+        result.outer_iterations++;
+
+        // Minimize the merit for the current multipliers
+        const int inner_limit = result.iterations + options.subproblem_iterations;
+        bool stationary = false;
+        while (result.iterations < options.max_iterations && result.iterations < inner_limit)
+        {
+            // Gradient and Gauss-Newton Hessian of the merit
+            G = ev.objective_gradient;
+            std::fill(H.begin(), H.end(), 0.0);
+            auto accumulate = [&](const ConstraintRow &row, double coefficient, double curvature)
+            {
+                for (const std::pair<size_t, double> &a : row.gradient)
+                {
+                    G[a.first] += coefficient * a.second;
+                    for (const std::pair<size_t, double> &c : row.gradient)
+                        H[a.first * n + c.first] += curvature * a.second * c.second;
+                }
+            };
+            for (const ConstraintRow &r : ev.smoothing)
+                accumulate(r, 2.0 * r.value, 2.0);
+            for (size_t i = 0; i < ev.equalities.size(); i++)
+                accumulate(ev.equalities[i], lambda[i] + rho * ev.equalities[i].value, rho);
+            for (size_t i = 0; i < ev.inequalities.size(); i++)
+            {
+                double a = mu[i] + rho * ev.inequalities[i].value;
+                if (a > 0.0)
+                    accumulate(ev.inequalities[i], a, rho);
+            }
+
+            // Raise the damping until a step lowers the merit. Variables held
+            // at a bound by the gradient stay out of the step; one the step
+            // would carry past a bound is pinned to it and the step re-solved
+            // for the rest, so steps follow the faces of the box instead of
+            // being clipped onto them.
+            bool accepted = false;
+            double trial_merit = merit;
+            std::vector<double> trial, move(n);
+            std::vector<char> pinned(n);
+            Evaluation trial_ev;
+            while (damping < 1e12)
+            {
+                std::fill(move.begin(), move.end(), 0.0);
+                for (size_t j = 0; j < n; j++)
+                    pinned[j] = (z[j] <= lower[j] && G[j] > 0.0) || (z[j] >= upper[j] && G[j] < 0.0);
+
+                bool solved = false;
+                for (;;)
+                {
+                    free.clear();
+                    for (size_t j = 0; j < n; j++)
+                        if (!pinned[j])
+                            free.push_back(j);
+                    const size_t nf = free.size();
+                    A.assign(nf * nf, 0.0);
+                    b.assign(nf, 0.0);
+                    for (size_t a = 0; a < nf; a++)
+                    {
+                        const double *row = &H[free[a] * n];
+                        b[a] = -G[free[a]];
+                        for (size_t j = 0; j < n; j++)
+                            if (pinned[j])
+                                b[a] -= row[j] * move[j];
+                        for (size_t c = 0; c < nf; c++)
+                            A[a * nf + c] = row[free[c]];
+                    }
+                    if (!solveDampedCholesky(A, b, damping, step))
+                        break;
+
+                    bool hit = false;
+                    for (size_t a = 0; a < nf; a++)
+                    {
+                        const size_t j = free[a];
+                        if (z[j] + step[a] < lower[j] || z[j] + step[a] > upper[j])
+                        {
+                            pinned[j] = 1;
+                            move[j] = (z[j] + step[a] < lower[j] ? lower[j] : upper[j]) - z[j];
+                            hit = true;
+                        }
+                    }
+                    if (!hit)
+                    {
+                        for (size_t a = 0; a < nf; a++)
+                            move[free[a]] = step[a];
+                        solved = true;
+                        break;
+                    }
+                }
+                if (!solved)
+                {
+                    damping *= 10.0;
+                    continue;
+                }
+
+                trial = z;
+                for (size_t j = 0; j < n; j++)
+                    trial[j] += move[j];
+                problem.project(trial);
+                trial_ev = problem.evaluate(trial, false, pool);
+                trial_merit = meritOf(trial_ev);
+                if (!(trial_merit < merit))
+                {
+                    // Second-order correction: a step along the constraints
+                    // leaves them by their curvature; pull it back onto their
+                    // linearization (minimum-norm over the step's variables)
+                    std::vector<double> corrected = trial;
+                    correctStep(corrected, trial_ev, pinned);
+                    Evaluation corrected_ev = problem.evaluate(corrected, false, pool);
+                    double corrected_merit = meritOf(corrected_ev);
+                    if (corrected_merit < merit)
+                    {
+                        trial = std::move(corrected);
+                        trial_ev = std::move(corrected_ev);
+                        trial_merit = corrected_merit;
+                    }
+                }
+                if (trial_merit < merit)
+                {
+                    accepted = true;
+                    break;
+                }
+                damping *= 10.0;
+            }
+            result.iterations++;
+            if (!accepted)
+            {
+                stationary = true; // No descent left at working precision
+                break;
+            }
+
+            const double decrease = merit - trial_merit;
+            z = std::move(trial);
+            ev = problem.evaluate(z, true, pool);
+            merit = meritOf(ev);
+            damping = std::max(damping * 0.1, 1e-12);
+            if (decrease <= options.optimality_tolerance * (1.0 + std::fabs(merit)))
+            {
+                stationary = true;
+                break;
+            }
+        }
+
+        if (!std::isfinite(merit))
+            break; // No step clears the ground
+        const double violation = violationOf(ev);
+        if (stationary && violation <= options.constraint_tolerance)
+        {
+            result.converged = true;
+            break;
+        }
+
+        // Enough progress towards feasibility: first-order multiplier update,
+        // and the next update has to cut the violation again. A subproblem
+        // solved without that progress raises the penalty instead; one cut
+        // short by the iteration limit just continues.
+        if (violation <= accept_violation)
+        {
+            for (size_t i = 0; i < lambda.size(); i++)
+                lambda[i] += rho * ev.equalities[i].value;
+            for (size_t i = 0; i < mu.size(); i++)
+                mu[i] = std::max(0.0, mu[i] + rho * ev.inequalities[i].value);
+            accept_violation = 0.25 * violation;
+        }
+        else if (stationary)
+        {
+            rho = std::min(rho * 10.0, 1e10);
+        }
+        merit = meritOf(ev);
+        damping = 1e-3;
+    }
+
+    // Result from the decision vector
+    const size_t N = problem.segmentCount();
+    const double tau = z[problem.durationIndex()];
+    result.initial = initial;
+    result.segment_duration = tau;
+    result.steps_per_segment = problem.stepsPerSegment();
+    result.integrator = options.integrator;
+    result.duration = N * tau;
+    result.energy = ev.energy;
+    result.constraint_violation = violationOf(ev);
+    for (size_t k = 0; k < N; k++)
+    {
+        result.throttle.push_back(z[problem.controlIndex(k)]);
+        result.elevator.push_back(z[problem.controlIndex(k) + 1]);
+    }
+    for (size_t k = 0; k <= N; k++)
+    {
+        const double *s = problem.boundaryState(z, k);
+        FlightState node;
+        node.position = Vec2(s[0], s[1]);
+        node.velocity = Vec2(s[2], s[3]);
+        node.pitch_deg = static_cast<float>(s[4]);
+        node.pitch_rate = static_cast<float>(s[5]);
+        node.throttle = static_cast<float>(result.throttle[std::min(k, N - 1)]);
+        node.elevator = static_cast<float>(result.elevator[std::min(k, N - 1)]);
+        node.t = initial.t + k * tau;
+        Dual<StateSize> alpha, speed;
+        boundaryAirData(s, node.t, problem.parameters(), alpha, speed);
+        node.alpha_deg = static_cast<float>(alpha.v);
+        result.nodes.push_back(node);
+    }
+    result.range = result.nodes.back().position.x - initial.position.x;
+    return result;
+}
+
+// Write an optimized schedule as a scenario the runner replays (see
+// scenario.hpp): the initial state, one "controls" entry per segment at its
+// start and the optimizer's step as dt, so control changes fall on step
+// boundaries. aircraftFile is written as given (relative to the scenario
+// file, or "default"). Atmosphere and wind are not written; add them to the
+// file if the optimization used them.
+inline void writeScheduleScenario(const TrajectoryResult &result, const std::filesystem::path &path,
+                                  const std::string &aircraftFile, const std::string &name,
+                                  double output_interval = 0.1)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to write scenario file: " + path.string());
+
+    const FlightState &s = result.initial;
+    file.precision(17);
+    file << "{\n"
+         << "    \"name\": \"" << jsonEscape(name) << "\",\n"
+         << "    \"aircraft\": \"" << jsonEscape(aircraftFile) << "\",\n"
+         << "    \"initial\": { \"x\": " << s.position.x << ", \"altitude\": " << s.position.y
+         << ", \"vx\": " << s.velocity.x << ", \"vz\": " << s.velocity.y
+         << ", \"pitch_deg\": " << s.pitch_deg << ", \"pitch_rate\": " << s.pitch_rate
+         << ", \"throttle\": " << result.throttle.front() << ", \"elevator\": " << result.elevator.front() << " },\n"
+         << "    \"duration\": " << result.duration << ",\n"
+         << "    \"dt\": " << result.dt() << ",\n"
+         << "    \"output_interval\": " << output_interval << ",\n"
+         << "    \"integrator\": \"" << (result.integrator == IntegratorType::SemiImplicitEuler ? "euler" : "rk4") << "\",\n"
+         << "    \"controls\": [\n";
+    for (size_t k = 0; k < result.throttle.size(); k++)
+    {
+        file << "        { \"t\": " << k * result.segment_duration << ", \"throttle\": " << result.throttle[k]
+             << ", \"elevator\": " << result.elevator[k] << " }" << (k + 1 < result.throttle.size() ? ",\n" : "\n");
+    }
+    file << "    ]\n}\n";
+    if (!file)
+        throw std::runtime_error("Failed to write scenario file: " + path.string());
+}
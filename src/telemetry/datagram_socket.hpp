@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// Parsed telemetry endpoint: "udp://host:port" or "unix:///path/to.sock"
+struct TelemetryEndpoint
+{
+    enum class Kind
+    {
+        Udp,
+        Unix
+    };
+
+    Kind kind = Kind::Udp;
+    std::string host; // UDP only
+    uint16_t port = 0; // UDP only
+    std::string path; // Unix only
+
+    static TelemetryEndpoint parse(const std::string &uri)
+    {
+        TelemetryEndpoint ep;
+        if (uri.rfind("udp://", 0) == 0)
+        {
+            std::string rest = uri.substr(6);
+            size_t colon = rest.rfind(':');
+            if (colon == std::string::npos || colon == 0)
+                throw std::runtime_error("Telemetry endpoint needs host:port: " + uri);
+            ep.kind = Kind::Udp;
+            ep.host = rest.substr(0, colon);
+            int port = std::stoi(rest.substr(colon + 1));
+            if (port < 0 || port > 65535)
+                throw std::runtime_error("Telemetry port out of range: " + uri);
+            ep.port = static_cast<uint16_t>(port);
+        }
+        else if (uri.rfind("unix://", 0) == 0)
+        {
+            ep.kind = Kind::Unix;
+            ep.path = uri.substr(7);
+            if (ep.path.empty())
+                throw std::runtime_error("Telemetry endpoint needs a socket path: " + uri);
+        }
+        else
+        {
+            throw std::runtime_error("Unknown telemetry endpoint (use udp://host:port or unix:///path): " + uri);
+        }
+        return ep;
+    }
+};
+
+// Connectionless datagram socket (UDP or Unix domain), move-only
+// Unix domain sockets are POSIX only.
+class DatagramSocket
+{
+public:
+    DatagramSocket() = default;
+    DatagramSocket(const DatagramSocket &) = delete;
+    DatagramSocket &operator=(const DatagramSocket &) = delete;
+
+    DatagramSocket(DatagramSocket &&other) noexcept { moveFrom(other); }
+
+    DatagramSocket &operator=(DatagramSocket &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~DatagramSocket() { close(); }
+
+    // Socket that sends to the endpoint
+    static DatagramSocket connectTo(const TelemetryEndpoint &ep)
+    {
+        DatagramSocket s;
+        if (ep.kind == TelemetryEndpoint::Kind::Udp)
+        {
+            s.open(AF_INET);
+            sockaddr_in addr = udpAddress(ep.host, ep.port);
+            if (::connect(s.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+                throw std::runtime_error("Failed to connect telemetry socket to " + ep.host);
+        }
+        else
+        {
+#ifdef _WIN32
+            throw std::runtime_error("Unix domain telemetry sockets are not supported on Windows");
+#else
+            s.open(AF_UNIX);
+            sockaddr_un addr = unixAddress(ep.path);
+            if (::connect(s.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+                throw std::runtime_error("Failed to connect telemetry socket to " + ep.path + " (is the receiver running?)");
+#endif
+        }
+        return s;
+    }
+
+    // Socket that receives on the endpoint (UDP binds host:port, Unix creates the socket file)
+    // The receive buffer is enlarged so bursts from a headless run are not lost
+    // while the reader catches up.
+    static DatagramSocket bindTo(const TelemetryEndpoint &ep, int receiveBufferBytes = 4 << 20)
+    {
+        DatagramSocket s;
+        if (ep.kind == TelemetryEndpoint::Kind::Udp)
+        {
+            s.open(AF_INET);
+            sockaddr_in addr = udpAddress(ep.host, ep.port);
+            if (::bind(s.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+                throw std::runtime_error("Failed to bind telemetry socket to port " + std::to_string(ep.port));
+        }
+        else
+        {
+#ifdef _WIN32
+            throw std::runtime_error("Unix domain telemetry sockets are not supported on Windows");
+#else
+            s.open(AF_UNIX);
+            ::unlink(ep.path.c_str());
+            sockaddr_un addr = unixAddress(ep.path);
+            if (::bind(s.fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+                throw std::runtime_error("Failed to bind telemetry socket to " + ep.path);
+            s.unlinkPath = ep.path;
+#endif
+        }
+        ::setsockopt(s.fd, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char *>(&receiveBufferBytes), sizeof(receiveBufferBytes));
+        return s;
+    }
+
+    bool isOpen() const { return fd != InvalidSocket; }
+
+    // Local UDP port (useful after binding to port 0)
+    uint16_t localPort() const
+    {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        if (::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len) != 0 || addr.sin_family != AF_INET)
+            return 0;
+        return ntohs(addr.sin_port);
+    }
+
+    // Returns false if the datagram could not be sent (e.g. no receiver yet)
+    bool send(const void *data, size_t size)
+    {
+        auto sent = ::send(fd, static_cast<const char *>(data), static_cast<int>(size), 0);
+        return sent == static_cast<decltype(sent)>(size);
+    }
+
+    // Wait up to timeoutMs for one datagram; returns its size, or 0 on timeout
+    size_t receive(void *buffer, size_t capacity, int timeoutMs)
+    {
+#ifdef _WIN32
+        WSAPOLLFD pfd{fd, POLLRDNORM, 0};
+        if (WSAPoll(&pfd, 1, timeoutMs) <= 0)
+            return 0;
+#else
+        pollfd pfd{fd, POLLIN, 0};
+        if (::poll(&pfd, 1, timeoutMs) <= 0)
+            return 0;
+#endif
+        auto n = ::recv(fd, static_cast<char *>(buffer), static_cast<int>(capacity), 0);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    void close()
+    {
+        if (fd == InvalidSocket)
+            return;
+#ifdef _WIN32
+        ::closesocket(fd);
+#else
+        ::close(fd);
+        if (!unlinkPath.empty())
+            ::unlink(unlinkPath.c_str());
+#endif
+        fd = InvalidSocket;
+        unlinkPath.clear();
+    }
+
+private:
+#ifdef _WIN32
+    using Handle = SOCKET;
+    static constexpr Handle InvalidSocket = INVALID_SOCKET;
+#else
+    using Handle = int;
+    static constexpr Handle InvalidSocket = -1;
+#endif
+
+    Handle fd = InvalidSocket;
+    std::string unlinkPath; // Socket file removed on close (Unix receiver)
+
+    void moveFrom(DatagramSocket &other)
+    {
+        fd = other.fd;
+        unlinkPath = std::move(other.unlinkPath);
+        other.fd = InvalidSocket;
+        other.unlinkPath.clear();
+    }
+
+    void open(int family)
+    {
+#ifdef _WIN32
+        static const bool wsaReady = []
+        {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        if (!wsaReady)
+            throw std::runtime_error("WSAStartup failed");
+#endif
+        fd = ::socket(family, SOCK_DGRAM, 0);
+        if (fd == InvalidSocket)
+            throw std::runtime_error("Failed to create telemetry socket");
+    }
+
+    static sockaddr_in udpAddress(const std::string &host, uint16_t port)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (host == "*" || host == "0.0.0.0")
+        {
+            addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        }
+        else if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+        {
+            addrinfo hints{};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_DGRAM;
+            addrinfo *found = nullptr;
+            if (getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0 || !found)
+                throw std::runtime_error("Cannot resolve telemetry host: " + host);
+            addr.sin_addr = reinterpret_cast<sockaddr_in *>(found->ai_addr)->sin_addr;
+            freeaddrinfo(found);
+        }
+        return addr;
+    }
+
+#ifndef _WIN32
+    static sockaddr_un unixAddress(const std::string &path)
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+            throw std::runtime_error("Unix socket path too long: " + path);
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        return addr;
+    }
+#endif
+};
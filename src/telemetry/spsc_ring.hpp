@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+// Bounded single-producer/single-consumer ring buffer
+// tryPush and tryPop are wait-free: one relaxed load of the local index, one
+// acquire load of the other side's index (only when the cached copy says the
+// ring looks full/empty) and one release store. Storage is allocated once in
+// the constructor, so pushing never allocates.
+template <typename T>
+class SpscRing
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing elements are copied without constructors");
+
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(size_t requestedCapacity)
+    {
+        size_t capacity = 2;
+        while (capacity < requestedCapacity)
+            capacity <<= 1;
+        mask = capacity - 1;
+        slots.reset(new T[capacity]);
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Producer: returns false (and leaves the ring untouched) if full
+    bool tryPush(const T &value)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail > mask)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail > mask)
+                return false;
+        }
+        slots[h & mask] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: returns false if empty
+    bool tryPop(T &value)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t == cachedHead)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead)
+                return false;
+        }
+        value = slots[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: drop everything currently queued
+    void discardAll()
+    {
+        cachedHead = head.load(std::memory_order_acquire);
+        tail.store(cachedHead, std::memory_order_release);
+    }
+
+    // Approximate number of queued elements (exact when called from either side while the other is idle)
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<T[]> slots;
+    size_t mask = 0;
+
+    // Producer and consumer indices live on separate cache lines so the two
+    // threads do not invalidate each other on every operation
+    alignas(64) std::atomic<size_t> head{0}; // Next slot to write (producer)
+    size_t cachedTail = 0;                   // Producer's last view of tail
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot to read (consumer)
+    size_t cachedHead = 0;                   // Consumer's last view of head
+};
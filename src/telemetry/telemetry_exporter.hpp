@@ -0,0 +1,128 @@
+#pragma once
+
+#include "telemetry_hub.hpp"
+#include "telemetry_frame.hpp"
+#include "datagram_socket.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams telemetry from a hub to a UDP or Unix datagram endpoint
+//
+// Runs on its own thread with its own hub consumer, so the physics thread
+// only ever does the wait-free publish. Records are packed into datagrams of
+// up to maxPacketBytes (default fits a 1500-byte Ethernet MTU without
+// fragmentation); a partial batch is flushed after flushInterval so a slow
+// sim still streams with bounded latency.
+class TelemetryExporter
+{
+public:
+    struct Stats
+    {
+        uint64_t frames = 0;      // Frames sent
+        uint64_t packets = 0;     // Datagrams sent
+        uint64_t sendErrors = 0;  // Datagrams the OS refused (e.g. no receiver)
+        uint64_t dropped = 0;     // Records lost to a full consumer ring
+    };
+
+    TelemetryExporter(TelemetryHub &hub, const std::string &endpoint,
+                      std::chrono::milliseconds flushInterval = std::chrono::milliseconds(20),
+                      size_t maxPacketBytes = 1400)
+        : consumer(hub.attach()),
+          socket(DatagramSocket::connectTo(TelemetryEndpoint::parse(endpoint))),
+          flushInterval(flushInterval),
+          framesPerPacket(telemetry_wire::framesPerPacket(maxPacketBytes))
+    {
+        if (framesPerPacket == 0 || framesPerPacket > 0xffff)
+            throw std::runtime_error("TelemetryExporter: maxPacketBytes must fit at least one frame");
+        packet.resize(telemetry_wire::HEADER_BYTES + framesPerPacket * telemetry_wire::FRAME_BYTES);
+        worker = std::thread([this]
+                             { run(); });
+    }
+
+    TelemetryExporter(const TelemetryExporter &) = delete;
+    TelemetryExporter &operator=(const TelemetryExporter &) = delete;
+
+    ~TelemetryExporter() { stop(); }
+
+    // Send whatever is still queued and join the thread
+    void stop()
+    {
+        if (!worker.joinable())
+            return;
+        stopping.store(true, std::memory_order_release);
+        worker.join();
+    }
+
+    Stats stats() const
+    {
+        Stats s;
+        s.frames = frames.load(std::memory_order_relaxed);
+        s.packets = packets.load(std::memory_order_relaxed);
+        s.sendErrors = sendErrors.load(std::memory_order_relaxed);
+        s.dropped = consumer.dropped();
+        return s;
+    }
+
+private:
+    TelemetryHub::Consumer consumer;
+    DatagramSocket socket;
+    std::chrono::milliseconds flushInterval;
+    size_t framesPerPacket;
+
+    std::vector<uint8_t> packet;
+    size_t pending = 0;
+    uint32_t packetSequence = 0;
+
+    std::thread worker;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> sendErrors{0};
+
+    void run()
+    {
+        auto lastFlush = std::chrono::steady_clock::now();
+        for (;;)
+        {
+            // Read the flag before draining so nothing published before stop() is missed
+            bool finalPass = stopping.load(std::memory_order_acquire);
+
+            size_t received = consumer.drain([this](const TelemetryRecord &record)
+                                             {
+                encodeTelemetryFrame(packet.data() + telemetry_wire::HEADER_BYTES + pending * telemetry_wire::FRAME_BYTES, record);
+                if (++pending == framesPerPacket)
+                    flush(); });
+
+            auto now = std::chrono::steady_clock::now();
+            if (pending > 0 && (finalPass || now - lastFlush >= flushInterval))
+                flush();
+            if (pending == 0)
+                lastFlush = now;
+
+            if (finalPass)
+                break;
+            if (received == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void flush()
+    {
+        encodeTelemetryHeader(packet.data(), static_cast<uint16_t>(pending), packetSequence++);
+        size_t size = telemetry_wire::HEADER_BYTES + pending * telemetry_wire::FRAME_BYTES;
+        if (socket.send(packet.data(), size))
+        {
+            packets.fetch_add(1, std::memory_order_relaxed);
+            frames.fetch_add(pending, std::memory_order_relaxed);
+        }
+        else
+        {
+            sendErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+        pending = 0;
+    }
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "telemetry_record.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// Binary wire format for telemetry datagrams
+//
+// Each datagram carries a 16-byte header followed by `count` frames of
+// FRAME_BYTES each. All fields are little-endian; positions and time are
+// float64, everything else float32.
+//
+//   header:  u32 magic 'FDTM' | u16 version | u16 count | u32 packet sequence | u32 reserved
+//   frame:   u64 record sequence | u16 aircraft | u16 flags | f64 t | f64 x | f64 altitude
+//            | f32 vx, vz | f32 thrust x,z | drag x,z | lift x,z | weight x,z
+//            | f32 pitch_deg, pitch_rate, alpha_deg, throttle, elevator
+//            | f32 speed_setpoint, altitude_setpoint
+//            | f32 speed P, I, D | altitude P, I, D
+namespace telemetry_wire
+{
+    constexpr uint32_t MAGIC = 0x4D544446; // "FDTM" read as little-endian bytes
+    constexpr uint16_t VERSION = 1;
+    constexpr size_t HEADER_BYTES = 16;
+    constexpr size_t FRAME_BYTES = 8 + 2 + 2 + 3 * 8 + 23 * 4;
+
+    // Frames per datagram for a given datagram size limit
+    constexpr size_t framesPerPacket(size_t maxPacketBytes)
+    {
+        return maxPacketBytes > HEADER_BYTES ? (maxPacketBytes - HEADER_BYTES) / FRAME_BYTES : 0;
+    }
+
+    class Writer
+    {
+    public:
+        explicit Writer(uint8_t *dst) : p(dst) {}
+
+        void u16(uint16_t v)
+        {
+            for (int i = 0; i < 2; i++)
+                *p++ = static_cast<uint8_t>(v >> (8 * i));
+        }
+        void u32(uint32_t v)
+        {
+            for (int i = 0; i < 4; i++)
+                *p++ = static_cast<uint8_t>(v >> (8 * i));
+        }
+        void u64(uint64_t v)
+        {
+            for (int i = 0; i < 8; i++)
+                *p++ = static_cast<uint8_t>(v >> (8 * i));
+        }
+        void f32(float v)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            u32(bits);
+        }
+        void f64(double v)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            u64(bits);
+        }
+        void vec2f(const Vec2 &v)
+        {
+            f32(static_cast<float>(v.x));
+            f32(static_cast<float>(v.y));
+        }
+
+    private:
+        uint8_t *p;
+    };
+
+    class Reader
+    {
+    public:
+        explicit Reader(const uint8_t *src) : p(src) {}
+
+        uint16_t u16()
+        {
+            uint16_t v = 0;
+            for (int i = 0; i < 2; i++)
+                v |= static_cast<uint16_t>(*p++) << (8 * i);
+            return v;
+        }
+        uint32_t u32()
+        {
+            uint32_t v = 0;
+            for (int i = 0; i < 4; i++)
+                v |= static_cast<uint32_t>(*p++) << (8 * i);
+            return v;
+        }
+        uint64_t u64()
+        {
+            uint64_t v = 0;
+            for (int i = 0; i < 8; i++)
+                v |= static_cast<uint64_t>(*p++) << (8 * i);
+            return v;
+        }
+        float f32()
+        {
+            uint32_t bits = u32();
+            float v;
+            std::memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+        double f64()
+        {
+            uint64_t bits = u64();
+            double v;
+            std::memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+        Vec2 vec2f()
+        {
+            float x = f32();
+            float y = f32();
+            return Vec2(x, y);
+        }
+
+    private:
+        const uint8_t *p;
+    };
+}
+
+inline void encodeTelemetryHeader(uint8_t *dst, uint16_t count, uint32_t packetSequence)
+{
+    telemetry_wire::Writer w(dst);
+    w.u32(telemetry_wire::MAGIC);
+    w.u16(telemetry_wire::VERSION);
+    w.u16(count);
+    w.u32(packetSequence);
+    w.u32(0);
+}
+
+inline void encodeTelemetryFrame(uint8_t *dst, const TelemetryRecord &r)
+{
+    telemetry_wire::Writer w(dst);
+    w.u64(r.sequence);
+    w.u16(static_cast<uint16_t>(r.aircraft));
+    w.u16(static_cast<uint16_t>(r.flags));
+    w.f64(r.t);
+    w.f64(r.position.x);
+    w.f64(r.position.y);
+    w.vec2f(r.velocity);
+    w.vec2f(r.F_thrust);
+    w.vec2f(r.F_drag);
+    w.vec2f(r.F_lift);
+    w.vec2f(r.F_weight);
+    w.f32(r.pitch_deg);
+    w.f32(r.pitch_rate);
+    w.f32(r.alpha_deg);
+    w.f32(r.throttle);
+    w.f32(r.elevator);
+    w.f32(r.speed_setpoint);
+    w.f32(r.altitude_setpoint);
+    w.f32(r.speed_p);
+    w.f32(r.speed_i);
+    w.f32(r.speed_d);
+    w.f32(r.altitude_p);
+    w.f32(r.altitude_i);
+    w.f32(r.altitude_d);
+}
+
+inline TelemetryRecord decodeTelemetryFrame(const uint8_t *src)
+{
+    telemetry_wire::Reader rd(src);
+    TelemetryRecord r{};
+    r.sequence = rd.u64();
+    r.aircraft = rd.u16();
+    r.flags = rd.u16();
+    r.t = rd.f64();
+    r.position.x = rd.f64();
+    r.position.y = rd.f64();
+    r.velocity = rd.vec2f();
+    r.F_thrust = rd.vec2f();
+    r.F_drag = rd.vec2f();
+    r.F_lift = rd.vec2f();
+    r.F_weight = rd.vec2f();
+    r.pitch_deg = rd.f32();
+    r.pitch_rate = rd.f32();
+    r.alpha_deg = rd.f32();
+    r.throttle = rd.f32();
+    r.elevator = rd.f32();
+    r.speed_setpoint = rd.f32();
+    r.altitude_setpoint = rd.f32();
+    r.speed_p = rd.f32();
+    r.speed_i = rd.f32();
+    r.speed_d = rd.f32();
+    r.altitude_p = rd.f32();
+    r.altitude_i = rd.f32();
+    r.altitude_d = rd.f32();
+    return r;
+}
+
+// Decode one datagram, calling fn(record) per frame
+// Returns the packet sequence; throws on a malformed or foreign datagram.
+template <typename Func>
+inline uint32_t decodeTelemetryPacket(const uint8_t *data, size_t size, Func &&fn)
+{
+    if (size < telemetry_wire::HEADER_BYTES)
+        throw std::runtime_error("Telemetry packet too short");
+
+    telemetry_wire::Reader rd(data);
+    if (rd.u32() != telemetry_wire::MAGIC)
+        throw std::runtime_error("Not a telemetry packet (bad magic)");
+    if (rd.u16() != telemetry_wire::VERSION)
+        throw std::runtime_error("Unsupported telemetry packet version");
+    uint16_t count = rd.u16();
+    uint32_t packetSequence = rd.u32();
+
+    if (size < telemetry_wire::HEADER_BYTES + count * telemetry_wire::FRAME_BYTES)
+        throw std::runtime_error("Telemetry packet truncated");
+
+    const uint8_t *frame = data + telemetry_wire::HEADER_BYTES;
+    for (uint16_t i = 0; i < count; i++, frame += telemetry_wire::FRAME_BYTES)
+        fn(decodeTelemetryFrame(frame));
+    return packetSequence;
+}
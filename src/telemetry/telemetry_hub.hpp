@@ -0,0 +1,175 @@
+#pragma once
+
+#include "spsc_ring.hpp"
+#include "telemetry_record.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Fan-out of telemetry records from the sim thread to several consumers
+//
+// The sim thread is the single producer. Each attached consumer (UI,
+// recorder, network exporter, ...) owns a private SPSC ring, so consumers
+// never contend with each other and a slow one only loses its own records.
+// publish() is wait-free: it visits a fixed number of slots, never takes a
+// lock and never allocates. A full ring drops the record and bumps that
+// consumer's overflow counter instead of blocking.
+//
+// All rings are allocated up front; attach/detach only flip a slot's state,
+// so the producer never touches memory that can be freed under it. The hub
+// must outlive its consumers.
+class TelemetryHub
+{
+public:
+    static constexpr size_t MaxConsumers = 8;
+
+    class Consumer;
+
+    explicit TelemetryHub(size_t capacityPerConsumer = 1024)
+    {
+        slots.reserve(MaxConsumers);
+        for (size_t i = 0; i < MaxConsumers; i++)
+            slots.emplace_back(new Slot(capacityPerConsumer));
+    }
+
+    TelemetryHub(const TelemetryHub &) = delete;
+    TelemetryHub &operator=(const TelemetryHub &) = delete;
+
+    // Producer: stamp the sequence number and offer the record to every consumer
+    void publish(TelemetryRecord record)
+    {
+        record.sequence = nextSequence.load(std::memory_order_relaxed);
+        // seq_cst pairs with attach(): a consumer that sees this sequence as its
+        // start is guaranteed to filter the record if it arrives after the attach
+        nextSequence.store(record.sequence + 1, std::memory_order_seq_cst);
+
+        for (auto &slot : slots)
+        {
+            if (!slot->active.load(std::memory_order_seq_cst))
+                continue;
+            if (!slot->ring.tryPush(record))
+                slot->dropped.store(slot->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    // Number of records published so far
+    uint64_t published() const { return nextSequence.load(std::memory_order_acquire); }
+
+    // Attach a new consumer; throws if all slots are taken
+    // Only records published after the attach are delivered.
+    Consumer attach();
+
+private:
+    struct Slot
+    {
+        explicit Slot(size_t capacity) : ring(capacity) {}
+
+        SpscRing<TelemetryRecord> ring;
+        std::atomic<bool> claimed{false};      // Owned by a Consumer handle
+        std::atomic<bool> active{false};       // Producer delivers to this slot
+        std::atomic<uint64_t> dropped{0};      // Written by the producer only
+        uint64_t startSequence = 0;            // Consumer side: first sequence to deliver
+        uint64_t droppedAtAttach = 0;          // Consumer side: overflow count before this attach
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::atomic<uint64_t> nextSequence{0};
+};
+
+// Handle to one consumer slot; detaches on destruction
+// Use from one thread at a time (the consumer side of the ring).
+class TelemetryHub::Consumer
+{
+public:
+    Consumer() = default;
+    Consumer(const Consumer &) = delete;
+    Consumer &operator=(const Consumer &) = delete;
+
+    Consumer(Consumer &&other) noexcept : slot(other.slot) { other.slot = nullptr; }
+
+    Consumer &operator=(Consumer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            detach();
+            slot = other.slot;
+            other.slot = nullptr;
+        }
+        return *this;
+    }
+
+    ~Consumer() { detach(); }
+
+    bool attached() const { return slot != nullptr; }
+
+    // Pop the oldest pending record; false if none
+    bool pop(TelemetryRecord &record)
+    {
+        if (!slot)
+            return false;
+        while (slot->ring.tryPop(record))
+        {
+            // Records from before this attach can still be in flight once
+            if (record.sequence >= slot->startSequence)
+                return true;
+        }
+        return false;
+    }
+
+    // Pop everything pending, calling fn(record) for each; returns the count
+    template <typename Func>
+    size_t drain(Func &&fn)
+    {
+        size_t count = 0;
+        TelemetryRecord record;
+        while (pop(record))
+        {
+            fn(record);
+            count++;
+        }
+        return count;
+    }
+
+    // Records this consumer lost because its ring was full
+    uint64_t dropped() const
+    {
+        return slot ? slot->dropped.load(std::memory_order_relaxed) - slot->droppedAtAttach : 0;
+    }
+
+    size_t capacity() const { return slot ? slot->ring.capacity() : 0; }
+
+    void detach()
+    {
+        if (!slot)
+            return;
+        slot->active.store(false, std::memory_order_seq_cst);
+        slot->claimed.store(false, std::memory_order_release);
+        slot = nullptr;
+    }
+
+private:
+    friend class TelemetryHub;
+    explicit Consumer(TelemetryHub::Slot *slot_) : slot(slot_) {}
+
+    TelemetryHub::Slot *slot = nullptr;
+};
+
+inline TelemetryHub::Consumer TelemetryHub::attach()
+{
+    for (auto &slot : slots)
+    {
+        bool expected = false;
+        if (!slot->claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+            continue;
+
+        // Anything left over from a previous consumer is discarded
+        slot->ring.discardAll();
+        slot->droppedAtAttach = slot->dropped.load(std::memory_order_relaxed);
+        slot->startSequence = nextSequence.load(std::memory_order_seq_cst);
+        slot->active.store(true, std::memory_order_seq_cst);
+        return Consumer(slot.get());
+    }
+    throw std::runtime_error("TelemetryHub: all consumer slots are in use");
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../simulation/simulation_state.hpp"
+#include <cstdint>
+#include <type_traits>
+
+// Snapshot of one aircraft after one physics step
+// Fixed size and trivially copyable so it can travel through lock-free rings
+// and be written to files or sockets as-is.
+struct TelemetryRecord
+{
+    enum Flags : uint32_t
+    {
+        SpeedAutopilot = 1u << 0,
+        AltitudeAutopilot = 1u << 1
+    };
+
+    uint64_t sequence; // Assigned by TelemetryHub::publish, increasing per hub
+    uint32_t aircraft; // Index of the aircraft in its scene (0 for single runs)
+    uint32_t flags;
+    double t;
+
+    Vec2 position;
+    Vec2 velocity;
+    Vec2 F_thrust;
+    Vec2 F_drag;
+    Vec2 F_lift;
+    Vec2 F_weight;
+
+    float pitch_deg;
+    float pitch_rate;
+    float alpha_deg;
+    float throttle;
+    float elevator;
+    float speed_setpoint;
+    float altitude_setpoint;
+
+    // PID term contributions from the last update
+    float speed_p, speed_i, speed_d;
+    float altitude_p, altitude_i, altitude_d;
+};
+
+static_assert(std::is_trivially_copyable<TelemetryRecord>::value, "TelemetryRecord must be trivially copyable");
+
+inline TelemetryRecord makeTelemetryRecord(const SimulationState &state, uint32_t aircraft = 0)
+{
+    TelemetryRecord r;
+    r.sequence = 0;
+    r.aircraft = aircraft;
+    r.flags = (state.autopilot_speed ? TelemetryRecord::SpeedAutopilot : 0u) |
+              (state.autopilot_altitude ? TelemetryRecord::AltitudeAutopilot : 0u);
+    r.t = state.t;
+    r.position = state.position;
+    r.velocity = state.velocity;
+    r.F_thrust = state.F_thrust_viz;
+    r.F_drag = state.F_drag_viz;
+    r.F_lift = state.F_lift_viz;
+    r.F_weight = state.F_weight_viz;
+    r.pitch_deg = state.pitch_deg;
+    r.pitch_rate = state.pitch_rate;
+    r.alpha_deg = state.alpha_deg;
+    r.throttle = state.throttle;
+    r.elevator = state.elevator;
+    r.speed_setpoint = state.speed_setpoint;
+    r.altitude_setpoint = state.altitude_setpoint;
+    r.speed_p = static_cast<float>(state.speed_pid.getProportionalTerm());
+    r.speed_i = static_cast<float>(state.speed_pid.getIntegralTerm());
+    r.speed_d = static_cast<float>(state.speed_pid.getDerivativeTerm());
+    r.altitude_p = static_cast<float>(state.altitude_pid.getProportionalTerm());
+    r.altitude_i = static_cast<float>(state.altitude_pid.getIntegralTerm());
+    r.altitude_d = static_cast<float>(state.altitude_pid.getDerivativeTerm());
+    return r;
+}
@@ -0,0 +1,632 @@
+#pragma once
+
+#include "../core/binary_io.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Compressed trajectory archives (.trj)
+//
+// A trajectory is a table of rows over fixed channels (t, x, altitude, ...).
+// Rows are cut into blocks, compressed channel by channel; every block
+// decodes on its own and an index at the end of the file locates them, so a
+// reader can jump to any row or time without touching the rest.
+//
+// A channel with a tolerance is quantized to steps of twice the tolerance
+// (every value decodes to within it) and stored as delta-of-delta integers:
+// sampled smooth signals have slowly changing slopes, so the second
+// differences are small zigzag varints, and runs of zeros (uniform time,
+// constant controls) collapse into one run-length token. A channel without
+// one is lossless, XOR-compressed as in Gorilla (Pelkonen et al., VLDB
+// 2015): each value is xored with the previous one and only the meaningful
+// bits of the xor are written. A block of a quantized channel holding
+// values that cannot be quantized (not finite, or beyond 2^52 steps) falls
+// back to the lossless encoding.
+//
+// File layout (little-endian; see BinaryWriter):
+//   header  "FTRJ", version, header bytes, block rows, channel count, {name, tolerance}...
+//   blocks  row count, then per channel: encoding, byte length, bytes
+//   index   block count, {offset, bytes, first row, rows, first value of channel 0}...
+//   footer  index offset, "FTRJ"
+struct TrajectoryChannel
+{
+    std::string name;
+    double tolerance = 0.0; // Largest decoding error; 0 = lossless
+};
+
+namespace trajectory_codec
+{
+    constexpr uint32_t Magic = 0x4a525446; // "FTRJ"
+    constexpr uint32_t Version = 1;
+    constexpr size_t HeaderStart = 12; // Magic, version, header bytes
+    constexpr size_t FooterBytes = 12;
+
+    enum Encoding : uint8_t
+    {
+        Xor = 0,
+        DeltaOfDelta = 1
+    };
+
+    inline int leadingZeros(uint64_t x) // x != 0
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(x);
+#else
+        int n = 0;
+        for (uint64_t bit = uint64_t(1) << 63; !(x & bit); bit >>= 1)
+            n++;
+        return n;
+#endif
+    }
+
+    inline int trailingZeros(uint64_t x) // x != 0
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(x);
+#else
+        int n = 0;
+        for (; !(x & 1); x >>= 1)
+            n++;
+        return n;
+#endif
+    }
+
+    inline uint64_t lowBits(int bits) { return bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1; }
+
+    // Most significant bit first
+    class BitWriter
+    {
+    public:
+        std::vector<uint8_t> bytes;
+
+        void put(uint64_t value, int bits)
+        {
+            if (bits > 32)
+            {
+                put(value >> 32, bits - 32);
+                value &= 0xffffffffu;
+                bits = 32;
+            }
+            acc = (acc << bits) | (value & lowBits(bits));
+            fill += bits;
+            while (fill >= 8)
+            {
+                fill -= 8;
+                bytes.push_back(static_cast<uint8_t>(acc >> fill));
+            }
+            acc &= lowBits(fill);
+        }
+
+        // Pad the last byte with zeros
+        void finish()
+        {
+            if (fill > 0)
+                bytes.push_back(static_cast<uint8_t>(acc << (8 - fill)));
+            acc = 0;
+            fill = 0;
+        }
+
+    private:
+        uint64_t acc = 0;
+        int fill = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t *data, size_t size) : p(data), end(data + size) {}
+
+        uint64_t get(int bits)
+        {
+            if (bits > 32)
+            {
+                uint64_t high = get(bits - 32);
+                return (high << 32) | get(32);
+            }
+            while (fill < bits)
+            {
+                if (p == end)
+                    throw std::runtime_error("Truncated trajectory block");
+                acc = (acc << 8) | *p++;
+                fill += 8;
+            }
+            fill -= bits;
+            return (acc >> fill) & lowBits(bits);
+        }
+
+    private:
+        const uint8_t *p;
+        const uint8_t *end;
+        uint64_t acc = 0;
+        int fill = 0;
+    };
+
+    inline uint64_t bitsOf(double v)
+    {
+        uint64_t b;
+        std::memcpy(&b, &v, sizeof(b));
+        return b;
+    }
+
+    inline double fromBits(uint64_t b)
+    {
+        double v;
+        std::memcpy(&v, &b, sizeof(v));
+        return v;
+    }
+
+    // Gorilla: '0' same value; '10' xor within the previous window of
+    // meaningful bits; '11', 5 bits of leading zeros, 6 bits of length - 1,
+    // then the bits (a new window)
+    inline std::vector<uint8_t> encodeXor(const double *values, size_t n)
+    {
+        BitWriter w;
+        if (n == 0)
+            return w.bytes;
+        uint64_t prev = bitsOf(values[0]);
+        w.put(prev, 64);
+        int leading = -1, trailing = 0;
+        for (size_t i = 1; i < n; i++)
+        {
+            uint64_t bits = bitsOf(values[i]);
+            uint64_t x = bits ^ prev;
+            prev = bits;
+            if (x == 0)
+            {
+                w.put(0, 1);
+                continue;
+            }
+            int lz = std::min(leadingZeros(x), 31);
+            int tz = trailingZeros(x);
+            if (leading >= 0 && lz >= leading && tz >= trailing)
+            {
+                w.put(0b10, 2);
+                w.put(x >> trailing, 64 - leading - trailing);
+            }
+            else
+            {
+                int significant = 64 - lz - tz;
+                w.put(0b11, 2);
+                w.put(static_cast<uint64_t>(lz), 5);
+                w.put(static_cast<uint64_t>(significant - 1), 6);
+                w.put(x >> tz, significant);
+                leading = lz;
+                trailing = tz;
+            }
+        }
+        w.finish();
+        return w.bytes;
+    }
+
+    inline void decodeXor(const uint8_t *data, size_t size, double *values, size_t n)
+    {
+        if (n == 0)
+            return;
+        BitReader r(data, size);
+        uint64_t prev = r.get(64);
+        values[0] = fromBits(prev);
+        int leading = 0, trailing = 0;
+        for (size_t i = 1; i < n; i++)
+        {
+            if (r.get(1) != 0)
+            {
+                if (r.get(1) != 0)
+                {
+                    leading = static_cast<int>(r.get(5));
+                    int significant = static_cast<int>(r.get(6)) + 1;
+                    trailing = 64 - leading - significant;
+                    if (trailing < 0)
+                        throw std::runtime_error("Malformed trajectory block");
+                }
+                prev ^= r.get(64 - leading - trailing) << trailing;
+            }
+            values[i] = fromBits(prev);
+        }
+    }
+
+    // Quantized steps of 2 tolerance; nullopt if a value does not fit
+    inline std::optional<std::vector<int64_t>> quantize(const double *values, size_t n, double tolerance)
+    {
+        const double step = 2.0 * tolerance;
+        std::vector<int64_t> k(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            double q = std::round(values[i] / step);
+            if (!(std::fabs(q) < 0x1.0p52))
+                return std::nullopt;
+            k[i] = static_cast<int64_t>(q);
+        }
+        return k;
+    }
+
+    // First value, first difference, then second differences as zigzag
+    // varint tokens: a value d as 2 zigzag(d), a run of r zeros as 2 r + 1
+    inline std::vector<uint8_t> encodeDeltaOfDelta(const std::vector<int64_t> &k)
+    {
+        BinaryWriter w;
+        const size_t n = k.size();
+        if (n > 0)
+            w.svarint(k[0]);
+        if (n > 1)
+            w.svarint(k[1] - k[0]);
+        uint64_t zeros = 0;
+        for (size_t i = 2; i < n; i++)
+        {
+            int64_t dod = (k[i] - k[i - 1]) - (k[i - 1] - k[i - 2]);
+            if (dod == 0)
+            {
+                zeros++;
+                continue;
+            }
+            if (zeros > 0)
+                w.uvarint(2 * zeros + 1);
+            zeros = 0;
+            w.uvarint(2 * ((static_cast<uint64_t>(dod) << 1) ^ static_cast<uint64_t>(dod >> 63)));
+        }
+        if (zeros > 0)
+            w.uvarint(2 * zeros + 1);
+        return w.bytes;
+    }
+
+    inline void decodeDeltaOfDelta(const uint8_t *data, size_t size, double step, double *values, size_t n)
+    {
+        BinaryReader r(data, size);
+        if (n == 0)
+            return;
+        int64_t k = r.svarint();
+        values[0] = static_cast<double>(k) * step;
+        if (n == 1)
+            return;
+        int64_t delta = r.svarint();
+        k += delta;
+        values[1] = static_cast<double>(k) * step;
+        size_t i = 2;
+        while (i < n)
+        {
+            uint64_t token = r.uvarint();
+            if (token & 1)
+            {
+                uint64_t zeros = token >> 1;
+                if (zeros > n - i)
+                    throw std::runtime_error("Malformed trajectory block");
+                for (; zeros > 0; zeros--, i++)
+                {
+                    k += delta;
+                    values[i] = static_cast<double>(k) * step;
+                }
+            }
+            else
+            {
+                uint64_t z = token >> 1;
+                delta += static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+                k += delta;
+                values[i++] = static_cast<double>(k) * step;
+            }
+        }
+    }
+}
+
+// Where a block lies in the file and what it holds
+struct TrajectoryBlockInfo
+{
+    uint64_t offset = 0;
+    uint64_t bytes = 0;
+    uint64_t first_row = 0;
+    uint32_t rows = 0;
+    double first_value = 0.0; // Channel 0 (time) of the block's first row, decoded
+};
+
+// Decoded rows of one block, by channel: block[c][r]
+struct TrajectoryBlock
+{
+    uint64_t first_row = 0;
+    size_t rows = 0;
+    std::vector<std::vector<double>> columns;
+
+    const std::vector<double> &operator[](size_t channel) const { return columns[channel]; }
+};
+
+// Streaming archive writer
+// Rows are buffered until a block is full, then the block is encoded and
+// written, so memory stays at one block whatever the length of the run and
+// the file can be written from the thread that produces the rows (or a
+// recorder thread fed by it). close() writes the last block and the index;
+// a file that was never closed has no index and does not open. The
+// destructor closes the file too, unless it runs while an exception
+// unwinds the writer's scope: a run that failed part-way leaves a file that
+// does not open, not one that reads as complete.
+class TrajectoryArchiveWriter
+{
+public:
+    TrajectoryArchiveWriter(const std::filesystem::path &filepath, std::vector<TrajectoryChannel> channels_,
+                            size_t blockRows_ = 4096)
+        : channels(std::move(channels_)), blockRows(blockRows_), columns(channels.size()),
+          exceptionsAtStart(std::uncaught_exceptions())
+    {
+        if (channels.empty() || blockRows == 0)
+            throw std::runtime_error("Trajectory archives need channels and a positive block size");
+        for (const TrajectoryChannel &c : channels)
+            if (!(c.tolerance >= 0.0))
+                throw std::runtime_error("Trajectory channel tolerance must be non-negative");
+        for (std::vector<double> &column : columns)
+            column.reserve(blockRows);
+
+        file.open(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open output file: " + filepath.string());
+        BinaryWriter body;
+        body.u32(static_cast<uint32_t>(blockRows));
+        body.u32(static_cast<uint32_t>(channels.size()));
+        for (const TrajectoryChannel &c : channels)
+        {
+            body.string(c.name);
+            body.f64(c.tolerance);
+        }
+        BinaryWriter header;
+        header.u32(trajectory_codec::Magic);
+        header.u32(trajectory_codec::Version);
+        header.u32(static_cast<uint32_t>(trajectory_codec::HeaderStart + body.bytes.size()));
+        header.raw(body.bytes.data(), body.bytes.size());
+        put(header.bytes);
+    }
+
+    TrajectoryArchiveWriter(const TrajectoryArchiveWriter &) = delete;
+    TrajectoryArchiveWriter &operator=(const TrajectoryArchiveWriter &) = delete;
+
+    ~TrajectoryArchiveWriter()
+    {
+        try
+        {
+            if (std::uncaught_exceptions() > exceptionsAtStart)
+                file.close(); // Unwinding: no index
+            else
+                close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    size_t channelCount() const { return channels.size(); }
+    uint64_t rows() const { return rowCount; }
+    uint64_t bytesWritten() const { return offset; }
+
+    // One value per channel
+    void append(const double *row)
+    {
+        for (size_t c = 0; c < channels.size(); c++)
+            columns[c].push_back(row[c]);
+        rowCount++;
+        if (columns[0].size() == blockRows)
+            flushBlock();
+    }
+
+    void close()
+    {
+        if (!file.is_open())
+            return;
+        flushBlock();
+        const uint64_t indexOffset = offset;
+        BinaryWriter index;
+        index.u32(static_cast<uint32_t>(blocks.size()));
+        for (const TrajectoryBlockInfo &b : blocks)
+        {
+            index.u64(b.offset);
+            index.u64(b.bytes);
+            index.u64(b.first_row);
+            index.u32(b.rows);
+            index.f64(b.first_value);
+        }
+        index.u64(indexOffset);
+        index.u32(trajectory_codec::Magic);
+        put(index.bytes);
+        file.close();
+        if (file.fail())
+            throw std::runtime_error("Failed to write trajectory archive");
+    }
+
+private:
+    std::vector<TrajectoryChannel> channels;
+    size_t blockRows;
+    std::vector<std::vector<double>> columns; // Rows of the open block
+    std::vector<TrajectoryBlockInfo> blocks;
+    uint64_t rowCount = 0;
+    uint64_t offset = 0;
+    std::ofstream file;
+    int exceptionsAtStart; // In flight when the writer was made
+
+    void put(const std::vector<uint8_t> &bytes)
+    {
+        file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        offset += bytes.size();
+    }
+
+    void flushBlock()
+    {
+        using namespace trajectory_codec;
+        const size_t n = columns[0].size();
+        if (n == 0)
+            return;
+        TrajectoryBlockInfo info;
+        info.offset = offset;
+        info.first_row = rowCount - n;
+        info.rows = static_cast<uint32_t>(n);
+
+        BinaryWriter block;
+        block.uvarint(n);
+        for (size_t c = 0; c < channels.size(); c++)
+        {
+            std::optional<std::vector<int64_t>> k;
+            if (channels[c].tolerance > 0.0)
+                k = quantize(columns[c].data(), n, channels[c].tolerance);
+            std::vector<uint8_t> bytes = k ? encodeDeltaOfDelta(*k) : encodeXor(columns[c].data(), n);
+            block.u8(k ? DeltaOfDelta : Xor);
+            block.uvarint(bytes.size());
+            block.raw(bytes.data(), bytes.size());
+            if (c == 0)
+                info.first_value = k ? static_cast<double>((*k)[0]) * (2.0 * channels[0].tolerance) : columns[0][0];
+            columns[c].clear();
+        }
+        info.bytes = block.bytes.size();
+        put(block.bytes);
+        blocks.push_back(info);
+    }
+};
+
+// Archive reader: the header and index are read on opening, blocks on demand
+// Reads share one file handle, so an archive object is for one thread; open
+// the file once per thread to decode blocks in parallel.
+class TrajectoryArchive
+{
+public:
+    explicit TrajectoryArchive(const std::filesystem::path &filepath)
+        : name(filepath.string())
+    {
+        file.open(filepath, std::ios::in | std::ios::binary);
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open " + name);
+        file.seekg(0, std::ios::end);
+        const uint64_t size = static_cast<uint64_t>(file.tellg());
+        if (size < trajectory_codec::HeaderStart + trajectory_codec::FooterBytes)
+            throw std::runtime_error(name + " is not a trajectory archive");
+
+        std::vector<uint8_t> start = read(0, trajectory_codec::HeaderStart);
+        BinaryReader lead(start);
+        if (lead.u32() != trajectory_codec::Magic || lead.u32() != trajectory_codec::Version)
+            throw std::runtime_error(name + " is not a trajectory archive");
+        const uint64_t headerSize = lead.u32();
+
+        std::vector<uint8_t> end = read(size - trajectory_codec::FooterBytes, trajectory_codec::FooterBytes);
+        BinaryReader footer(end);
+        const uint64_t indexOffset = footer.u64();
+        if (footer.u32() != trajectory_codec::Magic || indexOffset > size - trajectory_codec::FooterBytes ||
+            headerSize < trajectory_codec::HeaderStart || headerSize > indexOffset)
+            throw std::runtime_error(name + " is not a complete trajectory archive");
+
+        std::vector<uint8_t> headerBytes = read(trajectory_codec::HeaderStart, headerSize - trajectory_codec::HeaderStart);
+        BinaryReader header(headerBytes);
+        blockRows = header.u32();
+        channels_.resize(header.count(12));
+        for (TrajectoryChannel &c : channels_)
+        {
+            c.name = header.string();
+            c.tolerance = header.f64();
+        }
+        if (channels_.empty())
+            throw std::runtime_error(name + " has no channels");
+
+        std::vector<uint8_t> indexBytes = read(indexOffset, size - trajectory_codec::FooterBytes - indexOffset);
+        BinaryReader index(indexBytes);
+        blocks.resize(index.count(36));
+        for (TrajectoryBlockInfo &b : blocks)
+        {
+            b.offset = index.u64();
+            b.bytes = index.u64();
+            b.first_row = index.u64();
+            b.rows = index.u32();
+            b.first_value = index.f64();
+            if (b.offset + b.bytes > indexOffset || b.first_row != rowCount)
+                throw std::runtime_error(name + " has a corrupt block index");
+            rowCount += b.rows;
+        }
+    }
+
+    const std::vector<TrajectoryChannel> &channels() const { return channels_; }
+    uint64_t rows() const { return rowCount; }
+    size_t blockSize() const { return blockRows; } // Rows per block, the last may hold fewer
+    size_t blockCount() const { return blocks.size(); }
+    const TrajectoryBlockInfo &block(size_t i) const { return blocks.at(i); }
+
+    size_t channelIndex(const std::string &channel) const
+    {
+        for (size_t c = 0; c < channels_.size(); c++)
+            if (channels_[c].name == channel)
+                return c;
+        throw std::runtime_error(name + " has no channel " + channel);
+    }
+
+    // Block holding a row
+    size_t blockForRow(uint64_t row) const
+    {
+        if (row >= rowCount)
+            throw std::runtime_error("Row beyond the end of " + name);
+        auto it = std::upper_bound(blocks.begin(), blocks.end(), row, [](uint64_t r, const TrajectoryBlockInfo &b)
+                                   { return r < b.first_row; });
+        return static_cast<size_t>(it - blocks.begin()) - 1;
+    }
+
+    // Last block starting at or before t on channel 0 (rows in time order)
+    size_t blockForTime(double t) const
+    {
+        auto it = std::upper_bound(blocks.begin(), blocks.end(), t, [](double v, const TrajectoryBlockInfo &b)
+                                   { return v < b.first_value; });
+        return it == blocks.begin() ? 0 : static_cast<size_t>(it - blocks.begin()) - 1;
+    }
+
+    TrajectoryBlock readBlock(size_t i)
+    {
+        using namespace trajectory_codec;
+        const TrajectoryBlockInfo &info = blocks.at(i);
+        std::vector<uint8_t> bytes = read(info.offset, info.bytes);
+        BinaryReader r(bytes);
+        TrajectoryBlock block;
+        block.first_row = info.first_row;
+        block.rows = static_cast<size_t>(r.uvarint());
+        if (block.rows != info.rows)
+            throw std::runtime_error(name + " has a corrupt block");
+        block.columns.resize(channels_.size(), std::vector<double>(block.rows));
+        for (size_t c = 0; c < channels_.size(); c++)
+        {
+            const uint8_t encoding = r.u8();
+            const size_t size = static_cast<size_t>(r.uvarint());
+            const uint8_t *data = r.skip(size);
+            if (encoding == DeltaOfDelta && channels_[c].tolerance > 0.0)
+                decodeDeltaOfDelta(data, size, 2.0 * channels_[c].tolerance, block.columns[c].data(), block.rows);
+            else if (encoding == Xor)
+                decodeXor(data, size, block.columns[c].data(), block.rows);
+            else
+                throw std::runtime_error(name + " has an unknown channel encoding");
+        }
+        return block;
+    }
+
+    // Every row of one channel
+    std::vector<double> readChannel(size_t channel)
+    {
+        std::vector<double> values;
+        values.reserve(static_cast<size_t>(rowCount));
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            TrajectoryBlock b = readBlock(i);
+            values.insert(values.end(), b.columns.at(channel).begin(), b.columns.at(channel).end());
+        }
+        return values;
+    }
+
+private:
+    std::string name;
+    std::ifstream file;
+    std::vector<TrajectoryChannel> channels_;
+    std::vector<TrajectoryBlockInfo> blocks;
+    uint32_t blockRows = 0;
+    uint64_t rowCount = 0;
+
+    std::vector<uint8_t> read(uint64_t at, uint64_t size)
+    {
+        std::vector<uint8_t> bytes(static_cast<size_t>(size));
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(at));
+        file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(size));
+        if (!file)
+            throw std::runtime_error("Failed to read " + name);
+        return bytes;
+    }
+};
@@ -0,0 +1,131 @@
+// Reference receiver for the binary telemetry stream
+// Usage: TelemetryReceiver <udp://host:port | unix:///path> [--csv <file>] [--count <frames>]
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "telemetry/datagram_socket.hpp"
+#include "telemetry/telemetry_frame.hpp"
+
+static void printUsage()
+{
+    std::cout << "Usage: TelemetryReceiver <udp://host:port | unix:///path> [--csv <file>] [--count <frames>]\n"
+              << "  Prints a status line per second; --count exits after that many frames.\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::string endpoint;
+    std::string csvPath;
+    uint64_t maxFrames = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--csv" && i + 1 < argc)
+            csvPath = argv[++i];
+        else if (arg == "--count" && i + 1 < argc)
+            maxFrames = std::stoull(argv[++i]);
+        else if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (endpoint.empty())
+            endpoint = arg;
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (endpoint.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    DatagramSocket socket;
+    try
+    {
+        socket = DatagramSocket::bindTo(TelemetryEndpoint::parse(endpoint));
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::ofstream csv;
+    if (!csvPath.empty())
+    {
+        csv.open(csvPath);
+        csv << "sequence,aircraft,t,x,altitude,vx,vz,throttle,elevator,pitch_deg,alpha_deg\n";
+    }
+
+    std::cout << "Listening on " << endpoint << "\n";
+
+    std::vector<uint8_t> buffer(65536);
+    uint64_t frames = 0, packets = 0, lostPackets = 0, badPackets = 0;
+    uint64_t framesThisSecond = 0;
+    bool havePacket = false;
+    uint32_t lastPacket = 0;
+    TelemetryRecord latest{};
+    auto lastReport = std::chrono::steady_clock::now();
+
+    while (maxFrames == 0 || frames < maxFrames)
+    {
+        size_t size = socket.receive(buffer.data(), buffer.size(), 500);
+        if (size > 0)
+        {
+            try
+            {
+                uint32_t seq = decodeTelemetryPacket(buffer.data(), size, [&](const TelemetryRecord &r)
+                                                     {
+                    latest = r;
+                    frames++;
+                    framesThisSecond++;
+                    if (csv.is_open())
+                    {
+                        char line[256];
+                        int len = std::snprintf(line, sizeof(line), "%llu,%u,%.4f,%.3f,%.3f,%.3f,%.3f,%.4f,%.4f,%.3f,%.3f\n",
+                                                static_cast<unsigned long long>(r.sequence), r.aircraft, r.t,
+                                                r.position.x, r.position.y, r.velocity.x, r.velocity.y,
+                                                r.throttle, r.elevator, r.pitch_deg, r.alpha_deg);
+                        csv.write(line, len);
+                    } });
+                if (havePacket && seq != lastPacket + 1)
+                    lostPackets += static_cast<uint32_t>(seq - lastPacket - 1);
+                lastPacket = seq;
+                havePacket = true;
+                packets++;
+            }
+            catch (const std::exception &)
+            {
+                badPackets++;
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(1))
+        {
+            std::printf("%8llu frames/s | %llu packets, %llu lost, %llu bad | t=%.2f alt=%.1f m speed=%.1f m/s\n",
+                        static_cast<unsigned long long>(framesThisSecond),
+                        static_cast<unsigned long long>(packets),
+                        static_cast<unsigned long long>(lostPackets),
+                        static_cast<unsigned long long>(badPackets),
+                        latest.t, latest.position.y, latest.velocity.magnitude());
+            std::fflush(stdout);
+            framesThisSecond = 0;
+            lastReport = now;
+        }
+    }
+
+    std::printf("Received %llu frames in %llu packets (%llu lost, %llu bad)\n",
+                static_cast<unsigned long long>(frames), static_cast<unsigned long long>(packets),
+                static_cast<unsigned long long>(lostPackets), static_cast<unsigned long long>(badPackets));
+    return 0;
+}
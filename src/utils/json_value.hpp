@@ -0,0 +1,429 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Minimal JSON document model for scenario and result files
+// Supports the full JSON grammar except \u escapes outside ASCII. Objects keep
+// their keys in file order. Accessors throw std::runtime_error on type
+// mismatches so config errors surface with the offending key.
+class JsonValue
+{
+public:
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    JsonValue() : kind(Type::Null), boolean(false), number(0.0) {}
+
+    static JsonValue parse(const std::string &text)
+    {
+        Parser parser{text, 0};
+        JsonValue value = parser.parseValue();
+        parser.skipWhitespace();
+        if (parser.pos != text.size())
+            parser.fail("unexpected trailing characters");
+        return value;
+    }
+
+    static JsonValue parseFile(const std::string &filepath)
+    {
+        std::ifstream file(filepath);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Failed to open JSON file: " + filepath);
+        }
+        std::string content((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+        try
+        {
+            return parse(content);
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error(filepath + ": " + e.what());
+        }
+    }
+
+    Type type() const { return kind; }
+    bool isNull() const { return kind == Type::Null; }
+    bool isBool() const { return kind == Type::Bool; }
+    bool isNumber() const { return kind == Type::Number; }
+    bool isString() const { return kind == Type::String; }
+    bool isArray() const { return kind == Type::Array; }
+    bool isObject() const { return kind == Type::Object; }
+
+    bool asBool() const
+    {
+        expect(Type::Bool, "bool");
+        return boolean;
+    }
+
+    double asNumber() const
+    {
+        expect(Type::Number, "number");
+        return number;
+    }
+
+    const std::string &asString() const
+    {
+        expect(Type::String, "string");
+        return text;
+    }
+
+    // Array/object element count
+    size_t size() const { return items.size(); }
+
+    const JsonValue &operator[](size_t index) const
+    {
+        expect(Type::Array, "array");
+        if (index >= items.size())
+            throw std::runtime_error("JSON array index out of range");
+        return items[index];
+    }
+
+    const std::vector<JsonValue> &elements() const
+    {
+        expect(Type::Array, "array");
+        return items;
+    }
+
+    // Object lookup; returns nullptr if the key is missing
+    const JsonValue *find(const std::string &key) const
+    {
+        expect(Type::Object, "object");
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if (keys[i] == key)
+                return &items[i];
+        }
+        return nullptr;
+    }
+
+    bool has(const std::string &key) const { return find(key) != nullptr; }
+
+    const JsonValue &operator[](const std::string &key) const
+    {
+        const JsonValue *value = find(key);
+        if (!value)
+            throw std::runtime_error("Key not found in JSON: " + key);
+        return *value;
+    }
+
+    const std::vector<std::string> &objectKeys() const
+    {
+        expect(Type::Object, "object");
+        return keys;
+    }
+
+    double numberOr(const std::string &key, double fallback) const
+    {
+        const JsonValue *value = find(key);
+        return value ? value->asNumber() : fallback;
+    }
+
+    bool boolOr(const std::string &key, bool fallback) const
+    {
+        const JsonValue *value = find(key);
+        return value ? value->asBool() : fallback;
+    }
+
+    std::string stringOr(const std::string &key, const std::string &fallback) const
+    {
+        const JsonValue *value = find(key);
+        return value ? value->asString() : fallback;
+    }
+
+private:
+    Type kind;
+    bool boolean;
+    double number;
+    std::string text;
+    std::vector<std::string> keys; // Object keys, parallel to items
+    std::vector<JsonValue> items;  // Array elements or object values
+
+    static const char *typeName(Type type)
+    {
+        switch (type)
+        {
+        case Type::Null:
+            return "null";
+        case Type::Bool:
+            return "bool";
+        case Type::Number:
+            return "number";
+        case Type::String:
+            return "string";
+        case Type::Array:
+            return "array";
+        default:
+            return "object";
+        }
+    }
+
+    void expect(Type wanted, const char *name) const
+    {
+        if (kind != wanted)
+        {
+            throw std::runtime_error(std::string("JSON value is ") + typeName(kind) + ", expected " + name);
+        }
+    }
+
+    struct Parser
+    {
+        const std::string &src;
+        size_t pos;
+
+        [[noreturn]] void fail(const std::string &message) const
+        {
+            size_t line = 1;
+            for (size_t i = 0; i < pos && i < src.size(); i++)
+            {
+                if (src[i] == '\n')
+                    line++;
+            }
+            throw std::runtime_error("JSON parse error at line " + std::to_string(line) + ": " + message);
+        }
+
+        void skipWhitespace()
+        {
+            while (pos < src.size() && (src[pos] == ' ' || src[pos] == '\t' || src[pos] == '\n' || src[pos] == '\r'))
+                pos++;
+        }
+
+        bool consume(char c)
+        {
+            skipWhitespace();
+            if (pos < src.size() && src[pos] == c)
+            {
+                pos++;
+                return true;
+            }
+            return false;
+        }
+
+        void require(char c)
+        {
+            if (!consume(c))
+                fail(std::string("expected '") + c + "'");
+        }
+
+        bool matchWord(const char *word)
+        {
+            size_t len = std::char_traits<char>::length(word);
+            if (src.compare(pos, len, word) == 0)
+            {
+                pos += len;
+                return true;
+            }
+            return false;
+        }
+
+        JsonValue parseValue()
+        {
+            skipWhitespace();
+            if (pos >= src.size())
+                fail("unexpected end of input");
+
+            JsonValue value;
+            char c = src[pos];
+            if (c == '{')
+            {
+                pos++;
+                value.kind = Type::Object;
+                if (consume('}'))
+                    return value;
+                do
+                {
+                    skipWhitespace();
+                    if (pos >= src.size() || src[pos] != '"')
+                        fail("expected object key");
+                    value.keys.push_back(parseString());
+                    require(':');
+                    value.items.push_back(parseValue());
+                } while (consume(','));
+                require('}');
+            }
+            else if (c == '[')
+            {
+                pos++;
+                value.kind = Type::Array;
+                if (consume(']'))
+                    return value;
+                do
+                {
+                    value.items.push_back(parseValue());
+                } while (consume(','));
+                require(']');
+            }
+            else if (c == '"')
+            {
+                value.kind = Type::String;
+                value.text = parseString();
+            }
+            else if (matchWord("true"))
+            {
+                value.kind = Type::Bool;
+                value.boolean = true;
+            }
+            else if (matchWord("false"))
+            {
+                value.kind = Type::Bool;
+                value.boolean = false;
+            }
+            else if (matchWord("null"))
+            {
+                value.kind = Type::Null;
+            }
+            else
+            {
+                value.kind = Type::Number;
+                value.number = parseNumber();
+            }
+            return value;
+        }
+
+        // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? and nothing else:
+        // strtod alone would also take nan, inf, hex floats and a leading +
+        double parseNumber()
+        {
+            const size_t start = pos;
+            auto digits = [this]
+            {
+                size_t first = pos;
+                while (pos < src.size() && src[pos] >= '0' && src[pos] <= '9')
+                    pos++;
+                return pos - first;
+            };
+            if (pos < src.size() && src[pos] == '-')
+                pos++;
+            if (pos < src.size() && src[pos] == '0')
+                pos++;
+            else if (digits() == 0)
+                fail("invalid value");
+            if (pos < src.size() && src[pos] == '.')
+            {
+                pos++;
+                if (digits() == 0)
+                    fail("invalid number");
+            }
+            if (pos < src.size() && (src[pos] == 'e' || src[pos] == 'E'))
+            {
+                pos++;
+                if (pos < src.size() && (src[pos] == '+' || src[pos] == '-'))
+                    pos++;
+                if (digits() == 0)
+                    fail("invalid number");
+            }
+            double number = std::strtod(src.substr(start, pos - start).c_str(), nullptr);
+            if (!std::isfinite(number))
+                fail("number out of range");
+            return number;
+        }
+
+        std::string parseString()
+        {
+            pos++; // opening quote
+            std::string out;
+            while (pos < src.size() && src[pos] != '"')
+            {
+                char c = src[pos++];
+                if (c != '\\')
+                {
+                    out += c;
+                    continue;
+                }
+                if (pos >= src.size())
+                    fail("unterminated escape");
+                char e = src[pos++];
+                switch (e)
+                {
+                case 'n':
+                    out += '\n';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'u':
+                {
+                    if (pos + 4 > src.size())
+                        fail("invalid \\u escape");
+                    unsigned code = static_cast<unsigned>(std::stoul(src.substr(pos, 4), nullptr, 16));
+                    pos += 4;
+                    out += code < 0x80 ? static_cast<char>(code) : '?';
+                    break;
+                }
+                default:
+                    out += e; // \" \\ \/
+                    break;
+                }
+            }
+            if (pos >= src.size())
+                fail("unterminated string");
+            pos++; // closing quote
+            return out;
+        }
+    };
+};
+
+// Escape a string for embedding in JSON output
+inline std::string jsonEscape(const std::string &value)
+{
+    std::string out;
+    out.reserve(value.size() + 2);
+    for (char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                const char *hex = "0123456789abcdef";
+                out += "\\u00";
+                out += hex[(c >> 4) & 0xf];
+                out += hex[c & 0xf];
+            }
+            else
+            {
+                out += c;
+            }
+            break;
+        }
+    }
+    return out;
+}
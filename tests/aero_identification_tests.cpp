@@ -0,0 +1,258 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "simulation/aero_identification.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+/**
+ * TEST STRATEGY:
+ * 1. Logs load by column name and reject missing columns and
+ *    non-increasing time
+ * 2. Synthetic logs flown by the simulator with a known aircraft: a fit from
+ *    a wrong start recovers the polar, and the table nodes around the
+ *    angles of attack the flight covers
+ * 3. The result does not depend on the thread count; a fit that cannot
+ *    lower the cost at all is not reported as converged
+ * 4. The written JSON/CSV pair loads with AircraftLoader and reproduces the fit;
+ *    file names are escaped and load back unchanged
+ */
+
+static std::filesystem::path tempPath(const std::string &name)
+{
+    return std::filesystem::temp_directory_path() / ("flightsim_aerofit_" + name);
+}
+
+// Fly an aircraft open loop with varying elevator and throttle, logging every step
+static FlightLog flyLog(const Aircraft &aircraft, double duration)
+{
+    SimulationState state;
+    state.aircraft = aircraft;
+    state.dt = 0.01;
+    state.maxPathPoints = 0;
+    state.position = Vec2(0.0, 400.0);
+    state.velocity = Vec2(32.0, 0.0);
+    state.pitch_deg = 3.0f;
+    PhysicsStepFn step = selectPhysicsStep(state);
+
+    FlightLog log;
+    log.rows.push_back({state.t, state.position.x, state.position.y, state.velocity.x, state.velocity.y,
+                        state.pitch_deg, state.throttle});
+    while (state.t < duration)
+    {
+        state.elevator = static_cast<float>(0.12 * std::sin(0.9 * state.t) + 0.05 * std::sin(2.3 * state.t));
+        state.throttle = static_cast<float>(0.55 + 0.35 * std::sin(0.4 * state.t));
+        step(state);
+        log.rows.push_back({state.t, state.position.x, state.position.y, state.velocity.x, state.velocity.y,
+                            state.pitch_deg, state.throttle});
+    }
+    return log;
+}
+
+TEST_CASE("Aero identification - flight log loading")
+{
+    std::filesystem::path path = tempPath("log.csv");
+    {
+        std::ofstream f(path);
+        f << "vz,t,pitch_deg,extra,altitude,throttle,vx\n"
+          << "-1.0,0.0,2.5,9,100.0,0.5,30.0\n"
+          << "-1.1,0.1,2.6,9,99.9,0.5,30.1\n";
+    }
+    FlightLog log = FlightLog::loadFromCSV(path.string());
+    REQUIRE(log.rows.size() == 2);
+    REQUIRE(log.rows[1].t == 0.1);
+    REQUIRE(log.rows[1].altitude == 99.9);
+    REQUIRE(log.rows[1].vx == 30.1);
+    REQUIRE(log.rows[1].vz == -1.1);
+    REQUIRE(log.rows[1].pitch_deg == 2.6);
+    REQUIRE(log.rows[1].x == 0.0); // Optional column
+
+    {
+        std::ofstream f(path);
+        f << "t,altitude,vx,vz,throttle\n0,100,30,0,0.5\n";
+    }
+    REQUIRE_THROWS_WITH(FlightLog::loadFromCSV(path.string()), Catch::Matchers::ContainsSubstring("pitch_deg"));
+
+    {
+        std::ofstream f(path);
+        f << "t,altitude,vx,vz,pitch_deg,throttle\n0.1,100,30,0,2,0.5\n0.1,100,30,0,2,0.5\n";
+    }
+    REQUIRE_THROWS(FlightLog::loadFromCSV(path.string()));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Aero identification - recovers the polar")
+{
+    Aircraft truth;
+    truth.CL_alpha = 5.7;
+    truth.CD0 = 0.025;
+    truth.k = 0.04;
+    FlightLog log = flyLog(truth, 30.0);
+
+    Aircraft start = truth;
+    start.CL_alpha = 4.5;
+    start.CD0 = 0.04;
+    start.k = 0.06;
+
+    AeroFitOptions options;
+    options.mode = AeroFitMode::Polar;
+    ThreadPool pool(2);
+    AeroFitResult r = fitAeroCoefficients(log, start, options, pool);
+
+    REQUIRE(r.converged);
+    REQUIRE(r.segments == 6);
+    REQUIRE(r.residuals == 3 * (log.rows.size() - 1));
+    REQUIRE(r.initial_rms > 1.0);
+    REQUIRE(r.final_rms < 1e-6);
+    REQUIRE(r.aircraft.CL_alpha == Catch::Approx(5.7).epsilon(1e-7));
+    REQUIRE(r.aircraft.CD0 == Catch::Approx(0.025).epsilon(1e-6));
+    REQUIRE(r.aircraft.k == Catch::Approx(0.04).epsilon(1e-6));
+    REQUIRE_FALSE(r.aircraft.hasAeroTable());
+    REQUIRE(r.parameter_names == std::vector<std::string>{"CL_alpha", "CD0", "k"});
+}
+
+TEST_CASE("Aero identification - recovers an aero table")
+{
+    Aircraft truth = AircraftLoader::loadFromJSON(FLIGHTSIM_CONFIG_DIR "/aircraft_config.json");
+    REQUIRE(truth.hasAeroTable());
+    FlightLog log = flyLog(truth, 30.0);
+
+    // Start from a distorted table
+    std::vector<AeroDataTable::DataPoint> points = truth.aeroTable->points();
+    for (AeroDataTable::DataPoint &p : points)
+    {
+        p.CL = 0.85 * p.CL + 0.05;
+        p.CD = 1.3 * p.CD;
+    }
+    Aircraft start = truth;
+    start.aeroTable = std::make_shared<const AeroDataTable>(AeroDataTable::fromPoints(points));
+
+    AeroFitOptions options;
+    ThreadPool pool(3);
+    AeroFitResult r = fitAeroCoefficients(log, start, options, pool);
+    REQUIRE(r.converged);
+    REQUIRE(r.final_rms < 1e-5);
+    REQUIRE(r.final_rms < 1e-4 * r.initial_rms);
+    REQUIRE(r.parameters.size() == 2 * points.size());
+
+    // Angle of attack range the flight covers
+    double min_alpha = 1e9, max_alpha = -1e9;
+    for (const FlightLogRow &row : log.rows)
+    {
+        double alpha = row.pitch_deg * M_PI / 180.0 - std::atan2(row.vz, row.vx);
+        min_alpha = std::min(min_alpha, alpha);
+        max_alpha = std::max(max_alpha, alpha);
+    }
+    REQUIRE(max_alpha - min_alpha > 5.0 * M_PI / 180.0);
+
+    const std::vector<AeroDataTable::DataPoint> &fitted = r.aircraft.aeroTable->points();
+    const std::vector<AeroDataTable::DataPoint> &expected = truth.aeroTable->points();
+    int recovered = 0;
+    for (size_t i = 0; i < fitted.size(); i++)
+    {
+        INFO("node at " << fitted[i].alpha * 180.0 / M_PI << " deg");
+        // A node is pinned by the data when the flight spans a segment next to
+        // it; others are not (early iterates may pass through them)
+        bool excited = (i + 1 < fitted.size() && fitted[i + 1].alpha > min_alpha && fitted[i].alpha < max_alpha) ||
+                       (i > 0 && fitted[i].alpha > min_alpha && fitted[i - 1].alpha < max_alpha);
+        if (excited)
+        {
+            REQUIRE(fitted[i].CL == Catch::Approx(expected[i].CL).margin(1e-4));
+            REQUIRE(fitted[i].CD == Catch::Approx(expected[i].CD).margin(1e-4));
+            recovered++;
+        }
+    }
+    REQUIRE(recovered >= 3);
+}
+
+TEST_CASE("Aero identification - thread count and written configs")
+{
+    Aircraft truth;
+    FlightLog log = flyLog(truth, 12.0);
+    Aircraft start = truth;
+    start.CL_alpha *= 0.8;
+    start.CD0 *= 1.5;
+
+    AeroFitOptions options;
+    options.mode = AeroFitMode::Table;
+    options.segment_duration = 2.0;
+    options.max_iterations = 5;
+    ThreadPool one(1), three(3);
+    AeroFitResult a = fitAeroCoefficients(log, start, options, one);
+    AeroFitResult b = fitAeroCoefficients(log, start, options, three);
+    REQUIRE(a.parameters == b.parameters);
+    REQUIRE(a.final_rms == b.final_rms);
+
+    // Table mode on a legacy aircraft samples its polar into table nodes
+    REQUIRE(a.parameter_names.front() == "CL@-10.00deg");
+    REQUIRE(a.aircraft.hasAeroTable());
+
+    std::filesystem::path json = tempPath("fitted.json");
+    std::filesystem::path csv = writeFittedAircraft(a, json);
+    REQUIRE(csv.filename().string() == "flightsim_aerofit_fitted_aero.csv");
+    Aircraft loaded = AircraftLoader::loadFromJSON(json.string());
+    REQUIRE(loaded.hasAeroTable());
+    REQUIRE(loaded.mass == truth.mass);
+    REQUIRE(loaded.CD0 == Catch::Approx(start.CD0));
+    for (double alpha : {-0.1, 0.0, 0.05, 0.13})
+    {
+        REQUIRE(loaded.aeroTable->getCL(alpha) == Catch::Approx(a.aircraft.aeroTable->getCL(alpha)).epsilon(1e-10));
+        REQUIRE(loaded.aeroTable->getCD(alpha) == Catch::Approx(a.aircraft.aeroTable->getCD(alpha)).epsilon(1e-10));
+    }
+    std::filesystem::remove(json);
+    std::filesystem::remove(csv);
+
+    // Polar mode writes the JSON alone
+    options.mode = AeroFitMode::Polar;
+    AeroFitResult polar = fitAeroCoefficients(log, start, options, one);
+    REQUIRE(writeFittedAircraft(polar, json).empty());
+    loaded = AircraftLoader::loadFromJSON(json.string());
+    REQUIRE_FALSE(loaded.hasAeroTable());
+    REQUIRE(loaded.CL_alpha == Catch::Approx(polar.aircraft.CL_alpha).epsilon(1e-11));
+    std::filesystem::remove(json);
+
+    // No step can lower the cost of a corrupt log: stuck, not converged
+    FlightLog corrupt = log;
+    corrupt.rows[corrupt.rows.size() / 2].vz = std::numeric_limits<double>::quiet_NaN();
+    AeroFitResult stuck = fitAeroCoefficients(corrupt, start, options, one);
+    REQUIRE(stuck.iterations == 1);
+    REQUIRE_FALSE(stuck.converged);
+    REQUIRE(stuck.aircraft.CL_alpha == start.CL_alpha); // The start, unchanged
+
+    // No airborne data
+    FlightLog ground;
+    ground.rows.push_back({0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0});
+    ground.rows.push_back({0.1, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0});
+    REQUIRE_THROWS(fitAeroCoefficients(ground, start, options, one));
+}
+
+TEST_CASE("Aero identification - written names are escaped")
+{
+    // Quotes and backslashes in table names still give valid JSON that
+    // loads back to the same names
+    Aircraft ac;
+    ac.aeroDataFile = "tables/odd \"polar\" \\ v2.csv";
+    ac.gainScheduleFile = "gains\tfile.csv";
+    std::filesystem::path json = tempPath("escaped.json");
+    AircraftLoader::saveToJSON(ac, json.string());
+
+    std::ifstream file(json);
+    std::stringstream text;
+    text << file.rdbuf();
+    JsonValue parsed = JsonValue::parse(text.str());
+    REQUIRE(parsed["aeroDataFile"].asString() == ac.aeroDataFile);
+    REQUIRE(parsed["gainScheduleFile"].asString() == ac.gainScheduleFile);
+
+    Aircraft loaded = AircraftLoader::loadFromJSON(json.string());
+    REQUIRE(loaded.aeroDataFile == ac.aeroDataFile);
+    REQUIRE(loaded.gainScheduleFile == ac.gainScheduleFile);
+    REQUIRE(loaded.CD0 == ac.CD0);
+    std::filesystem::remove(json);
+}
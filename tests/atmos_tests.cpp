@@ -1,6 +1,14 @@
 #define CATCH_CONFIG_MAIN // This tells Catch to provide main()
 #include "catch_amalgamated.hpp"
 #include "environment/atmosphere.hpp"
+#include "environment/atmosphere_profile.hpp"
+#include <cmath>
+#include <limits>
+#include <string>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
 
 // Tolerance for floating point comparisons
 const double tol = 1e-2;
@@ -28,3 +36,166 @@ TEST_CASE("Speed of sound calculation")
     double a0 = 340.3; // m/s at sea level
     REQUIRE(std::abs(getSpeedOfSound(0) - a0) < 1.0);
 }
+
+TEST_CASE("ISA layer table is generated at compile time")
+{
+    static_assert(IsaLayers.size() == 7, "Seven layers up to 86 km");
+    static_assert(IsaLayers[0].base_pressure == p0, "Sea level pressure");
+    static_assert(IsaLayers[1].lapse_rate == 0.0 && IsaLayers[1].pressure_exponent == 0.0, "Isothermal tropopause");
+    static_assert(IsaLayers[6].base_pressure > 0.0, "Pressures integrated in constexpr");
+
+    // Base temperatures of the standard
+    const double temperatures[] = {288.15, 216.65, 216.65, 228.65, 270.65, 270.65, 214.65};
+    // Base pressures of US Standard Atmosphere 1976 (R = 287.053; ours is 287.0,
+    // which moves them by up to ~0.25% at the top)
+    const double pressures[] = {101325.0, 22632.06, 5474.889, 868.0187, 110.9063, 66.93887, 3.956420};
+    for (int i = 0; i < IsaLayerCount; i++)
+    {
+        REQUIRE(IsaLayers[i].base_temperature == Catch::Approx(temperatures[i]).epsilon(1e-12));
+        REQUIRE(IsaLayers[i].base_pressure == Catch::Approx(pressures[i]).epsilon(3e-3));
+        // Table pressures agree with the runtime formula of the layer below
+        if (i > 0)
+        {
+            const IsaLayer &below = IsaLayers[i - 1];
+            double dh = IsaLayers[i].base_altitude - below.base_altitude;
+            double T = below.base_temperature + below.lapse_rate * dh;
+            double p = below.base_pressure * std::pow(T / below.base_temperature, below.pressure_exponent) *
+                       std::exp(-below.isothermal_decay * dh);
+            REQUIRE(IsaLayers[i].base_pressure == Catch::Approx(p).epsilon(1e-13));
+        }
+    }
+    REQUIRE(getTemperature(IsaTopAltitude) == Catch::Approx(186.946).epsilon(1e-9));
+    REQUIRE(getPressure(IsaTopAltitude) == Catch::Approx(0.3734).epsilon(3e-3));
+}
+
+TEST_CASE("ISA layers are continuous and selected correctly")
+{
+    REQUIRE(isaLayerIndex(-100.0) == 0);
+    REQUIRE(isaLayerIndex(10999.0) == 0);
+    REQUIRE(isaLayerIndex(11000.0) == 1);
+    REQUIRE(isaLayerIndex(50000.0) == 4);
+    REQUIRE(isaLayerIndex(80000.0) == 6);
+    REQUIRE(isaLayerIndex(1e6) == 6);
+
+    for (int i = 1; i < IsaLayerCount; i++)
+    {
+        double base = IsaLayers[i].base_altitude;
+        REQUIRE(getTemperature(base - 1e-6) == Catch::Approx(getTemperature(base)).epsilon(1e-9));
+        REQUIRE(getPressure(base - 1e-6) == Catch::Approx(getPressure(base)).epsilon(1e-9));
+    }
+
+    // Pressure and density fall monotonically all the way up, and stay valid
+    double previous = getDensity(0.0);
+    for (double h = 100.0; h <= 100000.0; h += 100.0)
+    {
+        double rho = getDensity(h);
+        REQUIRE(std::isfinite(rho));
+        REQUIRE(rho > 0.0);
+        REQUIRE(rho < previous);
+        previous = rho;
+    }
+    // Stratospheric warming between 20 and 47 km
+    REQUIRE(getTemperature(47000.0) > getTemperature(20000.0));
+
+    // Above the top the temperature holds (the last lapse rate would reach
+    // 0 K near 178 km); pressure and density keep falling
+    const double topTemperature = getTemperature(IsaTopAltitude);
+    REQUIRE(getPressure(IsaTopAltitude + 1e-6) == Catch::Approx(getPressure(IsaTopAltitude)).epsilon(1e-9));
+    previous = getDensity(IsaTopAltitude);
+    for (double h : {90000.0, 150000.0, 178000.0, 200000.0, 250000.0, 1000000.0})
+    {
+        INFO(h);
+        REQUIRE(getTemperature(h) == topTemperature);
+        REQUIRE(std::isfinite(getSpeedOfSound(h)));
+        double rho = getDensity(h);
+        REQUIRE(std::isfinite(rho));
+        REQUIRE(rho > 0.0);
+        REQUIRE(rho < previous);
+        REQUIRE(getDensityFast(h) == Catch::Approx(rho).epsilon(1e-9));
+        REQUIRE(std::isfinite(getDensityGradient(h)));
+        REQUIRE(getDensityGradient(h) < 0.0);
+        previous = rho;
+    }
+}
+
+TEST_CASE("Troposphere matches the single-layer formula exactly")
+{
+    for (double h = 0.0; h < 11000.0; h += 137.0)
+    {
+        REQUIRE(getTemperature(h) == T0 - L * h);
+        REQUIRE(getPressure(h) == p0 * std::pow(1 - ((L * h) / T0), g / (R * L)));
+    }
+}
+
+TEST_CASE("Atmosphere profile - ISA deviation")
+{
+    // No offset reproduces the standard atmosphere through the table
+    AtmosphereProfile standard = AtmosphereProfile::isaDeviation(0.0);
+    REQUIRE(standard.minAltitude() == 0.0);
+    REQUIRE(standard.maxAltitude() == Catch::Approx(IsaTopAltitude));
+    for (double h = 0.0; h <= IsaTopAltitude; h += 377.0)
+    {
+        INFO("h = " << h);
+        REQUIRE(standard.temperature(h) == Catch::Approx(getTemperature(h)).epsilon(1e-9));
+        REQUIRE(standard.pressure(h) == Catch::Approx(getPressure(h)).epsilon(1e-6));
+        REQUIRE(standard.density(h) == Catch::Approx(getDensity(h)).epsilon(1e-6));
+    }
+
+    // Hot day: same sea-level pressure, thinner air at the surface, and
+    // pressure falls off more slowly with height
+    AtmosphereProfile hot = AtmosphereProfile::isaDeviation(20.0);
+    REQUIRE(hot.temperature(0.0) == Catch::Approx(308.15));
+    REQUIRE(hot.pressure(0.0) == Catch::Approx(p0));
+    REQUIRE(hot.density(0.0) == Catch::Approx(p0 / (R * 308.15)));
+    REQUIRE(hot.pressure(3000.0) > getPressure(3000.0));
+    REQUIRE(hot.density(3000.0) < getDensity(3000.0));
+
+    AtmosphereProfile cold = AtmosphereProfile::isaDeviation(-15.0, 103000.0);
+    REQUIRE(cold.pressure(0.0) == Catch::Approx(103000.0));
+    REQUIRE(cold.density(0.0) > getDensity(0.0));
+}
+
+TEST_CASE("Atmosphere profile - hydrostatic and ideal gas consistency")
+{
+    AtmosphereProfile profile = AtmosphereProfile::fromLevels({{0.0, 300.0}, {1000.0, 305.0}, {4000.0, 280.0}, {6000.0, 280.0}});
+    for (double h = 50.0; h < 6000.0; h += 250.0)
+    {
+        // dp/dh = -rho g, by central difference over a grid cell pair
+        double dpdh = (profile.pressure(h + 10.0) - profile.pressure(h - 10.0)) / 20.0;
+        REQUIRE(dpdh == Catch::Approx(-profile.density(h) * g).epsilon(1e-4));
+        REQUIRE(profile.density(h) == Catch::Approx(profile.pressure(h) / (R * profile.temperature(h))).epsilon(1e-6));
+    }
+    // Inversion: temperature rises through the first kilometre
+    REQUIRE(profile.temperature(500.0) == Catch::Approx(302.5));
+
+    // Outside the profile the end values hold
+    REQUIRE(profile.density(-100.0) == profile.density(0.0));
+    REQUIRE(profile.density(9000.0) == profile.density(6000.0));
+
+    // Non-finite altitudes stay in the table: NaN reads the lowest level
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    REQUIRE(profile.temperature(nan) == profile.temperature(0.0));
+    REQUIRE(profile.density(nan) == profile.density(0.0));
+    REQUIRE(profile.densityGradient(nan) == 0.0);
+    REQUIRE(profile.density(inf) == profile.density(6000.0));
+    REQUIRE(profile.density(-inf) == profile.density(0.0));
+    REQUIRE(profile.densityGradient(inf) == 0.0);
+
+    REQUIRE_THROWS(AtmosphereProfile::fromLevels({{0.0, 288.0}}));
+    REQUIRE_THROWS(AtmosphereProfile::fromLevels({{0.0, 288.0}, {0.0, 280.0}}));
+    REQUIRE_THROWS(AtmosphereProfile::fromLevels({{0.0, 288.0}, {1000.0, -5.0}}));
+}
+
+TEST_CASE("Atmosphere profile - sounding from CSV")
+{
+    AtmosphereProfile sounding = AtmosphereProfile::loadFromCSV(std::string(FLIGHTSIM_CONFIG_DIR) + "/atmosphere_sounding.csv");
+    REQUIRE(sounding.minAltitude() == 0.0);
+    REQUIRE(sounding.maxAltitude() == Catch::Approx(16000.0));
+    REQUIRE(sounding.pressure(0.0) == Catch::Approx(100800.0));
+    REQUIRE(sounding.temperature(0.0) == Catch::Approx(303.15));
+    // The shipped sounding's pressures are hydrostatic (rounded to 1 Pa)
+    REQUIRE(sounding.maxPressureMismatch() < 1e-4);
+
+    REQUIRE_THROWS(AtmosphereProfile::loadFromCSV("no_such_sounding.csv"));
+}
@@ -0,0 +1,275 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "core/batch_progress.hpp"
+#include "scenario/scenario_runner.hpp"
+#include "scenario/monte_carlo.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+/**
+ * TEST STRATEGY:
+ * 1. Pool threads get distinct, stable indices; other threads are 0
+ * 2. Per-thread counters add up exactly under a parallel pool, and
+ *    utilization and ETA follow the samples they are taken from
+ * 3. The status line and the Prometheus file carry every figure; the file
+ *    is replaced atomically (no .tmp left) and labels are escaped; a file
+ *    that cannot be written is reported by error(), never thrown
+ * 4. Scenario batches and Monte Carlo studies report exactly their jobs
+ *    and steps, a resumed study counting its checkpointed runs as done
+ */
+
+static std::filesystem::path tempFile(const std::string &name)
+{
+    return std::filesystem::temp_directory_path() / ("batch_progress_tests_" + name);
+}
+
+TEST_CASE("Batch progress - thread indices")
+{
+    REQUIRE(ThreadPool::threadIndex() == 0);
+    size_t other = 1;
+    std::thread([&]
+                { other = ThreadPool::threadIndex(); })
+        .join();
+    REQUIRE(other == 0);
+
+    ThreadPool pool(4);
+    std::mutex mutex;
+    std::set<size_t> seen;
+    bool stable = true; // Catch assertions stay on the test thread
+    for (int repeat = 0; repeat < 20; repeat++)
+        pool.parallelFor(64, 1, [&](size_t, size_t)
+                         {
+            size_t index = ThreadPool::threadIndex();
+            std::this_thread::yield();
+            std::lock_guard<std::mutex> lock(mutex);
+            stable = stable && ThreadPool::threadIndex() == index;
+            seen.insert(index); });
+    REQUIRE(stable);
+    REQUIRE(!seen.empty());
+    REQUIRE(*seen.rbegin() < pool.size());
+    REQUIRE(ThreadPool::threadIndex() == 0);
+}
+
+TEST_CASE("Batch progress - counters and rates")
+{
+    ThreadPool pool(4);
+    BatchProgress progress(pool.size());
+    REQUIRE(progress.workers() == 4);
+    progress.setJobs(1000, 200);
+
+    BatchProgress::Sample before = progress.sample();
+    REQUIRE(before.jobs_done == 200);
+    REQUIRE(std::isnan(batchRates(before, before).eta));
+
+    pool.parallelFor(800, 7, [&](size_t begin, size_t end)
+                     {
+        progress.beginWork();
+        for (size_t i = begin; i < end; i++)
+        {
+            progress.addSteps(i + 1);
+            progress.addJobs(1);
+        }
+        progress.endWork(); });
+    progress.endWork(); // Without beginWork, nothing to end
+
+    BatchProgress::Sample after = progress.sample();
+    REQUIRE(after.jobs_total == 1000);
+    REQUIRE(after.jobs_done == 1000);
+    REQUIRE(after.steps == 800 * 801 / 2);
+    uint64_t perWorker = 0;
+    for (uint64_t s : after.worker_steps)
+        perWorker += s;
+    REQUIRE(perWorker == after.steps);
+    REQUIRE(after.elapsed >= before.elapsed);
+
+    BatchRates rates = batchRates(before, after);
+    REQUIRE(rates.eta == 0.0);
+    REQUIRE(rates.worker_utilization.size() == 4);
+    double busy = 0.0;
+    for (size_t i = 0; i < 4; i++)
+    {
+        REQUIRE(rates.worker_utilization[i] >= 0.0);
+        REQUIRE(rates.worker_utilization[i] <= 1.0);
+        busy += after.worker_busy[i];
+    }
+    REQUIRE(busy > 0.0);
+    REQUIRE(busy <= 4.0 * after.elapsed + 1e-9);
+
+    // Half the remaining jobs at a known pace: ETA scales with the rest
+    BatchProgress::Sample half = after;
+    half.jobs_total = 1000;
+    half.jobs_before = 200;
+    half.jobs_done = 600;
+    half.elapsed = 10.0;
+    REQUIRE(batchRates(before, half).eta == Catch::Approx(10.0));
+
+    // Work in progress counts towards utilization
+    progress.beginWork();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    BatchProgress::Sample busyNow = progress.sample();
+    REQUIRE(busyNow.worker_busy[0] >= after.worker_busy[0] + 0.015);
+    REQUIRE(batchRates(after, busyNow).worker_utilization[0] > 0.5);
+    progress.endWork();
+}
+
+TEST_CASE("Batch progress - status line and metrics file")
+{
+    const std::filesystem::path metrics = tempFile("metrics.prom");
+    std::filesystem::remove(metrics);
+    BatchProgress progress(2);
+    progress.setJobs(10);
+    progress.addSteps(5000);
+    progress.addJobs(4);
+
+    std::ostringstream status;
+    {
+        ProgressReporter::Options options;
+        options.batch = "night \"run\"";
+        options.status = &status;
+        options.metrics_file = metrics;
+        options.interval = 0.0; // Only explicit reports
+        ProgressReporter reporter(progress, options);
+        reporter.report();
+        reporter.stop();
+        reporter.stop(); // Once only
+    }
+
+    std::string lines = status.str();
+    REQUIRE(std::count(lines.begin(), lines.end(), '\n') == 2);
+    std::string first = lines.substr(0, lines.find('\n'));
+    INFO(first);
+    REQUIRE(first.find("steps/s") != std::string::npos);
+    REQUIRE(first.find("jobs 4/10 (6 left)") != std::string::npos);
+    REQUIRE(first.find("ETA ") != std::string::npos);
+    REQUIRE(first.find("workers") != std::string::npos);
+    REQUIRE(std::count(first.begin(), first.end(), '%') == 2);
+
+    REQUIRE(std::filesystem::exists(metrics));
+    REQUIRE_FALSE(std::filesystem::exists(metrics.string() + ".tmp"));
+    std::vector<uint8_t> bytes = readFileBytes(metrics);
+    std::string text(bytes.begin(), bytes.end());
+    for (const char *expected :
+         {"# TYPE flightsim_batch_jobs gauge\n", "flightsim_batch_jobs{batch=\"night \\\"run\\\"\"} 10\n",
+          "flightsim_batch_jobs_done{batch=\"night \\\"run\\\"\"} 4\n",
+          "# TYPE flightsim_batch_steps_total counter\n",
+          "flightsim_batch_steps_total{batch=\"night \\\"run\\\"\",worker=\"0\"} 5000\n",
+          "flightsim_batch_steps_total{batch=\"night \\\"run\\\"\",worker=\"1\"} 0\n",
+          "flightsim_batch_worker_utilization{batch=\"night \\\"run\\\"\",worker=\"1\"} ",
+          "flightsim_batch_eta_seconds{", "flightsim_batch_steps_per_second{", "flightsim_batch_elapsed_seconds{",
+          "flightsim_batch_worker_busy_seconds_total{"})
+    {
+        INFO(expected);
+        REQUIRE(text.find(expected) != std::string::npos);
+    }
+    // Every sample line is "name{labels} value"
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.rfind("# ", 0) == 0)
+            continue;
+        INFO(line);
+        REQUIRE(line.rfind("flightsim_batch_", 0) == 0);
+        REQUIRE(line.find("} ") != std::string::npos);
+    }
+    std::filesystem::remove(metrics);
+
+    // A reporter on its own thread writes while the batch runs
+    ProgressReporter::Options periodic;
+    periodic.metrics_file = metrics;
+    periodic.interval = 0.01;
+    {
+        ProgressReporter reporter(progress, periodic);
+        for (int i = 0; i < 200 && !std::filesystem::exists(metrics); i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        REQUIRE(std::filesystem::exists(metrics));
+    }
+    std::filesystem::remove(metrics);
+
+    // A metrics file that cannot be written is kept as an error, not thrown
+    std::ostringstream kept;
+    ProgressReporter::Options unwritable;
+    unwritable.status = &kept;
+    unwritable.metrics_file = tempFile("missing_dir") / "metrics.prom";
+    unwritable.interval = 0.01;
+    {
+        ProgressReporter reporter(progress, unwritable);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        REQUIRE_NOTHROW(reporter.stop());
+        REQUIRE(reporter.error().find("Failed to open") != std::string::npos);
+    }
+    REQUIRE(kept.str().find("jobs 4/10") != std::string::npos);
+    REQUIRE_FALSE(std::filesystem::exists(unwritable.metrics_file));
+}
+
+TEST_CASE("Batch progress - scenario batches and Monte Carlo studies")
+{
+    const std::filesystem::path outputDir = tempFile("out");
+    std::vector<std::filesystem::path> files = {FLIGHTSIM_CONFIG_DIR "/scenarios/takeoff_climb.json",
+                                                FLIGHTSIM_CONFIG_DIR "/scenarios/power_off_glide.json",
+                                                FLIGHTSIM_CONFIG_DIR "/scenarios/missing.json"};
+    ThreadPool pool(3);
+    BatchProgress batch(pool.size());
+    std::vector<ScenarioResult> results = runScenarioFiles(files, outputDir, pool, ".csv", &batch);
+    BatchProgress::Sample s = batch.sample();
+    REQUIRE(s.jobs_total == 3);
+    REQUIRE(s.jobs_done == 3); // Failed files are done too
+    REQUIRE_FALSE(results[2].ok());
+    REQUIRE(s.steps == results[0].steps + results[1].steps);
+    std::filesystem::remove_all(outputDir);
+
+    Scenario scenario;
+    scenario.name = "glide";
+    scenario.initial.position = Vec2(0.0, 100.0);
+    scenario.initial.velocity = Vec2(30.0, 0.0);
+    scenario.initial.throttle = 0.0f;
+    scenario.initial.dt = 0.002;
+    scenario.duration = 3.0;
+    DispersionModel model;
+    model.mass = 0.1;
+    model.speed = 2.0;
+    MonteCarloOptions options;
+    options.runs = 18;
+    options.block = 4;
+    options.wave_blocks = 2;
+
+    BatchProgress study(pool.size());
+    MonteCarloSummary summary = runMonteCarlo(scenario, model, options, pool, &study);
+    s = study.sample();
+    REQUIRE(s.jobs_total == 18);
+    REQUIRE(s.jobs_done == summary.runs);
+    REQUIRE(s.steps == summary.steps);
+
+    // Stopped at the first checkpoint, then resumed
+    const std::filesystem::path checkpoint = tempFile("study.checkpoint");
+    std::filesystem::remove(checkpoint);
+    options.checkpoint_file = checkpoint;
+    options.time_limit = 0.0;
+    options.resume = true;
+    BatchProgress first(pool.size());
+    MonteCarloSummary partial = runMonteCarlo(scenario, model, options, pool, &first);
+    REQUIRE(partial.runs < options.runs);
+
+    options.time_limit = std::numeric_limits<double>::infinity();
+    BatchProgress second(pool.size());
+    summary = runMonteCarlo(scenario, model, options, pool, &second);
+    s = second.sample();
+    REQUIRE(summary.runs == 18);
+    REQUIRE(s.jobs_total == 18);
+    REQUIRE(s.jobs_done == 18);
+    REQUIRE(s.jobs_before == first.sample().jobs_done);
+    std::filesystem::remove(checkpoint);
+}
@@ -0,0 +1,131 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "core/counter_rng.hpp"
+#include "core/thread_pool.hpp"
+#include "core/streaming_stats.hpp"
+#include <cmath>
+#include <set>
+#include <vector>
+
+/**
+ * TEST STRATEGY:
+ * 1. Philox4x32-10 reproduces the published known-answer vectors
+ * 2. Bulk fills equal the element-wise draws for any start and length
+ * 3. Runs, streams, steps and seeds give different sequences; uniforms lie in
+ *    [0, 1) and normals have zero mean and unit variance
+ * 4. Draws are identical whatever the thread count or visiting order
+ */
+
+TEST_CASE("Counter RNG - Philox known answers")
+{
+    // Known-answer vectors of the Random123 reference implementation
+    auto a = philox4x32({0, 0, 0, 0}, {0, 0});
+    REQUIRE(a == std::array<uint32_t, 4>{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u});
+
+    auto b = philox4x32({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}, {0xffffffffu, 0xffffffffu});
+    REQUIRE(b == std::array<uint32_t, 4>{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu});
+
+    auto c = philox4x32({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}, {0xa4093822u, 0x299f31d0u});
+    REQUIRE(c == std::array<uint32_t, 4>{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u});
+
+    // The generator's coordinates map onto the counter and key
+    CounterRng rng(0x299f31d0a4093822ull, 0x03707344u, 0x13198a2eu);
+    REQUIRE(rng.block(0x85a308d3u, 0x243f6a88u) == c);
+}
+
+TEST_CASE("Counter RNG - bulk fills match element-wise draws")
+{
+    CounterRng rng(42, 7, 3);
+    for (uint32_t first : {0u, 1u, 5u, 16u})
+    {
+        for (size_t count : {size_t(0), size_t(1), size_t(2), size_t(7), size_t(8), size_t(17), size_t(100)})
+        {
+            INFO("first " << first << ", count " << count);
+            std::vector<double> u(count + 1, -1.0), z(count + 1, -1.0);
+            std::vector<uint32_t> w(4 * count + 1, 0xdeadbeefu);
+            rng.fillUniform(11, first, u.data(), count);
+            rng.fillNormal(11, first, z.data(), count);
+            rng.fill(11, first, w.data(), count);
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t index = first + static_cast<uint32_t>(i);
+                REQUIRE(u[i] == rng.uniform(11, index));
+                REQUIRE(z[i] == rng.normal(11, index));
+                std::array<uint32_t, 4> block = rng.block(11, index);
+                for (int j = 0; j < 4; j++)
+                    REQUIRE(w[4 * i + j] == block[j]);
+            }
+            // Nothing written past the end
+            REQUIRE(u[count] == -1.0);
+            REQUIRE(z[count] == -1.0);
+            REQUIRE(w[4 * count] == 0xdeadbeefu);
+        }
+    }
+}
+
+TEST_CASE("Counter RNG - independent coordinates and distributions")
+{
+    CounterRng base(1, 0, 0);
+    std::set<double> firsts = {base.uniform(0, 0), CounterRng(2, 0, 0).uniform(0, 0),
+                               CounterRng(1, 1, 0).uniform(0, 0), CounterRng(1, 0, 1).uniform(0, 0),
+                               base.uniform(1, 0), base.uniform(0, 1)};
+    REQUIRE(firsts.size() == 6);
+
+    const size_t n = 1 << 20;
+    std::vector<double> u(n), z(n);
+    base.fillUniform(0, 0, u.data(), n);
+    base.fillNormal(1, 0, z.data(), n);
+    RunningStats su, sz;
+    Histogram deciles(0.0, 1.0, 10);
+    for (size_t i = 0; i < n; i++)
+    {
+        REQUIRE((u[i] >= 0.0 && u[i] < 1.0));
+        su.add(u[i]);
+        sz.add(z[i]);
+        deciles.add(u[i]);
+    }
+    // Several standard errors of the mean and variance estimates
+    REQUIRE(su.mean() == Catch::Approx(0.5).margin(5.0 * std::sqrt(1.0 / 12.0 / n)));
+    REQUIRE(su.variance() == Catch::Approx(1.0 / 12.0).margin(2e-4));
+    REQUIRE(sz.mean() == Catch::Approx(0.0).margin(5.0 / std::sqrt(double(n))));
+    REQUIRE(sz.variance() == Catch::Approx(1.0).margin(5.0 * std::sqrt(2.0 / n)));
+    for (size_t i = 0; i < deciles.bins(); i++)
+        REQUIRE(double(deciles[i]) == Catch::Approx(n / 10.0).margin(5.0 * std::sqrt(n * 0.09)));
+
+    // Neighbouring uniforms are uncorrelated
+    double lag = 0.0;
+    for (size_t i = 0; i + 1 < n; i++)
+        lag += (u[i] - 0.5) * (u[i + 1] - 0.5);
+    REQUIRE(lag / (n - 1) / (1.0 / 12.0) == Catch::Approx(0.0).margin(5.0 / std::sqrt(double(n))));
+}
+
+TEST_CASE("Counter RNG - independent of scheduling")
+{
+    // Every run draws a few normals at every step; computed serially, on a
+    // pool, and in reverse order, the draws agree bit for bit
+    const size_t runs = 64, steps = 50;
+    auto draw = [](size_t run, size_t step)
+    {
+        CounterRng rng(9, static_cast<uint32_t>(run), 2);
+        double z[3];
+        rng.fillNormal(static_cast<uint32_t>(step), 0, z, 3);
+        return z[0] + 2.0 * z[1] + 3.0 * z[2];
+    };
+
+    std::vector<double> serial(runs * steps), parallel(runs * steps), reversed(runs * steps);
+    for (size_t r = 0; r < runs; r++)
+        for (size_t s = 0; s < steps; s++)
+            serial[r * steps + s] = draw(r, s);
+
+    ThreadPool pool(4);
+    pool.parallelFor(runs, 3, [&](size_t begin, size_t end)
+                     {
+        for (size_t r = begin; r < end; r++)
+            for (size_t s = 0; s < steps; s++)
+                parallel[r * steps + s] = draw(r, s); });
+    for (size_t i = runs * steps; i-- > 0;)
+        reversed[i] = draw(i / steps, i % steps);
+
+    REQUIRE(parallel == serial);
+    REQUIRE(reversed == serial);
+}
@@ -0,0 +1,158 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "core/fast_math.hpp"
+#include "simulation/physics_update.hpp"
+#include "aircraft/aircraft_loader.hpp"
+#include <cmath>
+#include <random>
+#include <string>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+/**
+ * TEST STRATEGY:
+ * 1. Check every kernel against the C library over its documented range
+ *    and compare with the error bound stated in fast_math.hpp
+ * 2. Fly the same aircraft with the exact and fast tiers for 10 simulated
+ *    minutes and require the trajectories to stay within 1e-6 relative
+ */
+
+TEST_CASE("Fast math - sin/cos error bound")
+{
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> angle(-1e5, 1e5);
+    double max_err = 0.0;
+    for (int i = 0; i < 200000; ++i)
+    {
+        double x = (i % 2) ? angle(rng) : angle(rng) * 1e-4; // large and small angles
+        double s, c;
+        fastSinCos(x, s, c);
+        max_err = std::max(max_err, std::abs(s - std::sin(x)));
+        max_err = std::max(max_err, std::abs(c - std::cos(x)));
+    }
+    REQUIRE(max_err < 1e-13);
+    REQUIRE(fastSin(0.0) == 0.0);
+    REQUIRE(fastCos(0.0) == 1.0);
+}
+
+TEST_CASE("Fast math - atan2 error bound and quadrants")
+{
+    std::mt19937_64 rng(2);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::uniform_real_distribution<double> decade(-8.0, 8.0);
+    double max_err = 0.0;
+    for (int i = 0; i < 200000; ++i)
+    {
+        double y = unit(rng) * std::pow(10.0, decade(rng));
+        double x = unit(rng) * std::pow(10.0, decade(rng));
+        max_err = std::max(max_err, std::abs(fastAtan2(y, x) - std::atan2(y, x)));
+    }
+    REQUIRE(max_err < 1e-11);
+
+    // Axes and signed zeros follow std::atan2
+    REQUIRE(fastAtan2(0.0, 0.0) == std::atan2(0.0, 0.0));
+    REQUIRE(fastAtan2(0.0, -0.0) == std::atan2(0.0, -0.0));
+    REQUIRE(fastAtan2(-0.0, -1.0) == std::atan2(-0.0, -1.0));
+    REQUIRE(std::abs(fastAtan2(1.0, 0.0) - std::atan2(1.0, 0.0)) < 1e-15);
+}
+
+TEST_CASE("Fast math - log, exp and pow error bounds")
+{
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> decade(-30.0, 30.0);
+    std::uniform_real_distribution<double> exponent(-700.0, 700.0);
+    std::uniform_real_distribution<double> base(0.2, 1.2);
+    double log_err = 0.0, exp_err = 0.0, pow_err = 0.0;
+    for (int i = 0; i < 200000; ++i)
+    {
+        double x = std::pow(10.0, decade(rng));
+        log_err = std::max(log_err, std::abs(fastLog(x) - std::log(x)));
+
+        double e = exponent(rng);
+        exp_err = std::max(exp_err, std::abs(fastExp(e) / std::exp(e) - 1.0));
+
+        // Barometric formula range: base (1 - L h / T0), exponent g / (R L)
+        double b = base(rng);
+        double p = 5.2559 * (i % 3);
+        pow_err = std::max(pow_err, std::abs(fastPow(b, p) / std::pow(b, p) - 1.0));
+    }
+    REQUIRE(log_err < 1e-12);
+    REQUIRE(exp_err < 1e-13);
+    REQUIRE(pow_err < 1e-10);
+
+    // Out-of-range inputs fall back to the C library
+    REQUIRE(std::isnan(fastLog(-1.0)));
+    REQUIRE(std::isinf(fastExp(1000.0)));
+}
+
+TEST_CASE("Fast math - density matches exact ISA")
+{
+    for (double h = 0.0; h <= IsaTopAltitude; h += 100.0)
+    {
+        REQUIRE(std::abs(getDensityFast(h) / getDensity(h) - 1.0) < 1e-10);
+    }
+}
+
+// Fly the same aircraft with both tiers and return the largest relative
+// difference in position or velocity seen over the flight
+static double maxTrajectoryDivergence(const Aircraft &aircraft, bool speed_ap, bool altitude_ap, double duration)
+{
+    SimulationState exact, fast;
+    for (SimulationState *state : {&exact, &fast})
+    {
+        state->aircraft = aircraft;
+        state->reset();
+        state->position = Vec2(0.0, 100.0);
+        state->velocity = Vec2(40.0, 0.0);
+        state->pitch_deg = 2.0f;
+        state->throttle = 0.5f;
+        state->dt = 0.01;
+        state->autopilot_speed = speed_ap;
+        state->autopilot_altitude = altitude_ap;
+        state->speed_setpoint = 35.0f;
+        state->altitude_setpoint = 150.0f;
+        state->maxPathPoints = 1;
+    }
+    fast.math_tier = MathTier::Fast;
+
+    PhysicsStepFn exact_step = selectPhysicsStep(exact);
+    PhysicsStepFn fast_step = selectPhysicsStep(fast);
+    REQUIRE(exact_step != fast_step);
+
+    double max_rel = 0.0;
+    int steps = static_cast<int>(duration / exact.dt);
+    for (int i = 0; i < steps; ++i)
+    {
+        exact_step(exact);
+        fast_step(fast);
+        double pos_rel = (exact.position - fast.position).magnitude() / std::max(1.0, exact.position.magnitude());
+        double vel_rel = (exact.velocity - fast.velocity).magnitude() / std::max(1.0, exact.velocity.magnitude());
+        max_rel = std::max(max_rel, std::max(pos_rel, vel_rel));
+    }
+    return max_rel;
+}
+
+TEST_CASE("Fast math - long flight trajectories match exact tier (legacy aero)")
+{
+    Aircraft aircraft; // default legacy model
+    for (int mode = 0; mode < 4; ++mode)
+    {
+        double divergence = maxTrajectoryDivergence(aircraft, mode & 1, mode & 2, 600.0);
+        INFO("autopilot mode " << mode << " divergence " << divergence);
+        REQUIRE(divergence < 1e-6);
+    }
+}
+
+TEST_CASE("Fast math - long flight trajectories match exact tier (table aero)")
+{
+    Aircraft aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHTSIM_CONFIG_DIR) + "/aircraft_config.json");
+    REQUIRE(aircraft.hasAeroTable());
+    for (int mode = 0; mode < 4; ++mode)
+    {
+        double divergence = maxTrajectoryDivergence(aircraft, mode & 1, mode & 2, 600.0);
+        INFO("autopilot mode " << mode << " divergence " << divergence);
+        REQUIRE(divergence < 1e-6);
+    }
+}
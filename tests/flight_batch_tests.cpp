@@ -0,0 +1,362 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "simulation/flight_batch.hpp"
+#include "simulation/precision_drift.hpp"
+#include "aircraft/aircraft_loader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * TEST STRATEGY:
+ * 1. Layout: the hot state is one cache line and SimulationState still
+ *    exposes every field through its parts
+ * 2. Without autopilot, batch lanes are bit-identical to SimulationStates
+ *    stepped one at a time (both integrators, table and legacy aero)
+ * 3. With autopilot (fixed and scheduled gains), lanes track the
+ *    SimulationState to rounding, and gain edits reach every lane in place
+ * 4. Results do not depend on the thread count
+ * 5. Float precision: the float batch stays close to the double batch over
+ *    short horizons, and the drift harness measures and flags divergence
+ * 6. selectPhysicsStep maps every aero model, autopilot, integrator and math
+ *    tier combination to its own specialization, and a step selected once
+ *    flies exactly as updatePhysics (re-selecting each step) does, with and
+ *    without wind
+ */
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+// Spread of starting conditions, different per lane
+static FlightState startState(size_t i)
+{
+    FlightState f;
+    f.position = Vec2(0.0, 100.0 + 10.0 * (i % 17));
+    f.velocity = Vec2(30.0 + 0.5 * (i % 23), 0.1 * (i % 5));
+    f.pitch_deg = 2.0f + 0.25f * static_cast<float>(i % 13);
+    f.throttle = 0.3f + 0.01f * static_cast<float>(i % 31);
+    f.elevator = 0.02f * static_cast<float>(i % 3);
+    return f;
+}
+
+static SimulationState referenceState(const FlightParams &params, const FlightState &start)
+{
+    SimulationState state;
+    static_cast<FlightParams &>(state) = params;
+    static_cast<FlightState &>(state) = start;
+    state.maxPathPoints = 0;
+    syncControllerGains(state);
+    return state;
+}
+
+static void requireSame(const FlightState &a, const FlightState &b)
+{
+    REQUIRE(a.position.x == b.position.x);
+    REQUIRE(a.position.y == b.position.y);
+    REQUIRE(a.velocity.x == b.velocity.x);
+    REQUIRE(a.velocity.y == b.velocity.y);
+    REQUIRE(a.pitch_deg == b.pitch_deg);
+    REQUIRE(a.pitch_rate == b.pitch_rate);
+    REQUIRE(a.alpha_deg == b.alpha_deg);
+    REQUIRE(a.t == b.t);
+}
+
+static void requireClose(const FlightState &a, const FlightState &b)
+{
+    REQUIRE(a.position.x == Catch::Approx(b.position.x).epsilon(1e-9));
+    REQUIRE(a.position.y == Catch::Approx(b.position.y).epsilon(1e-9));
+    REQUIRE(a.velocity.x == Catch::Approx(b.velocity.x).epsilon(1e-9));
+    REQUIRE(a.velocity.y == Catch::Approx(b.velocity.y).epsilon(1e-9).margin(1e-9));
+    REQUIRE(a.throttle == Catch::Approx(b.throttle).epsilon(1e-6).margin(1e-6));
+    REQUIRE(a.elevator == Catch::Approx(b.elevator).epsilon(1e-6).margin(1e-6));
+}
+
+TEST_CASE("Flight batch - state layout")
+{
+    REQUIRE(sizeof(FlightState) == 64);
+    REQUIRE(alignof(FlightState) == 64);
+    REQUIRE(std::is_trivially_copyable<FlightState>::value);
+
+    // The composed state keeps the flat member names
+    SimulationState state;
+    state.position = Vec2(1.0, 2.0);
+    state.dt = 0.01;
+    state.flightPath.push_back({1.0f, 2.0f});
+    const FlightState &hot = state;
+    const FlightParams &params = state;
+    REQUIRE(hot.position.y == 2.0);
+    REQUIRE(params.dt == 0.01);
+    REQUIRE(state.speed_pid.getKp() == Catch::Approx(state.pid_kp));
+}
+
+// The step selectPhysicsStep should return for a configuration
+template <typename AeroModel, bool Speed, bool Altitude>
+static PhysicsStepFn expectedStep(IntegratorType integrator, MathTier tier)
+{
+    bool fast = tier == MathTier::Fast;
+    if (integrator == IntegratorType::SemiImplicitEuler)
+        return fast ? &stepPhysics<AeroModel, Speed, Altitude, SemiImplicitEulerIntegrator, FastMath>
+                    : &stepPhysics<AeroModel, Speed, Altitude, SemiImplicitEulerIntegrator, ExactMath>;
+    return fast ? &stepPhysics<AeroModel, Speed, Altitude, RK4Integrator, FastMath>
+                : &stepPhysics<AeroModel, Speed, Altitude, RK4Integrator, ExactMath>;
+}
+
+template <typename AeroModel>
+static PhysicsStepFn expectedStep(const SimulationState &s)
+{
+    if (s.autopilot_speed && s.autopilot_altitude)
+        return expectedStep<AeroModel, true, true>(s.integrator, s.math_tier);
+    if (s.autopilot_speed)
+        return expectedStep<AeroModel, true, false>(s.integrator, s.math_tier);
+    if (s.autopilot_altitude)
+        return expectedStep<AeroModel, false, true>(s.integrator, s.math_tier);
+    return expectedStep<AeroModel, false, false>(s.integrator, s.math_tier);
+}
+
+TEST_CASE("Physics step - selected specializations match updatePhysics")
+{
+    const Aircraft tableAircraft =
+        AircraftLoader::loadFromJSON(std::string(FLIGHTSIM_CONFIG_DIR) + "/aircraft_config.json");
+    REQUIRE(tableAircraft.hasAeroTable());
+
+    std::vector<PhysicsStepFn> selected;
+    for (int config = 0; config < 64; config++)
+    {
+        SimulationState start = referenceState(FlightParams(), startState(static_cast<size_t>(config)));
+        if (config & 1)
+            start.aircraft = tableAircraft;
+        start.autopilot_speed = (config & 2) != 0;
+        start.autopilot_altitude = (config & 4) != 0;
+        start.integrator = (config & 8) ? IntegratorType::SemiImplicitEuler : IntegratorType::RK4;
+        start.math_tier = (config & 16) ? MathTier::Fast : MathTier::Exact;
+        if (config & 32)
+        {
+            start.wind.steady = Vec2(6.0, -0.5);
+            start.wind.gusts.push_back({0.5, 1.0, Vec2(2.0, 3.0)});
+        }
+        start.dt = 0.01;
+        start.speed_setpoint = 35.0f;
+        start.altitude_setpoint = start.position.y + 20.0f;
+        syncControllerGains(start);
+        INFO("configuration " << config);
+
+        // The dispatcher maps the configuration to its own instantiation
+        PhysicsStepFn step = selectPhysicsStep(start);
+        REQUIRE(step == (start.aircraft.hasAeroTable() ? expectedStep<TableAeroModel>(start)
+                                                       : expectedStep<LegacyAeroModel>(start)));
+        if (config < 32) // Wind is not part of the selection
+            selected.push_back(step);
+
+        // Selected once, it flies exactly as re-selecting every step does
+        SimulationState once = start, every = start;
+        for (int i = 0; i < 300; i++)
+        {
+            step(once);
+            updatePhysics(every);
+        }
+        requireSame(once, every);
+        REQUIRE(once.throttle == every.throttle);
+        REQUIRE(once.elevator == every.elevator);
+        REQUIRE(std::isfinite(once.position.y));
+    }
+
+    // Every configuration has a specialization of its own
+    std::sort(selected.begin(), selected.end(), std::less<PhysicsStepFn>());
+    REQUIRE(std::unique(selected.begin(), selected.end()) == selected.end());
+}
+
+TEST_CASE("Flight batch - lanes match SimulationState without autopilot")
+{
+    FlightParams params;
+    params.dt = 0.01;
+
+    // Each section sets up the parameters; the comparison below runs for all
+    SECTION("Legacy aero, RK4")
+    {
+        params.integrator = IntegratorType::RK4;
+        REQUIRE_FALSE(params.aircraft.hasAeroTable());
+        REQUIRE(params.math_tier == MathTier::Exact);
+    }
+    SECTION("Legacy aero, semi-implicit Euler")
+    {
+        params.integrator = IntegratorType::SemiImplicitEuler;
+    }
+    SECTION("Table aero, fast math")
+    {
+        params.aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHTSIM_CONFIG_DIR) + "/aircraft_config.json");
+        REQUIRE(params.aircraft.hasAeroTable());
+        params.math_tier = MathTier::Fast;
+    }
+
+    FlightBatch batch(params, 1, 16);
+    std::vector<SimulationState> reference;
+    for (size_t i = 0; i < 100; i++)
+    {
+        batch.add(startState(i));
+        reference.push_back(referenceState(params, startState(i)));
+    }
+
+    for (int step = 0; step < 300; step++)
+    {
+        batch.step();
+        for (SimulationState &state : reference)
+            selectPhysicsStep(state)(state);
+    }
+
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        INFO("lane " << i);
+        requireSame(batch[i], reference[i]);
+    }
+}
+
+TEST_CASE("Flight batch - autopilot lanes track SimulationState")
+{
+    FlightParams params;
+    params.dt = 0.01;
+    params.autopilot_speed = true;
+    params.autopilot_altitude = true;
+    params.speed_setpoint = 42.0f;
+    params.altitude_setpoint = 160.0f;
+
+    SECTION("Fixed gains")
+    {
+        params.gain_scheduling = false;
+    }
+    SECTION("Scheduled gains")
+    {
+        params.aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHTSIM_CONFIG_DIR) + "/aircraft_scheduled.json");
+        REQUIRE(params.gainsScheduled());
+    }
+
+    FlightBatch batch(params, 1, 8);
+    std::vector<SimulationState> reference;
+    for (size_t i = 0; i < 40; i++)
+    {
+        batch.add(startState(i));
+        reference.push_back(referenceState(params, startState(i)));
+    }
+
+    auto run = [&](int steps)
+    {
+        for (int step = 0; step < steps; step++)
+        {
+            batch.step();
+            for (SimulationState &state : reference)
+                selectPhysicsStep(state)(state);
+        }
+    };
+
+    run(200);
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        INFO("lane " << i);
+        requireClose(batch[i], reference[i]);
+    }
+
+    // Edited fixed gains reach every lane without a reset
+    batch.params.gain_scheduling = false;
+    batch.params.pid_kp = 0.05f;
+    for (SimulationState &state : reference)
+    {
+        state.gain_scheduling = false;
+        state.pid_kp = 0.05f;
+        syncControllerGains(state);
+    }
+    run(100);
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        INFO("lane " << i << " after gain edit");
+        requireClose(batch[i], reference[i]);
+    }
+}
+
+TEST_CASE("Flight batch - thread count does not change results")
+{
+    FlightParams params;
+    params.dt = 0.01;
+    params.autopilot_speed = true;
+
+    FlightBatch serial(params, 1, 64);
+    FlightBatch parallel(params, 4, 64);
+    for (size_t i = 0; i < 1000; i++)
+    {
+        serial.add(startState(i));
+        parallel.add(startState(i));
+    }
+    REQUIRE(parallel.size() == 1000);
+
+    for (int step = 0; step < 50; step++)
+    {
+        serial.step();
+        parallel.step();
+    }
+    for (size_t i : {size_t(0), size_t(511), size_t(999)})
+        requireSame(serial[i], parallel[i]);
+
+    parallel.clear();
+    REQUIRE(parallel.size() == 0);
+    parallel.step(); // Empty batch is a no-op
+}
+
+TEST_CASE("Flight batch - float precision tracks double")
+{
+    REQUIRE(sizeof(FlightStateF) == 40);
+
+    FlightParams params;
+    params.dt = 0.01;
+    params.aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHTSIM_CONFIG_DIR) + "/aircraft_config.json");
+
+    FlightBatch reference(params, 1);
+    FlightBatchF single(params, 1);
+    for (size_t i = 0; i < 20; i++)
+    {
+        reference.add(startState(i));
+        single.add(convertFlightState<float>(startState(i)));
+    }
+
+    for (int step = 0; step < 1000; step++)
+    {
+        reference.step();
+        single.step();
+    }
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        INFO("lane " << i);
+        FlightState s = convertFlightState<double>(single[i]);
+        REQUIRE((s.position - reference[i].position).magnitude() < 0.1);
+        REQUIRE((s.velocity - reference[i].velocity).magnitude() < 0.01);
+        REQUIRE(s.t == Catch::Approx(reference[i].t).epsilon(1e-4));
+    }
+}
+
+TEST_CASE("Flight batch - drift harness")
+{
+    Aircraft aircraft;
+    DriftOptions options;
+    options.duration = 20.0;
+    options.lanes = 4;
+
+    for (DriftManeuver maneuver : {DriftManeuver::Trim, DriftManeuver::OpenLoop, DriftManeuver::Autopilot})
+    {
+        DriftReport r = measureDrift(aircraft, maneuver, options);
+        INFO(r.maneuver);
+        REQUIRE(r.lanes == 4);
+        REQUIRE(r.steps == 2000);
+        REQUIRE(r.max_position_error > 0.0); // float really differs
+        REQUIRE(r.max_position_error < 1.0);
+        REQUIRE(r.final_position_rms <= r.max_position_error);
+        REQUIRE(r.withinTolerance());
+    }
+
+    // A tolerance below the float resolution is exceeded almost at once
+    options.tolerance = 1e-9;
+    DriftReport strict = measureDrift(aircraft, DriftManeuver::OpenLoop, options);
+    REQUIRE_FALSE(strict.withinTolerance());
+    REQUIRE(strict.time_to_tolerance > 0.0);
+    REQUIRE(strict.time_to_tolerance < 1.0);
+}
@@ -0,0 +1,244 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "simulation/flight_events.hpp"
+#include "simulation/physics_update.hpp"
+#include "scenario/scenario_runner.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+/**
+ * TEST STRATEGY:
+ * 1. Dense output: inside an RK4 step it matches a shorter step from the
+ *    same state, its ends match the step, and it ignores the ground clamp
+ * 2. Root finding converges on a known crossing
+ * 3. Event times do not depend on dt: a ballistic drop (exact under RK4)
+ *    touches down at the analytic time for steps from 0.01 s to 0.25 s
+ * 4. Reported states sit on their thresholds: altitude and speed crossings,
+ *    stall angle of attack, setpoint captures
+ * 5. Runs stop on the located event and write the events file
+ */
+
+static Scenario scenarioFromString(const std::string &json)
+{
+    return ScenarioLoader::fromJSON(JsonValue::parse(json), FLIGHTSIM_CONFIG_DIR, "inline");
+}
+
+static std::filesystem::path tempOutput(const std::string &name)
+{
+    return std::filesystem::temp_directory_path() / ("flightsim_events_" + name + ".csv");
+}
+
+static SimulationState cruiseState(double dt)
+{
+    SimulationState state;
+    state.dt = dt;
+    state.maxPathPoints = 0;
+    state.position = Vec2(0.0, 100.0);
+    state.velocity = Vec2(30.0, -3.0);
+    state.pitch_deg = 2.0f;
+    state.pitch_rate = 4.0f;
+    state.elevator = 0.2f;
+    state.throttle = 0.4f;
+    return state;
+}
+
+TEST_CASE("Step interpolant - dense output of a step")
+{
+    SECTION("RK4: matches a shorter step from the same state")
+    {
+        SimulationState state = cruiseState(0.1);
+        const FlightState before = state;
+        updatePhysics(state);
+        StepInterpolant step(before, state);
+        Vec2 acceleration = (state.F_thrust_viz + state.F_drag_viz + state.F_lift_viz + state.F_weight_viz) / state.aircraft.mass;
+
+        // The step holds its acceleration, so a 0.03 s step with it is the same motion
+        Vec2 p = before.position, v = before.velocity;
+        RK4Integrator::step(p, v, acceleration, 0.03);
+        REQUIRE(step.position(0.03).x == Catch::Approx(p.x).epsilon(1e-13));
+        REQUIRE(step.position(0.03).y == Catch::Approx(p.y).epsilon(1e-13));
+        REQUIRE(step.velocity(0.03).y == Catch::Approx(v.y).epsilon(1e-12));
+
+        // Ends are the step's own states
+        REQUIRE(step.position(0.0).x == before.position.x);
+        REQUIRE(step.position(0.1).y == state.position.y);
+        REQUIRE(step.velocity(0.1).x == state.velocity.x);
+        REQUIRE(step.pitchDeg(0.0) == Catch::Approx(before.pitch_deg));
+        REQUIRE(step.pitchDeg(0.1) == Catch::Approx(state.pitch_deg));
+        REQUIRE(step.at(0.05).t == Catch::Approx(0.05));
+    }
+
+    SECTION("Semi-implicit Euler: passes through both ends with their velocities")
+    {
+        SimulationState state = cruiseState(0.1);
+        state.integrator = IntegratorType::SemiImplicitEuler;
+        const FlightState before = state;
+        updatePhysics(state);
+        StepInterpolant step(before, state);
+
+        const double h = 1e-6;
+        Vec2 slope = (step.position(0.1 - h) - step.position(0.1 - 2 * h)) / h;
+        REQUIRE(step.position(0.1 - 1e-15).y == Catch::Approx(state.position.y).epsilon(1e-12));
+        REQUIRE(slope.y == Catch::Approx(state.velocity.y).margin(1e-4));
+    }
+
+    SECTION("Ground clamp: the interpolant keeps the unconstrained motion")
+    {
+        SimulationState state = cruiseState(0.1);
+        state.position.y = 0.1;
+        state.velocity.y = -5.0;
+        const FlightState before = state;
+        updatePhysics(state);
+        REQUIRE(state.position.y == 0.0); // Clamped
+        StepInterpolant step(before, state);
+        REQUIRE(step.position(0.1).y < -0.3);
+        REQUIRE(step.position(0.02).y == Catch::Approx(0.0).margin(0.01)); // Touches down at 0.02 s
+    }
+}
+
+TEST_CASE("Root finding - Illinois regula falsi")
+{
+    auto g = [](double x)
+    { return std::exp(x) - 2.0; };
+    double root = locateCrossing(g, 0.0, 1.0, g(0.0), g(1.0), 1e-14);
+    REQUIRE(root == Catch::Approx(std::log(2.0)).epsilon(1e-13));
+    REQUIRE(g(root) >= 0.0); // On the far side of the crossing
+
+    // Already at the crossing
+    REQUIRE(locateCrossing(g, 0.0, std::log(2.0), g(0.0), 0.0) == std::log(2.0));
+}
+
+TEST_CASE("Flight events - event times do not depend on the step size")
+{
+    // No wing and no thrust: the aircraft falls under gravity alone, which RK4
+    // integrates exactly, so only event location can depend on dt
+    const double h0 = 20.0;
+    const double touchdown = std::sqrt(2.0 * h0 / g);
+    const double through_ten = std::sqrt(2.0 * (h0 - 10.0) / g);
+
+    for (double dt : {0.01, 0.07, 0.25})
+    {
+        Scenario s = scenarioFromString(R"({
+            "initial": { "altitude": 20, "vx": 10 },
+            "duration": 60, "detect": { "altitudes": [10], "speeds": [20] }
+        })");
+        s.initial.aircraft.S = 0.0;
+        s.initial.dt = dt;
+
+        ScenarioResult r = runScenario(s, tempOutput("drop"));
+        INFO("dt = " << dt);
+        REQUIRE(r.stop_reason == "ground_contact");
+        REQUIRE(r.sim_time == Catch::Approx(touchdown).epsilon(1e-9));
+        REQUIRE(r.events.size() == 3);
+        REQUIRE(std::string(r.events[0].name) == "altitude");
+        REQUIRE(r.events[0].state.t == Catch::Approx(through_ten).epsilon(1e-9));
+        REQUIRE(r.events[0].direction == -1);
+        REQUIRE(std::string(r.events[1].name) == "speed"); // |v| = 20 with vx = 10
+        REQUIRE(r.events[1].state.velocity.magnitude() == Catch::Approx(20.0).epsilon(1e-9));
+        REQUIRE(r.events[1].state.t == Catch::Approx(std::sqrt(20.0 * 20.0 - 100.0) / g).epsilon(1e-9));
+        REQUIRE(r.events[2].terminal);
+        REQUIRE(r.events[2].state.velocity.y == Catch::Approx(-g * touchdown).epsilon(1e-9));
+        std::filesystem::remove(r.outputFile);
+        std::filesystem::remove(r.eventsFile);
+    }
+}
+
+TEST_CASE("Flight events - stall and setpoint captures")
+{
+    SECTION("Stall angle of attack")
+    {
+        Scenario s = scenarioFromString(R"({
+            "initial": { "altitude": 300, "vx": 30, "pitch_deg": 3, "throttle": 0.5 },
+            "duration": 5, "dt": 0.05,
+            "controls": [ { "t": 1, "elevator": 0.3 } ],
+            "detect": { "stall_alpha_deg": 12 }
+        })");
+        ScenarioResult r = runScenario(s, tempOutput("stall"));
+        REQUIRE(r.stop_reason == "duration");
+        REQUIRE(!r.events.empty());
+        const FlightEvent &stall = r.events.front();
+        REQUIRE(std::string(stall.name) == "stall");
+        REQUIRE(stall.direction == 1);
+        REQUIRE(stall.state.t > 1.0);
+        REQUIRE(stall.state.alpha_deg == Catch::Approx(12.0).margin(1e-4));
+        std::filesystem::remove(r.outputFile);
+        std::filesystem::remove(r.eventsFile);
+    }
+
+    SECTION("Speed captures, once per setpoint")
+    {
+        Scenario s = scenarioFromString(R"({
+            "aircraft": "aircraft_config.json",
+            "initial": { "altitude": 150, "vx": 40, "pitch_deg": 6, "throttle": 0.5 },
+            "duration": 90, "dt": 0.01, "output_interval": 1.0,
+            "stop": { "ground_contact": false },
+            "autopilot": [ { "t": 0, "speed": 36 }, { "t": 30, "speed": 31.5 } ],
+            "detect": { "captures": true }
+        })");
+        ScenarioResult r = runScenario(s, tempOutput("capture"));
+        REQUIRE(r.events.size() == 2);
+
+        // Slowing down to each setpoint in turn; the first is not captured
+        // again when the speed sags below it before the change
+        const FlightEvent &first = r.events[0], &second = r.events[1];
+        REQUIRE(std::string(first.name) == "speed_capture");
+        REQUIRE(first.threshold == 36.0);
+        REQUIRE(first.direction == -1);
+        REQUIRE(first.state.t < 30.0);
+        REQUIRE(first.state.velocity.magnitude() == Catch::Approx(36.0).epsilon(1e-9));
+        REQUIRE(second.threshold == 31.5);
+        REQUIRE(second.direction == -1);
+        REQUIRE(second.state.t > 30.0);
+        REQUIRE(second.state.velocity.magnitude() == Catch::Approx(31.5).epsilon(1e-9));
+        std::filesystem::remove(r.outputFile);
+        std::filesystem::remove(r.eventsFile);
+    }
+}
+
+TEST_CASE("Flight events - runs stop on the located event")
+{
+    Scenario s = scenarioFromString(R"({
+        "initial": { "altitude": 20, "vx": 25, "vz": -2, "throttle": 0.0 },
+        "duration": 600, "dt": 0.1, "output_interval": 0.1
+    })");
+    REQUIRE(s.watch.empty());
+    ScenarioResult r = runScenario(s, tempOutput("touchdown"));
+    REQUIRE(r.stop_reason == "ground_contact");
+    REQUIRE(r.events.size() == 1);
+
+    // Final row at the touchdown time, between two step boundaries
+    double t = r.events.back().state.t;
+    REQUIRE(r.sim_time == t);
+    REQUIRE(std::fabs(t / 0.1 - std::round(t / 0.1)) > 1e-6);
+    std::ifstream trajectory(r.outputFile);
+    std::string line, last;
+    while (std::getline(trajectory, line))
+        last = line;
+    REQUIRE(std::stod(last.substr(0, last.find(','))) == Catch::Approx(t).margin(1e-4));
+
+    // Events file next to the trajectory
+    REQUIRE(r.eventsFile == eventsFileFor(r.outputFile));
+    std::ifstream events(r.eventsFile);
+    REQUIRE(std::getline(events, line));
+    REQUIRE(line.rfind("t,event,", 0) == 0);
+    REQUIRE(std::getline(events, line));
+    REQUIRE(line.find(",ground_contact,") != std::string::npos);
+    REQUIRE_FALSE(std::getline(events, line));
+    std::filesystem::remove(r.outputFile);
+    std::filesystem::remove(r.eventsFile);
+
+    // Scenario "detect" block
+    Scenario detect = scenarioFromString(R"({
+        "detect": { "altitudes": [50, 150], "speeds": [30], "stall_alpha_deg": 14, "captures": true }
+    })");
+    REQUIRE(detect.watch.altitudes.size() == 2);
+    REQUIRE(detect.watch.speeds[0] == 30.0);
+    REQUIRE(detect.watch.stall_alpha_deg == 14.0);
+    REQUIRE(detect.watch.captures);
+}
@@ -2,6 +2,8 @@
 #include "catch_amalgamated.hpp"
 #include "core/integrator.hpp"
 #include "core/vec2.hpp"
+#include "core/simd_pack.hpp"
+#include <algorithm>
 #include <cmath>
 
 #ifndef M_PI
@@ -169,6 +171,59 @@ TEST_CASE("RK4 integrator - small timestep consistency")
     REQUIRE(std::abs(vel1.y - vel2.y) < 1e-6);
 }
 
+// Harmonic oscillator x'' = -x from (1, 0) to time 1 with the semi-implicit
+// Euler step; returns the position error against cos(1)
+static double semiImplicitEulerError(int steps)
+{
+    Vec2 position(1.0, 0.0);
+    Vec2 velocity(0.0, 0.0);
+    double dt = 1.0 / steps;
+    for (int i = 0; i < steps; ++i)
+        SemiImplicitEulerIntegrator::step(position, velocity, position * -1.0, dt);
+    return std::abs(position.x - std::cos(1.0));
+}
+
+TEST_CASE("Semi-implicit Euler integrator - constant acceleration")
+{
+    // Velocity first, then position with the new velocity
+    Vec2 position(1.0, 2.0);
+    Vec2 velocity(3.0, 0.0);
+    SemiImplicitEulerIntegrator::step(position, velocity, Vec2(0.0, -10.0), 0.1);
+    REQUIRE(std::abs(velocity.x - 3.0) < tol);
+    REQUIRE(std::abs(velocity.y - -1.0) < tol);
+    REQUIRE(std::abs(position.x - 1.3) < tol);
+    REQUIRE(std::abs(position.y - 1.9) < tol);
+    REQUIRE(SemiImplicitEulerIntegrator::type == IntegratorType::SemiImplicitEuler);
+}
+
+TEST_CASE("Semi-implicit Euler integrator - first-order convergence")
+{
+    // Halving the step halves the error
+    double coarse = semiImplicitEulerError(100);
+    double fine = semiImplicitEulerError(200);
+    double finer = semiImplicitEulerError(400);
+    REQUIRE(coarse < 5e-3);
+    REQUIRE(coarse / fine == Catch::Approx(2.0).margin(0.1));
+    REQUIRE(fine / finer == Catch::Approx(2.0).margin(0.1));
+}
+
+TEST_CASE("Semi-implicit Euler integrator - bounded energy (harmonic oscillator)")
+{
+    // Symplectic: over a hundred periods the energy oscillates but does not drift
+    Vec2 position(1.0, 0.0);
+    Vec2 velocity(0.0, 0.0);
+    double dt = 0.01;
+    double maxDeviation = 0.0;
+    int steps = static_cast<int>(100.0 * 2.0 * M_PI / dt);
+    for (int i = 0; i < steps; ++i)
+    {
+        SemiImplicitEulerIntegrator::step(position, velocity, position * -1.0, dt);
+        double energy = 0.5 * position.magnitudeSquared() + 0.5 * velocity.magnitudeSquared();
+        maxDeviation = std::max(maxDeviation, std::abs(energy - 0.5));
+    }
+    REQUIRE(maxDeviation < 0.01);
+}
+
 TEST_CASE("Vec2 - magnitude and normalization")
 {
     Vec2 v(3.0, 4.0);
@@ -251,3 +306,74 @@ TEST_CASE("Vec2 - arithmetic operations")
     REQUIRE(std::abs(divided.x - 1.5) < tol);
     REQUIRE(std::abs(divided.y - 2.0) < tol);
 }
+
+TEST_CASE("Vec2T - single precision matches double")
+{
+    Vec2f pos_f(0.0f, 100.0f);
+    Vec2f vel_f(20.0f, 0.0f);
+    Vec2f acc_f(0.0f, -9.81f);
+    Vec2 pos_d(0.0, 100.0);
+    Vec2 vel_d(20.0, 0.0);
+    Vec2 acc_d(0.0, -9.81);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        integrateRK4(pos_f, vel_f, acc_f, 0.1f);
+        integrateRK4(pos_d, vel_d, acc_d, 0.1);
+    }
+
+    REQUIRE(std::abs(pos_f.x - pos_d.x) < 1e-4);
+    REQUIRE(std::abs(pos_f.y - pos_d.y) < 1e-4);
+    REQUIRE(std::abs(vel_f.y - vel_d.y) < 1e-4);
+
+    Vec2f scaled = 2.0 * Vec2f(1.5f, -1.0f);
+    REQUIRE(std::abs(scaled.x - 3.0f) < tol);
+    REQUIRE(std::abs(scaled.y + 2.0f) < tol);
+}
+
+TEST_CASE("Vec2xN - packed lanes match scalar integration")
+{
+    // Four independent harmonic oscillators stepped together
+    Vec2x4d position;
+    Vec2x4d velocity;
+    Vec2 scalar_pos[4];
+    Vec2 scalar_vel[4];
+    for (size_t lane = 0; lane < 4; ++lane)
+    {
+        scalar_pos[lane] = Vec2(1.0 + lane, 0.5 * lane);
+        scalar_vel[lane] = Vec2(0.0, 1.0 - lane);
+        insertLane(position, lane, scalar_pos[lane]);
+        insertLane(velocity, lane, scalar_vel[lane]);
+    }
+
+    for (int i = 0; i < 100; ++i)
+    {
+        integrateRK4(position, velocity, position * -1.0, 0.01);
+        for (size_t lane = 0; lane < 4; ++lane)
+            integrateRK4(scalar_pos[lane], scalar_vel[lane], scalar_pos[lane] * -1.0, 0.01);
+    }
+
+    for (size_t lane = 0; lane < 4; ++lane)
+    {
+        Vec2 p = extractLane(position, lane);
+        Vec2 v = extractLane(velocity, lane);
+        REQUIRE(p.x == scalar_pos[lane].x);
+        REQUIRE(p.y == scalar_pos[lane].y);
+        REQUIRE(v.x == scalar_vel[lane].x);
+        REQUIRE(v.y == scalar_vel[lane].y);
+    }
+
+    // Normalization handles zero-length lanes like the scalar version
+    Vec2x4d mixed;
+    insertLane(mixed, 0, Vec2(3.0, 4.0));
+    insertLane(mixed, 1, Vec2(0.0, 0.0));
+    insertLane(mixed, 2, Vec2(0.0, -2.0));
+    insertLane(mixed, 3, Vec2(1e-12, 0.0));
+    Vec2x4d unit = mixed.normalized();
+    for (size_t lane = 0; lane < 4; ++lane)
+    {
+        Vec2 expected = extractLane(mixed, lane).normalized();
+        REQUIRE(std::abs(unit.x[lane] - expected.x) < tol);
+        REQUIRE(std::abs(unit.y[lane] - expected.y) < tol);
+    }
+}
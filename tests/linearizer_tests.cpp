@@ -0,0 +1,219 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "simulation/linearizer.hpp"
+#include "aircraft/aircraft_loader.hpp"
+#include <cmath>
+#include <string>
+
+/**
+ * TEST STRATEGY:
+ * 1. Derivatives: f(x, u) agrees with what the physics step integrates
+ * 2. Jacobians: entries with closed forms (kinematics, pitch response,
+ *    thrust direction) match, and the linear model predicts small
+ *    perturbations of the nonlinear model to second order
+ * 3. Trim: level-flight trim zeroes the accelerations, infeasible speeds fail
+ * 4. Batches: parallel grid results equal one-at-a-time results, and the
+ *    cache reuses models per aircraft and condition
+ */
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+static OperatingPoint cruisePoint()
+{
+    OperatingPoint p;
+    p.x = {40.0, 0.5, 6.0, 1.0, 300.0};
+    p.u = {0.45, 0.1};
+    return p;
+}
+
+TEST_CASE("Linearizer - derivatives match the physics step")
+{
+    SimulationState state;
+    state.maxPathPoints = 0;
+    state.velocity = Vec2(40.0, 0.5);
+    state.position = Vec2(0.0, 300.0);
+    state.pitch_deg = 6.0f;
+    state.pitch_rate = 1.0f;
+    state.throttle = 0.45f;
+    state.elevator = 0.1f;
+    state.integrator = IntegratorType::SemiImplicitEuler;
+    state.dt = 1e-5;
+
+    OperatingPoint p = OperatingPoint::fromState(state);
+    LinearStateVector xdot;
+    selectDerivatives(state.aircraft)(state.aircraft, p.x, p.u, xdot);
+
+    SimulationState next = state;
+    selectPhysicsStep(next)(next);
+
+    // Semi-implicit Euler: the velocity change is exactly a*dt (forces at the
+    // already updated pitch, which moves by O(dt))
+    REQUIRE((next.velocity.x - state.velocity.x) / state.dt == Catch::Approx(xdot[LinVx]).epsilon(1e-3));
+    REQUIRE((next.velocity.y - state.velocity.y) / state.dt == Catch::Approx(xdot[LinVz]).epsilon(1e-3));
+    REQUIRE((next.pitch_rate - state.pitch_rate) / state.dt == Catch::Approx(xdot[LinPitchRate]).epsilon(1e-3));
+    REQUIRE(xdot[LinPitch] == Catch::Approx(1.0));
+    REQUIRE(xdot[LinAltitude] == Catch::Approx(0.5));
+}
+
+TEST_CASE("Linearizer - closed-form Jacobian entries")
+{
+    Aircraft aircraft;
+    OperatingPoint p = cruisePoint();
+    LinearModel m = linearize(aircraft, p);
+
+    // Kinematics
+    REQUIRE(m.A[LinPitch][LinPitchRate] == Catch::Approx(1.0));
+    REQUIRE(m.A[LinAltitude][LinVz] == Catch::Approx(1.0));
+    REQUIRE(m.A[LinPitch][LinPitch] == Catch::Approx(0.0).margin(1e-9));
+
+    // Pitch response: damping and elevator authority (q above the 500 Pa saturation)
+    REQUIRE(m.A[LinPitchRate][LinPitchRate] == Catch::Approx(-5.0));
+    double rho = getDensity(p.x[LinAltitude]);
+    double q = 0.5 * rho * (40.0 * 40.0 + 0.5 * 0.5);
+    REQUIRE(q > 500.0);
+    REQUIRE(m.B[LinPitchRate][LinElevator] == Catch::Approx(250.0));
+
+    // Thrust acts along the pitch attitude
+    double pitch = p.x[LinPitch] * M_PI / 180.0;
+    REQUIRE(m.B[LinVx][LinThrottle] == Catch::Approx(aircraft.maxThrust * std::cos(pitch) / aircraft.mass));
+    REQUIRE(m.B[LinVz][LinThrottle] == Catch::Approx(aircraft.maxThrust * std::sin(pitch) / aircraft.mass));
+
+    // Throttle does not act on pitch, elevator does not act on velocity directly
+    REQUIRE(m.B[LinPitchRate][LinThrottle] == Catch::Approx(0.0).margin(1e-9));
+    REQUIRE(m.B[LinVx][LinElevator] == Catch::Approx(0.0).margin(1e-9));
+
+    // More speed means more drag
+    REQUIRE(m.A[LinVx][LinVx] < 0.0);
+}
+
+TEST_CASE("Linearizer - linear model predicts small perturbations")
+{
+    Aircraft aircraft;
+    OperatingPoint p = cruisePoint();
+    LinearModel m = linearize(aircraft, p);
+    DerivativeFn f = selectDerivatives(aircraft);
+
+    LinearStateVector dx = {0.2, -0.1, 0.3, 0.5, 2.0};
+    LinearInputVector du = {0.02, -0.01};
+    for (double scale : {1.0, 0.1})
+    {
+        LinearStateVector x = p.x;
+        LinearInputVector u = p.u;
+        for (size_t i = 0; i < LinStateCount; i++)
+            x[i] += scale * dx[i];
+        for (size_t i = 0; i < LinInputCount; i++)
+            u[i] += scale * du[i];
+
+        LinearStateVector actual;
+        f(aircraft, x, u, actual);
+        for (size_t row = 0; row < LinStateCount; row++)
+        {
+            double predicted = m.xdot[row];
+            for (size_t j = 0; j < LinStateCount; j++)
+                predicted += m.A[row][j] * scale * dx[j];
+            for (size_t j = 0; j < LinInputCount; j++)
+                predicted += m.B[row][j] * scale * du[j];
+            // Second-order remainder: shrinks by ~100x when the perturbation shrinks 10x
+            REQUIRE(std::fabs(predicted - actual[row]) < 0.02 * scale * scale);
+        }
+    }
+}
+
+TEST_CASE("Linearizer - level-flight trim")
+{
+    SECTION("Default aircraft")
+    {
+        Aircraft aircraft;
+        auto trim = trimLevelFlight(aircraft, 40.0, 300.0);
+        REQUIRE(trim.has_value());
+        LinearModel m = linearize(aircraft, *trim);
+        for (double v : {m.xdot[LinVx], m.xdot[LinVz], m.xdot[LinPitch], m.xdot[LinPitchRate], m.xdot[LinAltitude]})
+            REQUIRE(std::fabs(v) < 1e-6);
+        REQUIRE(trim->u[LinThrottle] > 0.0);
+        REQUIRE(trim->u[LinThrottle] < 1.0);
+        REQUIRE(trim->x[LinPitch] > 0.0);
+        REQUIRE(trim->x[LinPitch] < 15.0);
+
+        // Flying faster needs less angle of attack
+        auto fast = trimLevelFlight(aircraft, 55.0, 300.0);
+        REQUIRE(fast.has_value());
+        REQUIRE(fast->x[LinPitch] < trim->x[LinPitch]);
+    }
+
+    SECTION("Table aircraft")
+    {
+        Aircraft aircraft = AircraftLoader::loadFromJSON(std::string(FLIGHTSIM_CONFIG_DIR) + "/aircraft_config.json");
+        REQUIRE(aircraft.hasAeroTable());
+        auto trim = trimLevelFlight(aircraft, 40.0, 300.0);
+        REQUIRE(trim.has_value());
+        LinearModel m = linearize(aircraft, *trim);
+        REQUIRE(std::fabs(m.xdot[LinVx]) < 1e-6);
+        REQUIRE(std::fabs(m.xdot[LinVz]) < 1e-6);
+    }
+
+    SECTION("Beyond the thrust limit")
+    {
+        Aircraft aircraft;
+        REQUIRE_FALSE(trimLevelFlight(aircraft, 200.0, 300.0).has_value());
+    }
+}
+
+TEST_CASE("Linearizer - parallel grid and cache")
+{
+    Aircraft aircraft;
+    std::vector<OperatingPoint> grid;
+    for (int i = 0; i < 20; i++)
+    {
+        for (int j = 0; j < 10; j++)
+        {
+            OperatingPoint p = cruisePoint();
+            p.x[LinVx] = 25.0 + i * 2.0;
+            p.x[LinAltitude] = 50.0 + j * 100.0;
+            grid.push_back(p);
+        }
+    }
+
+    ThreadPool pool(4);
+    std::vector<LinearModel> models = linearizeAll(aircraft, grid, pool);
+    REQUIRE(models.size() == grid.size());
+    for (size_t i : {size_t(0), size_t(57), grid.size() - 1})
+    {
+        LinearModel serial = linearize(aircraft, grid[i]);
+        REQUIRE(models[i].point == grid[i]);
+        REQUIRE(models[i].A == serial.A);
+        REQUIRE(models[i].B == serial.B);
+        REQUIRE(models[i].xdot == serial.xdot);
+    }
+
+    LinearizationCache cache;
+    std::vector<LinearModel> first = cache.getAll(aircraft, grid, pool);
+    REQUIRE(cache.size() == grid.size());
+    REQUIRE(cache.misses() == grid.size());
+    REQUIRE(first[10].A == models[10].A);
+
+    // Same configuration, different instance: served from the cache
+    Aircraft copy = aircraft;
+    std::vector<LinearModel> second = cache.getAll(copy, grid, pool);
+    REQUIRE(cache.hits() == grid.size());
+    REQUIRE(second[10].A == models[10].A);
+    REQUIRE(cache.get(copy, grid[3]).B == models[3].B);
+
+    // A different aircraft gets its own entries
+    Aircraft heavy = aircraft;
+    heavy.mass = 200.0;
+    LinearModel heavyModel = cache.get(heavy, grid[3]);
+    REQUIRE(cache.size() == grid.size() + 1);
+    REQUIRE(heavyModel.B[LinVx][LinThrottle] < models[3].B[LinVx][LinThrottle]);
+
+    // -0.0 and 0.0 are the same operating point
+    OperatingPoint idle = grid[3];
+    idle.u[LinThrottle] = 0.0;
+    cache.get(aircraft, idle);
+    const uint64_t hitsBefore = cache.hits();
+    idle.u[LinThrottle] = -0.0;
+    cache.get(aircraft, idle);
+    REQUIRE(cache.hits() == hitsBefore + 1);
+    REQUIRE(cache.size() == grid.size() + 2);
+}
@@ -0,0 +1,449 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "scenario/monte_carlo.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+/**
+ * TEST STRATEGY:
+ * 1. Welford moments match a two-pass computation, also after merging parts
+ * 2. t-digest quantiles stay within a small rank error of the exact ones,
+ *    with bounded centroids, also when merged from parts
+ * 3. Histograms bin, count outliers and merge only with equal binning
+ * 4. NaN and infinite values are skipped by all three estimators alike and
+ *    counted apart, also through merge and save/load
+ * 5. The driver gives the same summary for any thread count and wave size;
+ *    without dispersions every run is the nominal one
+ * 6. Dispersion study files load, bad sigmas throw
+ * 7. A run saved mid-flight continues exactly; a study stopped at a
+ *    checkpoint after every slice and resumed each time ends with the same
+ *    summary as one flown in one go; checkpoints of another study, of an
+ *    edited scenario or truncated ones are rejected
+ * 8. A finished study's CSVs are written in full before its checkpoint is
+ *    removed; outputs that cannot be written keep the checkpoint
+ */
+
+static Scenario shortGlide()
+{
+    Scenario s;
+    s.name = "glide";
+    s.initial.position = Vec2(0.0, 100.0);
+    s.initial.velocity = Vec2(30.0, 0.0);
+    s.initial.pitch_deg = 2.0f;
+    s.initial.throttle = 0.0f;
+    s.initial.dt = 0.02;
+    s.duration = 5.0;
+    return s;
+}
+
+// Fraction of the sorted data below x
+static double rankOf(const std::vector<double> &sorted, double x)
+{
+    return static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), x) - sorted.begin()) /
+           static_cast<double>(sorted.size());
+}
+
+TEST_CASE("Streaming stats - Welford moments")
+{
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> dist(1e6, 2.0); // Large offset: naive sums would lose the variance
+    std::vector<double> data(10000);
+    for (double &x : data)
+        x = dist(rng);
+
+    double mean = 0.0;
+    for (double x : data)
+        mean += x;
+    mean /= data.size();
+    double var = 0.0;
+    for (double x : data)
+        var += (x - mean) * (x - mean);
+    var /= (data.size() - 1);
+
+    RunningStats all, merged, part;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        all.add(data[i]);
+        part.add(data[i]);
+        if (i % 777 == 776)
+        {
+            merged.merge(part);
+            part = RunningStats();
+        }
+    }
+    merged.merge(part);
+    merged.merge(RunningStats()); // Empty parts change nothing
+
+    for (const RunningStats *s : {&all, &merged})
+    {
+        REQUIRE(s->count() == data.size());
+        REQUIRE(s->mean() == Catch::Approx(mean).epsilon(1e-14));
+        REQUIRE(s->variance() == Catch::Approx(var).epsilon(1e-9));
+        REQUIRE(s->min() == *std::min_element(data.begin(), data.end()));
+        REQUIRE(s->max() == *std::max_element(data.begin(), data.end()));
+    }
+    REQUIRE(std::isnan(RunningStats().mean()));
+}
+
+TEST_CASE("Streaming stats - t-digest quantiles")
+{
+    std::mt19937_64 rng(7);
+    std::lognormal_distribution<double> dist(0.0, 1.0); // Skewed, long upper tail
+    std::vector<double> data(100000);
+    for (double &x : data)
+        x = dist(rng);
+
+    QuantileDigest single;
+    std::vector<QuantileDigest> parts(8);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        single.add(data[i]);
+        parts[i % parts.size()].add(data[i]);
+    }
+    QuantileDigest merged;
+    for (const QuantileDigest &p : parts)
+        merged.merge(p);
+
+    std::vector<double> sorted = data;
+    std::sort(sorted.begin(), sorted.end());
+    for (const QuantileDigest *d : {&single, &merged})
+    {
+        REQUIRE(d->count() == Catch::Approx(data.size()));
+        REQUIRE(d->centroidCount() <= 200);
+        REQUIRE(d->quantile(0.0) == sorted.front());
+        REQUIRE(d->quantile(1.0) == sorted.back());
+        for (double q : {0.001, 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99, 0.999})
+        {
+            INFO("q = " << q);
+            // Rank error: about 1/compression in the middle, much less in the tails
+            double tolerance = std::max(5e-4, 0.04 * q * (1.0 - q));
+            REQUIRE(rankOf(sorted, d->quantile(q)) == Catch::Approx(q).margin(tolerance));
+        }
+    }
+
+    // Few values: exact order statistics at the ends, empty is NaN
+    QuantileDigest small;
+    for (double x : {3.0, 1.0, 2.0})
+        small.add(x);
+    REQUIRE(small.quantile(0.0) == 1.0);
+    REQUIRE(small.quantile(0.5) == 2.0);
+    REQUIRE(small.quantile(1.0) == 3.0);
+    REQUIRE(std::isnan(QuantileDigest().quantile(0.5)));
+}
+
+TEST_CASE("Streaming stats - histogram")
+{
+    Histogram h(0.0, 10.0, 5);
+    for (double x : {-1.0, 0.0, 1.9, 2.0, 9.99, 10.0, 42.0})
+        h.add(x);
+    REQUIRE(h.underflow() == 1);
+    REQUIRE(h.overflow() == 2);
+    REQUIRE(h[0] == 2);
+    REQUIRE(h[1] == 1);
+    REQUIRE(h[4] == 1);
+    REQUIRE(h.binLow(1) == Catch::Approx(2.0));
+    REQUIRE(h.binHigh(4) == Catch::Approx(10.0));
+
+    Histogram other(0.0, 10.0, 5);
+    other.add(5.0);
+    h.merge(other);
+    REQUIRE(h[2] == 1);
+
+    REQUIRE_THROWS(h.merge(Histogram(0.0, 10.0, 4)));
+    REQUIRE_THROWS(Histogram(1.0, 1.0, 3));
+}
+
+TEST_CASE("Streaming stats - non-finite values")
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN(), inf = std::numeric_limits<double>::infinity();
+    MetricSummary a, b;
+    a.histogram = Histogram(0.0, 10.0, 5);
+    b.histogram = Histogram(0.0, 10.0, 5);
+    for (double x : {1.0, nan, 3.0, inf})
+        a.add(x);
+    for (double x : {-inf, 5.0})
+        b.add(x);
+    a.merge(b);
+
+    // The same three values in every estimator, the other three counted apart
+    REQUIRE(a.stats.count() == 3);
+    REQUIRE(a.stats.mean() == Catch::Approx(3.0));
+    REQUIRE(a.stats.max() == 5.0);
+    REQUIRE(a.quantiles.count() == 3.0);
+    REQUIRE(a.quantiles.min() == 1.0);
+    REQUIRE(a.quantiles.max() == 5.0);
+    REQUIRE(a.histogram.underflow() + a.histogram.overflow() == 0);
+    REQUIRE(a.stats.nonFinite() == 3);
+    REQUIRE(a.quantiles.nonFinite() == 3);
+    REQUIRE(a.histogram.nonFinite() == 3);
+
+    // Also into an empty estimator, and through save/load
+    RunningStats empty;
+    empty.merge(a.stats);
+    REQUIRE(empty.nonFinite() == 3);
+    BinaryWriter out;
+    a.stats.save(out);
+    a.quantiles.save(out);
+    a.histogram.save(out);
+    BinaryReader in(out.bytes);
+    REQUIRE(RunningStats::load(in).nonFinite() == 3);
+    REQUIRE(QuantileDigest::load(in).nonFinite() == 3);
+    REQUIRE(Histogram::load(in).nonFinite() == 3);
+}
+
+TEST_CASE("Monte Carlo - reproducible summary")
+{
+    Scenario scenario = shortGlide();
+    DispersionModel model;
+    model.mass = 0.1;
+    model.cd0 = 0.2;
+    model.altitude = 5.0;
+    model.speed = 2.0;
+    model.steady_wind = Vec2(3.0, 0.5);
+
+    MonteCarloOptions options;
+    options.runs = 300;
+    options.block = 16;
+    ThreadPool one(1), three(3);
+    MonteCarloSummary serial = runMonteCarlo(scenario, model, options, one);
+    MonteCarloSummary parallel = runMonteCarlo(scenario, model, options, three);
+    options.wave_blocks = 2; // More merges of fewer blocks
+    MonteCarloSummary waves = runMonteCarlo(scenario, model, options, three);
+
+    REQUIRE(serial.runs == 300);
+    REQUIRE(serial.steps == 300 * 250);
+    REQUIRE(serial.stop_reasons.at("duration") == 300);
+    for (const MonteCarloSummary *s : {&parallel, &waves})
+    {
+        REQUIRE(s->runs == serial.runs);
+        REQUIRE(s->steps == serial.steps);
+        for (size_t m = 0; m < DispersionMetricCount; m++)
+        {
+            INFO(dispersionMetricName(m));
+            const MetricSummary &a = serial.metrics[m], &b = s->metrics[m];
+            REQUIRE(a.stats.mean() == b.stats.mean());
+            REQUIRE(a.stats.variance() == b.stats.variance());
+            REQUIRE(a.quantiles.quantile(0.05) == b.quantiles.quantile(0.05));
+            REQUIRE(a.quantiles.quantile(0.5) == b.quantiles.quantile(0.5));
+            for (size_t i = 0; i < a.histogram.bins(); i++)
+                REQUIRE(a.histogram[i] == b.histogram[i]);
+        }
+    }
+
+    // The dispersions spread the outcome; pilot-ranged histograms hold every run
+    const MetricSummary &altitude = serial[DispersionMetric::FinalAltitude];
+    REQUIRE(altitude.stats.stddev() > 1.0);
+    REQUIRE(altitude.histogram.bins() == options.histogram_bins);
+    uint64_t binned = altitude.histogram.underflow() + altitude.histogram.overflow();
+    for (size_t i = 0; i < altitude.histogram.bins(); i++)
+        binned += altitude.histogram[i];
+    REQUIRE(binned == 300);
+    REQUIRE(serial[DispersionMetric::FlightTime].stats.max() == Catch::Approx(5.0));
+}
+
+TEST_CASE("Monte Carlo - no dispersion reproduces the nominal run")
+{
+    Scenario scenario = shortGlide();
+    DispersionRun nominal = flyDispersionRun(scenario, scenario.initial);
+
+    MonteCarloOptions options;
+    options.runs = 20;
+    ThreadPool pool(2);
+    MonteCarloSummary summary = runMonteCarlo(scenario, DispersionModel(), options, pool);
+    for (size_t m = 0; m < DispersionMetricCount; m++)
+    {
+        INFO(dispersionMetricName(m));
+        REQUIRE(summary.metrics[m].stats.min() == nominal.metrics[m]);
+        REQUIRE(summary.metrics[m].stats.max() == nominal.metrics[m]);
+        REQUIRE(summary.metrics[m].quantiles.quantile(0.5) == nominal.metrics[m]);
+    }
+
+    // A ground stop ends the run early and is counted
+    scenario.initial.position.y = 2.0;
+    scenario.initial.velocity = Vec2(15.0, -3.0);
+    scenario.duration = 30.0;
+    summary = runMonteCarlo(scenario, DispersionModel(), options, pool);
+    REQUIRE(summary.stop_reasons.at("ground_contact") == 20);
+    REQUIRE(summary[DispersionMetric::FinalAltitude].stats.max() == Catch::Approx(0.0).margin(1e-9));
+    REQUIRE(summary[DispersionMetric::FlightTime].stats.max() < 30.0);
+}
+
+TEST_CASE("Monte Carlo - study files")
+{
+    DispersionStudy study = DispersionLoader::loadFromFile(FLIGHTSIM_CONFIG_DIR "/dispersions/glide_dispersion.json");
+    REQUIRE(study.scenario.name == "power_off_glide");
+    REQUIRE(study.options.runs == 2000);
+    REQUIRE(study.model.mass == Catch::Approx(0.05));
+    REQUIRE(study.model.steady_wind.x == Catch::Approx(3.0));
+    REQUIRE(study.options.histogram_max[static_cast<size_t>(DispersionMetric::FlightTime)] == Catch::Approx(300.0));
+    REQUIRE(std::isnan(study.options.histogram_min[static_cast<size_t>(DispersionMetric::Range)]));
+
+    const std::filesystem::path dir = FLIGHTSIM_CONFIG_DIR "/dispersions";
+    REQUIRE_THROWS(DispersionLoader::fromJSON(
+        JsonValue::parse(R"({"scenario": "../scenarios/power_off_glide.json", "aircraft": {"mass": -0.1}})"), dir));
+    REQUIRE_THROWS(DispersionLoader::fromJSON(
+        JsonValue::parse(R"({"scenario": "../scenarios/power_off_glide.json", "histograms": {"range": [5, 1]}})"), dir));
+}
+
+static void requireSameSummary(const MonteCarloSummary &a, const MonteCarloSummary &b)
+{
+    REQUIRE(a.runs == b.runs);
+    REQUIRE(a.steps == b.steps);
+    REQUIRE(a.stop_reasons == b.stop_reasons);
+    for (size_t m = 0; m < DispersionMetricCount; m++)
+    {
+        INFO(dispersionMetricName(m));
+        const MetricSummary &x = a.metrics[m], &y = b.metrics[m];
+        REQUIRE(x.stats.mean() == y.stats.mean());
+        REQUIRE(x.stats.variance() == y.stats.variance());
+        for (double q : {0.01, 0.5, 0.99})
+            REQUIRE(x.quantiles.quantile(q) == y.quantiles.quantile(q));
+        REQUIRE(x.histogram.low() == y.histogram.low());
+        REQUIRE(x.histogram.overflow() == y.histogram.overflow());
+        for (size_t i = 0; i < x.histogram.bins(); i++)
+            REQUIRE(x.histogram[i] == y.histogram[i]);
+    }
+}
+
+TEST_CASE("Monte Carlo - checkpoint and resume")
+{
+    Scenario scenario = shortGlide();
+    scenario.initial.dt = 0.002; // 2500 steps: runs are paused in flight
+    ScenarioEvent climb;
+    climb.time = 1.0;
+    climb.throttle = 0.6f;
+    climb.autopilot_altitude = true;
+    climb.altitude_setpoint = 110.0f;
+    scenario.events.push_back(climb);
+
+    DispersionModel model;
+    model.mass = 0.1;
+    model.altitude = 5.0;
+    model.speed = 2.0;
+
+    // A run saved part-way, also before and after the event, ends the same
+    SimulationState initial = disperseInitialState(scenario, model, 5, 3);
+    DispersionRun whole = flyDispersionRun(scenario, initial);
+    for (size_t pause : {size_t(1), size_t(499), size_t(500), size_t(1700)})
+    {
+        DispersionFlight flight(scenario, initial, 3);
+        REQUIRE_FALSE(flight.advance(pause));
+        BinaryWriter out;
+        flight.save(out);
+        BinaryReader in(out.bytes);
+        DispersionFlight resumed = DispersionFlight::load(scenario, model, 5, in);
+        REQUIRE(in.remaining() == 0);
+        REQUIRE(resumed.advance(std::numeric_limits<size_t>::max()));
+        DispersionRun r = resumed.result();
+        REQUIRE(r.steps == whole.steps);
+        for (size_t m = 0; m < DispersionMetricCount; m++)
+            REQUIRE(r.metrics[m] == whole.metrics[m]);
+    }
+
+    MonteCarloOptions options;
+    options.runs = 22;
+    options.block = 4;
+    options.wave_blocks = 2;
+    options.seed = 5;
+    ThreadPool one(1), three(3);
+    MonteCarloSummary reference = runMonteCarlo(scenario, model, options, three);
+
+    // Time limit zero: every session checkpoints after one slice per block
+    const std::filesystem::path file = std::filesystem::temp_directory_path() / "monte_carlo_tests.checkpoint";
+    std::filesystem::remove(file);
+    options.checkpoint_file = file;
+    options.checkpoint_interval = 0.0;
+    options.time_limit = 0.0;
+    options.resume = true;
+    MonteCarloSummary summary;
+    size_t sessions = 0;
+    do
+    {
+        summary = runMonteCarlo(scenario, model, options, sessions % 2 ? one : three);
+        REQUIRE(std::filesystem::exists(file));
+        REQUIRE(summary.runs <= options.runs);
+        sessions++;
+    } while (summary.runs < options.runs && sessions < 1000);
+    REQUIRE(sessions > 10);
+    requireSameSummary(summary, reference);
+    REQUIRE_FALSE(std::filesystem::exists(file.string() + ".tmp"));
+
+    // The final checkpoint holds the result; without resume it starts afresh
+    options.time_limit = std::numeric_limits<double>::infinity();
+    requireSameSummary(runMonteCarlo(scenario, model, options, one), reference);
+    options.resume = false;
+    options.checkpoint_interval = 0.05;
+    requireSameSummary(runMonteCarlo(scenario, model, options, three), reference);
+
+    // Another study's checkpoint, or a torn one, is not resumed
+    options.resume = true;
+    MonteCarloOptions other = options;
+    other.seed = 6;
+    REQUIRE_THROWS(runMonteCarlo(scenario, model, other, one));
+    // So is the same study after an edit to the aircraft, an event or a stop
+    Scenario edited = scenario;
+    edited.initial.aircraft.CD0 *= 1.1;
+    REQUIRE_THROWS(runMonteCarlo(edited, model, options, one));
+    edited = scenario;
+    edited.events[0].altitude_setpoint = 120.0f;
+    REQUIRE_THROWS(runMonteCarlo(edited, model, options, one));
+    edited = scenario;
+    edited.stop.min_speed = 5.0;
+    REQUIRE_THROWS(runMonteCarlo(edited, model, options, one));
+    requireSameSummary(runMonteCarlo(scenario, model, options, one), reference);
+    std::vector<uint8_t> bytes = readFileBytes(file);
+    bytes.resize(bytes.size() / 2);
+    writeFileAtomically(file, bytes);
+    REQUIRE_THROWS(runMonteCarlo(scenario, model, options, one));
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Monte Carlo - study outputs")
+{
+    Scenario scenario = shortGlide();
+    DispersionModel model;
+    model.mass = 0.1;
+    MonteCarloOptions options;
+    options.runs = 8;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "monte_carlo_tests_out";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    options.checkpoint_file = dir / "study.checkpoint";
+    ThreadPool pool(2);
+    MonteCarloSummary summary = runMonteCarlo(scenario, model, options, pool);
+    REQUIRE(std::filesystem::exists(options.checkpoint_file));
+
+    // Outputs that cannot be opened, or fill up, keep the checkpoint
+    const std::filesystem::path missing = dir / "missing" / "study.summary.csv";
+    REQUIRE_THROWS_WITH(completeMonteCarloStudy(summary, missing, dir / "study.histograms.csv", options.checkpoint_file),
+                        Catch::Matchers::ContainsSubstring(missing.string()));
+    REQUIRE(std::filesystem::exists(options.checkpoint_file));
+    if (std::filesystem::exists("/dev/full"))
+    {
+        REQUIRE_THROWS_WITH(completeMonteCarloStudy(summary, dir / "study.summary.csv", "/dev/full",
+                                                    options.checkpoint_file),
+                            Catch::Matchers::ContainsSubstring("Failed to write /dev/full"));
+        REQUIRE(std::filesystem::exists(options.checkpoint_file));
+    }
+
+    completeMonteCarloStudy(summary, dir / "study.summary.csv", dir / "study.histograms.csv", options.checkpoint_file);
+    REQUIRE_FALSE(std::filesystem::exists(options.checkpoint_file));
+    std::ifstream csv(dir / "study.summary.csv");
+    std::string header, row;
+    std::getline(csv, header);
+    REQUIRE(header == "metric,count,non_finite,mean,stddev,min,p01,p05,p50,p95,p99,max");
+    size_t rows = 0;
+    while (std::getline(csv, row))
+        rows++;
+    REQUIRE(rows == DispersionMetricCount);
+    std::filesystem::remove_all(dir);
+}
@@ -1,7 +1,13 @@
 #define CATCH_CONFIG_MAIN
 #include "catch_amalgamated.hpp"
 #include "control/pid.hpp"
+#include "control/gain_schedule.hpp"
+#include "control/pid_bank.hpp"
 #include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
 
 const double tol = 1e-6;
 
@@ -13,6 +19,12 @@ const double tol = 1e-6;
  * 4. Test output limiting/saturation
  * 5. Test reset functionality
  * 6. Test step response behavior
+ * 7. Test in-place gain changes keep the controller output continuous
+ * 8. Test gain schedule lookup (nodes, bilinear interpolation, clamping)
+ *    and CSV validation
+ * 9. Test the PID bank lane by lane against individual PIDControllers
+ *    (including saturation, anti-windup, gain changes and resets)
+ * 10. Test snapshot/restore continues a controller exactly (checkpoints)
  */
 
 TEST_CASE("PID - Proportional only (P controller)")
@@ -230,3 +242,241 @@ TEST_CASE("PID - Zero gain stability")
     double output = pid.update(50.0, 30.0, 0.1);
     REQUIRE(std::abs(output - 0.0) < tol);
 }
+
+TEST_CASE("PID - Gain changes keep state")
+{
+    PIDController pid(0.5, 0.2, 0.1, -10.0, 10.0);
+    pid.update(5.0, 0.0, 0.1);
+    pid.update(5.0, 1.0, 0.1);
+    double i_before = pid.getIntegralTerm();
+    REQUIRE(i_before > 0.0);
+
+    SECTION("Integral contribution is preserved")
+    {
+        pid.setGains(0.5, 0.4, 0.1);
+        REQUIRE(pid.getKi() == Catch::Approx(0.4));
+        // Zero error step: only the integral term remains (derivative sees the
+        // error go from 4 to 0, so compare the I term alone)
+        pid.update(1.0, 1.0, 0.1);
+        REQUIRE(pid.getIntegralTerm() == Catch::Approx(i_before));
+    }
+
+    SECTION("Derivative history is kept")
+    {
+        PIDController fresh(0.5, 0.2, 0.1, -10.0, 10.0);
+        pid.setGains(0.5, 0.2, 0.3);
+        fresh.setGains(0.5, 0.2, 0.3);
+        // Same error as the previous step: no derivative kick for the kept
+        // controller, while a rebuilt controller has no history at all
+        pid.update(5.0, 1.0, 0.1);
+        REQUIRE(std::abs(pid.getDerivativeTerm()) < tol);
+        REQUIRE(pid.getIntegralTerm() > i_before);
+    }
+}
+
+static std::filesystem::path writeGainCsv(const std::string &name, const std::string &contents)
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("flightsim_gains_" + name + ".csv");
+    std::ofstream(path) << contents;
+    return path;
+}
+
+TEST_CASE("PID - Snapshot and restore continue exactly")
+{
+    PIDController pid(0.3, 0.05, 0.2, -1.0, 1.0);
+    for (int i = 0; i < 20; i++)
+        pid.update(5.0, 0.2 * i, 0.1);
+    pid.setGains(0.4, 0.08, 0.1);
+
+    // A controller restored from the snapshot, even one built with other
+    // gains and limits, gives the same outputs from then on
+    PIDController copy(1.0, 1.0, 1.0, 0.0, 0.5);
+    copy.restore(pid.snapshot());
+    REQUIRE(copy.getKi() == pid.getKi());
+    for (int i = 0; i < 20; i++)
+    {
+        double measurement = 4.0 + 0.1 * i;
+        REQUIRE(copy.update(5.0, measurement, 0.1) == pid.update(5.0, measurement, 0.1));
+        REQUIRE(copy.getIntegralTerm() == pid.getIntegralTerm());
+    }
+
+    // A fresh controller's snapshot keeps its first update flag
+    PIDController fresh(1.0, 0.0, 1.0, -1.0, 1.0);
+    PIDController restored(1.0, 0.0, 1.0, -1.0, 1.0);
+    restored.update(0.0, 1.0, 0.1);
+    restored.restore(fresh.snapshot());
+    REQUIRE(restored.update(1.0, 0.0, 0.1) == fresh.update(1.0, 0.0, 0.1));
+}
+
+TEST_CASE("Gain schedule - bilinear lookup")
+{
+    // Rows out of order on purpose; gains vary linearly in q and altitude
+    std::filesystem::path path = writeGainCsv("grid",
+        "q,altitude,speed_kp,speed_ki,speed_kd,alt_kp,alt_ki,alt_kd\n"
+        "1000,0,   0.2,0.02,0.01, 2.0,0.2,0.1\n"
+        "100,0,    0.1,0.01,0.01, 1.0,0.1,0.1\n"
+        "100,1000, 0.3,0.01,0.01, 1.0,0.1,0.1\n"
+        "1000,1000,0.4,0.02,0.01, 2.0,0.2,0.1\n");
+    GainSchedule schedule = GainSchedule::loadFromCSV(path.string());
+    std::filesystem::remove(path);
+
+    REQUIRE(schedule.dynamicPressures() == std::vector<double>{100.0, 1000.0});
+    REQUIRE(schedule.altitudes() == std::vector<double>{0.0, 1000.0});
+
+    SECTION("Nodes")
+    {
+        ScheduledGains g = schedule.lookup(1000.0, 1000.0);
+        REQUIRE(g.speed[0] == Catch::Approx(0.4));
+        REQUIRE(g.altitude[0] == Catch::Approx(2.0));
+        REQUIRE(schedule.lookup(100.0, 0.0).speed[0] == Catch::Approx(0.1));
+    }
+
+    SECTION("Interpolation")
+    {
+        ScheduledGains g = schedule.lookup(550.0, 500.0);
+        REQUIRE(g.speed[0] == Catch::Approx(0.25));
+        REQUIRE(g.speed[1] == Catch::Approx(0.015));
+        REQUIRE(g.altitude[0] == Catch::Approx(1.5));
+        REQUIRE(g.altitude[2] == Catch::Approx(0.1));
+    }
+
+    SECTION("Clamped outside the table")
+    {
+        ScheduledGains low = schedule.lookup(0.0, -50.0);
+        REQUIRE(low.speed[0] == Catch::Approx(0.1));
+        ScheduledGains high = schedule.lookup(5000.0, 20000.0);
+        REQUIRE(high.speed[0] == Catch::Approx(0.4));
+        ScheduledGains edge = schedule.lookup(5000.0, 500.0);
+        REQUIRE(edge.speed[0] == Catch::Approx(0.3));
+    }
+}
+
+TEST_CASE("Gain schedule - invalid files throw")
+{
+    REQUIRE_THROWS_AS(GainSchedule::loadFromCSV("does_not_exist.csv"), std::runtime_error);
+
+    std::filesystem::path shortRow = writeGainCsv("short", "100,0,0.1,0.01,0.01\n");
+    REQUIRE_THROWS_AS(GainSchedule::loadFromCSV(shortRow.string()), std::runtime_error);
+    std::filesystem::remove(shortRow);
+
+    std::filesystem::path missing = writeGainCsv("missing",
+        "100,0,0.1,0.01,0.01,1,0.1,0.1\n"
+        "1000,0,0.1,0.01,0.01,1,0.1,0.1\n"
+        "100,1000,0.1,0.01,0.01,1,0.1,0.1\n");
+    REQUIRE_THROWS_AS(GainSchedule::loadFromCSV(missing.string()), std::runtime_error);
+    std::filesystem::remove(missing);
+
+    std::filesystem::path duplicate = writeGainCsv("duplicate",
+        "100,0,0.1,0.01,0.01,1,0.1,0.1\n"
+        "100,0,0.2,0.01,0.01,1,0.1,0.1\n"
+        "1000,0,0.1,0.01,0.01,1,0.1,0.1\n"
+        "1000,1000,0.1,0.01,0.01,1,0.1,0.1\n");
+    REQUIRE_THROWS_AS(GainSchedule::loadFromCSV(duplicate.string()), std::runtime_error);
+    std::filesystem::remove(duplicate);
+}
+
+TEST_CASE("PID bank - lanes match PIDController")
+{
+    // Mixed gains and limits: P-only, PI, full PID, throttle-style and
+    // elevator-style limits, a zero-Ki lane and a lane that saturates
+    struct Lane
+    {
+        double kp, ki, kd, min, max;
+    };
+    const std::vector<Lane> lanes = {
+        {1.0, 0.0, 0.0, 0.0, 1.0},
+        {0.5, 0.2, 0.0, -1.0, 1.0},
+        {0.02, 0.001, 0.01, 0.0, 1.0},
+        {0.1, 0.001, 0.5, -1.0, 1.0},
+        {5.0, 2.0, 0.1, -0.5, 0.5},
+        {0.0, 0.0, 0.0, 0.0, 1.0},
+        {0.3, 0.05, 0.02, -10.0, 15.0},
+    };
+
+    PIDBank bank;
+    std::vector<PIDController> reference;
+    for (const Lane &l : lanes)
+    {
+        REQUIRE(bank.add(l.kp, l.ki, l.kd, l.min, l.max) == reference.size());
+        reference.emplace_back(l.kp, l.ki, l.kd, l.min, l.max);
+    }
+    REQUIRE(bank.size() == lanes.size());
+
+    const size_t n = lanes.size();
+    std::vector<double> setpoints(n), measurements(n), outputs(n);
+    auto stepAndCompare = [&](int step, double dt)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            setpoints[i] = 40.0 + 5.0 * i;
+            measurements[i] = 35.0 + 3.0 * std::sin(0.1 * step + i) + 0.05 * step;
+        }
+        bank.update(setpoints.data(), measurements.data(), dt, outputs.data());
+        for (size_t i = 0; i < n; i++)
+        {
+            INFO("step " << step << " lane " << i);
+            // Equal up to rounding: with FMA available the compiler may fuse the
+            // vector and scalar multiply-adds differently
+            REQUIRE(outputs[i] == Catch::Approx(reference[i].update(setpoints[i], measurements[i], dt)).epsilon(1e-12).margin(1e-15));
+        }
+    };
+
+    SECTION("Steady stepping, saturation and anti-windup")
+    {
+        for (int step = 0; step < 500; step++)
+            stepAndCompare(step, 0.01);
+    }
+
+    SECTION("Zero time step skips the derivative")
+    {
+        stepAndCompare(0, 0.01);
+        stepAndCompare(1, 0.0);
+        stepAndCompare(2, 0.01);
+    }
+
+    SECTION("Gain changes, limit changes and resets")
+    {
+        for (int step = 0; step < 100; step++)
+            stepAndCompare(step, 0.01);
+
+        bank.setGains(3, 0.2, 0.002, 0.4);
+        reference[3].setGains(0.2, 0.002, 0.4);
+        bank.setGains(1, 0.5, 0.0, 0.1);
+        reference[1].setGains(0.5, 0.0, 0.1);
+        bank.setOutputLimits(6, -1.0, 1.0);
+        reference[6].setOutputLimits(-1.0, 1.0);
+        bank.reset(2);
+        reference[2].reset();
+        REQUIRE(bank.getKi(3) == Catch::Approx(0.002));
+        REQUIRE(bank.getIntegral(2) == 0.0);
+
+        for (int step = 100; step < 200; step++)
+            stepAndCompare(step, 0.01);
+
+        bank.resetAll();
+        for (PIDController &pid : reference)
+            pid.reset();
+        for (int step = 200; step < 250; step++)
+            stepAndCompare(step, 0.02);
+    }
+}
+
+TEST_CASE("PID bank - uniform construction")
+{
+    PIDBank bank(1000, 0.5, 0.1, 0.05, 0.0, 1.0);
+    REQUIRE(bank.size() == 1000);
+
+    std::vector<double> setpoints(1000, 30.0), measurements(1000), outputs(1000);
+    for (size_t i = 0; i < measurements.size(); i++)
+        measurements[i] = 20.0 + 0.01 * i;
+    bank.update(setpoints.data(), measurements.data(), 0.1, outputs.data());
+
+    PIDController pid(0.5, 0.1, 0.05, 0.0, 1.0);
+    REQUIRE(outputs[999] == Catch::Approx(pid.update(30.0, measurements[999], 0.1)).epsilon(1e-12));
+    REQUIRE(bank.getPreviousError(0) == Catch::Approx(10.0));
+    for (double output : outputs)
+    {
+        REQUIRE(output >= 0.0);
+        REQUIRE(output <= 1.0);
+    }
+}
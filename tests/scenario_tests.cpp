@@ -0,0 +1,353 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "utils/json_value.hpp"
+#include "scenario/scenario_runner.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+/**
+ * TEST STRATEGY:
+ * 1. Parse JSON documents covering every value type and malformed input,
+ *    numbers outside the JSON grammar included
+ * 2. Load scenarios from inline JSON and check defaults, ordering and errors
+ * 3. Run short scenarios and check the CSV, event timing and stop conditions
+ * 4. Atmosphere profiles selected per scenario change the flight
+ * 5. Run every shipped scenario in config/scenarios through the parallel batch
+ */
+
+const double tol = 1e-9;
+
+static Scenario scenarioFromString(const std::string &json)
+{
+    return ScenarioLoader::fromJSON(JsonValue::parse(json), FLIGHTSIM_CONFIG_DIR, "inline");
+}
+
+static std::filesystem::path tempOutput(const std::string &name)
+{
+    return std::filesystem::temp_directory_path() / ("flightsim_scenario_" + name + ".csv");
+}
+
+// Read the CSV back as rows of numbers (header skipped)
+static std::vector<std::vector<double>> readCsv(const std::filesystem::path &path)
+{
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    std::vector<std::vector<double>> rows;
+    while (std::getline(file, line))
+    {
+        std::vector<double> row;
+        std::stringstream ss(line);
+        std::string cell;
+        while (std::getline(ss, cell, ','))
+            row.push_back(std::stod(cell));
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+TEST_CASE("JSON - parses all value types")
+{
+    JsonValue v = JsonValue::parse(R"({
+        "n": -1.5e2, "s": "a\"b\\c\nd", "t": true, "f": false, "z": null,
+        "arr": [1, [2, 3], {"k": "v"}], "empty": {}, "none": []
+    })");
+
+    REQUIRE(v.isObject());
+    REQUIRE_THAT(v["n"].asNumber(), Catch::Matchers::WithinAbs(-150.0, tol));
+    REQUIRE(v["s"].asString() == "a\"b\\c\nd");
+    REQUIRE(v["t"].asBool());
+    REQUIRE_FALSE(v["f"].asBool());
+    REQUIRE(v["z"].isNull());
+    REQUIRE(v["arr"].size() == 3);
+    REQUIRE(v["arr"][1][1].asNumber() == 3.0);
+    REQUIRE(v["arr"][2]["k"].asString() == "v");
+    REQUIRE(v["empty"].size() == 0);
+    REQUIRE(v["none"].elements().empty());
+    REQUIRE(v.objectKeys().front() == "n");
+    REQUIRE(v.numberOr("missing", 7.0) == 7.0);
+}
+
+TEST_CASE("JSON - malformed input and type errors throw")
+{
+    REQUIRE_THROWS_AS(JsonValue::parse("{\"a\": }"), std::runtime_error);
+    REQUIRE_THROWS_AS(JsonValue::parse("[1, 2"), std::runtime_error);
+    REQUIRE_THROWS_AS(JsonValue::parse("{} extra"), std::runtime_error);
+    REQUIRE_THROWS_AS(JsonValue::parse("\"open"), std::runtime_error);
+    REQUIRE_THROWS_WITH(JsonValue::parse("{\n\"a\": 1,\n\"b\" 2}"), Catch::Matchers::ContainsSubstring("line 3"));
+
+    // Numbers follow the JSON grammar: no NaN, infinities, hex, leading + or
+    // zeros, bare or trailing points, empty exponents, or out-of-range values
+    for (const char *number : {"nan", "NaN", "inf", "-Infinity", "0x10", "0x1p3", "+1", "01", ".5", "1.", "1e",
+                               "1e+", "-", "1e999"})
+    {
+        INFO(number);
+        REQUIRE_THROWS_AS(JsonValue::parse(std::string("[") + number + "]"), std::runtime_error);
+    }
+    REQUIRE(JsonValue::parse("[0]")[0].asNumber() == 0.0);
+    REQUIRE(JsonValue::parse("[-0.25E+1]")[0].asNumber() == -2.5);
+    REQUIRE(JsonValue::parse("[10e-1]")[0].asNumber() == 1.0);
+
+    JsonValue v = JsonValue::parse("{\"a\": \"text\"}");
+    REQUIRE_THROWS_AS(v["a"].asNumber(), std::runtime_error);
+    REQUIRE_THROWS_AS(v["b"], std::runtime_error);
+}
+
+TEST_CASE("Scenario - loader reads fields and sorts events")
+{
+    Scenario s = scenarioFromString(R"({
+        "aircraft": "aircraft_heavy.json",
+        "initial": { "x": 5, "altitude": 120, "vx": 30, "vz": -1, "pitch_deg": 3, "throttle": 0.4 },
+        "duration": 10, "dt": 0.005, "integrator": "euler", "math": "fast",
+        "controls": [ { "t": 5, "throttle": 0.9 }, { "t": 1, "elevator": 0.2 } ],
+        "autopilot": [ { "t": 2, "speed": 35, "altitude_pid": [0.2, 0.0, 0.4] }, { "t": 4, "speed": false } ],
+        "stop": { "max_altitude": 500, "ground_contact": false }
+    })");
+
+    REQUIRE(s.name == "inline");
+    REQUIRE(s.initial.aircraft.mass > Aircraft().mass);
+    REQUIRE(s.initial.position.x == 5.0);
+    REQUIRE(s.initial.position.y == 120.0);
+    REQUIRE(s.initial.velocity.y == -1.0);
+    REQUIRE(s.initial.throttle == 0.4f);
+    REQUIRE(s.initial.dt == 0.005);
+    REQUIRE(s.initial.integrator == IntegratorType::SemiImplicitEuler);
+    REQUIRE(s.initial.math_tier == MathTier::Fast);
+    REQUIRE(s.duration == 10.0);
+
+    REQUIRE(s.events.size() == 4);
+    REQUIRE(s.events[0].time == 1.0);
+    REQUIRE(s.events[0].elevator.value() == 0.2f);
+    REQUIRE(s.events[1].autopilot_speed.value());
+    REQUIRE(s.events[1].speed_setpoint.value() == 35.0f);
+    REQUIRE(s.events[1].altitude_gains.value()[2] == 0.4f);
+    REQUIRE_FALSE(s.events[2].autopilot_speed.value());
+    REQUIRE_FALSE(s.events[2].speed_setpoint.has_value());
+    REQUIRE(s.events[3].throttle.value() == 0.9f);
+
+    REQUIRE(s.stop.max_altitude == 500.0);
+    REQUIRE_FALSE(s.stop.ground_contact);
+    REQUIRE(std::isinf(s.stop.min_speed));
+}
+
+TEST_CASE("Scenario - loader rejects invalid settings")
+{
+    REQUIRE_THROWS_AS(scenarioFromString(R"({"integrator": "rk45"})"), std::runtime_error);
+    REQUIRE_THROWS_AS(scenarioFromString(R"({"math": "approximate"})"), std::runtime_error);
+    REQUIRE_THROWS_AS(scenarioFromString(R"({"dt": 0})"), std::runtime_error);
+    REQUIRE_THROWS_AS(scenarioFromString(R"({"controls": [ { "throttle": 1 } ]})"), std::runtime_error);
+    REQUIRE_THROWS_AS(scenarioFromString(R"({"autopilot": [ { "t": 0, "speed_pid": [1, 2] } ]})"), std::runtime_error);
+}
+
+TEST_CASE("Scenario - runs for the full duration and writes rows at the output interval")
+{
+    Scenario s = scenarioFromString(R"({
+        "initial": { "altitude": 100, "vx": 30, "pitch_deg": 2, "throttle": 0.5 },
+        "duration": 2.0, "dt": 0.01, "output_interval": 0.1,
+        "controls": [ { "t": 1.0, "throttle": 0.8 } ],
+        "stop": { "ground_contact": false }
+    })");
+
+    auto path = tempOutput("duration");
+    ScenarioResult r = runScenario(s, path);
+
+    REQUIRE(r.ok());
+    REQUIRE(r.stop_reason == "duration");
+    REQUIRE(r.steps == 200);
+    REQUIRE_THAT(r.sim_time, Catch::Matchers::WithinAbs(2.0, 1e-9));
+
+    auto rows = readCsv(path);
+    REQUIRE(rows.size() == 21); // initial state + one row every 10 steps
+    REQUIRE(r.rows == rows.size());
+    REQUIRE_THAT(rows.back()[0], Catch::Matchers::WithinAbs(2.0, 1e-4));
+
+    // The event applies to the step starting at t = 1.0, so rows after it show the new throttle
+    for (const auto &row : rows)
+    {
+        double expected = row[0] < 1.0 + 1e-6 ? 0.5 : 0.8;
+        REQUIRE_THAT(row[8], Catch::Matchers::WithinAbs(expected, 1e-4));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Scenario - events fire at the nearest step")
+{
+    // Steps start at 0.3 and 0.4: an event at 0.34 fires half a step early,
+    // one at 0.36 at the step after
+    Scenario s = scenarioFromString(R"({
+        "initial": { "altitude": 100, "vx": 30, "pitch_deg": 2, "throttle": 0.5 },
+        "duration": 1.0, "dt": 0.1, "output_interval": 0,
+        "controls": [ { "t": 0.34, "throttle": 0.6 }, { "t": 0.36, "throttle": 0.7 } ],
+        "stop": { "ground_contact": false }
+    })");
+    ScenarioResult r = runScenario(s, tempOutput("event_steps"));
+    auto rows = readCsv(r.outputFile);
+    REQUIRE(rows.size() == 11);
+    for (const auto &row : rows)
+    {
+        // A row is the state at the end of a step, with that step's controls
+        double expected = row[0] < 0.35 ? 0.5 : row[0] < 0.45 ? 0.6 : 0.7;
+        INFO(row[0]);
+        REQUIRE_THAT(row[8], Catch::Matchers::WithinAbs(expected, 1e-4));
+    }
+    std::filesystem::remove(r.outputFile);
+}
+
+TEST_CASE("Scenario - stop conditions end the run early")
+{
+    SECTION("Ground contact after a power-off descent")
+    {
+        Scenario s = scenarioFromString(R"({
+            "initial": { "altitude": 20, "vx": 25, "vz": -2, "throttle": 0.0 },
+            "duration": 600, "dt": 0.01
+        })");
+        ScenarioResult r = runScenario(s, tempOutput("ground"));
+        REQUIRE(r.stop_reason == "ground_contact");
+        REQUIRE(r.sim_time < 600.0);
+        auto rows = readCsv(r.outputFile);
+        REQUIRE(rows.back()[2] == 0.0); // final row is the touchdown state
+        std::filesystem::remove(r.outputFile);
+    }
+
+    SECTION("Starting on the ground does not count as contact")
+    {
+        Scenario s = scenarioFromString(R"({
+            "initial": { "altitude": 0, "vx": 0, "pitch_deg": 5, "throttle": 1.0 },
+            "duration": 5, "dt": 0.01
+        })");
+        ScenarioResult r = runScenario(s, tempOutput("ground_start"));
+        REQUIRE(r.stop_reason == "duration");
+        std::filesystem::remove(r.outputFile);
+    }
+
+    SECTION("Altitude limit")
+    {
+        Scenario s = scenarioFromString(R"({
+            "initial": { "altitude": 100, "vx": 30, "vz": 5, "pitch_deg": 10, "throttle": 1.0 },
+            "duration": 600, "dt": 0.01,
+            "stop": { "max_altitude": 101 }
+        })");
+        ScenarioResult r = runScenario(s, tempOutput("max_alt"));
+        REQUIRE(r.stop_reason == "max_altitude");
+        REQUIRE(r.sim_time < 5.0);
+        std::filesystem::remove(r.outputFile);
+    }
+}
+
+TEST_CASE("Scenario - autopilot schedule tracks the new speed setpoint")
+{
+    Scenario s = scenarioFromString(R"({
+        "aircraft": "aircraft_config.json",
+        "initial": { "altitude": 150, "vx": 40, "pitch_deg": 6, "throttle": 0.5 },
+        "duration": 120, "dt": 0.01, "output_interval": 1.0,
+        "autopilot": [ { "t": 0, "speed": 40 }, { "t": 30, "speed": 45 } ]
+    })");
+
+    ScenarioResult r = runScenario(s, tempOutput("autopilot"));
+    REQUIRE(r.stop_reason == "duration");
+    auto rows = readCsv(r.outputFile);
+    REQUIRE(rows.back()[5] > rows[30][5] + 3.0); // accelerating after the setpoint change
+    REQUIRE_THAT(rows.back()[5], Catch::Matchers::WithinAbs(45.0, 2.0));
+    std::filesystem::remove(r.outputFile);
+}
+
+TEST_CASE("Scenario - scheduled gains follow the flight condition")
+{
+    Scenario s = scenarioFromString(R"({
+        "aircraft": "aircraft_scheduled.json",
+        "initial": { "altitude": 150, "vx": 40, "pitch_deg": 6, "throttle": 0.5 },
+        "duration": 60, "dt": 0.01, "output_interval": 1.0,
+        "autopilot": [ { "t": 0, "speed": 40 }, { "t": 20, "speed": 48 } ]
+    })");
+    REQUIRE(s.initial.aircraft.hasGainSchedule());
+
+    SimulationState state = s.initial;
+    state.autopilot_speed = true;
+    state.speed_setpoint = 40.0f;
+    for (int i = 0; i < 100; i++)
+        selectPhysicsStep(state)(state);
+
+    // Gains match the table at the current condition, not the state's sliders
+    double q = 0.5 * getDensity(state.position.y) * state.velocity.magnitude() * state.velocity.magnitude();
+    ScheduledGains expected = state.aircraft.gainSchedule->lookup(q, state.position.y);
+    REQUIRE(state.speed_pid.getKp() == Catch::Approx(expected.speed[0]).epsilon(1e-3));
+    REQUIRE(state.speed_pid.getKi() == Catch::Approx(expected.speed[1]).epsilon(1e-3));
+    REQUIRE(state.speed_pid.getKp() != Catch::Approx(state.pid_kp));
+
+    // Gain updates do not reset the integrator
+    double integral = state.speed_pid.getIntegralTerm();
+    REQUIRE(integral != 0.0);
+    selectPhysicsStep(state)(state);
+    REQUIRE(state.speed_pid.getIntegralTerm() == Catch::Approx(integral).epsilon(0.05));
+
+    // Switching scheduling off hands control back to the fixed gains (as an
+    // autopilot event or the control panel would)
+    state.gain_scheduling = false;
+    syncControllerGains(state);
+    REQUIRE(state.speed_pid.getKp() == Catch::Approx(state.pid_kp));
+
+    ScenarioResult r = runScenario(s, tempOutput("scheduled"));
+    REQUIRE(r.stop_reason == "duration");
+    auto rows = readCsv(r.outputFile);
+    REQUIRE(rows.back()[5] > rows[20][5] + 3.0);
+    std::filesystem::remove(r.outputFile);
+}
+
+TEST_CASE("Scenario - atmosphere profile changes the air density")
+{
+    Scenario standard = scenarioFromString(R"({
+        "initial": { "altitude": 0, "vx": 0, "pitch_deg": 5, "throttle": 1.0 },
+        "duration": 60, "dt": 0.01,
+        "stop": { "max_altitude": 50 }
+    })");
+    Scenario hot = scenarioFromString(R"({
+        "initial": { "altitude": 0, "vx": 0, "pitch_deg": 5, "throttle": 1.0 },
+        "duration": 60, "dt": 0.01,
+        "atmosphere": { "temperature_offset": 30 },
+        "stop": { "max_altitude": 50 }
+    })");
+    REQUIRE_FALSE(standard.initial.atmosphere);
+    REQUIRE(hot.initial.atmosphere);
+    REQUIRE(hot.initial.atmosphere->density(0.0) < getDensity(0.0));
+
+    // Thinner air: longer to climb out on the same thrust
+    ScenarioResult a = runScenario(standard, tempOutput("standard_day"));
+    ScenarioResult b = runScenario(hot, tempOutput("hot_day"));
+    REQUIRE(a.stop_reason == "max_altitude");
+    REQUIRE(b.stop_reason == "max_altitude");
+    REQUIRE(b.sim_time > a.sim_time + 0.5);
+    std::filesystem::remove(a.outputFile);
+    std::filesystem::remove(b.outputFile);
+
+    Scenario sounding = scenarioFromString(R"({ "atmosphere": { "file": "atmosphere_sounding.csv" } })");
+    REQUIRE(sounding.initial.atmosphere->pressure(0.0) == Catch::Approx(100800.0));
+    REQUIRE_THROWS(scenarioFromString(R"({ "atmosphere": { "file": "missing.csv" } })"));
+}
+
+TEST_CASE("Scenario - shipped scenarios run in parallel")
+{
+    auto files = findScenarioFiles(std::filesystem::path(FLIGHTSIM_CONFIG_DIR) / "scenarios");
+    REQUIRE(files.size() >= 3);
+
+    auto outputDir = std::filesystem::temp_directory_path() / "flightsim_scenario_batch";
+    ThreadPool pool(2);
+    auto results = runScenarioFiles(files, outputDir, pool);
+
+    REQUIRE(results.size() == files.size());
+    for (const auto &r : results)
+    {
+        INFO(r.name << ": " << r.error);
+        REQUIRE(r.ok());
+        REQUIRE(r.steps > 0);
+        REQUIRE(std::filesystem::exists(r.outputFile));
+    }
+    std::filesystem::remove_all(outputDir);
+}
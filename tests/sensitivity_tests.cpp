@@ -0,0 +1,273 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "simulation/sensitivity.hpp"
+#include "scenario/scenario.hpp"
+#include <cmath>
+#include <functional>
+#include <string>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+/**
+ * TEST STRATEGY:
+ * 1. Dual numbers: derivatives of arithmetic and the math functions match
+ *    the analytic ones; comparisons look at the value
+ * 2. Density gradients (ISA layers, profiles) match finite differences
+ * 3. A dual run flies the same trajectory as the double simulator
+ * 4. Trajectory derivatives with respect to the airframe parameters match
+ *    central finite differences of the simulator (legacy model) and of the
+ *    dual run's own values (aero table, which is only piecewise smooth)
+ * 5. Derivatives with respect to the autopilot gains match as well, with
+ *    both loops engaged
+ * 6. A takeoff roll from rest (zero speed, sqrt and atan2 at the origin)
+ *    keeps finite derivatives that match finite differences
+ */
+
+using D2 = Dual<2>;
+
+static Scenario scenarioFromString(const std::string &json)
+{
+    return ScenarioLoader::fromJSON(JsonValue::parse(json), FLIGHTSIM_CONFIG_DIR, "inline");
+}
+
+static FlightState flyDouble(SimulationState state, size_t steps)
+{
+    syncControllerGains(state);
+    PhysicsStepFn step = selectPhysicsStep(state);
+    for (size_t i = 0; i < steps; i++)
+        step(state);
+    return state;
+}
+
+// Final altitude and velocity of a run
+struct Endpoint
+{
+    double altitude, vx, vz;
+};
+
+// By the simulator itself
+static Endpoint flySimulator(const SimulationState &state, size_t steps)
+{
+    FlightState end = flyDouble(state, steps);
+    return {end.position.y, end.velocity.x, end.velocity.y};
+}
+
+// By the values of a dual run: the same discrete model without the float
+// rounding of the controls, so small steps give clean differences
+static Endpoint flyDualValues(const SimulationState &state, size_t steps)
+{
+    SensitivityRun run(state);
+    run.run(steps);
+    return {run.state().position.y.v, run.state().velocity.x.v, run.state().velocity.y.v};
+}
+
+// Central difference of the endpoint with respect to one parameter, set
+// through `set` (which returns the value actually stored, so float fields are
+// differenced by their rounded values), against the dual derivatives
+static void requireMatchesFiniteDifference(const SimulationState &state, size_t steps, SensitivityParameter p,
+                                           const std::function<double(SimulationState &, double)> &set,
+                                           double value, Endpoint (*fly)(const SimulationState &, size_t),
+                                           double relative_step, double tolerance)
+{
+    SensitivityRun run(state);
+    run.run(steps);
+    const FlightStateT<SensitivityScalar> &dual = run.state();
+
+    const double h = relative_step * std::fabs(value);
+    SimulationState plus = state, minus = state;
+    double up = set(plus, value + h), down = set(minus, value - h);
+    Endpoint ep = fly(plus, steps), em = fly(minus, steps);
+
+    auto check = [&](const char *what, double fd, double ad)
+    {
+        INFO(sensitivityParameterName(p) << " d(" << what << "): finite difference " << fd << ", dual " << ad);
+        REQUIRE(ad == Catch::Approx(fd).epsilon(tolerance).margin(tolerance * 1e-3));
+    };
+    check("altitude", (ep.altitude - em.altitude) / (up - down), dual.position.y.d[p]);
+    check("vx", (ep.vx - em.vx) / (up - down), dual.velocity.x.d[p]);
+    check("vz", (ep.vz - em.vz) / (up - down), dual.velocity.y.d[p]);
+}
+
+static double setMass(SimulationState &s, double v) { return s.aircraft.mass = v; }
+static double setS(SimulationState &s, double v) { return s.aircraft.S = v; }
+static double setCD0(SimulationState &s, double v) { return s.aircraft.CD0 = v; }
+static double setK(SimulationState &s, double v) { return s.aircraft.k = v; }
+static double setMaxThrust(SimulationState &s, double v) { return s.aircraft.maxThrust = v; }
+
+TEST_CASE("Dual numbers - derivatives")
+{
+    D2 x = D2::variable(0.7, 0), y = D2::variable(1.9, 1);
+
+    D2 f = sin(x) * y + exp(x) / y - sqrt(x * y) + 3.0 * log(y) - pow(x, 3.0);
+    REQUIRE(f.v == Catch::Approx(std::sin(0.7) * 1.9 + std::exp(0.7) / 1.9 - std::sqrt(0.7 * 1.9) + 3.0 * std::log(1.9) - std::pow(0.7, 3.0)));
+    REQUIRE(f.d[0] == Catch::Approx(std::cos(0.7) * 1.9 + std::exp(0.7) / 1.9 - 0.5 * 1.9 / std::sqrt(0.7 * 1.9) - 3.0 * 0.49));
+    REQUIRE(f.d[1] == Catch::Approx(std::sin(0.7) - std::exp(0.7) / (1.9 * 1.9) - 0.5 * 0.7 / std::sqrt(0.7 * 1.9) + 3.0 / 1.9));
+
+    D2 a = atan2(y, -x);
+    double r2 = 0.7 * 0.7 + 1.9 * 1.9;
+    REQUIRE(a.v == std::atan2(1.9, -0.7));
+    REQUIRE(a.d[0] == Catch::Approx(1.9 / r2)); // d/dx atan2(y, -x)
+    REQUIRE(a.d[1] == Catch::Approx(-0.7 / r2));
+
+    D2 c = cos(-x) - fabs(-y);
+    REQUIRE(c.d[0] == Catch::Approx(-std::sin(0.7)));
+    REQUIRE(c.d[1] == -1.0);
+
+    // Constants carry no derivatives; comparisons see values only
+    D2 k = 2.5;
+    REQUIRE(k.d[0] == 0.0);
+    REQUIRE((x < y && y > 1.0 && 0.7 == x && x != y));
+    REQUIRE(std::max(x, y).d[1] == 1.0);
+    REQUIRE(scalarValue(y) == 1.9);
+
+    // At the origin: the value, with zero rather than NaN derivatives
+    D2 zero = x * 0.0;
+    REQUIRE(sqrt(zero).v == 0.0);
+    REQUIRE(sqrt(zero).d[0] == 0.0);
+    REQUIRE(atan2(zero, zero).d[0] == 0.0);
+}
+
+TEST_CASE("Sensitivity - density gradients")
+{
+    const double h = 1e-3;
+    for (double altitude : {500.0, 15000.0, 25000.0, 50000.0})
+    {
+        INFO("altitude " << altitude);
+        double fd = (getDensity(altitude + h) - getDensity(altitude - h)) / (2 * h);
+        REQUIRE(getDensityGradient(altitude) == Catch::Approx(fd).epsilon(1e-6));
+    }
+
+    AtmosphereProfile hot = AtmosphereProfile::isaDeviation(20.0);
+    REQUIRE(hot.densityGradient(1234.0) == Catch::Approx((hot.density(1236.0) - hot.density(1232.0)) / 4.0).epsilon(1e-12));
+    REQUIRE(hot.densityGradient(-10.0) == 0.0);
+
+    // Through the flight condition, zero on the ground
+    FlightParams params;
+    FlightStateT<D2> flight;
+    flight.position.y = D2::variable(800.0, 0);
+    REQUIRE(flightCondition(flight, params).rho.d[0] == Catch::Approx(getDensityGradient(800.0)));
+    flight.position.y = D2::variable(0.0, 0);
+    REQUIRE(flightCondition(flight, params).rho.d[0] == 0.0);
+}
+
+TEST_CASE("Sensitivity - dual run flies the simulator's trajectory")
+{
+    Scenario s = scenarioFromString(R"({
+        "initial": { "altitude": 300, "vx": 35, "pitch_deg": 4, "throttle": 0.5, "elevator": 0.05 },
+        "dt": 0.01
+    })");
+    SensitivityRun run(s.initial);
+    run.run(500);
+    FlightState reference = flyDouble(s.initial, 500);
+
+    // Equal up to the float rounding of the attitude in the simulator
+    REQUIRE(run.state().t.v == Catch::Approx(reference.t));
+    REQUIRE(run.state().position.x.v == Catch::Approx(reference.position.x).epsilon(1e-6));
+    REQUIRE(run.state().position.y.v == Catch::Approx(reference.position.y).epsilon(1e-6));
+    REQUIRE(run.state().pitch_deg.v == Catch::Approx(reference.pitch_deg).epsilon(1e-5));
+
+    // Time does not depend on the parameters
+    for (double d : run.state().t.d)
+        REQUIRE(d == 0.0);
+}
+
+TEST_CASE("Sensitivity - airframe parameters against finite differences")
+{
+    const std::string initial = R"("initial": { "altitude": 300, "vx": 35, "pitch_deg": 4, "throttle": 0.5, "elevator": 0.05 }, "dt": 0.01)";
+
+    SECTION("Legacy model, against the simulator")
+    {
+        Scenario s = scenarioFromString("{" + initial + "}");
+        REQUIRE_FALSE(s.initial.aircraft.hasAeroTable());
+        const Aircraft &a = s.initial.aircraft;
+        requireMatchesFiniteDifference(s.initial, 500, SensMass, setMass, a.mass, flySimulator, 1e-4, 1e-4);
+        requireMatchesFiniteDifference(s.initial, 500, SensWingArea, setS, a.S, flySimulator, 1e-4, 1e-4);
+        requireMatchesFiniteDifference(s.initial, 500, SensCD0, setCD0, a.CD0, flySimulator, 1e-4, 1e-4);
+        requireMatchesFiniteDifference(s.initial, 500, SensInducedDrag, setK, a.k, flySimulator, 1e-4, 1e-4);
+        requireMatchesFiniteDifference(s.initial, 500, SensMaxThrust, setMaxThrust, a.maxThrust, flySimulator, 1e-4, 1e-4);
+    }
+
+    SECTION("Aero table, semi-implicit Euler")
+    {
+        // The table is piecewise linear in alpha: steps small enough that no
+        // perturbed step lands on the other side of a breakpoint
+        Scenario s = scenarioFromString(R"({ "aircraft": "aircraft_config.json", )" + initial + "}");
+        REQUIRE(s.initial.aircraft.hasAeroTable());
+        s.initial.integrator = IntegratorType::SemiImplicitEuler;
+        const Aircraft &a = s.initial.aircraft;
+        requireMatchesFiniteDifference(s.initial, 500, SensMass, setMass, a.mass, flyDualValues, 1e-6, 1e-5);
+        requireMatchesFiniteDifference(s.initial, 500, SensWingArea, setS, a.S, flyDualValues, 1e-6, 1e-5);
+        requireMatchesFiniteDifference(s.initial, 500, SensCD0, setCD0, a.CD0, flyDualValues, 1e-6, 1e-5);
+        requireMatchesFiniteDifference(s.initial, 500, SensMaxThrust, setMaxThrust, a.maxThrust, flyDualValues, 1e-6, 1e-5);
+
+        // Against the simulator over a shorter run, away from breakpoints
+        requireMatchesFiniteDifference(s.initial, 200, SensMass, setMass, a.mass, flySimulator, 1e-4, 1e-4);
+
+        // The table replaces the drag polar: k has no effect
+        SensitivityRun run(s.initial);
+        run.run(500);
+        REQUIRE(run.state().position.y.d[SensInducedDrag] == 0.0);
+    }
+}
+
+TEST_CASE("Sensitivity - autopilot gains against finite differences")
+{
+    Scenario s = scenarioFromString(R"({
+        "initial": { "altitude": 300, "vx": 35, "pitch_deg": 2, "throttle": 0.5 },
+        "dt": 0.01
+    })");
+    s.initial.autopilot_speed = true;
+    s.initial.speed_setpoint = 38.0f;
+    s.initial.autopilot_altitude = true;
+    s.initial.altitude_setpoint = 310.0f;
+    s.initial.pid_kp = 0.05f;
+    s.initial.alt_pid_kp = 0.02f;
+    s.initial.alt_pid_kd = 0.05f;
+
+    // Gains are float fields: steps well above their rounding, differenced by
+    // the rounded values
+    auto gain = [](float SimulationState::*field)
+    {
+        return [field](SimulationState &st, double v)
+        { return static_cast<double>(st.*field = static_cast<float>(v)); };
+    };
+    const SimulationState &st = s.initial;
+    requireMatchesFiniteDifference(st, 500, SensSpeedKp, gain(&SimulationState::pid_kp), st.pid_kp, flyDualValues, 1e-4, 1e-5);
+    requireMatchesFiniteDifference(st, 500, SensSpeedKi, gain(&SimulationState::pid_ki), st.pid_ki, flyDualValues, 1e-4, 1e-5);
+    requireMatchesFiniteDifference(st, 500, SensSpeedKd, gain(&SimulationState::pid_kd), st.pid_kd, flyDualValues, 1e-4, 1e-5);
+    requireMatchesFiniteDifference(st, 500, SensAltitudeKp, gain(&SimulationState::alt_pid_kp), st.alt_pid_kp, flyDualValues, 1e-4, 1e-5);
+    requireMatchesFiniteDifference(st, 500, SensAltitudeKi, gain(&SimulationState::alt_pid_ki), st.alt_pid_ki, flyDualValues, 1e-4, 1e-5);
+    requireMatchesFiniteDifference(st, 500, SensAltitudeKd, gain(&SimulationState::alt_pid_kd), st.alt_pid_kd, flyDualValues, 1e-4, 1e-5);
+
+    // Airframe derivatives carry through the closed loops
+    requireMatchesFiniteDifference(st, 500, SensMass, setMass, st.aircraft.mass, flyDualValues, 1e-5, 1e-5);
+}
+
+TEST_CASE("Sensitivity - takeoff from rest")
+{
+    Scenario s = scenarioFromString(R"({
+        "initial": { "altitude": 0, "vx": 0, "vz": 0, "pitch_deg": 5, "throttle": 1 },
+        "dt": 0.01
+    })");
+    SensitivityRun run(s.initial);
+    run.run(500);
+    const FlightStateT<SensitivityScalar> &end = run.state();
+    REQUIRE(end.position.x.v > 10.0);
+    for (size_t p = 0; p < SensParameterCount; p++)
+    {
+        INFO(sensitivityParameterName(static_cast<SensitivityParameter>(p)));
+        REQUIRE(std::isfinite(end.position.x.d[p]));
+        REQUIRE(std::isfinite(end.position.y.d[p]));
+        REQUIRE(std::isfinite(end.velocity.x.d[p]));
+        REQUIRE(std::isfinite(end.velocity.y.d[p]));
+    }
+    // Heavier accelerates slower, more thrust faster
+    REQUIRE(end.position.x.d[SensMass] < 0.0);
+    REQUIRE(end.position.x.d[SensMaxThrust] > 0.0);
+
+    const Aircraft &a = s.initial.aircraft;
+    requireMatchesFiniteDifference(s.initial, 500, SensMass, setMass, a.mass, flyDualValues, 1e-6, 1e-5);
+    requireMatchesFiniteDifference(s.initial, 500, SensMaxThrust, setMaxThrust, a.maxThrust, flyDualValues, 1e-6, 1e-5);
+}
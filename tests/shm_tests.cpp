@@ -0,0 +1,276 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "shm/shm_control.hpp"
+#include "shm/shm_client.h"
+#include "scenario/scenario_runner.hpp"
+#include <atomic>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * TEST STRATEGY:
+ * 1. Seqlock: a reader racing a writer only ever sees complete payloads
+ * 2. Segment: the C client maps the server's segment and reads published state,
+ *    and fails cleanly when no simulator is running; a segment left by an
+ *    exited simulator is replaced, one in use (or not ours) is not
+ * 3. Mailbox: commands set throttle/elevator per their flags, are clamped,
+ *    drop non-finite inputs, apply once per id and are echoed back in the published state
+ * 4. Scenario runner: commands posted by a client drive a headless run
+ */
+
+static std::string segmentName(const char *tag)
+{
+    return "/flightsim_test_" + std::string(tag) + "_" + std::to_string(::getpid());
+}
+
+TEST_CASE("Seqlock - concurrent reader never sees a torn payload")
+{
+    struct Payload
+    {
+        uint64_t words[14];
+    };
+    alignas(64) uint64_t seq = 0;
+    Payload shared{};
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]
+                       {
+        Payload p;
+        for (uint64_t k = 1; k <= 200000; k++)
+        {
+            for (uint64_t &w : p.words)
+                w = k;
+            fsim_seqlock_write(&seq, &shared, &p, sizeof(p));
+        }
+        done.store(true); });
+
+    size_t reads = 0, torn = 0;
+    uint64_t last = 0;
+    bool monotonic = true;
+    while (!done.load())
+    {
+        Payload copy;
+        if (!fsim_seqlock_read(&seq, &shared, &copy, sizeof(copy), 100))
+            continue;
+        reads++;
+        for (uint64_t w : copy.words)
+            torn += (w != copy.words[0]);
+        monotonic = monotonic && copy.words[0] >= last;
+        last = copy.words[0];
+    }
+    writer.join();
+
+    REQUIRE(reads > 0);
+    REQUIRE(torn == 0);
+    REQUIRE(monotonic);
+    REQUIRE(seq == 2 * 200000);
+}
+
+TEST_CASE("ShmControl - C client reads published state")
+{
+    std::string name = segmentName("state");
+    ShmControlServer server(name);
+
+    fsim_client *client = fsim_client_open(name.c_str());
+    REQUIRE(client != nullptr);
+
+    SimulationState state;
+    state.position = Vec2(12.0, 345.0);
+    state.velocity = Vec2(40.0, -1.5);
+    state.pitch_deg = 4.0f;
+    state.throttle = 0.6f;
+    state.t = 1.25;
+    server.publish(state);
+
+    fsim_shm_state s;
+    REQUIRE(fsim_client_read_state(client, &s));
+    REQUIRE(s.step == 1);
+    REQUIRE(s.t == Catch::Approx(1.25));
+    REQUIRE(s.x == Catch::Approx(12.0));
+    REQUIRE(s.altitude == Catch::Approx(345.0));
+    REQUIRE(s.vz == Catch::Approx(-1.5));
+    REQUIRE(s.throttle == Catch::Approx(0.6));
+    REQUIRE(s.command_id == 0);
+
+    fsim_client_close(client);
+}
+
+TEST_CASE("ShmControl - opening a missing segment fails")
+{
+    REQUIRE(fsim_client_open(segmentName("missing").c_str()) == nullptr);
+
+    // The segment disappears with its server
+    std::string name = segmentName("gone");
+    {
+        ShmControlServer server(name);
+    }
+    REQUIRE(fsim_client_open(name.c_str()) == nullptr);
+}
+
+TEST_CASE("ShmControl - existing segments")
+{
+    // A live simulator keeps its segment
+    std::string name = segmentName("busy");
+    {
+        ShmControlServer server(name);
+        REQUIRE_THROWS_WITH(ShmControlServer(name), Catch::Matchers::ContainsSubstring("in use by process"));
+        fsim_client *client = fsim_client_open(name.c_str());
+        REQUIRE(client != nullptr);
+        fsim_client_close(client);
+    }
+
+    // A segment left behind by a simulator that has exited is replaced
+    pid_t child = ::fork();
+    REQUIRE(child >= 0);
+    if (child == 0)
+        ::_exit(0);
+    ::waitpid(child, nullptr, 0);
+    auto leaveSegment = [&](uint32_t magic, uint32_t pid)
+    {
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        REQUIRE(fd >= 0);
+        REQUIRE(::ftruncate(fd, sizeof(fsim_shm_segment)) == 0);
+        void *mem = ::mmap(nullptr, sizeof(fsim_shm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        REQUIRE(mem != MAP_FAILED);
+        fsim_shm_segment *segment = static_cast<fsim_shm_segment *>(mem);
+        segment->magic = magic;
+        segment->sim_pid = pid;
+        ::munmap(mem, sizeof(fsim_shm_segment));
+    };
+    leaveSegment(FSIM_SHM_MAGIC, static_cast<uint32_t>(child));
+    {
+        ShmControlServer server(name);
+        REQUIRE(server.statesPublished() == 0);
+    }
+
+    // Someone else's segment is never removed
+    leaveSegment(0, 0);
+    REQUIRE_THROWS_WITH(ShmControlServer(name), Catch::Matchers::ContainsSubstring("not a simulator segment"));
+    ::shm_unlink(name.c_str());
+}
+
+TEST_CASE("ShmControl - command mailbox")
+{
+    std::string name = segmentName("cmd");
+    ShmControlServer server(name);
+    fsim_client *client = fsim_client_open(name.c_str());
+    REQUIRE(client != nullptr);
+
+    SimulationState state;
+    state.throttle = 0.2f;
+    state.elevator = 0.1f;
+
+    SECTION("No command leaves the controls alone")
+    {
+        REQUIRE_FALSE(server.applyCommands(state));
+        REQUIRE(state.throttle == 0.2f);
+        REQUIRE(state.elevator == 0.1f);
+    }
+
+    SECTION("Flags select the fields, each id applies once")
+    {
+        fsim_client_send(client, FSIM_CMD_THROTTLE, 0.7f, -0.9f);
+        REQUIRE(server.applyCommands(state));
+        REQUIRE(state.throttle == 0.7f);
+        REQUIRE(state.elevator == 0.1f);
+
+        // Local changes are not overwritten by an already applied command
+        state.throttle = 0.3f;
+        REQUIRE_FALSE(server.applyCommands(state));
+        REQUIRE(state.throttle == 0.3f);
+
+        fsim_client_send(client, FSIM_CMD_THROTTLE | FSIM_CMD_ELEVATOR, 0.4f, -0.25f);
+        REQUIRE(server.applyCommands(state));
+        REQUIRE(state.throttle == 0.4f);
+        REQUIRE(state.elevator == -0.25f);
+        REQUIRE(server.commandsApplied() == 2);
+    }
+
+    SECTION("Out-of-range commands are clamped")
+    {
+        fsim_client_send(client, FSIM_CMD_THROTTLE | FSIM_CMD_ELEVATOR, 3.0f, -7.0f);
+        REQUIRE(server.applyCommands(state));
+        REQUIRE(state.throttle == 1.0f);
+        REQUIRE(state.elevator == -1.0f);
+    }
+
+    SECTION("Non-finite inputs keep the previous ones")
+    {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        const float inf = std::numeric_limits<float>::infinity();
+        fsim_client_send(client, FSIM_CMD_THROTTLE | FSIM_CMD_ELEVATOR, nan, -inf);
+        REQUIRE(server.applyCommands(state));
+        REQUIRE(state.throttle == 0.2f);
+        REQUIRE(state.elevator == 0.1f);
+
+        fsim_client_send(client, FSIM_CMD_THROTTLE | FSIM_CMD_ELEVATOR, 0.6f, nan);
+        REQUIRE(server.applyCommands(state));
+        REQUIRE(state.throttle == 0.6f);
+        REQUIRE(state.elevator == 0.1f);
+    }
+
+    SECTION("Applied command is echoed in the next published state")
+    {
+        uint64_t id = fsim_client_send(client, FSIM_CMD_ELEVATOR, 0.0f, 0.5f);
+        server.applyCommands(state);
+        server.publish(state);
+
+        fsim_shm_state s;
+        REQUIRE(fsim_client_wait_applied(client, id, 1000000000, &s));
+        REQUIRE(s.command_id == id);
+        REQUIRE(s.elevator == Catch::Approx(0.5));
+        REQUIRE(s.command_applied_ns >= s.command_sent_ns);
+    }
+
+    SECTION("A new client continues the id sequence")
+    {
+        uint64_t first = fsim_client_send(client, FSIM_CMD_THROTTLE, 0.5f, 0.0f);
+        fsim_client *second = fsim_client_open(name.c_str());
+        REQUIRE(second != nullptr);
+        REQUIRE(fsim_client_send(second, FSIM_CMD_THROTTLE, 0.5f, 0.0f) == first + 1);
+        fsim_client_close(second);
+    }
+
+    fsim_client_close(client);
+}
+
+TEST_CASE("ShmControl - client commands drive a scenario run")
+{
+    std::string name = segmentName("run");
+    ShmControlServer server(name);
+    fsim_client *client = fsim_client_open(name.c_str());
+    REQUIRE(client != nullptr);
+
+    Scenario s;
+    s.name = "shm";
+    s.initial.position = Vec2(0.0, 500.0);
+    s.initial.velocity = Vec2(40.0, 0.0);
+    s.initial.pitch_deg = 6.0f;
+    s.initial.throttle = 0.5f;
+    s.duration = 2.0;
+
+    // Posted before the run starts, so it applies to the very first step
+    uint64_t id = fsim_client_send(client, FSIM_CMD_THROTTLE, 0.9f, 0.0f);
+
+    std::filesystem::path output = std::filesystem::temp_directory_path() / "flightsim_shm_run.csv";
+    ScenarioResult r = runScenario(s, output, nullptr, &server);
+    REQUIRE(r.ok());
+    REQUIRE(server.commandsApplied() == 1);
+    REQUIRE(server.statesPublished() == r.steps);
+
+    fsim_shm_state state;
+    REQUIRE(fsim_client_read_state(client, &state));
+    REQUIRE(state.command_id == id);
+    REQUIRE(state.throttle == Catch::Approx(0.9));
+    REQUIRE(state.t == Catch::Approx(r.sim_time));
+
+    fsim_client_close(client);
+    std::filesystem::remove(output);
+}
@@ -0,0 +1,351 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "telemetry/spsc_ring.hpp"
+#include "telemetry/telemetry_hub.hpp"
+#include "telemetry/telemetry_exporter.hpp"
+#include "simulation/physics_update.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * TEST STRATEGY:
+ * 1. Ring: FIFO order, full/empty behavior and index wrap-around
+ * 2. Hub: every consumer sees every record, overflow is counted per consumer
+ *    without affecting the others, detach/re-attach starts fresh
+ * 3. Threaded: a producer publishing flat out never blocks, and each consumer
+ *    receives an increasing sequence with received + dropped == published
+ * 4. Wire format: frames round-trip, malformed datagrams are rejected
+ * 5. Exporter: records published on the sim side arrive in order over
+ *    loopback UDP (and a Unix socket on POSIX), batched into few datagrams
+ */
+
+static TelemetryRecord recordAt(double t)
+{
+    TelemetryRecord r{};
+    r.t = t;
+    return r;
+}
+
+TEST_CASE("SpscRing - FIFO order, full and empty")
+{
+    SpscRing<int> ring(3);
+    REQUIRE(ring.capacity() == 4); // rounded up to a power of two
+
+    int value = 0;
+    REQUIRE_FALSE(ring.tryPop(value));
+
+    for (int i = 0; i < 4; i++)
+        REQUIRE(ring.tryPush(i));
+    REQUIRE_FALSE(ring.tryPush(99));
+    REQUIRE(ring.size() == 4);
+
+    for (int i = 0; i < 4; i++)
+    {
+        REQUIRE(ring.tryPop(value));
+        REQUIRE(value == i);
+    }
+    REQUIRE_FALSE(ring.tryPop(value));
+}
+
+TEST_CASE("SpscRing - wraps around many times")
+{
+    SpscRing<int> ring(8);
+    int expected = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        REQUIRE(ring.tryPush(i));
+        if (i % 3 == 2)
+        {
+            int value;
+            while (ring.tryPop(value))
+                REQUIRE(value == expected++);
+        }
+    }
+    int value;
+    while (ring.tryPop(value))
+        REQUIRE(value == expected++);
+    REQUIRE(expected == 1000);
+}
+
+TEST_CASE("TelemetryHub - all consumers receive every record")
+{
+    TelemetryHub hub(16);
+    auto ui = hub.attach();
+    auto recorder = hub.attach();
+
+    for (int i = 0; i < 10; i++)
+        hub.publish(recordAt(i * 0.1));
+    REQUIRE(hub.published() == 10);
+
+    for (auto *consumer : {&ui, &recorder})
+    {
+        std::vector<uint64_t> sequences;
+        consumer->drain([&](const TelemetryRecord &r)
+                        { sequences.push_back(r.sequence); });
+        REQUIRE(sequences.size() == 10);
+        for (size_t i = 0; i < sequences.size(); i++)
+            REQUIRE(sequences[i] == i);
+        REQUIRE(consumer->dropped() == 0);
+    }
+}
+
+TEST_CASE("TelemetryHub - overflow is counted per consumer")
+{
+    TelemetryHub hub(8);
+    auto slow = hub.attach();
+    auto fast = hub.attach();
+
+    size_t fast_received = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        hub.publish(recordAt(i));
+        fast_received += fast.drain([](const TelemetryRecord &) {});
+    }
+
+    REQUIRE(fast_received == 100);
+    REQUIRE(fast.dropped() == 0);
+
+    // The slow consumer keeps the oldest records and loses the rest
+    TelemetryRecord r{};
+    REQUIRE(slow.pop(r));
+    REQUIRE(r.sequence == 0);
+    REQUIRE(slow.dropped() == 100 - slow.capacity());
+}
+
+TEST_CASE("TelemetryHub - detach frees the slot and re-attach starts fresh")
+{
+    TelemetryHub hub(8);
+    std::vector<TelemetryHub::Consumer> consumers;
+    for (size_t i = 0; i < TelemetryHub::MaxConsumers; i++)
+        consumers.push_back(hub.attach());
+    REQUIRE_THROWS_AS(hub.attach(), std::runtime_error);
+
+    for (int i = 0; i < 20; i++)
+        hub.publish(recordAt(i)); // overflows every ring
+
+    consumers.front().detach();
+    REQUIRE_FALSE(consumers.front().attached());
+
+    auto fresh = hub.attach();
+    REQUIRE(fresh.dropped() == 0);
+    TelemetryRecord r{};
+    REQUIRE_FALSE(fresh.pop(r)); // nothing from before the attach
+
+    hub.publish(recordAt(99.0));
+    REQUIRE(fresh.pop(r));
+    REQUIRE(r.sequence == 20);
+    REQUIRE(r.t == 99.0);
+}
+
+TEST_CASE("TelemetryHub - record snapshot matches the state")
+{
+    SimulationState state;
+    state.position = Vec2(10.0, 200.0);
+    state.velocity = Vec2(40.0, 0.0);
+    state.throttle = 0.5f;
+    state.pitch_deg = 4.0f;
+    state.autopilot_speed = true;
+    state.dt = 0.01;
+    syncControllerGains(state);
+    selectPhysicsStep(state)(state);
+
+    TelemetryRecord r = makeTelemetryRecord(state, 3);
+    REQUIRE(r.aircraft == 3);
+    REQUIRE(r.flags == TelemetryRecord::SpeedAutopilot);
+    REQUIRE(r.t == state.t);
+    REQUIRE(r.position.x == state.position.x);
+    REQUIRE(r.velocity.y == state.velocity.y);
+    REQUIRE(r.F_lift.y == state.F_lift_viz.y);
+    REQUIRE(r.throttle == state.throttle);
+    REQUIRE(r.speed_p == static_cast<float>(state.speed_pid.getProportionalTerm()));
+}
+
+TEST_CASE("TelemetryHub - concurrent producer and consumers")
+{
+    const uint64_t total = 200000;
+    TelemetryHub hub(256);
+
+    std::vector<TelemetryHub::Consumer> consumers;
+    consumers.push_back(hub.attach());
+    consumers.push_back(hub.attach());
+
+    std::atomic<bool> done{false};
+    std::vector<uint64_t> received(consumers.size(), 0);
+    std::vector<bool> ordered(consumers.size(), true);
+
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < consumers.size(); c++)
+    {
+        threads.emplace_back([&, c]
+                             {
+            uint64_t last = 0;
+            bool first = true;
+            auto handle = [&](const TelemetryRecord &r)
+            {
+                if (!first && r.sequence <= last)
+                    ordered[c] = false;
+                last = r.sequence;
+                first = false;
+                received[c]++;
+            };
+            while (!done.load(std::memory_order_acquire))
+                consumers[c].drain(handle);
+            consumers[c].drain(handle); });
+    }
+
+    for (uint64_t i = 0; i < total; i++)
+        hub.publish(recordAt(static_cast<double>(i)));
+    done.store(true, std::memory_order_release);
+
+    for (auto &t : threads)
+        t.join();
+
+    REQUIRE(hub.published() == total);
+    for (size_t c = 0; c < consumers.size(); c++)
+    {
+        REQUIRE(ordered[c]);
+        REQUIRE(received[c] + consumers[c].dropped() == total);
+    }
+}
+
+TEST_CASE("Telemetry wire - frame round trip")
+{
+    TelemetryRecord r{};
+    r.sequence = 123456789012345ULL;
+    r.aircraft = 7;
+    r.flags = TelemetryRecord::AltitudeAutopilot;
+    r.t = 12.345678901234;
+    r.position = Vec2(98765.4321, 1234.5678);
+    r.velocity = Vec2(41.5, -2.25);
+    r.F_lift = Vec2(-10.0, 1180.5);
+    r.throttle = 0.625f;
+    r.elevator = -0.125f;
+    r.altitude_d = 0.0625f;
+
+    uint8_t buffer[telemetry_wire::FRAME_BYTES];
+    encodeTelemetryFrame(buffer, r);
+    TelemetryRecord d = decodeTelemetryFrame(buffer);
+
+    REQUIRE(telemetry_wire::FRAME_BYTES == 128);
+    REQUIRE(d.sequence == r.sequence);
+    REQUIRE(d.aircraft == 7);
+    REQUIRE(d.flags == r.flags);
+    REQUIRE(d.t == r.t);                   // float64 fields are exact
+    REQUIRE(d.position.x == r.position.x);
+    REQUIRE(d.position.y == r.position.y);
+    REQUIRE(d.velocity.y == -2.25);        // float32 fields exact for these values
+    REQUIRE(d.F_lift.y == 1180.5);
+    REQUIRE(d.throttle == 0.625f);
+    REQUIRE(d.elevator == -0.125f);
+    REQUIRE(d.altitude_d == 0.0625f);
+}
+
+TEST_CASE("Telemetry wire - packet framing and validation")
+{
+    REQUIRE(telemetry_wire::framesPerPacket(1400) == 10);
+
+    std::vector<uint8_t> packet(telemetry_wire::HEADER_BYTES + 3 * telemetry_wire::FRAME_BYTES);
+    encodeTelemetryHeader(packet.data(), 3, 42);
+    for (int i = 0; i < 3; i++)
+    {
+        TelemetryRecord r = recordAt(i);
+        r.sequence = 100 + i;
+        encodeTelemetryFrame(packet.data() + telemetry_wire::HEADER_BYTES + i * telemetry_wire::FRAME_BYTES, r);
+    }
+
+    std::vector<uint64_t> sequences;
+    uint32_t seq = decodeTelemetryPacket(packet.data(), packet.size(), [&](const TelemetryRecord &r)
+                                         { sequences.push_back(r.sequence); });
+    REQUIRE(seq == 42);
+    REQUIRE(sequences == std::vector<uint64_t>{100, 101, 102});
+
+    auto ignore = [](const TelemetryRecord &) {};
+    REQUIRE_THROWS_AS(decodeTelemetryPacket(packet.data(), packet.size() - 1, ignore), std::runtime_error);
+    REQUIRE_THROWS_AS(decodeTelemetryPacket(packet.data(), 4, ignore), std::runtime_error);
+    packet[0] ^= 0xff;
+    REQUIRE_THROWS_AS(decodeTelemetryPacket(packet.data(), packet.size(), ignore), std::runtime_error);
+}
+
+TEST_CASE("Telemetry endpoint parsing")
+{
+    TelemetryEndpoint udp = TelemetryEndpoint::parse("udp://127.0.0.1:9870");
+    REQUIRE(udp.kind == TelemetryEndpoint::Kind::Udp);
+    REQUIRE(udp.host == "127.0.0.1");
+    REQUIRE(udp.port == 9870);
+
+    TelemetryEndpoint unix_ep = TelemetryEndpoint::parse("unix:///tmp/flightsim.sock");
+    REQUIRE(unix_ep.kind == TelemetryEndpoint::Kind::Unix);
+    REQUIRE(unix_ep.path == "/tmp/flightsim.sock");
+
+    REQUIRE_THROWS_AS(TelemetryEndpoint::parse("tcp://localhost:1"), std::runtime_error);
+    REQUIRE_THROWS_AS(TelemetryEndpoint::parse("udp://localhost"), std::runtime_error);
+    REQUIRE_THROWS_AS(TelemetryEndpoint::parse("udp://localhost:70000"), std::runtime_error);
+}
+
+// Publish `count` records through an exporter and collect them on `receiver`
+static void checkLoopback(DatagramSocket &receiver, const std::string &endpoint)
+{
+    const uint64_t count = 500;
+    std::vector<uint64_t> sequences;
+    uint64_t packets = 0;
+
+    std::thread listener([&]
+                         {
+        std::vector<uint8_t> buffer(65536);
+        while (sequences.size() < count)
+        {
+            size_t size = receiver.receive(buffer.data(), buffer.size(), 2000);
+            if (size == 0)
+                break; // timed out
+            decodeTelemetryPacket(buffer.data(), size, [&](const TelemetryRecord &r)
+                                  { sequences.push_back(r.sequence); });
+            packets++;
+        } });
+
+    TelemetryHub hub(1024);
+    {
+        TelemetryExporter exporter(hub, endpoint, std::chrono::milliseconds(5));
+        for (uint64_t i = 0; i < count; i++)
+        {
+            hub.publish(recordAt(i * 0.01));
+            if (i % 50 == 49)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        exporter.stop();
+
+        TelemetryExporter::Stats stats = exporter.stats();
+        REQUIRE(stats.dropped == 0);
+        REQUIRE(stats.sendErrors == 0);
+        REQUIRE(stats.frames == count);
+        REQUIRE(stats.packets < count); // batched
+    }
+    listener.join();
+
+    REQUIRE(sequences.size() == count);
+    for (uint64_t i = 0; i < count; i++)
+        REQUIRE(sequences[i] == i);
+    REQUIRE(packets < count);
+}
+
+TEST_CASE("TelemetryExporter - UDP loopback")
+{
+    DatagramSocket receiver = DatagramSocket::bindTo(TelemetryEndpoint::parse("udp://127.0.0.1:0"));
+    std::string endpoint = "udp://127.0.0.1:" + std::to_string(receiver.localPort());
+    checkLoopback(receiver, endpoint);
+}
+
+#ifndef _WIN32
+TEST_CASE("TelemetryExporter - Unix domain socket")
+{
+    std::string path = (std::filesystem::temp_directory_path() / "flightsim_telemetry_test.sock").string();
+    DatagramSocket receiver = DatagramSocket::bindTo(TelemetryEndpoint::parse("unix://" + path));
+    checkLoopback(receiver, "unix://" + path);
+    receiver.close();
+    REQUIRE_FALSE(std::filesystem::exists(path));
+}
+#endif
@@ -0,0 +1,278 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "telemetry/trajectory_codec.hpp"
+#include "scenario/scenario_runner.hpp"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+/**
+ * TEST STRATEGY:
+ * 1. Varints, zigzag and the bit stream round-trip at their edge values
+ * 2. XOR channels are lossless for any double (NaN, infinities, -0,
+ *    subnormals); constant series shrink to about a bit per value
+ * 3. Quantized channels stay within their tolerance; values that cannot be
+ *    quantized fall back to lossless
+ * 4. Archives decode by block in any order, locate rows and times, and
+ *    unfinished or truncated files, or those of a writer destroyed by an
+ *    exception, are rejected
+ * 5. A scenario written as .trj holds the CSV's values in a fraction of
+ *    its size
+ */
+
+static std::filesystem::path tempFile(const std::string &name)
+{
+    return std::filesystem::temp_directory_path() / ("trajectory_codec_tests_" + name);
+}
+
+static bool sameBits(double a, double b)
+{
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+TEST_CASE("Trajectory codec - varints and bits")
+{
+    const int64_t signedValues[] = {0, 1, -1, 63, -64, 64, 1000000, -1000000,
+                                    std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()};
+    BinaryWriter w;
+    for (int64_t v : signedValues)
+        w.svarint(v);
+    w.uvarint(std::numeric_limits<uint64_t>::max());
+    BinaryReader r(w.bytes);
+    for (int64_t v : signedValues)
+        REQUIRE(r.svarint() == v);
+    REQUIRE(r.uvarint() == std::numeric_limits<uint64_t>::max());
+    REQUIRE(r.remaining() == 0);
+
+    // Small magnitudes take one byte
+    BinaryWriter small;
+    small.svarint(-64);
+    small.svarint(63);
+    small.uvarint(127);
+    REQUIRE(small.bytes.size() == 3);
+    small.uvarint(128);
+    REQUIRE(small.bytes.size() == 5);
+
+    std::vector<uint8_t> unterminated = {0x80, 0x80};
+    BinaryReader bad(unterminated);
+    REQUIRE_THROWS(bad.uvarint());
+
+    trajectory_codec::BitWriter bits;
+    std::mt19937_64 rng(1);
+    std::vector<std::pair<uint64_t, int>> written;
+    for (int i = 0; i < 1000; i++)
+    {
+        int width = 1 + static_cast<int>(rng() % 64);
+        uint64_t value = rng() & trajectory_codec::lowBits(width);
+        bits.put(value, width);
+        written.push_back({value, width});
+    }
+    bits.finish();
+    trajectory_codec::BitReader read(bits.bytes.data(), bits.bytes.size());
+    for (const auto &entry : written)
+        REQUIRE(read.get(entry.second) == entry.first);
+}
+
+TEST_CASE("Trajectory codec - lossless XOR channels")
+{
+    std::mt19937_64 rng(2);
+    std::uniform_real_distribution<double> uniform(-1e3, 1e3);
+    std::vector<double> values;
+    for (int i = 0; i < 500; i++)
+        values.push_back(std::sin(0.01 * i) * 50.0);
+    for (int i = 0; i < 200; i++)
+        values.push_back(uniform(rng));
+    for (double special : {0.0, -0.0, std::numeric_limits<double>::quiet_NaN(),
+                           std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::max(), 1.0})
+        values.push_back(special);
+
+    std::vector<uint8_t> bytes = trajectory_codec::encodeXor(values.data(), values.size());
+    std::vector<double> decoded(values.size());
+    trajectory_codec::decodeXor(bytes.data(), bytes.size(), decoded.data(), decoded.size());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        INFO("value " << i);
+        REQUIRE(sameBits(decoded[i], values[i]));
+    }
+
+    // A constant costs one bit per repeat
+    std::vector<double> constant(8000, 0.75);
+    REQUIRE(trajectory_codec::encodeXor(constant.data(), constant.size()).size() <= 8 + 1000);
+    REQUIRE_THROWS(trajectory_codec::decodeXor(bytes.data(), 10, decoded.data(), decoded.size()));
+}
+
+TEST_CASE("Trajectory codec - quantized channels")
+{
+    const std::filesystem::path file = tempFile("quantized.trj");
+    const size_t n = 5000;
+    {
+        TrajectoryArchiveWriter writer(file, {{"t", 5e-5}, {"x", 1e-3}, {"wild", 1e-3}}, 1024);
+        for (size_t i = 0; i < n; i++)
+        {
+            double t = 0.01 * static_cast<double>(i);
+            // The last block holds values no quantizer can take
+            double wild = i < 4096 ? std::cos(t) : (i % 2 ? std::numeric_limits<double>::quiet_NaN() : 1e300);
+            const double row[] = {t, 30.0 * t + 2.0 * std::sin(t), wild};
+            writer.append(row);
+        }
+        REQUIRE(writer.rows() == n);
+    }
+
+    TrajectoryArchive archive(file);
+    REQUIRE(archive.rows() == n);
+    REQUIRE(archive.blockCount() == 5);
+    std::vector<double> t = archive.readChannel(0), x = archive.readChannel(1), wild = archive.readChannel(2);
+    for (size_t i = 0; i < n; i++)
+    {
+        double ti = 0.01 * static_cast<double>(i);
+        REQUIRE(std::fabs(t[i] - ti) <= 5e-5 * (1.0 + 1e-9));
+        REQUIRE(std::fabs(x[i] - (30.0 * ti + 2.0 * std::sin(ti))) <= 1e-3 * (1.0 + 1e-9));
+        if (i < 4096)
+            REQUIRE(std::fabs(wild[i] - std::cos(ti)) <= 1e-3 * (1.0 + 1e-9));
+        else if (i % 2)
+            REQUIRE(std::isnan(wild[i]));
+        else
+            REQUIRE(wild[i] == 1e300);
+    }
+
+    // Uniform time and smooth tracks have (nearly) zero second differences:
+    // under two bytes for a row of three channels
+    REQUIRE(archive.block(1).bytes < 2 * 1024);
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Trajectory codec - archive random access")
+{
+    const std::filesystem::path file = tempFile("random_access.trj");
+    const size_t n = 10000, blockRows = 512;
+    auto value = [](size_t row, size_t channel)
+    { return channel == 0 ? 0.02 * static_cast<double>(row) : std::sin(0.001 * row * (channel + 1)) * 100.0; };
+    {
+        TrajectoryArchiveWriter writer(file, {{"t", 0.0}, {"a", 0.0}, {"b", 1e-4}}, blockRows);
+        for (size_t i = 0; i < n; i++)
+        {
+            const double row[] = {value(i, 0), value(i, 1), value(i, 2)};
+            writer.append(row);
+        }
+        writer.close();
+        REQUIRE(writer.bytesWritten() == std::filesystem::file_size(file));
+    }
+
+    TrajectoryArchive archive(file);
+    REQUIRE(archive.rows() == n);
+    REQUIRE(archive.blockSize() == blockRows);
+    REQUIRE(archive.blockCount() == (n + blockRows - 1) / blockRows);
+    REQUIRE(archive.channelIndex("b") == 2);
+    REQUIRE_THROWS(archive.channelIndex("missing"));
+
+    // Any block on its own, in any order
+    for (size_t i : {size_t(19), size_t(0), size_t(7), size_t(19), size_t(3)})
+    {
+        TrajectoryBlock block = archive.readBlock(i);
+        REQUIRE(block.first_row == i * blockRows);
+        REQUIRE(block.rows == std::min(blockRows, n - i * blockRows));
+        for (size_t r = 0; r < block.rows; r++)
+        {
+            size_t row = block.first_row + r;
+            REQUIRE(sameBits(block[0][r], value(row, 0)));
+            REQUIRE(sameBits(block[1][r], value(row, 1)));
+            REQUIRE(std::fabs(block[2][r] - value(row, 2)) <= 1e-4 * (1.0 + 1e-9));
+        }
+    }
+    REQUIRE(archive.blockForRow(0) == 0);
+    REQUIRE(archive.blockForRow(1023) == 1);
+    REQUIRE(archive.blockForRow(1024) == 2);
+    REQUIRE_THROWS(archive.blockForRow(n));
+    REQUIRE(archive.blockForTime(-1.0) == 0);
+    REQUIRE(archive.blockForTime(0.02 * 1500) == 2);
+    REQUIRE(archive.blockForTime(1e9) == archive.blockCount() - 1);
+
+    // Without its index (a writer that never closed) or cut short, no archive
+    std::vector<uint8_t> bytes = readFileBytes(file);
+    for (size_t size : {bytes.size() - 1, bytes.size() / 2, size_t(10)})
+    {
+        std::vector<uint8_t> cut(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(size));
+        writeFileAtomically(file, cut);
+        REQUIRE_THROWS(TrajectoryArchive(file));
+    }
+
+    // A writer destroyed by an exception leaves no index either; one that
+    // simply goes out of scope finishes the file
+    for (bool fail : {true, false})
+    {
+        try
+        {
+            TrajectoryArchiveWriter writer(file, {{"t", 0.0}}, 4);
+            for (size_t i = 0; i < 10; i++)
+            {
+                const double row[] = {0.1 * static_cast<double>(i)};
+                writer.append(row);
+            }
+            if (fail)
+                throw std::runtime_error("run failed");
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+        if (fail)
+            REQUIRE_THROWS(TrajectoryArchive(file));
+        else
+            REQUIRE(TrajectoryArchive(file).rows() == 10);
+    }
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Trajectory codec - scenario output")
+{
+    Scenario scenario = ScenarioLoader::loadFromFile(FLIGHTSIM_CONFIG_DIR "/scenarios/takeoff_climb.json");
+    const std::filesystem::path csvFile = tempFile("scenario.csv"), trjFile = tempFile("scenario.trj");
+    ScenarioResult csvRun = runScenario(scenario, csvFile);
+    ScenarioResult trjRun = runScenario(scenario, trjFile);
+    REQUIRE(trjRun.ok());
+    REQUIRE(trjRun.rows == csvRun.rows);
+
+    TrajectoryArchive archive(trjFile);
+    REQUIRE(archive.rows() == csvRun.rows);
+    std::vector<std::string> names;
+    for (const TrajectoryChannel &c : archive.channels())
+        names.push_back(c.name);
+    REQUIRE(names == std::vector<std::string>{"t", "x", "altitude", "vx", "vz", "speed", "pitch_deg", "alpha_deg",
+                                              "throttle", "elevator"});
+
+    std::vector<std::vector<double>> columns;
+    for (size_t c = 0; c < names.size(); c++)
+        columns.push_back(archive.readChannel(c));
+    std::ifstream csv(csvFile);
+    std::string line;
+    std::getline(csv, line);
+    for (size_t row = 0; std::getline(csv, line); row++)
+    {
+        std::stringstream fields(line);
+        std::string field;
+        for (size_t c = 0; std::getline(fields, field, ','); c++)
+        {
+            INFO("row " << row << ", " << names[c]);
+            // Both within half a printed digit of the true value
+            REQUIRE(std::fabs(columns[c][row] - std::stod(field)) <= 2.0 * archive.channels()[c].tolerance + 1e-9);
+        }
+    }
+
+    const double ratio = static_cast<double>(std::filesystem::file_size(csvFile)) /
+                         static_cast<double>(std::filesystem::file_size(trjFile));
+    INFO("CSV / archive size ratio " << ratio);
+    REQUIRE(ratio > 5.0);
+    std::filesystem::remove(csvFile);
+    std::filesystem::remove(trjFile);
+}
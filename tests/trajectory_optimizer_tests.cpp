@@ -0,0 +1,226 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "simulation/trajectory_optimizer.hpp"
+#include "scenario/scenario_runner.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifndef FLIGHTSIM_CONFIG_DIR
+#define FLIGHTSIM_CONFIG_DIR "config"
+#endif
+
+/**
+ * TEST STRATEGY:
+ * 1. Segment derivatives (dual numbers for the start state and controls,
+ *    differences for the duration) match finite differences of the segment
+ * 2. A minimum-time climb converges onto its terminal conditions within the
+ *    bounds and the angle of attack limit, independently of the thread count
+ * 3. Maximum range with no energy budget glides: zero throttle, terminal
+ *    altitude met
+ * 4. The exported scenario replays through the scenario runner onto the
+ *    optimized final state
+ * 5. Invalid options throw
+ */
+
+static std::filesystem::path tempPath(const std::string &name)
+{
+    return std::filesystem::temp_directory_path() / ("flightsim_trajopt_" + name);
+}
+
+static FlightState cruise()
+{
+    FlightState s;
+    s.position = Vec2(0.0, 100.0);
+    s.velocity = Vec2(30.0, 0.0);
+    s.pitch_deg = 3.0f;
+    s.throttle = 0.5f;
+    return s;
+}
+
+static TrajectoryOptions climbOptions()
+{
+    TrajectoryOptions o;
+    o.segments = 8;
+    o.duration = 20.0;
+    o.max_step = 0.05;
+    o.final_altitude = 150.0;
+    o.final_speed = 30.0;
+    o.final_vz = 0.0;
+    return o;
+}
+
+TEST_CASE("Trajectory optimizer - segment derivatives")
+{
+    using namespace trajectory_detail;
+    FlightParams params;
+    params.aircraft = AircraftLoader::loadFromJSON(FLIGHTSIM_CONFIG_DIR "/aircraft_config.json");
+    REQUIRE(params.aircraft.hasAeroTable());
+
+    const double state[StateSize] = {10.0, 120.0, 31.0, 1.5, 4.0, 0.5};
+    const double controls[ControlSize] = {0.6, 0.05};
+    const double duration = 1.5;
+    const int steps = 40;
+    SegmentEvaluation e;
+    evaluateSegment<TableAeroModel, RK4Integrator>(state, controls, 0.0, duration, 2, steps, params, true, e);
+    REQUIRE_FALSE(e.grounded);
+
+    auto outputs = [&](size_t input, double delta)
+    {
+        double s[StateSize], c[ControlSize];
+        std::copy(state, state + StateSize, s);
+        std::copy(controls, controls + ControlSize, c);
+        double tau = duration;
+        if (input < StateSize)
+            s[input] += delta;
+        else if (input < StateSize + ControlSize)
+            c[input - StateSize] += delta;
+        else
+            tau += delta;
+        SegmentEvaluation r;
+        evaluateSegment<TableAeroModel, RK4Integrator>(s, c, 0.0, tau, 2, steps, params, false, r);
+        return r.value;
+    };
+
+    for (size_t j = 0; j < InputSize; j++)
+    {
+        const double h = 1e-5;
+        std::array<double, OutputSize> plus = outputs(j, h), minus = outputs(j, -h);
+        for (size_t i = 0; i < OutputSize; i++)
+        {
+            INFO("output " << i << ", input " << j);
+            double fd = (plus[i] - minus[i]) / (2.0 * h);
+            REQUIRE(e.jacobian[i][j] == Catch::Approx(fd).epsilon(1e-4).margin(1e-3));
+        }
+    }
+}
+
+TEST_CASE("Trajectory optimizer - minimum time climb")
+{
+    Aircraft aircraft;
+    TrajectoryOptions options = climbOptions();
+    ThreadPool one(1), three(3);
+    TrajectoryResult r = optimizeTrajectory(cruise(), aircraft, options, three);
+
+    REQUIRE(r.converged);
+    REQUIRE(r.constraint_violation <= options.constraint_tolerance);
+    REQUIRE(r.duration < 0.5 * options.duration);
+    REQUIRE(r.duration == Catch::Approx(r.segment_duration * options.segments));
+    REQUIRE(r.nodes.size() == 9);
+    REQUIRE(r.throttle.size() == 8);
+
+    const FlightState &end = r.nodes.back();
+    // Tolerance 1e-3 in scaled units: 1 mm, 0.1 mm/s
+    REQUIRE(end.position.y == Catch::Approx(150.0).margin(1e-3));
+    REQUIRE(end.velocity.magnitude() == Catch::Approx(30.0).margin(1e-4));
+    REQUIRE(end.velocity.y == Catch::Approx(0.0).margin(1e-4));
+    REQUIRE(r.range == Catch::Approx(end.position.x));
+    for (size_t k = 0; k < r.throttle.size(); k++)
+    {
+        REQUIRE(r.throttle[k] >= 0.0);
+        REQUIRE(r.throttle[k] <= 1.0);
+        REQUIRE(std::fabs(r.elevator[k]) <= 1.0);
+        REQUIRE(std::fabs(r.nodes[k + 1].alpha_deg) <= options.max_alpha_deg + 1e-3);
+        REQUIRE(r.nodes[k + 1].position.y >= options.min_altitude - 1e-3);
+    }
+    REQUIRE(r.throttle.front() == Catch::Approx(1.0)); // Full power for the climb
+
+    // Segments are independent: the thread count does not change the result
+    TrajectoryResult serial = optimizeTrajectory(cruise(), aircraft, options, one);
+    REQUIRE(serial.iterations == r.iterations);
+    REQUIRE(serial.throttle == r.throttle);
+    REQUIRE(serial.elevator == r.elevator);
+    REQUIRE(serial.duration == r.duration);
+}
+
+TEST_CASE("Trajectory optimizer - maximum range glide")
+{
+    Aircraft aircraft;
+    FlightState start = cruise();
+    start.throttle = 0.0f;
+
+    TrajectoryOptions options;
+    options.objective = TrajectoryObjective::MaximumRange;
+    options.segments = 6;
+    options.duration = 30.0;
+    options.max_step = 0.05;
+    options.final_altitude = 50.0;
+    options.energy_budget = 0.0;
+    ThreadPool pool(2);
+    TrajectoryResult r = optimizeTrajectory(start, aircraft, options, pool);
+
+    REQUIRE(r.converged);
+    REQUIRE(r.nodes.back().position.y == Catch::Approx(50.0).margin(1e-3));
+    for (double throttle : r.throttle)
+        REQUIRE(throttle < 1e-4);
+    REQUIRE(r.energy < 1e-3 * aircraft.maxThrust * 30.0); // Budget tolerance in scaled units
+    // Fifty meters at the default aircraft's lift-to-drag ratio and more
+    // than the initial speed bled off
+    REQUIRE(r.range > 500.0);
+    REQUIRE(r.duration > options.min_duration);
+}
+
+TEST_CASE("Trajectory optimizer - exported schedule replays")
+{
+    Aircraft aircraft;
+    TrajectoryOptions options = climbOptions();
+    options.integrator = IntegratorType::SemiImplicitEuler;
+    ThreadPool pool(2);
+    TrajectoryResult r = optimizeTrajectory(cruise(), aircraft, options, pool);
+    REQUIRE(r.converged);
+
+    std::filesystem::path json = tempPath("schedule.json");
+    std::filesystem::path csv = tempPath("schedule.csv");
+    writeScheduleScenario(r, json, "default", "schedule");
+    Scenario scenario = ScenarioLoader::loadFromFile(json);
+    REQUIRE(scenario.name == "schedule");
+    REQUIRE(scenario.initial.integrator == IntegratorType::SemiImplicitEuler);
+    REQUIRE(scenario.initial.dt == Catch::Approx(r.dt()));
+    REQUIRE(scenario.events.size() == r.throttle.size());
+
+    ScenarioResult run = runScenario(scenario, csv);
+    REQUIRE(run.ok());
+    REQUIRE(run.stop_reason == "duration");
+    REQUIRE(run.sim_time == Catch::Approx(r.duration).margin(1e-6));
+
+    std::ifstream file(csv);
+    std::string line, last;
+    while (std::getline(file, line))
+        if (!line.empty())
+            last = line;
+    std::vector<double> row;
+    std::stringstream fields(last);
+    std::string field;
+    while (std::getline(fields, field, ','))
+        row.push_back(std::stod(field));
+    REQUIRE(row.size() == 10);
+
+    // The runner steps in float pitch; the schedule still lands on the target
+    const FlightState &end = r.nodes.back();
+    REQUIRE(row[1] == Catch::Approx(end.position.x).margin(0.5));
+    REQUIRE(row[2] == Catch::Approx(150.0).margin(0.5));
+    REQUIRE(row[5] == Catch::Approx(30.0).margin(0.2));
+
+    std::filesystem::remove(json);
+    std::filesystem::remove(csv);
+}
+
+TEST_CASE("Trajectory optimizer - invalid options")
+{
+    Aircraft aircraft;
+    ThreadPool pool(1);
+    TrajectoryOptions options = climbOptions();
+    options.segments = 0;
+    REQUIRE_THROWS(optimizeTrajectory(cruise(), aircraft, options, pool));
+
+    options = climbOptions();
+    options.duration = 0.5; // Below min_duration
+    REQUIRE_THROWS(optimizeTrajectory(cruise(), aircraft, options, pool));
+
+    options = climbOptions();
+    options.final_altitude = 0.0;
+    REQUIRE_THROWS_WITH(optimizeTrajectory(cruise(), aircraft, options, pool),
+                        Catch::Matchers::ContainsSubstring("ground"));
+}
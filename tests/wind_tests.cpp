@@ -0,0 +1,221 @@
+#define CATCH_CONFIG_MAIN
+#include "catch_amalgamated.hpp"
+#include "environment/wind.hpp"
+#include "simulation/physics_update.hpp"
+#include "scenario/scenario.hpp"
+#include <cmath>
+#include <vector>
+
+/**
+ * TEST STRATEGY:
+ * 1. Turbulence field statistics: exact RMS and zero mean, and the Dryden
+ *    autocorrelations at one length scale (exp(-1) horizontal,
+ *    exp(-1) / 2 vertical)
+ * 2. Field lookup: deterministic per seed, interpolates, wraps at the
+ *    repeat distance
+ * 3. 1-cosine gusts and the composed wind model
+ * 4. Force model: a steady wind is Galilean (only the air-relative velocity
+ *    matters), an updraft raises the angle of attack, still air is unchanged
+ * 5. Scenario "wind" block
+ */
+
+// Normalized autocorrelation of one channel at a lag of `lag` samples
+static double autocorrelation(const TurbulenceField &field, int channel, size_t lag)
+{
+    const size_t n = field.samples();
+    double sum = 0.0, sq = 0.0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double a = channel == 0 ? field.at(i * field.spacing()).x : field.at(i * field.spacing()).y;
+        double b = channel == 0 ? field.at((i + lag) * field.spacing()).x : field.at((i + lag) * field.spacing()).y;
+        sum += a * b;
+        sq += a * a;
+    }
+    return sum / sq;
+}
+
+TEST_CASE("Turbulence field - Dryden statistics")
+{
+    DrydenParameters p;
+    p.sigma_u = 2.0;
+    p.sigma_w = 1.5;
+    p.length_u = 200.0;
+    p.length_w = 100.0;
+    TurbulenceField field(p, 7, 5.0, 1 << 17);
+
+    double mean_u = 0.0, mean_w = 0.0, sq_u = 0.0, sq_w = 0.0;
+    for (size_t i = 0; i < field.samples(); i++)
+    {
+        Vec2 v = field.at(i * field.spacing());
+        mean_u += v.x;
+        mean_w += v.y;
+        sq_u += v.x * v.x;
+        sq_w += v.y * v.y;
+    }
+    const double n = static_cast<double>(field.samples());
+    REQUIRE(std::fabs(mean_u / n) < 1e-5);
+    REQUIRE(std::fabs(mean_w / n) < 1e-5);
+    REQUIRE(std::sqrt(sq_u / n) == Catch::Approx(2.0).epsilon(1e-5));
+    REQUIRE(std::sqrt(sq_w / n) == Catch::Approx(1.5).epsilon(1e-5));
+
+    // R_u(L) = exp(-1), R_w(L) = (1 - 1/2) exp(-1)
+    REQUIRE(autocorrelation(field, 0, 40) == Catch::Approx(std::exp(-1.0)).margin(0.05));
+    REQUIRE(autocorrelation(field, 1, 20) == Catch::Approx(0.5 * std::exp(-1.0)).margin(0.05));
+    // Far apart samples are uncorrelated
+    REQUIRE(std::fabs(autocorrelation(field, 0, 400)) < 0.05);
+}
+
+TEST_CASE("Turbulence field - lookup")
+{
+    DrydenParameters p = DrydenParameters::preset("moderate");
+    TurbulenceField a(p, 1, 5.0, 1 << 12);
+    TurbulenceField b(p, 1, 5.0, 1 << 12);
+    TurbulenceField c(p, 2, 5.0, 1 << 12);
+    REQUIRE(a.length() == Catch::Approx(5.0 * 4096));
+
+    // Same seed, same field; different seed, different field
+    REQUIRE(a.at(1234.5).x == b.at(1234.5).x);
+    REQUIRE(a.at(1234.5).y == b.at(1234.5).y);
+    REQUIRE(a.at(1234.5).x != c.at(1234.5).x);
+
+    // Linear between samples
+    Vec2 lo = a.at(100.0), hi = a.at(105.0), mid = a.at(102.5);
+    REQUIRE(mid.x == Catch::Approx(0.5 * (lo.x + hi.x)));
+    REQUIRE(mid.y == Catch::Approx(0.5 * (lo.y + hi.y)));
+
+    // Periodic, including negative distances
+    REQUIRE(a.at(37.0).x == Catch::Approx(a.at(37.0 + a.length()).x));
+    REQUIRE(a.at(-37.0).y == Catch::Approx(a.at(a.length() - 37.0).y));
+
+    REQUIRE_THROWS(TurbulenceField(p, 1, 5.0, 1000));
+    REQUIRE_THROWS(DrydenParameters::preset("hurricane"));
+}
+
+TEST_CASE("Wind model - gusts and composition")
+{
+    DiscreteGust gust;
+    gust.start = 10.0;
+    gust.duration = 2.0;
+    gust.amplitude = Vec2(0.0, 6.0);
+    REQUIRE(gust.at(9.0).y == 0.0);
+    REQUIRE(gust.at(11.0).y == Catch::Approx(6.0));
+    REQUIRE(gust.at(10.5).y == Catch::Approx(3.0));
+    REQUIRE(gust.at(12.5).y == 0.0);
+
+    WindModel wind;
+    REQUIRE_FALSE(wind.active());
+    wind.steady = Vec2(-5.0, 0.0);
+    wind.gusts.push_back(gust);
+    REQUIRE(wind.active());
+    Vec2 v = wind.at(0.0, 11.0);
+    REQUIRE(v.x == Catch::Approx(-5.0));
+    REQUIRE(v.y == Catch::Approx(6.0));
+
+    // Turbulence is frozen in the air mass, which drifts with the steady wind
+    wind.gusts.clear();
+    wind.turbulence = std::make_shared<const TurbulenceField>(DrydenParameters::preset("light"), 3, 5.0, 1 << 12);
+    wind.turbulence_offset = 1000.0;
+    Vec2 later = wind.at(-50.0, 10.0); // Same air parcel as x = 0 at t = 0
+    Vec2 first = wind.at(0.0, 0.0);
+    REQUIRE(later.x == Catch::Approx(first.x));
+    REQUIRE(later.y == Catch::Approx(first.y));
+    REQUIRE(first.x == Catch::Approx(-5.0 + wind.turbulence->at(1000.0).x));
+}
+
+static SimulationState cruiseState()
+{
+    SimulationState state;
+    state.dt = 0.01;
+    state.maxPathPoints = 0;
+    state.position = Vec2(0.0, 300.0);
+    state.velocity = Vec2(40.0, 0.0);
+    state.pitch_deg = 3.0f;
+    state.throttle = 0.5f;
+    return state;
+}
+
+TEST_CASE("Wind model - force model uses the air-relative velocity")
+{
+    SECTION("Steady wind is Galilean")
+    {
+        SimulationState still = cruiseState();
+        SimulationState windy = cruiseState();
+        windy.wind.steady = Vec2(10.0, 0.0); // Tailwind
+        windy.velocity = Vec2(50.0, 0.0);    // Same 40 m/s airspeed
+
+        for (int i = 0; i < 500; i++)
+        {
+            updatePhysics(still);
+            updatePhysics(windy);
+        }
+        REQUIRE(windy.velocity.x - still.velocity.x == Catch::Approx(10.0).epsilon(1e-9));
+        REQUIRE(windy.velocity.y == Catch::Approx(still.velocity.y).margin(1e-9));
+        REQUIRE(windy.alpha_deg == Catch::Approx(still.alpha_deg).epsilon(1e-5));
+        REQUIRE(windy.position.y == Catch::Approx(still.position.y).epsilon(1e-9));
+    }
+
+    SECTION("Updraft raises the angle of attack")
+    {
+        SimulationState still = cruiseState();
+        SimulationState gusty = cruiseState();
+        DiscreteGust gust;
+        gust.start = -1.0; // Peak at t = 0
+        gust.duration = 2.0;
+        gust.amplitude = Vec2(0.0, 5.0);
+        gusty.wind.gusts.push_back(gust);
+
+        updatePhysics(still);
+        updatePhysics(gusty);
+        // Air rising at 5 m/s past a 40 m/s aircraft: about 7 degrees more AoA
+        REQUIRE(gusty.alpha_deg - still.alpha_deg == Catch::Approx(std::atan2(5.0, 40.0) * 180.0 / M_PI).margin(0.01));
+
+        // The extra lift carries the aircraft up with the gust
+        for (int i = 0; i < 100; i++)
+        {
+            updatePhysics(still);
+            updatePhysics(gusty);
+        }
+        REQUIRE(gusty.velocity.y > still.velocity.y + 1.0);
+    }
+
+    SECTION("Airspeed autopilot holds airspeed in a headwind")
+    {
+        SimulationState state = cruiseState();
+        state.wind.steady = Vec2(-8.0, 0.0);
+        state.autopilot_speed = true;
+        state.speed_setpoint = 40.0f;
+        state.velocity = Vec2(32.0, 0.0);
+        for (int i = 0; i < 20000; i++)
+            updatePhysics(state);
+        REQUIRE((state.velocity - state.wind.steady).magnitude() == Catch::Approx(40.0).margin(0.5));
+    }
+}
+
+TEST_CASE("Wind model - scenario wind block")
+{
+    JsonValue root = JsonValue::parse(R"({
+        "wind": { "steady": [-5, 0], "turbulence": "light", "seed": 9, "offset": 250,
+                  "gusts": [ { "t": 20, "duration": 2, "vertical": 4 } ] }
+    })");
+    Scenario scenario = ScenarioLoader::fromJSON(root, ".", "wind");
+    const WindModel &wind = scenario.initial.wind;
+    REQUIRE(wind.steady.x == -5.0);
+    REQUIRE(wind.turbulence);
+    REQUIRE(wind.turbulence->seed() == 9);
+    REQUIRE(wind.turbulence->parameters().sigma_w == 1.5);
+    REQUIRE(wind.turbulence_offset == 250.0);
+    REQUIRE(wind.gusts.size() == 1);
+    REQUIRE(wind.gusts[0].amplitude.y == 4.0);
+
+    JsonValue custom = JsonValue::parse(R"({ "wind": { "turbulence": { "sigma_u": 1, "sigma_w": 0.5, "length_w": 100 } } })");
+    Scenario s2 = ScenarioLoader::fromJSON(custom, ".", "custom");
+    REQUIRE(s2.initial.wind.turbulence->parameters().length_w == 100.0);
+    REQUIRE(s2.initial.wind.turbulence->parameters().length_u == Catch::Approx(533.4));
+
+    JsonValue bad = JsonValue::parse(R"({ "wind": { "steady": [1, 2, 3] } })");
+    REQUIRE_THROWS(ScenarioLoader::fromJSON(bad, ".", "bad"));
+
+    // No wind block: still air
+    JsonValue none = JsonValue::parse("{}");
+    REQUIRE_FALSE(ScenarioLoader::fromJSON(none, ".", "none").initial.wind.active());
+}